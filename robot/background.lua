@@ -0,0 +1,29 @@
+---Background worker program.
+---
+---Runs on a low priority thread in its own Lua state, never inside the
+---control loop. Put heavy, non-realtime work here (planning, auto selection,
+---dashboards) and exchange results with bot programs using `worker.lua`
+---@see config.worker Worker settings
+
+local worker = require('worker')
+
+---Message handlers by topic.
+local handlers = {
+    ---Replies with the same payload. Handy to check the channel works.
+    ping = function(data)
+        worker.post('pong', data)
+    end,
+}
+
+local function run()
+    local topic, data = worker.poll()
+    while topic ~= nil do
+        local handler = handlers[topic]
+        if handler then handler(data) end
+        topic, data = worker.poll()
+    end
+end
+
+return {
+    run = run
+}
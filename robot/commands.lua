@@ -0,0 +1,137 @@
+---Commands.
+---
+---Build commands from robot actions, waits and groups, then schedule them.
+---The scheduler runs them in C++ every tick, so a running command costs no
+---Lua time. Scheduling a command interrupts any running command that uses
+---one of the same subsystems.
+---
+---Commands are discarded when bot programs are (re)loaded. Build them in
+---`init` or `prepare`, not every tick: there is room for 64 at a time
+---counting group members, and a command is used up once it finishes.
+---
+---```lua
+---local commands = require('commands')
+---local auto = commands.parallel(
+---    commands.shoot(1.0),
+---    commands.sequence(commands.wait(0.5), commands.drive(0.5, 0.0, 2.0)))
+---commands.schedule(auto)
+---```
+---@class commands
+local M = {}
+
+local impl = cxx.commands
+
+---Returned when a command couldn't be built.
+M.INVALID = impl.INVALID
+
+---Drive at a speed and rotation for some time.
+---@param speed number -1 to 1
+---@param rot number -1 to 1
+---@param seconds? number How long. Runs until interrupted if missing.
+---@return integer
+function M.drive(speed, rot, seconds)
+    return impl.action('drive', speed, rot, seconds or 0)
+end
+
+---Shoot a note. Finishes when the shot is done.
+---@param level? number Shoot level 0.2 to 1.0. Defaults to 1.0
+---@return integer
+function M.shoot(level)
+    return impl.action('shoot', level or 1.0)
+end
+
+---Run the intake.
+---@param seconds? number How long. Runs until interrupted if missing.
+---@return integer
+function M.intake(seconds)
+    return impl.action('intake', seconds or 0)
+end
+
+---Raise the lifter arms.
+---@param seconds? number How long. Runs until interrupted if missing.
+---@return integer
+function M.raise_arms(seconds)
+    return impl.action('lift', 1, seconds or 0)
+end
+
+---Lower the lifter arms.
+---@param seconds? number How long. Runs until interrupted if missing.
+---@return integer
+function M.lower_arms(seconds)
+    return impl.action('lift', -1, seconds or 0)
+end
+
+---Move the lifter arms to a position and hold them there. Finishes once
+---they're there.
+---@param target string|number A setpoint in `config.lifter.setpoints` or degrees.
+---@param seconds? number Longest to wait. Waits until there if missing.
+---@return integer
+function M.move_arms(target, seconds)
+    local degrees = type(target) == 'string' and cxx.lifter.setpoint(target) or target
+    if type(degrees) ~= 'number' then return M.INVALID end
+    return impl.action('lift_to', degrees, seconds or 0)
+end
+
+---Do nothing for some time.
+---@param seconds number
+---@return integer
+function M.wait(seconds)
+    return impl.wait(seconds)
+end
+
+---Run commands one after another.
+---@param ... integer Up to 8 commands.
+---@return integer
+function M.sequence(...)
+    return impl.sequence(...)
+end
+
+---Run commands together until they've all finished.
+---@param ... integer Up to 8 commands.
+---@return integer
+function M.parallel(...)
+    return impl.parallel(...)
+end
+
+---Run commands together until one finishes. The rest are interrupted.
+---@param ... integer Up to 8 commands.
+---@return integer
+function M.race(...)
+    return impl.race(...)
+end
+
+---Interrupt a command if it takes too long.
+---@param command integer
+---@param seconds number
+---@return integer
+function M.timeout(command, seconds)
+    return impl.timeout(command, seconds)
+end
+
+---Start running a command.
+---@param command integer
+---@return boolean scheduled False if the command was invalid, already used
+---                          or there was no room.
+function M.schedule(command)
+    return impl.schedule(command)
+end
+
+---Interrupt a command.
+---@param command integer
+function M.cancel(command)
+    impl.cancel(command)
+end
+
+---Interrupt every command.
+function M.cancel_all()
+    impl.cancel_all()
+end
+
+---Returns true if a command is running.
+---@param command integer
+---@return boolean
+function M.scheduled(command)
+    return impl.scheduled(command)
+end
+
+return M
@@ -37,8 +37,41 @@ local gamepad = {
 ---Engine specific settings.
 local engine = {
     ---Periodic time out in milliseconds. Greater than 0
-    period = math.max(1.0, math.floor((1.0 / 60.0) * 1000.0))   -- 60fps
+    period = math.max(1.0, math.floor((1.0 / 60.0) * 1000.0)),  -- 60fps
     -- period = 4
+
+    ---Bot programs to run in teleop mode. Each program runs every `divisor`
+    ---ticks, e.g. a divisor of 3 runs every third engine period.
+    teleop = {
+        { program = 'teleop.bot', divisor = 1 },
+        -- { program = 'drive.bot',      divisor = 1 },
+        -- { program = 'mechanisms.bot', divisor = 3 },
+    }
+}
+
+---Rate groups. Work that runs on its own schedule, independent of the engine
+---period which the Lua bot programs run at. `period` and `offset` are in
+---milliseconds. Offsets spread the groups out so they don't all land on the
+---same tick.
+local rates = {
+    ---Command scheduler. see commands.lua
+    commands   = { period = 20, offset = 0 },
+
+    ---Drivetrain velocity control loop.
+    drivetrain = { period = 5, offset = 0 },
+
+    ---Shooter and other mechanisms.
+    mechanisms = { period = 20, offset = 1 },
+
+    ---Battery current sharing. see `power`
+    power      = { period = 20, offset = 2 },
+
+    ---Drivetrain physics, simulation only. Lands just before the drivetrain
+    ---group so its sensors are fresh. see `simulation`
+    simulation = { period = 5, offset = 4 },
+
+    ---Copy subsystem state for the telemetry publisher.
+    telemetry  = { period = 20, offset = 3 }
 }
 
 ---Driving specific settings
@@ -59,18 +92,324 @@ local drivetrain = {
     encoder_resolution = 4096,
 
     -- Ratio applied to angular velocity. (0.0 to 1.0)
-    rotation_throttle = 0.54
+    rotation_throttle = 0.54,
+
+    ---Wheel velocity PID gains. Example values: tune for your own bot!
+    kp = 8.5,
+    ki = 0.0,
+    kd = 0.0,
+
+    ---Feedforward static gain (volts), velocity gain (volts per m/s) and
+    ---acceleration gain (volts per m/s^2). Run characterize.bot to measure
+    ---them, it saves them to `config_overlay.lua`.
+    ks = 1.0,
+    kv = 3.0,
+    ka = 0.0,
+
+    ---How often the encoders and gyro are sampled for odometry (milliseconds).
+    ---Runs on its own notifier, 5 ms is 200 Hz. About the last 1.3 seconds of
+    ---poses are kept for latency compensated lookups.
+    odometry_period = 5
+}
+
+---Power management. The battery's current is shared out so the bus voltage
+---stays above `min_voltage`, well clear of the roboRIO's 6.8V brownout.
+---Every subsystem may always draw its `min_current`; the rest goes by
+---`priority`, lowest first. Subsystems over their share have their output
+---scaled down.
+local power = {
+    enabled      = true,
+
+    ---Read total current from the PDP/PDH, which counts loads not managed
+    ---here. Otherwise the managed subsystems' motor currents are summed.
+    pdp          = true,
+
+    min_voltage  = 8.0,   -- volts
+    resistance   = 0.020, -- battery and wiring (ohms), also used by the simulator
+    min_budget   = 60.0,  -- amps
+    max_budget   = 400.0, -- amps
+    filter_time  = 0.1,   -- budget recovery time constant (seconds)
+    recover_rate = 1.0,   -- output scale recovered per second
+    min_scale    = 0.25,  -- lowest output scale
+
+    drivetrain   = { priority = 1, min_current = 60.0 },
+    lifter       = { priority = 2, min_current = 20.0 },
+    shooter      = { priority = 3, min_current = 20.0 }
+}
+
+---Drivetrain simulation. The physics is stepped apart from the control loop
+---and the engine period, so faster control rates can be tried in simulation
+---first. Times are in milliseconds.
+local simulation = {
+    ---Physics step. Voltages that land part way through a step are applied
+    ---from the next one.
+    step = 1.0,
+
+    ---Time for a motor controller to apply a new output.
+    controller_delay = 1.0,
+
+    ---Age of encoder and gyro readings when read. At most 512 steps.
+    sensor_latency = 0.0,
+
+    ---Standard deviation of encoder rate (m/s) and gyro (degrees) noise.
+    rate_noise = 0.0,
+    gyro_noise = 0.0,
+    seed       = 5167,
+
+    ---Step a fine reference alongside and report the integration error with
+    ---the stats. If the error is small, the step is fine for control loops
+    ---no faster than it.
+    reference      = false,
+    reference_step = 0.1
+}
+
+---Drivetrain characterization. see characterize.bot. Give the bot
+---`max_distance` of clear floor ahead and behind.
+local characterization = {
+    ramp_rate        = 0.25,  -- quasistatic volts per second
+    step_voltage     = 6.0,   -- dynamic step volts
+    quasistatic_time = 10.0,  -- longest quasistatic test (seconds)
+    dynamic_time     = 2.0,   -- longest dynamic test (seconds)
+    rest_time        = 1.0,   -- stopped between tests (seconds)
+    max_distance     = 3.0,   -- meters
+    min_velocity     = 0.02,  -- slower samples aren't fitted (m/s)
+    max_samples      = 16384,
+
+    ---Overlay written next to this file with the fitted gains.
+    output           = 'config_overlay.lua'
+}
+
+---Monte Carlo evaluation of `trajectories`, see tools/evaluator. Gains and
+---rates come from `drivetrain` and `rates`.
+local evaluator = {
+    runs               = 2000,
+    seed               = 2024,
+
+    ---Perturbations. Start pose error is normal (meters, degrees), slip is
+    ---even from 0 to `max_slip` per side, plant kV and kA error is normal.
+    start_xy           = 0.05,
+    start_heading      = 2.0,
+    max_slip           = 0.05,
+    gain_error         = 0.1,
+
+    ---Same plant as the simulator.
+    plant              = { kv = 1.98, ka = 0.2, kv_angular = 1.5, ka_angular = 0.3 },
+
+    step               = 1.0,  -- plant step (milliseconds)
+    speed_scale        = 0.5,  -- the follow action's speed scale, see AutonomousInit
+    settle_time        = 1.0,  -- after the trajectory ends (seconds)
+    position_tolerance = 0.1,  -- meters from the end pose counted as arrived
+    heading_tolerance  = 5.0   -- degrees
+}
+
+---Sampling profiler for test mode programs. Folded stacks are written next
+---to this file on leaving test mode, render them with flamegraph.pl.
+local profiler = {
+    enabled  = false,
+    interval = 1,      -- sample every N milliseconds
+    depth    = 32,     -- deepest stack recorded
+    slots    = 4096,   -- distinct stacks kept
+    arena    = 262144, -- bytes of stack text
+    output   = 'profile.folded'
+}
+
+---Pose estimation. Wheel odometry is fused with timestamped field poses from
+---vision. Standard deviations are x meters, y meters, heading radians; larger
+---means less trusted.
+local vision = {
+    ---Trust in the wheel odometry.
+    state_std_devs = { 0.02, 0.02, 0.01 },
+
+    ---Trust in a measurement that doesn't say how good it is.
+    measurement_std_devs = { 0.3, 0.3, 0.5 },
+
+    ---Measurements older than this are rejected (milliseconds). Can't be more
+    ---than the estimator's 1.5 second history.
+    max_age = 1000,
+
+    ---Fake measurements generated from the simulated pose.
+    synthetic = {
+        enabled     = true,
+        period      = 100,   -- milliseconds between measurements
+        latency     = 50,    -- milliseconds
+        noise_xy    = 0.05,  -- meters
+        noise_theta = 0.02,  -- radians
+        seed        = 9431
+    }
+}
+
+---Realtime setup of the control loop thread. Every step degrades gracefully
+---without privileges (e.g. on a desktop), see the `[rt]` lines at startup.
+local realtime = {
+    ---Master switch. When false nothing below is applied.
+    enabled = false,
+
+    ---Lock all memory in RAM so the loop never page faults.
+    lock_memory = true,
+
+    ---SCHED_FIFO priority of the loop thread (1-99). 0 to leave as is.
+    priority = 40,
+
+    ---CPU the loop thread runs on. -1 to not pin.
+    cpu = 1,
+
+    ---CPU every other thread (NetworkTables, camera, worker) runs on. -1 to
+    ---not pin. The HAL notifier stays at the loop's priority, and the
+    ---odometry notifier moves to the loop's CPU.
+    helper_cpu = 0,
+
+    ---Bytes of stack to pre-fault.
+    prefault_stack = 256 * 1024,
+
+    ---Bytes of Lua heap to pre-fault.
+    prefault_lua = 4 * 1024 * 1024
+}
+
+---Overrun handling. Deferrable work (telemetry capture, Lua GC steps,
+---dashboard chooser polling, stats logging) is skipped after a main loop
+---tick overruns, or when the current tick is close to its deadline. See the
+---`[overrun]` line at the end of each mode for how often each was shed.
+local overrun = {
+    ---Fraction of the engine period after which deferrable work is shed.
+    margin = 0.75,
+
+    ---Size of the Lua GC step run at the end of a tick with time to spare, in
+    ---KB. 0 is one basic step, -1 to not step.
+    gc_step = 0
 }
 
--- lifter specific settings
-local lifter = {}
+---Background Lua worker. Runs a program in its own Lua state on a low
+---priority thread. See `worker.lua` and `background.lua`
+local worker = {
+    ---Set false to not start the worker thread.
+    enabled = true,
+
+    ---Program file to run.
+    program = 'background.lua',
+
+    ---How often the program's run function is called (milliseconds)
+    period = 50
+}
+
+---Dashboard telemetry. Published to NetworkTables under /Telemetry by a
+---background thread. Only values that changed are sent.
+local telemetry = {
+    ---How often changes are published (milliseconds)
+    period = 50
+}
+
+---Live tunables. These settings are mirrored to NetworkTables under
+---/Tunables/<category>/<name> and can be edited from the dashboard while the
+---bot runs. Starting values come from the settings above, this sets the
+---{ min, max } each edit is clamped to. Edits are not saved: copy good values
+---back here.
+local tunables = {
+    ---Publish to NetworkTables.
+    enabled = true,
+
+    drivetrain = {
+        kp                = { 0.0, 50.0 },
+        ki                = { 0.0, 10.0 },
+        kd                = { 0.0, 10.0 },
+        ks                = { 0.0, 6.0 },
+        kv                = { 0.0, 12.0 },
+        ka                = { 0.0, 4.0 },
+        rotation_throttle = { 0.0, 1.0 }
+    },
+
+    shooter = {
+        shoot_power            = { 1.0, 12.0 },
+        intake_primary_power   = { 1.0, 12.0 },
+        intake_secondary_power = { 1.0, 12.0 }
+    }
+}
+
+---Camera and vision pipeline. Capture, processing and publishing each run on
+---their own low priority thread using a fixed pool of frames.
+local camera = {
+    ---Set false to not start the camera.
+    enabled = true,
+
+    ---Where frames come from: 'camera' or 'files'. The camera is not used in
+    ---simulation.
+    source = 'camera',
+
+    ---Directory of recorded .png/.jpg images when `source` is 'files',
+    ---relative to the deploy directory.
+    files = 'images',
+
+    name = 'Camera 1',
+    device = 0,
+    width = 640,
+    height = 360,
+    fps = 20,
+
+    ---Frames preallocated (3 to 8).
+    pool_size = 6,
+
+    ---When processing falls behind: 'oldest' skips stale frames and processes
+    ---the newest, 'newest' processes every frame and drops new captures.
+    drop_policy = 'oldest'
+}
+
+---Lifter settings. Positions are arm angles in degrees from horizontal, read
+---from the NEO hall sensors through the gearbox.
+local lifter = {
+    gear_ratio       = 60.0, -- motor turns per arm turn
+    manual_voltage   = 3.6,  -- volts when moved up or down by hand
+
+    ---Arms are assumed to be here at power on.
+    start_position   = -80.0,
+
+    ---Soft limits. Also set on the controllers.
+    min_position     = -85.0,
+    max_position     = 95.0,
+
+    ---Named positions for `robot.move_arms()`
+    setpoints        = {
+        stowed  = -80.0,
+        raised  = 90.0,
+        climbed = -60.0
+    },
+
+    ---Motion profile limits and how close counts as there.
+    max_velocity     = 180.0, -- deg/s
+    max_acceleration = 360.0, -- deg/s^2
+    tolerance        = 2.0,   -- deg
+
+    ---Position loop on the roboRIO, volts per degree of error.
+    kP               = 0.2,
+    kI               = 0.0,
+    kD               = 0.0,
+
+    ---Feedforward: static, gravity at horizontal (volts) and velocity
+    ---(volts per deg/s).
+    kS               = 0.1,
+    kG               = 0.4,
+    kV               = 0.021,
+
+    ---Run the position loop on the SPARK MAXes instead, duty cycle per
+    ---motor turn of error. The feedforward is still sent from here.
+    onboard          = {
+        enabled = false,
+        kP      = 0.05,
+        kI      = 0.0,
+        kD      = 0.0
+    },
+
+    ---Arm in the simulator.
+    sim_arm_length   = 0.5, -- meters
+    sim_arm_mass     = 2.0  -- kg
+}
 
 ---Shooter specific settings
 local shooter = {
-    ---(deprecated) Time to run intake motor (seconds) 
+    ---Longest time to run the intake motors without a note (seconds). It
+    ---stops sooner when a note is detected, see `note_detect`.
     intake_time = 3.0,
 
-    ---Time to warm up before shooting (seconds)
+    ---Longest time to wait for the flywheels to reach speed before feeding
+    ---the note anyway (seconds)
     warmup_time = 1.0,
 
     ---Time taken to shoot the note (seconds)
@@ -83,7 +422,101 @@ local shooter = {
     intake_primary_power = 5.0,
 
     ---Power while intaking. Secondary motor. (volts)
-    intake_secondary_power = 4.0
+    intake_secondary_power = 4.0,
+
+    ---Flywheel speed per volt of shoot power (RPM/V). A shot aims for
+    ---shoot_power * level * rpm_per_volt.
+    rpm_per_volt = 440,
+
+    ---Both flywheels must be within this fraction of the target speed to
+    ---feed the note.
+    ready_tolerance = 0.05,
+
+    ---Fraction of the target speed the flywheels can drop by once ready.
+    ready_exit_tolerance = 0.10,
+
+    ---Readings in a row within tolerance before feeding.
+    ready_samples = 2,
+
+    ---Flywheel moment of inertia in the simulator (kg m^2)
+    sim_moi = 0.0008,
+
+    ---Ends intake once a note is seated, judged by the summed current of the
+    ---shooter motors. Current is low-pass filtered, the start inrush is
+    ---ignored and the free running level learned. A note is in when current
+    ---stays `spike_current` above that level for `plateau_time`. The learned
+    ---level is kept between `min_free_current` and `max_free_current`, so a
+    ---note already in at the start is still detected.
+    note_detect = {
+        enabled          = true,
+        filter_time      = 0.04, -- seconds
+        blank_time       = 0.30, -- seconds
+        spike_current    = 6.0,  -- amps
+        plateau_time     = 0.12, -- seconds
+        min_free_current = 1.0,  -- amps
+        max_free_current = 14.0  -- amps
+    },
+
+    ---Intake current in the simulator: an inrush decaying to the free current,
+    ---then a step when the note arrives. note_time -1 never brings a note.
+    sim_intake = {
+        free_current   = 8.0,  -- amps
+        inrush_current = 30.0, -- amps
+        inrush_time    = 0.15, -- seconds
+        note_time      = 1.0,  -- seconds
+        note_current   = 16.0  -- amps
+    }
+}
+
+---CAN bus settings.
+local can = {
+    ---Motor voltages closer than this to the last one sent are not sent
+    ---again (volts)
+    cache_epsilon = 0.01,
+
+    ---Resend unchanged motor voltages at least this often (milliseconds)
+    keep_alive = 100,
+
+    ---Spark MAX periodic status frame periods (milliseconds). Slower frames
+    ---mean less bus traffic. `default` applies to every controller, entries
+    ---named after a port override it. Frames are:
+    ---  status0 applied output, faults (followers track their leader's)
+    ---  status1 velocity, temperature, voltage, current
+    ---  status2 position
+    ---  status3 analog sensor
+    ---  status4 alternate encoder
+    ---  status5 duty cycle position
+    ---  status6 duty cycle velocity
+    status_frames = {
+        default = {
+            status0 = 100,
+            status1 = 500,
+            status2 = 500,
+            status3 = 1000,
+            status4 = 1000,
+            status5 = 1000,
+            status6 = 1000
+        },
+
+        -- followers need their leader's applied output quickly, and the power
+        -- budget reads every drive motor's current each 20 ms.
+        drive_left_leader    = { status0 = 10, status1 = 20 },
+        drive_right_leader   = { status0 = 10, status1 = 20 },
+        drive_left_follower  = { status1 = 20 },
+        drive_right_follower = { status1 = 20 },
+
+        -- the lifter closes its position loop on the roboRIO every tick, and
+        -- reads current for the power budget.
+        arm_left  = { status1 = 20, status2 = 20 },
+        arm_right = { status1 = 20, status2 = 20 },
+
+        -- flywheel speeds decide when a shot is fed, and current when a
+        -- note is in.
+        shooter_primary_top      = { status1 = 20 },
+        shooter_primary_bottom   = { status1 = 20 },
+        shooter_secondary_top    = { status1 = 20 },
+        shooter_secondary_bottom = { status1 = 20 }
+    }
 }
 
 ---Ports, channels, indexes used in motor controllers, gamepads, etc...
@@ -167,7 +600,7 @@ local function print_settings(title, cat)
     print(title .. ":")
     for key in pairs(cat) do
         local pad = space_for_key - #key
-        print("  " .. key .. string.rep(' ', pad) .. " = " .. cat[key])
+        print("  " .. key .. string.rep(' ', pad) .. " = " .. tostring(cat[key]))
     end
 end
 
@@ -188,12 +621,27 @@ M.general = general
 ---Port indexes
 M.ports = ports
 
+---CAN bus settings
+M.can = can
+
 ---Gamepad specific settings
 M.gamepad = gamepad
 
 ---Drivetrain settings
 M.drivetrain = drivetrain
 
+---Pose estimation settings
+M.vision = vision
+
+---Camera settings
+M.camera = camera
+
+---Live tunable ranges
+M.tunables = tunables
+
+---Telemetry settings
+M.telemetry = telemetry
+
 ---Lifter settings
 M.lifter = lifter
 
@@ -206,6 +654,56 @@ M.trajectories = trajectories
 ---Engine settings
 M.engine = engine
 
+---Rate group settings
+M.rates = rates
+
+---Background worker settings
+M.worker = worker
+
+---Realtime settings
+M.realtime = realtime
+
+---Overrun settings
+M.overrun = overrun
+
+---Characterization settings
+M.characterization = characterization
+
+---Power management settings
+M.power = power
+
+---Simulation settings
+M.simulation = simulation
+
+---Evaluator settings
+M.evaluator = evaluator
+
+---Profiler settings
+M.profiler = profiler
+
+---Apply settings saved by tools on the robot, e.g. characterize.bot. An
+---overlay returns a table of sections whose values replace those above.
+local function apply_overlay(name)
+    local ok, overlay = pcall(require, name)
+    if not ok then
+        -- a missing overlay is normal, a broken one isn't.
+        if not string.find(overlay, "module '" .. name .. "' not found", 1, true) then
+            print('[config] overlay ' .. name .. ' failed: ' .. tostring(overlay))
+        end
+        return
+    end
+    if type(overlay) ~= 'table' then return end
+    for section, values in pairs(overlay) do
+        local target = M[section]
+        if type(target) == 'table' and type(values) == 'table' then
+            for key, value in pairs(values) do target[key] = value end
+        end
+    end
+    print('[config] applied overlay: ' .. name)
+end
+
+apply_overlay((string.gsub(characterization.output, '%.lua$', '')))
+
 ---Print all settings to the console.
 function M.print()
     print("Configuration")
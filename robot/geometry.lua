@@ -0,0 +1,262 @@
+---2d geometry as FFI value types.
+---
+---Translation2d, Rotation2d, Pose2d, Transform2d and Twist2d are plain C
+---structs, laid out like src/geometry.hpp. Reading fields is a load the JIT
+---compiles in line, and the math calls WPILib through `cxx.geometry.api`
+---without leaving compiled code.
+---
+---Methods that make a value take an optional `out` to write in to. Pass one
+---made ahead of time to do pose math every tick without making garbage.
+---
+---```lua
+---local geometry = require('geometry')
+---local pose = geometry.Pose2d(1.0, 2.0, math.pi / 2)
+---local step = geometry.Transform2d(0.5, 0.0, 0.0)
+---local next = geometry.Pose2d()
+---pose:transform_by(step, next)
+---print(next:x(), next:y(), next.rotation:degrees())
+---```
+---@class geometry
+local M = {}
+
+local ffi = require('ffi')
+
+local cos, sin, atan2, sqrt = math.cos, math.sin, math.atan2, math.sqrt
+
+-- keep in sync with src/geometry.hpp
+ffi.cdef [[
+typedef struct frc_Translation2d { double x, y; } frc_Translation2d;
+typedef struct frc_Rotation2d { double cos, sin; } frc_Rotation2d;
+typedef struct frc_Pose2d {
+    frc_Translation2d translation;
+    frc_Rotation2d rotation;
+} frc_Pose2d;
+typedef struct frc_Transform2d {
+    frc_Translation2d translation;
+    frc_Rotation2d rotation;
+} frc_Transform2d;
+typedef struct frc_Twist2d { double dx, dy, dtheta; } frc_Twist2d;
+
+typedef struct frc_GeometryApi {
+    void (*rotation_from_radians) (double, frc_Rotation2d*);
+    double (*rotation_radians) (const frc_Rotation2d*);
+    void (*rotation_rotate_by) (const frc_Rotation2d*, const frc_Rotation2d*, frc_Rotation2d*);
+    void (*rotation_interpolate) (const frc_Rotation2d*, const frc_Rotation2d*, double, frc_Rotation2d*);
+
+    double (*translation_distance) (const frc_Translation2d*, const frc_Translation2d*);
+    void (*translation_rotate_by) (const frc_Translation2d*, const frc_Rotation2d*, frc_Translation2d*);
+    void (*translation_interpolate) (const frc_Translation2d*, const frc_Translation2d*, double, frc_Translation2d*);
+
+    void (*pose_transform_by) (const frc_Pose2d*, const frc_Transform2d*, frc_Pose2d*);
+    void (*pose_relative_to) (const frc_Pose2d*, const frc_Pose2d*, frc_Pose2d*);
+    void (*pose_interpolate) (const frc_Pose2d*, const frc_Pose2d*, double, frc_Pose2d*);
+    void (*pose_exp) (const frc_Pose2d*, const frc_Twist2d*, frc_Pose2d*);
+    void (*pose_log) (const frc_Pose2d*, const frc_Pose2d*, frc_Twist2d*);
+    double (*pose_distance) (const frc_Pose2d*, const frc_Pose2d*);
+
+    void (*transform_between) (const frc_Pose2d*, const frc_Pose2d*, frc_Transform2d*);
+    void (*transform_compose) (const frc_Transform2d*, const frc_Transform2d*, frc_Transform2d*);
+    void (*transform_inverse) (const frc_Transform2d*, frc_Transform2d*);
+} frc_GeometryApi;
+]]
+
+local api = ffi.cast('const frc_GeometryApi*', cxx.geometry.api)
+
+local translation_t = ffi.typeof('frc_Translation2d')
+local rotation_t    = ffi.typeof('frc_Rotation2d')
+local pose_t        = ffi.typeof('frc_Pose2d')
+local transform_t   = ffi.typeof('frc_Transform2d')
+local twist_t       = ffi.typeof('frc_Twist2d')
+
+---Make a translation in meters.
+---@param x? number
+---@param y? number
+function M.Translation2d(x, y)
+    return translation_t(x or 0.0, y or 0.0)
+end
+
+---Make a rotation from radians.
+---@param radians? number
+function M.Rotation2d(radians)
+    radians = radians or 0.0
+    return rotation_t(cos(radians), sin(radians))
+end
+
+---Make a pose from meters and radians.
+---@param x? number
+---@param y? number
+---@param radians? number
+function M.Pose2d(x, y, radians)
+    radians = radians or 0.0
+    return pose_t({ x or 0.0, y or 0.0 }, { cos(radians), sin(radians) })
+end
+
+---Make a transform from meters and radians.
+---@param x? number
+---@param y? number
+---@param radians? number
+function M.Transform2d(x, y, radians)
+    radians = radians or 0.0
+    return transform_t({ x or 0.0, y or 0.0 }, { cos(radians), sin(radians) })
+end
+
+---Make a twist from meters and radians.
+---@param dx? number
+---@param dy? number
+---@param dtheta? number
+function M.Twist2d(dx, dy, dtheta)
+    return twist_t(dx or 0.0, dy or 0.0, dtheta or 0.0)
+end
+
+--------------------------------------------------------------------------------
+local Translation2d = {}
+
+---Distance from the origin in meters.
+function Translation2d:norm() return sqrt(self.x * self.x + self.y * self.y) end
+
+---Distance to another translation in meters.
+function Translation2d:distance(other) return api.translation_distance(self, other) end
+
+---Rotate about the origin.
+function Translation2d:rotate_by(rotation, out)
+    out = out or translation_t()
+    api.translation_rotate_by(self, rotation, out)
+    return out
+end
+
+---Linear interpolation toward `to`, `t` from 0 to 1.
+function Translation2d:interpolate(to, t, out)
+    out = out or translation_t()
+    api.translation_interpolate(self, to, t, out)
+    return out
+end
+
+function Translation2d:__tostring()
+    return string.format('Translation2d(%g, %g)', self.x, self.y)
+end
+
+--------------------------------------------------------------------------------
+local Rotation2d = {}
+
+function Rotation2d:radians() return atan2(self.sin, self.cos) end
+function Rotation2d:degrees() return math.deg(atan2(self.sin, self.cos)) end
+function Rotation2d:tan() return self.sin / self.cos end
+
+---Add another rotation to this one.
+function Rotation2d:rotate_by(other, out)
+    out = out or rotation_t()
+    api.rotation_rotate_by(self, other, out)
+    return out
+end
+
+---Interpolate toward `to` the short way round, `t` from 0 to 1.
+function Rotation2d:interpolate(to, t, out)
+    out = out or rotation_t()
+    api.rotation_interpolate(self, to, t, out)
+    return out
+end
+
+function Rotation2d:__tostring()
+    return string.format('Rotation2d(%g deg)', self:degrees())
+end
+
+--------------------------------------------------------------------------------
+local Pose2d = {}
+
+function Pose2d:x() return self.translation.x end
+function Pose2d:y() return self.translation.y end
+
+---Apply a transform relative to this pose.
+function Pose2d:transform_by(transform, out)
+    out = out or pose_t()
+    api.pose_transform_by(self, transform, out)
+    return out
+end
+
+---This pose as seen from `other`.
+function Pose2d:relative_to(other, out)
+    out = out or pose_t()
+    api.pose_relative_to(self, other, out)
+    return out
+end
+
+---Interpolate along the twist toward `to`, `t` from 0 to 1.
+function Pose2d:interpolate(to, t, out)
+    out = out or pose_t()
+    api.pose_interpolate(self, to, t, out)
+    return out
+end
+
+---Follow a twist from this pose.
+function Pose2d:exp(twist, out)
+    out = out or pose_t()
+    api.pose_exp(self, twist, out)
+    return out
+end
+
+---The twist that goes from this pose to `to`.
+function Pose2d:log(to, out)
+    out = out or twist_t()
+    api.pose_log(self, to, out)
+    return out
+end
+
+---Distance between the translations in meters.
+function Pose2d:distance(other) return api.pose_distance(self, other) end
+
+function Pose2d:__tostring()
+    return string.format('Pose2d(%g, %g, %g deg)', self.translation.x, self.translation.y,
+        self.rotation:degrees())
+end
+
+--------------------------------------------------------------------------------
+local Transform2d = {}
+
+function Transform2d:x() return self.translation.x end
+function Transform2d:y() return self.translation.y end
+
+---This transform followed by `other`.
+function Transform2d:compose(other, out)
+    out = out or transform_t()
+    api.transform_compose(self, other, out)
+    return out
+end
+
+---The transform that undoes this one.
+function Transform2d:inverse(out)
+    out = out or transform_t()
+    api.transform_inverse(self, out)
+    return out
+end
+
+function Transform2d:__tostring()
+    return string.format('Transform2d(%g, %g, %g deg)', self.translation.x, self.translation.y,
+        self.rotation:degrees())
+end
+
+---The transform that takes pose `initial` to pose `last`.
+function M.between(initial, last, out)
+    out = out or transform_t()
+    api.transform_between(initial, last, out)
+    return out
+end
+
+--------------------------------------------------------------------------------
+local Twist2d = {}
+
+function Twist2d:__tostring()
+    return string.format('Twist2d(%g, %g, %g)', self.dx, self.dy, self.dtheta)
+end
+
+local function metatype(ct, methods)
+    methods.__index = methods
+    ffi.metatype(ct, methods)
+end
+
+metatype(translation_t, Translation2d)
+metatype(rotation_t, Rotation2d)
+metatype(pose_t, Pose2d)
+metatype(transform_t, Transform2d)
+metatype(twist_t, Twist2d)
+
+return M
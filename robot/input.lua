@@ -0,0 +1,89 @@
+---Input events.
+---
+---Bot programs register handlers for input edges instead of polling buttons
+---every tick. The C++ side finds the edges and calls `dispatch` once for each
+---one, so a tick with no input changes runs no handler code at all.
+---
+---Handlers are cleared whenever bot programs are (re)loaded, so register them
+---in `init` or `prepare`.
+---
+---```lua
+---local input = require('input')
+---input.on_button(gamepad.BUTTON_A, function() robot.intake() end)
+---input.on_pov(function(angle) print(angle) end)
+---```
+---@class input
+local M = {}
+
+local impl = cxx.params
+
+local EVENT_BUTTON_DOWN = impl.EVENT_BUTTON_DOWN
+local EVENT_BUTTON_UP   = impl.EVENT_BUTTON_UP
+local EVENT_POV         = impl.EVENT_POV
+local EVENT_AXIS_ABOVE  = impl.EVENT_AXIS_ABOVE
+local EVENT_AXIS_BELOW  = impl.EVENT_AXIS_BELOW
+
+local pressed  = {}
+local released = {}
+local povs     = {}
+local axes     = {}
+
+---Call a function when a button is pressed.
+---@param button integer A gamepad button e.g. `gamepad.BUTTON_A`
+---@param fn function Called with no arguments.
+function M.on_button(button, fn)
+    pressed[button] = fn
+end
+
+---Call a function when a button is released.
+---@param button integer A gamepad button e.g. `gamepad.BUTTON_A`
+---@param fn function Called with no arguments.
+function M.on_button_released(button, fn)
+    released[button] = fn
+end
+
+---Call a function when the dpad changes.
+---@param fn function Called with the new angle in degrees, or -1 if released.
+function M.on_pov(fn)
+    povs[1] = fn
+end
+
+---Call a function when an axis crosses a threshold in either direction.
+---@param axis integer A gamepad axis e.g. `gamepad.TRIGGER_LEFT`
+---@param threshold number Magnitude to cross (0.0 to 1.0)
+---@param fn function Called with true when crossing up to the threshold,
+---                   false when going back below it, and the axis value.
+function M.on_axis(axis, threshold, fn)
+    axes[axis] = fn
+    impl.set_axis_threshold(axis, threshold)
+end
+
+---Remove all handlers.
+function M.clear()
+    pressed, released, povs, axes = {}, {}, {}, {}
+    impl.clear_axis_thresholds()
+end
+
+---Deliver one event. Called from C++.
+---@param kind integer Event type
+---@param index integer Button (0-based), dpad or axis index
+---@param value number
+function M.dispatch(kind, index, value)
+    local fn
+    if kind == EVENT_BUTTON_DOWN then
+        fn = pressed[index + 1] -- gamepad buttons are 1-indexed.
+    elseif kind == EVENT_BUTTON_UP then
+        fn = released[index + 1]
+    elseif kind == EVENT_POV then
+        fn = povs[index + 1]
+        if fn then fn(value) end
+        return
+    elseif kind == EVENT_AXIS_ABOVE or kind == EVENT_AXIS_BELOW then
+        fn = axes[index]
+        if fn then fn(kind == EVENT_AXIS_ABOVE, value) end
+        return
+    end
+    if fn then fn() end
+end
+
+return M
@@ -0,0 +1,98 @@
+---LuaJIT trace diagnostics.
+---
+---Attaches to the JIT's trace events and counts the traces it compiles and
+---the ones it aborts, by reason and source location. Aborted code runs in
+---the interpreter, usually because of a call into C (the `cxx` bindings) or
+---something LuaJIT doesn't compile yet (NYI). see src/jitdiag.hpp
+---
+---Reasons are text when LuaJIT's jit/vmdef.lua is on package.path, otherwise
+---the trace error number.
+local M = {}
+
+local jit = require('jit')
+local jutil = require('jit.util')
+local has_vmdef, vmdef = pcall(require, 'jit.vmdef')
+
+local stats = nil
+
+---Returns "file:line" for a Lua function, or the name of a builtin.
+local function location(func, pc)
+    local info = jutil.funcinfo(func, pc)
+    if info.source == nil then
+        if has_vmdef and info.ffid and vmdef.ffnames[info.ffid] then
+            return vmdef.ffnames[info.ffid]
+        end
+        return '[C]'
+    end
+    local source = string.gsub(info.source, '^[@=]', '')
+    source = string.match(source, '[^/\\]+$') or source
+    return source .. ':' .. tostring(info.currentline or info.linedefined or 0)
+end
+
+local function reason(err, info)
+    if type(err) ~= 'number' then return tostring(err) end
+    if type(info) == 'function' then info = location(info) end
+    if has_vmdef and vmdef.traceerr[err] then
+        return string.format(vmdef.traceerr[err], info)
+    end
+    if info == nil then return 'trace error ' .. err end
+    return 'trace error ' .. err .. ' (' .. tostring(info) .. ')'
+end
+
+local function on_trace(what, tr, func, pc, otr, oex)
+    if what == 'start' then
+        stats.started = stats.started + 1
+        stats.starts[tr] = location(func, pc)
+    elseif what == 'stop' then
+        stats.compiled = stats.compiled + 1
+        local where = stats.starts[tr] or location(func, pc)
+        stats.traces[where] = (stats.traces[where] or 0) + 1
+    elseif what == 'abort' then
+        stats.aborted = stats.aborted + 1
+        local key = reason(otr, oex) .. '\t' .. location(func, pc)
+        stats.aborts[key] = (stats.aborts[key] or 0) + 1
+    elseif what == 'flush' then
+        stats.flushed = stats.flushed + 1
+    end
+end
+
+---Start counting. Flushes compiled traces so everything is seen again.
+function M.attach()
+    M.detach()
+    stats = { started = 0, compiled = 0, aborted = 0, flushed = 0, starts = {}, traces = {}, aborts = {} }
+    jit.flush()
+    jit.attach(on_trace, 'trace')
+end
+
+---Stop counting. Counts are kept until the next attach.
+function M.detach()
+    jit.attach(on_trace)
+end
+
+local function by_count(a, b)
+    if a.count ~= b.count then return a.count > b.count end
+    return a.location < b.location
+end
+
+---Returns counts since attach. `aborts` is a list of { reason, location,
+---count } and `traces` of { location, count }, most first.
+function M.result()
+    local s = stats or { started = 0, compiled = 0, aborted = 0, flushed = 0, traces = {}, aborts = {} }
+    local out = {
+        started = s.started, compiled = s.compiled,
+        aborted = s.aborted, flushed = s.flushed,
+        aborts = {}, traces = {}
+    }
+    for key, count in pairs(s.aborts) do
+        local why, where = string.match(key, '^(.*)\t(.*)$')
+        out.aborts[#out.aborts + 1] = { reason = why, location = where, count = count }
+    end
+    for where, count in pairs(s.traces) do
+        out.traces[#out.traces + 1] = { location = where, count = count }
+    end
+    table.sort(out.aborts, by_count)
+    table.sort(out.traces, by_count)
+    return out
+end
+
+return M
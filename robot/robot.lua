@@ -28,6 +28,19 @@ local function stop_lifter()
     lifter.stop()
 end
 
+---Move the arms to a position along a motion profile, then hold it.
+---@param target string|number A setpoint in `config.lifter.setpoints` or degrees.
+---@return boolean ok False if there's no such setpoint.
+local function move_arms(target)
+    return lifter.move_to(target)
+end
+
+---Returns true if the arms are holding the position they were moved to.
+---@return boolean
+local function arms_at_goal()
+    return lifter.at_goal()
+end
+
 ---Returns true if the robot is shooting.
 ---@return boolean
 local function shooting()
@@ -60,6 +73,8 @@ local M = {
     drive          = drive,
     raise_arms     = raise_arms,
     lower_arms     = lower_arms,
+    move_arms      = move_arms,
+    arms_at_goal   = arms_at_goal,
     intake_running = intake_running,
     intake         = intake,
     shooting       = shooting,
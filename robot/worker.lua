@@ -0,0 +1,27 @@
+---Messaging between bot programs and the background worker.
+---
+---The same module works in both Lua states. `post` sends a message to the
+---other side and `poll` receives one from it. Messages never block: `post`
+---returns false when the queue is full.
+---@class worker
+local M = {}
+
+local impl = cxx.worker
+
+---Send a message to the other side.
+---@param topic string Message topic (max 31 bytes)
+---@param data? any Payload, converted with tostring (max 222 bytes)
+---@return boolean sent False if the queue is full or the message too long.
+function M.post(topic, data)
+    if data == nil then return impl.post(topic) end
+    return impl.post(topic, tostring(data))
+end
+
+---Receive the next message from the other side.
+---@return string|nil topic nil when nothing is waiting.
+---@return string|nil data
+function M.poll()
+    return impl.poll()
+end
+
+return M
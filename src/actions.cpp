@@ -0,0 +1,117 @@
+#include "actions.hpp"
+#include "robot.hpp"
+
+namespace detail {
+
+// true once a timed action has run its time. 0 seconds never finishes.
+static bool timeIsUp (const CommandState& state, double seconds) noexcept {
+    return seconds > 0.0 && state.elapsed >= seconds;
+}
+
+} // namespace detail
+
+//==============================================================================
+bool DriveAction::execute (CommandState& state) {
+    if (detail::timeIsUp (state, state.args[2]))
+        return true;
+    drivetrain.driveNormalized (state.args[0], state.args[1]);
+    return false;
+}
+
+void DriveAction::end (CommandState&, bool) {
+    drivetrain.drive (MetersPerSecond (0), RadiansPerSecond (0));
+}
+
+//==============================================================================
+bool FollowTrajectoryAction::execute (CommandState& state) {
+    if (trajectory == nullptr)
+        return true;
+
+    const units::second_t elapsed { state.elapsed };
+    const units::second_t turnTime { state.args[1] };
+
+    if (elapsed <= trajectory->TotalTime()) {
+        auto reference = trajectory->Sample (elapsed);
+        auto speeds    = ramsete.Calculate (drivetrain.estimatedPosition(), reference);
+        if (reversed)
+            speeds.vx *= -1.0;
+        drivetrain.drive (speeds.vx * state.args[0], speeds.omega);
+        return false;
+    }
+
+    if (elapsed < trajectory->TotalTime() + turnTime) {
+        drivetrain.drive (MetersPerSecond (0), DegreesPerSecond (state.args[2]));
+        return false;
+    }
+
+    return true;
+}
+
+void FollowTrajectoryAction::end (CommandState&, bool) {
+    drivetrain.drive (MetersPerSecond (0), RadiansPerSecond (0));
+}
+
+//==============================================================================
+bool ShootAction::execute (CommandState& state) {
+    // phase 0: waiting for the shooter to be free. 1: shooting.
+    if (state.phase == 0) {
+        if (! shooter.isIdle())
+            return false;
+        shooter.setShootLevel (state.args[0]);
+        shooter.shoot();
+        state.phase = 1;
+        return false;
+    }
+
+    return ! shooter.isShooting();
+}
+
+void ShootAction::end (CommandState& state, bool interrupted) {
+    if (interrupted && state.phase == 1)
+        shooter.stop();
+}
+
+//==============================================================================
+bool IntakeAction::execute (CommandState& state) {
+    // keep asking, a shot in progress has to finish first.
+    if (shooter.isIdle())
+        shooter.intake();
+    return detail::timeIsUp (state, state.args[0]);
+}
+
+void IntakeAction::end (CommandState&, bool) {
+    if (shooter.isLoading())
+        shooter.stop();
+}
+
+//==============================================================================
+bool LiftAction::execute (CommandState& state) {
+    if (detail::timeIsUp (state, state.args[1]))
+        return true;
+    if (state.args[0] > 0.0)
+        lifter.moveUp();
+    else if (state.args[0] < 0.0)
+        lifter.moveDown();
+    else
+        lifter.stop();
+    return false;
+}
+
+void LiftAction::end (CommandState&, bool) {
+    lifter.stop();
+}
+
+//==============================================================================
+void LiftToAction::initialize (CommandState& state) {
+    lifter.moveTo (state.args[0]);
+}
+
+bool LiftToAction::execute (CommandState& state) {
+    return lifter.atGoal() || detail::timeIsUp (state, state.args[1]);
+}
+
+void LiftToAction::end (CommandState&, bool interrupted) {
+    // arrived arms keep holding the position.
+    if (interrupted)
+        lifter.stop();
+}
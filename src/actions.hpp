@@ -0,0 +1,122 @@
+#pragma once
+
+#include <frc/controller/RamseteController.h>
+#include <frc/trajectory/Trajectory.h>
+
+#include "commands.hpp"
+
+class Drivetrain;
+class Lifter;
+class Shooter;
+
+/** Requirement bits of the robot's subsystems. */
+namespace subsystem {
+enum : uint32_t {
+    Drivetrain = 1u << 0,
+    Shooter    = 1u << 1,
+    Lifter     = 1u << 2
+};
+}
+
+/** Drive at a normalized speed and rotation for some time.
+    args: speed (-1 to 1), rotation (-1 to 1), seconds (0 runs until
+    interrupted)
+*/
+class DriveAction final : public Action {
+public:
+    explicit DriveAction (Drivetrain& d) : drivetrain (d) {}
+    std::string_view name() const noexcept override { return "drive"; }
+    uint32_t requirements() const noexcept override { return subsystem::Drivetrain; }
+    bool execute (CommandState& state) override;
+    void end (CommandState& state, bool interrupted) override;
+
+private:
+    Drivetrain& drivetrain;
+};
+
+/** Follow the autonomous trajectory with a Ramsete controller, then turn in
+    place for a while.
+    args: speed scale, seconds to turn after, degrees per second to turn at
+*/
+class FollowTrajectoryAction final : public Action {
+public:
+    explicit FollowTrajectoryAction (Drivetrain& d) : drivetrain (d) {}
+    std::string_view name() const noexcept override { return "follow"; }
+    uint32_t requirements() const noexcept override { return subsystem::Drivetrain; }
+    bool execute (CommandState& state) override;
+    void end (CommandState& state, bool interrupted) override;
+
+    /** Set the trajectory to follow. It must outlive any command using it. */
+    void setTrajectory (const frc::Trajectory& t, bool reverse) noexcept {
+        trajectory = &t;
+        reversed   = reverse;
+    }
+
+private:
+    Drivetrain& drivetrain;
+    const frc::Trajectory* trajectory { nullptr };
+    bool reversed { false };
+    frc::RamseteController ramsete;
+};
+
+/** Shoot a note and finish once the shooter is idle again. Waits for a
+    running intake to stop first.
+    args: shoot level (0.2 to 1)
+*/
+class ShootAction final : public Action {
+public:
+    explicit ShootAction (Shooter& s) : shooter (s) {}
+    std::string_view name() const noexcept override { return "shoot"; }
+    uint32_t requirements() const noexcept override { return subsystem::Shooter; }
+    bool execute (CommandState& state) override;
+    void end (CommandState& state, bool interrupted) override;
+
+private:
+    Shooter& shooter;
+};
+
+/** Run the intake.
+    args: seconds (0 runs until interrupted)
+*/
+class IntakeAction final : public Action {
+public:
+    explicit IntakeAction (Shooter& s) : shooter (s) {}
+    std::string_view name() const noexcept override { return "intake"; }
+    uint32_t requirements() const noexcept override { return subsystem::Shooter; }
+    bool execute (CommandState& state) override;
+    void end (CommandState& state, bool interrupted) override;
+
+private:
+    Shooter& shooter;
+};
+
+/** Move the lifter arms.
+    args: direction (> 0 up, < 0 down), seconds (0 runs until interrupted)
+*/
+class LiftAction final : public Action {
+public:
+    explicit LiftAction (Lifter& l) : lifter (l) {}
+    std::string_view name() const noexcept override { return "lift"; }
+    uint32_t requirements() const noexcept override { return subsystem::Lifter; }
+    bool execute (CommandState& state) override;
+    void end (CommandState& state, bool interrupted) override;
+
+private:
+    Lifter& lifter;
+};
+
+/** Move the lifter arms to a position and hold them there.
+    args: degrees, seconds (0 waits until there)
+*/
+class LiftToAction final : public Action {
+public:
+    explicit LiftToAction (Lifter& l) : lifter (l) {}
+    std::string_view name() const noexcept override { return "lift_to"; }
+    uint32_t requirements() const noexcept override { return subsystem::Lifter; }
+    void initialize (CommandState& state) override;
+    bool execute (CommandState& state) override;
+    void end (CommandState& state, bool interrupted) override;
+
+private:
+    Lifter& lifter;
+};
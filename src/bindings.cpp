@@ -1,11 +1,21 @@
 
+#include <filesystem>
+#include <tuple>
+
 #include <frc/XboxController.h>
+#include <frc/geometry/Pose2d.h>
+#include <frc/geometry/Rotation2d.h>
+#include <frc/geometry/Transform2d.h>
 
 #include "scripting.hpp"
 #include "sol/sol.hpp"
 
+#include "characterization.hpp"
+#include "commands.hpp"
+#include "geometry.hpp"
 #include "parameters.hpp"
 #include "robot.hpp"
+#include "worker.hpp"
 
 namespace lua {
 
@@ -109,11 +119,24 @@ bool Parameters::bind (Parameters* self) {
         M["rotation"] = [self]() -> lua_Number { return self->getAngularSpeed(); };
         M["brake"]    = [self]() -> lua_Number { return self->getBrake(); };
 
+        // input events, see input.lua
+        M["EVENT_BUTTON_DOWN"] = (int) Parameters::Event::ButtonDown;
+        M["EVENT_BUTTON_UP"]   = (int) Parameters::Event::ButtonUp;
+        M["EVENT_POV"]         = (int) Parameters::Event::POV;
+        M["EVENT_AXIS_ABOVE"]  = (int) Parameters::Event::AxisAbove;
+        M["EVENT_AXIS_BELOW"]  = (int) Parameters::Event::AxisBelow;
+
+        M["set_axis_threshold"] = [self] (int axis, double threshold) {
+            self->setAxisThreshold (axis, threshold);
+        };
+        M["clear_axis_thresholds"] = [self]() { self->clearAxisThresholds(); };
+
         cxx["params"] = M;
     } else {
         // clang-format off
         detail::clear_function_bindings (L, "params", { 
-            "speed", "rotation", "brake" 
+            "speed", "rotation", "brake", 
+            "set_axis_threshold", "clear_axis_thresholds" 
         });
         // clang-format on
     }
@@ -162,10 +185,26 @@ void Lifter::bind (Lifter* self) {
         M["move_up"]   = [self]() { self->moveUp(); };
         M["move_down"] = [self]() { self->moveDown(); };
         M["stop"]      = [self]() { self->stop(); };
+        M["move_to"]   = [self] (sol::object target) {
+            if (target.is<double>()) {
+                self->moveTo (target.as<double>());
+                return true;
+            }
+            return target.is<std::string>() && self->moveTo (target.as<std::string>());
+        };
+        M["setpoint"] = [self] (const std::string& name) {
+            return self->settings().setpoint (name);
+        };
+        M["position"] = [self]() { return self->position(); };
+        M["at_goal"]  = [self]() { return self->atGoal(); };
 
         cxx["lifter"] = M;
     } else {
-        detail::clear_function_bindings (L, "lifter", { "move_up", "move_down", "stop" });
+        // clang-format off
+        detail::clear_function_bindings (L, "lifter", {
+            "move_up", "move_down", "stop", "move_to", "setpoint", "position", "at_goal"
+        });
+        // clang-format on
     }
 }
 
@@ -189,11 +228,129 @@ void Drivetrain::bind (Drivetrain* self) {
 }
 
 //=============================================================================
-// experimental...
-#include <frc/geometry/Pose2d.h>
-#include <frc/geometry/Rotation2d.h>
+void Characterization::bind (Characterization* self) {
+    auto& L  = lua::state();
+    auto cxx = detail::cxx_table (L);
+
+    // bind/unbind 'cxx.characterization' global module.
+    if (self != nullptr) {
+        auto M = L.create_table();
+
+        M["start"]    = [self]() { self->start(); };
+        M["stop"]     = [self]() { self->stop(); };
+        M["active"]   = [self]() { return self->active(); };
+        M["finished"] = [self]() { return self->finished(); };
+        M["test"]     = [self]() { return std::string (Characterization::name (self->test())); };
+
+        // fit, write the overlay and return the gains. nil and a message on
+        // failure.
+        M["save"] = [self] (sol::this_state ts) -> std::tuple<sol::object, sol::object> {
+            sol::state_view L (ts);
+            auto gains = self->fit();
+            if (! gains)
+                return { sol::lua_nil, sol::make_object (L, "not enough data to fit") };
+
+            std::filesystem::path path (lua::search_directory());
+            path /= self->output();
+            if (! self->save (*gains, path.string()))
+                return { sol::lua_nil, sol::make_object (L, "could not write " + path.string()) };
+
+            auto T       = L.create_table();
+            T["ks"]      = gains->kS;
+            T["kv"]      = gains->kV;
+            T["ka"]      = gains->kA;
+            T["r2"]      = gains->r2;
+            T["rmse"]    = gains->rmse;
+            T["samples"] = gains->samples;
+            T["path"]    = path.string();
+            return { T, sol::lua_nil };
+        };
+
+        cxx["characterization"] = M;
+    } else {
+        // clang-format off
+        detail::clear_function_bindings (L, "characterization", {
+            "start", "stop", "active", "finished", "test", "save"
+        });
+        // clang-format on
+    }
+}
+
+//=============================================================================
 namespace lua {
+namespace detail {
+
+// build a group from Lua arguments without allocating.
+template <typename Build>
+static CommandScheduler::Id command_group (sol::variadic_args va, Build&& build) {
+    std::array<CommandScheduler::Id, CommandScheduler::MaxChildren> ids;
+    int count = 0;
+    for (auto arg : va) {
+        if (count >= CommandScheduler::MaxChildren)
+            return CommandScheduler::Invalid;
+        ids[count++] = arg.is<int>() ? arg.get<int>() : CommandScheduler::Invalid;
+    }
+    return build (ids.data(), count);
+}
+
+} // namespace detail
+} // namespace lua
+
+void CommandScheduler::bind (CommandScheduler* self) {
+    auto& L  = lua::state();
+    auto cxx = detail::cxx_table (L);
 
+    // bind/unbind 'cxx.commands' global module.
+    if (self != nullptr) {
+        auto M = L.create_table();
+
+        M["INVALID"] = (int) CommandScheduler::Invalid;
+
+        M["action"] = [self] (std::string_view name, sol::optional<double> a0,
+                              sol::optional<double> a1, sol::optional<double> a2) {
+            return self->action (name, a0.value_or (0.0), a1.value_or (0.0), a2.value_or (0.0));
+        };
+        M["wait"]     = [self] (double seconds) { return self->wait (seconds); };
+        M["sequence"] = [self] (sol::variadic_args va) {
+            return detail::command_group (va, [self] (const Id* ids, int n) { return self->sequence (ids, n); });
+        };
+        M["parallel"] = [self] (sol::variadic_args va) {
+            return detail::command_group (va, [self] (const Id* ids, int n) { return self->parallel (ids, n); });
+        };
+        M["race"] = [self] (sol::variadic_args va) {
+            return detail::command_group (va, [self] (const Id* ids, int n) { return self->race (ids, n); });
+        };
+        M["timeout"]    = [self] (int id, double seconds) { return self->timeout (id, seconds); };
+        M["schedule"]   = [self] (int id) { return self->schedule (id); };
+        M["cancel"]     = [self] (int id) { self->cancel (id); };
+        M["cancel_all"] = [self]() { self->cancelAll(); };
+        M["scheduled"]  = [self] (int id) { return self->isScheduled (id); };
+
+        cxx["commands"] = M;
+    } else {
+        // clang-format off
+        detail::clear_function_bindings (L, "commands", { 
+            "action", "wait", "sequence", "parallel", "race", "timeout",
+            "schedule", "cancel", "cancel_all", "scheduled"
+        });
+        // clang-format on
+    }
+}
+
+//=============================================================================
+void lua::Worker::bind (Worker* self) {
+    // bind/unbind 'cxx.worker' global module.
+    bindChannels (state().lua_state(),
+                  self != nullptr ? &self->toWorker : nullptr,
+                  self != nullptr ? &self->fromWorker : nullptr);
+}
+
+//=============================================================================
+namespace lua {
+
+/** Rotation2d as a sol usertype. Kept to compare against the FFI types in
+    robot/geometry.lua, see test/geometrytest.cpp
+*/
 inline static int frc_Rotation2d (lua_State* state) {
     using frc::Rotation2d;
     sol::state_view L (state);
@@ -201,7 +358,7 @@ inline static int frc_Rotation2d (lua_State* state) {
 
     // clang-format off
     T.new_usertype<Rotation2d> ("Rotation2d", sol::no_constructor,
-        "new", []() { return Rotation2d(); },
+        "new", [](double radians) { return Rotation2d (units::radian_t (radians)); },
         "rotateBy", &Rotation2d::RotateBy,
         "cos", sol::readonly_property (&Rotation2d::Cos),
         "sin", sol::readonly_property (&Rotation2d::Sin),
@@ -212,7 +369,26 @@ inline static int frc_Rotation2d (lua_State* state) {
     // clang-format on
 
     sol::stack::push (L, T["Rotation2d"]);
-    return 0;
+    return 1;
+}
+
+inline static int frc_Transform2d (lua_State* state) {
+    using frc::Transform2d;
+    sol::state_view L (state);
+    auto T = L.create_table();
+    // clang-format off
+    T.new_usertype<Transform2d> ("Transform2d", sol::no_constructor,
+        "new", [](double x, double y, double radians) {
+            return Transform2d (units::meter_t (x), units::meter_t (y), units::radian_t (radians));
+        },
+        "x", sol::readonly_property ([](const Transform2d& self) { return self.X().value(); }),
+        "y", sol::readonly_property ([](const Transform2d& self) { return self.Y().value(); }),
+        "rotation", sol::readonly_property (&Transform2d::Rotation),
+        "inverse", &Transform2d::Inverse
+    );
+    // clang-format on
+    sol::stack::push (L, T["Transform2d"]);
+    return 1;
 }
 
 inline static int frc_Pose2d (lua_State* state) {
@@ -221,14 +397,43 @@ inline static int frc_Pose2d (lua_State* state) {
     auto T = L.create_table();
     // clang-format off
     T.new_usertype<Pose2d> ("Pose2d", sol::no_constructor,
-        "new", []() { return Pose2d(); },
-        "x", sol::readonly_property ([](Pose2d& self) { return self.X().value(); }),
-        "y", sol::readonly_property ([](Pose2d& self) { return self.Y().value(); }),
-        "rotation", sol::readonly_property(&Pose2d::Rotation)
+        "new", [](double x, double y, double radians) {
+            return Pose2d (units::meter_t (x), units::meter_t (y), units::radian_t (radians));
+        },
+        "x", sol::readonly_property ([](const Pose2d& self) { return self.X().value(); }),
+        "y", sol::readonly_property ([](const Pose2d& self) { return self.Y().value(); }),
+        "rotation", sol::readonly_property (&Pose2d::Rotation),
+        "transformBy", &Pose2d::TransformBy,
+        "relativeTo", &Pose2d::RelativeTo,
+        "distance", [](const Pose2d& self, const Pose2d& other) {
+            return self.Translation().Distance (other.Translation()).value();
+        }
     );
     // clang-format on
     sol::stack::push (L, T["Pose2d"]);
     return 1;
 }
 
+void bind_geometry() {
+    auto& L  = state();
+    auto cxx = detail::cxx_table (L);
+
+    // 'cxx.geometry' holds no instance, so it's never unbound.
+    auto M   = L.create_table();
+    M["api"] = sol::lightuserdata_value (const_cast<frc_GeometryApi*> (frc_geometry_api()));
+
+    // the usertypes, for comparison.
+    const std::tuple<const char*, lua_CFunction> usertypes[] = {
+        { "Rotation2d", frc_Rotation2d },
+        { "Transform2d", frc_Transform2d },
+        { "Pose2d", frc_Pose2d }
+    };
+    for (const auto& [name, loader] : usertypes) {
+        loader (L.lua_state());
+        M[name] = sol::stack::pop<sol::object> (L.lua_state());
+    }
+
+    cxx["geometry"] = M;
+}
+
 } // namespace lua
@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "cachedmotor.hpp"
+#include "config.hpp"
+
+namespace detail {
+
+static std::vector<CachedMotor*>& motors() {
+    static std::vector<CachedMotor*> list;
+    return list;
+}
+
+static snider::OutputCache makeCache() {
+    const auto keepAlive = std::chrono::duration<double, std::milli> (
+        std::max (0.0, config::number ("can", "keep_alive", 100.0)));
+    return snider::OutputCache (
+        config::number ("can", "cache_epsilon", 0.01),
+        std::chrono::duration_cast<snider::OutputCache::clock::duration> (keepAlive));
+}
+
+} // namespace detail
+
+CachedMotor::CachedMotor (std::string_view portSymbol, MotorType type)
+    : _name (portSymbol),
+      spark (config::port (portSymbol), type),
+      cache (detail::makeCache()),
+      periods (can::status_periods (portSymbol)) {
+    can::apply (spark, periods);
+    detail::motors().push_back (this);
+}
+
+CachedMotor::~CachedMotor() {
+    auto& list = detail::motors();
+    list.erase (std::remove (list.begin(), list.end(), this), list.end());
+}
+
+const std::vector<CachedMotor*>& CachedMotor::all() noexcept {
+    return detail::motors();
+}
+
+void CachedMotor::report (std::ostream& out) {
+    for (const auto* m : all()) {
+        const auto total = m->sent() + m->suppressed();
+        out << "[can] " << std::left << std::setw (26) << m->name()
+            << " sent=" << m->sent()
+            << " suppressed=" << m->suppressed()
+            << std::fixed << std::setprecision (1)
+            << " (" << (total > 0 ? 100.0 * m->suppressed() / total : 0.0) << "%)"
+            << std::endl;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <rev/CANSparkMax.h>
+#include <units/voltage.h>
+
+#include "canbus.hpp"
+#include "snider/outputcache.hpp"
+#include "types.hpp"
+
+/** A thin wrapper over rev::CANSparkMax that skips redundant CAN writes.
+
+    A voltage within `config.can.cache_epsilon` of the last one sent is not
+    sent again until `config.can.keep_alive` milliseconds pass. Sent and
+    suppressed frames are counted per device.
+
+    Status frame periods from `config.can.status_frames` are applied when
+    constructed. Configuration calls go straight to the controller with
+    motor().
+*/
+class CachedMotor final {
+public:
+    /** @param portSymbol A port name in `config.ports`
+        @param type The motor type.
+    */
+    CachedMotor (std::string_view portSymbol, MotorType type);
+    ~CachedMotor();
+
+    CachedMotor (const CachedMotor&)            = delete;
+    CachedMotor& operator= (const CachedMotor&) = delete;
+
+    /** Set the output voltage unless it's the same as last time. */
+    void setVoltage (units::volt_t volts) {
+        if (cache.update (volts.value()))
+            spark.SetVoltage (volts);
+    }
+
+    /** Returns the set speed of the controller. */
+    double get() const { return spark.Get(); }
+
+    /** Returns the last voltage sent. */
+    units::volt_t lastVoltage() const noexcept { return units::volt_t { cache.lastValue() }; }
+
+    /** Force the next setVoltage() to be sent. */
+    void invalidate() noexcept { cache.invalidate(); }
+
+    /** Returns the wrapped controller. */
+    rev::CANSparkMax& motor() noexcept { return spark; }
+
+    /** Returns the wrapped controller. */
+    const rev::CANSparkMax& motor() const noexcept { return spark; }
+
+    /** Returns the port name. */
+    const std::string& name() const noexcept { return _name; }
+
+    /** Returns the status frame periods applied to this controller. */
+    const can::StatusPeriods& statusPeriods() const noexcept { return periods; }
+
+    /** Returns the number of frames sent. */
+    int64_t sent() const noexcept { return cache.sent(); }
+
+    /** Returns the number of frames suppressed. */
+    int64_t suppressed() const noexcept { return cache.suppressed(); }
+
+    /** Returns every motor currently instantiated. */
+    static const std::vector<CachedMotor*>& all() noexcept;
+
+    /** Write sent and suppressed counts of every motor to a stream. */
+    static void report (std::ostream& out);
+
+private:
+    std::string _name;
+    rev::CANSparkMax spark;
+    snider::OutputCache cache;
+    can::StatusPeriods periods;
+};
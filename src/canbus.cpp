@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <rev/CANSparkMax.h>
+
+#include "cachedmotor.hpp"
+#include "canbus.hpp"
+#include "config.hpp"
+#include "scripting.hpp"
+
+namespace can {
+namespace detail {
+
+// copy `statusN = ms` entries from a table over the given periods.
+static void read_periods (sol::object obj, StatusPeriods& periods) {
+    if (! obj.is<sol::table>())
+        return;
+    sol::table tbl = obj;
+    for (int i = 0; i < num_status_frames; ++i) {
+        const auto key = std::string ("status") + std::to_string (i);
+        periods[i]     = static_cast<int> (tbl.get_or (key, static_cast<double> (periods[i])));
+    }
+}
+
+} // namespace detail
+
+StatusPeriods default_status_periods() noexcept {
+    return { 10, 20, 20, 50, 20, 200, 200 };
+}
+
+StatusPeriods status_periods (std::string_view device) {
+    auto periods    = default_status_periods();
+    sol::object cfg = lua::config::get ("can", "status_frames");
+    if (! cfg.is<sol::table>())
+        return periods;
+
+    sol::table frames = cfg;
+    detail::read_periods (frames["default"], periods);
+    if (! device.empty())
+        detail::read_periods (frames[device], periods);
+
+    for (auto& p : periods)
+        p = std::clamp (p, 1, 65535);
+    return periods;
+}
+
+void apply (rev::CANSparkMax& motor, const StatusPeriods& periods) {
+    using Frame = rev::CANSparkLowLevel::PeriodicFrame;
+    static constexpr std::array<Frame, num_status_frames> frames {
+        Frame::kStatus0, Frame::kStatus1, Frame::kStatus2, Frame::kStatus3,
+        Frame::kStatus4, Frame::kStatus5, Frame::kStatus6
+    };
+
+    for (int i = 0; i < num_status_frames; ++i)
+        motor.SetPeriodicFramePeriod (frames[i], periods[i]);
+}
+
+double frame_rate (const StatusPeriods& periods) noexcept {
+    double rate = 0.0;
+    for (auto p : periods)
+        rate += 1000.0 / static_cast<double> (std::max (1, p));
+    return rate;
+}
+
+double bus_load (double framesPerSecond, double bitrate, double bitsPerFrame) noexcept {
+    return bitrate > 0.0 ? framesPerSecond * bitsPerFrame / bitrate : 0.0;
+}
+
+void report (std::ostream& out) {
+    const double keepAlive = std::max (1.0, config::number ("can", "keep_alive", 100.0));
+    double total = 0.0, totalDefault = 0.0;
+
+    for (const auto* m : CachedMotor::all()) {
+        // status frames plus at least one control frame per keep alive.
+        const double rate = frame_rate (m->statusPeriods()) + 1000.0 / keepAlive;
+        total += rate;
+        totalDefault += frame_rate (default_status_periods()) + 1000.0 / keepAlive;
+        out << "[can] " << std::left << std::setw (26) << m->name()
+            << std::fixed << std::setprecision (0)
+            << " " << rate << " frames/s" << std::endl;
+    }
+
+    out << "[can] estimated bus load: " << std::fixed << std::setprecision (1)
+        << 100.0 * bus_load (total) << "% ("
+        << 100.0 * bus_load (totalDefault) << "% with REV defaults)" << std::endl;
+}
+
+} // namespace can
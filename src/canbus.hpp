@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <iosfwd>
+#include <string_view>
+
+namespace rev {
+class CANSparkMax;
+}
+
+/** CAN bus status frame budget.
+
+    Spark MAX controllers broadcast periodic status frames whether we read
+    them or not. These helpers apply per device frame periods from
+    `config.can.status_frames` and estimate the bus load they cause.
+*/
+namespace can {
+
+/** Number of Spark MAX periodic status frames. */
+constexpr int num_status_frames = 7;
+
+/** Status frame periods in milliseconds, indexed by frame number. */
+using StatusPeriods = std::array<int, num_status_frames>;
+
+/** Returns REV's default status frame periods. */
+StatusPeriods default_status_periods() noexcept;
+
+/** Returns the configured periods for a device. Values come from
+    `status_frames.default` overridden by `status_frames[device]`, and fall
+    back to REV's defaults.
+    @param device A port name in `config.ports`
+*/
+StatusPeriods status_periods (std::string_view device);
+
+/** Apply status frame periods to a controller. */
+void apply (rev::CANSparkMax& motor, const StatusPeriods& periods);
+
+/** Returns the frames per second a set of periods produces. */
+double frame_rate (const StatusPeriods& periods) noexcept;
+
+/** Estimate bus utilization (0.0 to 1.0) for a number of frames per second.
+    @param framesPerSecond Total frames per second on the bus.
+    @param bitrate The bus bitrate. The roboRIO runs at 1 Mbit/s
+    @param bitsPerFrame Bits in one frame. An extended frame with 8 data
+                        bytes is about 135 bits including average bit stuffing.
+*/
+double bus_load (double framesPerSecond, double bitrate = 1.0e6, double bitsPerFrame = 135.0) noexcept;
+
+/** Log per device frame rates and the estimated total bus load of every
+    CachedMotor instantiated.
+*/
+void report (std::ostream& out);
+
+} // namespace can
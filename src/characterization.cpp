@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "characterization.hpp"
+#include "config.hpp"
+
+//==============================================================================
+Characterization::Settings Characterization::Settings::fromConfig() {
+    Settings s;
+    s.rampRate        = config::number ("characterization", "ramp_rate", s.rampRate);
+    s.stepVoltage     = config::number ("characterization", "step_voltage", s.stepVoltage);
+    s.quasistaticTime = config::number ("characterization", "quasistatic_time", s.quasistaticTime);
+    s.dynamicTime     = config::number ("characterization", "dynamic_time", s.dynamicTime);
+    s.restTime        = config::number ("characterization", "rest_time", s.restTime);
+    s.maxDistance     = config::number ("characterization", "max_distance", s.maxDistance);
+    s.minVelocity     = config::number ("characterization", "min_velocity", s.minVelocity);
+    s.maxSamples      = config::integer ("characterization", "max_samples", s.maxSamples);
+    s.output          = config::string ("characterization", "output", s.output);
+    return s;
+}
+
+//==============================================================================
+Characterization::Characterization (const Settings& s)
+    : settings (s) {
+    _samples.reserve (static_cast<std::size_t> (std::max (1, settings.maxSamples)));
+}
+
+void Characterization::start() {
+    _samples.clear();
+    _dropped = 0;
+    _active  = true;
+    started  = false;
+    _test    = Test::QuasistaticForward;
+}
+
+double Characterization::step (double now, double velocity, double distance) noexcept {
+    if (! _active)
+        return 0.0;
+
+    // settle before the first test too.
+    if (! started) {
+        started   = true;
+        resting   = true;
+        testStart = now;
+    }
+
+    const double t = now - testStart;
+    if (resting) {
+        if (t >= settings.restTime) {
+            resting       = false;
+            testStart     = now;
+            startDistance = distance;
+        }
+        return 0.0;
+    }
+
+    const bool quasistatic = _test == Test::QuasistaticForward || _test == Test::QuasistaticReverse;
+    const bool forward     = _test == Test::QuasistaticForward || _test == Test::DynamicForward;
+    const double limit     = quasistatic ? settings.quasistaticTime : settings.dynamicTime;
+
+    if (t >= limit || std::abs (distance - startDistance) >= settings.maxDistance) {
+        next (now, distance);
+        return 0.0;
+    }
+
+    const double magnitude = quasistatic ? settings.rampRate * t : settings.stepVoltage;
+    const double volts     = std::clamp ((forward ? 1.0 : -1.0) * magnitude, -12.0, 12.0);
+
+    if (_samples.size() < _samples.capacity())
+        _samples.push_back ({ t, volts, velocity, _test });
+    else
+        ++_dropped;
+
+    return volts;
+}
+
+void Characterization::next (double now, double) noexcept {
+    _test     = static_cast<Test> (static_cast<int> (_test) + 1);
+    _active   = _test != Test::Done;
+    resting   = true;
+    testStart = now;
+}
+
+std::optional<Characterization::Gains> Characterization::fit (const std::vector<Sample>& samples,
+                                                              double minVelocity) {
+    snider::FeedforwardFit fit;
+    const std::size_t n = samples.size();
+
+    for (std::size_t begin = 0; begin < n;) {
+        std::size_t end = begin;
+        while (end < n && samples[end].test == samples[begin].test)
+            ++end;
+
+        // each interval runs from one velocity change to the next, driven by
+        // the average voltage applied in between. accelerations across tests
+        // are meaningless so each test starts over.
+        std::size_t anchor = begin;
+        double voltSum     = samples[begin].volts;
+        int voltCount      = 1;
+
+        for (std::size_t i = begin + 1; i < end; ++i) {
+            const auto& a = samples[anchor];
+            const auto& b = samples[i];
+            if (b.velocity != a.velocity) {
+                const double dt = b.time - a.time;
+                const double v  = 0.5 * (a.velocity + b.velocity);
+                if (dt > 0.0 && std::abs (v) >= minVelocity)
+                    fit.add (voltSum / voltCount, v, (b.velocity - a.velocity) / dt);
+                anchor    = i;
+                voltSum   = 0.0;
+                voltCount = 0;
+            }
+
+            voltSum += b.volts;
+            ++voltCount;
+        }
+
+        begin = end;
+    }
+
+    return fit.solve();
+}
+
+bool Characterization::save (const Gains& gains, const std::string& path) const {
+    std::ofstream out (path, std::ios::trunc);
+    if (! out)
+        return false;
+
+    out << "-- Drivetrain feedforward fitted by characterize.bot. Applied over\n"
+        << "-- config.lua at startup: delete this file to go back to its values.\n"
+        << "-- samples=" << gains.samples
+        << std::fixed << std::setprecision (4)
+        << " r2=" << gains.r2 << " rmse=" << gains.rmse << "V\n"
+        << std::setprecision (6)
+        << "return {\n"
+        << "    drivetrain = {\n"
+        << "        ks = " << gains.kS << ",\n"
+        << "        kv = " << gains.kV << ",\n"
+        << "        ka = " << gains.kA << "\n"
+        << "    }\n"
+        << "}\n";
+    return static_cast<bool> (out);
+}
+
+void Characterization::report (std::ostream& out) const {
+    out << "[characterize] samples=" << _samples.size() << " dropped=" << _dropped;
+    if (auto gains = fit()) {
+        out << std::fixed << std::setprecision (4)
+            << " ks=" << gains->kS << "V"
+            << " kv=" << gains->kV << "V/(m/s)"
+            << " ka=" << gains->kA << "V/(m/s^2)"
+            << " r2=" << gains->r2;
+    } else {
+        out << " (not enough data to fit)";
+    }
+    out << std::endl;
+}
+
+std::string_view Characterization::name (Test test) noexcept {
+    switch (test) {
+        case Test::QuasistaticForward:
+            return "quasistatic-forward";
+        case Test::QuasistaticReverse:
+            return "quasistatic-reverse";
+        case Test::DynamicForward:
+            return "dynamic-forward";
+        case Test::DynamicReverse:
+            return "dynamic-reverse";
+        case Test::Done:
+            break;
+    }
+    return "done";
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "snider/feedforwardfit.hpp"
+
+/** Measures the drivetrain and fits its feedforward gains.
+
+    Runs four tests back to back, resting in between: quasistatic forward
+    and reverse, a slow voltage ramp where acceleration hardly matters, then
+    dynamic forward and reverse, a voltage step where it does. A test ends
+    after its time or once the bot has driven `max_distance`.
+
+    While active it takes the place of the velocity loop in the drivetrain
+    rate group, so it records voltage and velocity at that group's rate.
+    Acceleration is worked out when fitting. kS, kV and kA are fitted by
+    least squares over every test and can be saved as a config overlay that
+    config.lua applies at startup. see `characterize.bot`
+
+    Recording never allocates: sample storage is reserved up front and
+    samples past the end are dropped.
+*/
+class Characterization final {
+public:
+    /** see `config.characterization` */
+    struct Settings {
+        /** Quasistatic ramp rate (volts per second) */
+        double rampRate { 0.25 };
+        /** Dynamic step (volts) */
+        double stepVoltage { 6.0 };
+        /** Longest quasistatic and dynamic tests (seconds) */
+        double quasistaticTime { 10.0 };
+        double dynamicTime { 2.0 };
+        /** Stopped time between tests (seconds) */
+        double restTime { 1.0 };
+        /** Longest distance a test may drive (meters) */
+        double maxDistance { 3.0 };
+        /** Samples slower than this are left out of the fit (m/s) */
+        double minVelocity { 0.02 };
+        /** Most samples recorded. */
+        int maxSamples { 16384 };
+        /** Overlay file written next to config.lua */
+        std::string output { "config_overlay.lua" };
+
+        /** Returns settings read from `config.characterization` */
+        static Settings fromConfig();
+    };
+
+    /** The tests, in the order they run. */
+    enum class Test : int {
+        QuasistaticForward,
+        QuasistaticReverse,
+        DynamicForward,
+        DynamicReverse,
+        Done
+    };
+
+    /** One recorded sample. */
+    struct Sample {
+        double time;     ///> seconds since the test started.
+        double volts;    ///> voltage applied after reading velocity.
+        double velocity; ///> m/s, average of both sides.
+        Test test;
+    };
+
+    using Gains = snider::FeedforwardFit::Gains;
+
+    explicit Characterization (const Settings& settings);
+
+    /** Start over from the first test. */
+    void start();
+
+    /** Stop. Recorded samples are kept until the next start(). */
+    void stop() noexcept { _active = false; }
+
+    /** Returns true while tests are running. */
+    constexpr bool active() const noexcept { return _active; }
+
+    /** Returns true once every test has run. */
+    constexpr bool finished() const noexcept { return _test == Test::Done && ! _samples.empty(); }
+
+    /** Returns the test running now. */
+    constexpr Test test() const noexcept { return _test; }
+
+    /** Run one step.
+        @param now Time in seconds.
+        @param velocity Measured velocity (m/s)
+        @param distance Measured distance driven, any origin (meters)
+        @returns The voltage to apply to both sides until the next step.
+    */
+    double step (double now, double velocity, double distance) noexcept;
+
+    /** Returns the recorded samples. */
+    const std::vector<Sample>& samples() const noexcept { return _samples; }
+
+    /** Returns how many samples didn't fit in storage. */
+    constexpr int64_t dropped() const noexcept { return _dropped; }
+
+    /** Returns gains fitted to the recorded samples. */
+    std::optional<Gains> fit() const { return fit (_samples, settings.minVelocity); }
+
+    /** Returns gains fitted to samples. Samples with unchanged velocity,
+        as when read faster than the sensor updates, are merged.
+    */
+    static std::optional<Gains> fit (const std::vector<Sample>& samples, double minVelocity);
+
+    /** Write gains as a config overlay. Returns false if the file couldn't
+        be written.
+    */
+    bool save (const Gains& gains, const std::string& path) const;
+
+    /** Returns the overlay file name. */
+    const std::string& output() const noexcept { return settings.output; }
+
+    /** Write fitted gains to a stream. */
+    void report (std::ostream& out) const;
+
+    /** Returns the name of a test. */
+    static std::string_view name (Test test) noexcept;
+
+private:
+    friend class RobotMain;
+    /** Bind to lua. see bindings.cpp */
+    static void bind (Characterization*);
+
+    Settings settings;
+    std::vector<Sample> _samples;
+    int64_t _dropped { 0 };
+
+    bool _active { false }, resting { false }, started { false };
+    Test _test { Test::Done };
+    double testStart { 0.0 }, startDistance { 0.0 };
+
+    void next (double now, double distance) noexcept;
+};
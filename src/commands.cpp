@@ -0,0 +1,353 @@
+#include <iomanip>
+#include <iostream>
+
+#include "commands.hpp"
+
+namespace detail {
+
+// Ids carry the slot in the low bits and the slot's generation above, so an
+// Id from a finished command never matches whatever reuses its slot.
+static constexpr int idIndexBits = 8;
+static constexpr int idIndexMask = (1 << idIndexBits) - 1;
+static_assert (CommandScheduler::MaxCommands <= (1 << idIndexBits));
+
+} // namespace detail
+
+CommandScheduler::CommandScheduler() {
+    slots.fill (-1);
+    reset();
+    resetStats();
+}
+
+bool CommandScheduler::addAction (Action& newAction) {
+    if (numActions >= MaxActions || findAction (newAction.name()) != nullptr)
+        return false;
+    actions[numActions++] = &newAction;
+    return true;
+}
+
+Action* CommandScheduler::findAction (std::string_view name) const noexcept {
+    for (int i = 0; i < numActions; ++i)
+        if (actions[i]->name() == name)
+            return actions[i];
+    return nullptr;
+}
+
+//==============================================================================
+CommandScheduler::Id CommandScheduler::makeId (int index) const noexcept {
+    return (static_cast<Id> (nodes[index].generation) << detail::idIndexBits) | index;
+}
+
+CommandScheduler::Node* CommandScheduler::find (Id id) noexcept {
+    return const_cast<Node*> (static_cast<const CommandScheduler*> (this)->find (id));
+}
+
+const CommandScheduler::Node* CommandScheduler::find (Id id) const noexcept {
+    if (id < 0)
+        return nullptr;
+    const int index = id & detail::idIndexMask;
+    if (index >= MaxCommands)
+        return nullptr;
+    const auto& node = nodes[index];
+    if (! node.used || (id >> detail::idIndexBits) != node.generation)
+        return nullptr;
+    return &node;
+}
+
+int CommandScheduler::allocate (Kind kind) noexcept {
+    if (numFree <= 0) {
+        ++_stats.rejected;
+        return -1;
+    }
+
+    const int index = freeList[--numFree];
+    auto& node      = nodes[index];
+    const auto gen  = node.generation;
+    node            = Node();
+    node.generation = gen;
+    node.kind       = kind;
+    node.used       = true;
+    return index;
+}
+
+void CommandScheduler::release (int index) noexcept {
+    auto& node = nodes[index];
+    if (! node.used)
+        return;
+
+    for (int i = 0; i < node.numChildren; ++i)
+        release (node.children[i]);
+
+    node.used = false;
+    ++node.generation;
+    freeList[numFree++] = static_cast<int16_t> (index);
+}
+
+//==============================================================================
+CommandScheduler::Id CommandScheduler::action (Action& a, double arg0, double arg1, double arg2) noexcept {
+    const int index = allocate (Kind::Action);
+    if (index < 0)
+        return Invalid;
+
+    auto& node        = nodes[index];
+    node.action       = &a;
+    node.requirements = a.requirements();
+    node.state.args   = { arg0, arg1, arg2 };
+    return makeId (index);
+}
+
+CommandScheduler::Id CommandScheduler::action (std::string_view name, double arg0, double arg1, double arg2) noexcept {
+    auto* a = findAction (name);
+    return a != nullptr ? action (*a, arg0, arg1, arg2) : Invalid;
+}
+
+CommandScheduler::Id CommandScheduler::wait (double seconds) noexcept {
+    const int index = allocate (Kind::Wait);
+    if (index < 0)
+        return Invalid;
+    nodes[index].state.args[0] = seconds;
+    return makeId (index);
+}
+
+CommandScheduler::Id CommandScheduler::group (Kind kind, const Id* children, int count) noexcept {
+    if (count <= 0 || count > MaxChildren)
+        return Invalid;
+
+    // check every child before touching any of them.
+    for (int i = 0; i < count; ++i) {
+        const auto* child = find (children[i]);
+        if (child == nullptr || child->parent >= 0 || child->scheduled)
+            return Invalid;
+        for (int j = 0; j < i; ++j)
+            if (children[j] == children[i])
+                return Invalid;
+    }
+
+    const int index = allocate (kind);
+    if (index < 0)
+        return Invalid;
+
+    auto& node = nodes[index];
+    for (int i = 0; i < count; ++i) {
+        const int child = children[i] & detail::idIndexMask;
+        nodes[child].parent = static_cast<int16_t> (index);
+        node.children[i]    = static_cast<int16_t> (child);
+        node.requirements |= nodes[child].requirements;
+    }
+    node.numChildren = count;
+    return makeId (index);
+}
+
+CommandScheduler::Id CommandScheduler::sequence (const Id* children, int count) noexcept {
+    return group (Kind::Sequence, children, count);
+}
+
+CommandScheduler::Id CommandScheduler::parallel (const Id* children, int count) noexcept {
+    return group (Kind::Parallel, children, count);
+}
+
+CommandScheduler::Id CommandScheduler::race (const Id* children, int count) noexcept {
+    return group (Kind::Race, children, count);
+}
+
+CommandScheduler::Id CommandScheduler::timeout (Id command, double seconds) noexcept {
+    if (find (command) == nullptr)
+        return Invalid;
+    const Id limit = wait (seconds);
+    const Id raced = race ({ command, limit });
+    if (raced == Invalid && limit != Invalid)
+        release (limit & detail::idIndexMask);
+    return raced;
+}
+
+//==============================================================================
+bool CommandScheduler::schedule (Id command) noexcept {
+    auto* node = find (command);
+    if (node == nullptr || node->parent >= 0 || node->scheduled)
+        return false;
+
+    // room is whatever is free plus whatever this would interrupt.
+    int freeSlot = -1;
+    for (int s = 0; s < MaxScheduled && freeSlot < 0; ++s) {
+        if (slots[s] < 0 || (nodes[slots[s]].requirements & node->requirements) != 0)
+            freeSlot = s;
+    }
+    if (freeSlot < 0) {
+        ++_stats.rejected;
+        return false;
+    }
+
+    for (int s = 0; s < MaxScheduled; ++s) {
+        if (slots[s] >= 0 && (nodes[slots[s]].requirements & node->requirements) != 0)
+            unschedule (s, true);
+    }
+
+    node->scheduled = true;
+    slots[freeSlot] = static_cast<int16_t> (command & detail::idIndexMask);
+    ++_stats.scheduled;
+    return true;
+}
+
+void CommandScheduler::cancel (Id command) noexcept {
+    auto* node = find (command);
+    if (node == nullptr || node->parent >= 0)
+        return;
+
+    const int index = command & detail::idIndexMask;
+    if (! node->scheduled) {
+        release (index);
+        return;
+    }
+
+    for (int s = 0; s < MaxScheduled; ++s)
+        if (slots[s] == index)
+            unschedule (s, true);
+}
+
+void CommandScheduler::cancelAll() noexcept {
+    for (int s = 0; s < MaxScheduled; ++s)
+        if (slots[s] >= 0)
+            unschedule (s, true);
+}
+
+void CommandScheduler::reset() noexcept {
+    cancelAll();
+    for (int i = 0; i < MaxCommands; ++i)
+        if (nodes[i].used && nodes[i].parent < 0)
+            release (i);
+
+    numFree = 0;
+    for (int i = MaxCommands; --i >= 0;)
+        freeList[numFree++] = static_cast<int16_t> (i);
+    slots.fill (-1);
+}
+
+bool CommandScheduler::isScheduled (Id command) const noexcept {
+    const auto* node = find (command);
+    return node != nullptr && node->scheduled;
+}
+
+uint32_t CommandScheduler::requirements (Id command) const noexcept {
+    const auto* node = find (command);
+    return node != nullptr ? node->requirements : 0;
+}
+
+int CommandScheduler::numScheduled() const noexcept {
+    int count = 0;
+    for (auto s : slots)
+        count += s >= 0 ? 1 : 0;
+    return count;
+}
+
+//==============================================================================
+void CommandScheduler::run (double dt) noexcept {
+    snider::TimingStats::Scope timed (_cost);
+    for (int s = 0; s < MaxScheduled; ++s) {
+        if (slots[s] >= 0 && step (slots[s], dt))
+            unschedule (s, false);
+    }
+}
+
+// run a command one tick. returns true once it has finished.
+bool CommandScheduler::step (int index, double dt) noexcept {
+    auto& node = nodes[index];
+    if (node.finished)
+        return true;
+
+    auto& state = node.state;
+    if (! node.initialized) {
+        node.initialized = true;
+        state.elapsed    = 0.0;
+        if (node.kind == Kind::Action)
+            node.action->initialize (state);
+    } else {
+        state.elapsed += dt;
+    }
+
+    bool done = false;
+    switch (node.kind) {
+        case Kind::Action: {
+            done = node.action->execute (state);
+            if (done)
+                node.action->end (state, false);
+            break;
+        }
+        case Kind::Wait: {
+            done = state.elapsed >= state.args[0];
+            break;
+        }
+        case Kind::Sequence: {
+            // the next child starts on the following tick.
+            if (step (node.children[node.current], dt))
+                ++node.current;
+            done = node.current >= node.numChildren;
+            break;
+        }
+        case Kind::Parallel: {
+            done = true;
+            for (int i = 0; i < node.numChildren; ++i)
+                done &= step (node.children[i], dt);
+            break;
+        }
+        case Kind::Race: {
+            for (int i = 0; i < node.numChildren; ++i)
+                done |= step (node.children[i], dt);
+            if (done)
+                for (int i = 0; i < node.numChildren; ++i)
+                    interrupt (node.children[i]);
+            break;
+        }
+    }
+
+    node.finished = done;
+    return done;
+}
+
+// stop a command early. Only commands that started and haven't finished are
+// told they were interrupted.
+void CommandScheduler::interrupt (int index) noexcept {
+    auto& node = nodes[index];
+    if (node.finished)
+        return;
+    node.finished = true;
+    if (! node.initialized)
+        return;
+
+    if (node.kind == Kind::Action)
+        node.action->end (node.state, true);
+    for (int i = 0; i < node.numChildren; ++i)
+        interrupt (node.children[i]);
+}
+
+void CommandScheduler::unschedule (int slot, bool interrupted) noexcept {
+    const int index = slots[slot];
+    slots[slot]     = -1;
+
+    if (interrupted) {
+        if (! nodes[index].finished)
+            ++_stats.interrupted;
+        interrupt (index);
+    } else {
+        ++_stats.finished;
+    }
+
+    release (index);
+}
+
+//==============================================================================
+void CommandScheduler::report (std::ostream& out) const {
+    out << "[commands] scheduled=" << _stats.scheduled
+        << " finished=" << _stats.finished
+        << " interrupted=" << _stats.interrupted
+        << " rejected=" << _stats.rejected
+        << " free=" << numFree << "/" << MaxCommands
+        << std::fixed << std::setprecision (1)
+        << " run avg=" << _cost.averageMicros() << "us"
+        << " max=" << _cost.maxMicros() << "us"
+        << std::endl;
+}
+
+void CommandScheduler::resetStats() noexcept {
+    _stats = {};
+    _cost.reset();
+}
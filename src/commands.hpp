@@ -0,0 +1,218 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <iosfwd>
+#include <string_view>
+
+#include "snider/timingstats.hpp"
+
+/** State a running command hands to its action. */
+struct CommandState {
+    /** Arguments given when the command was built. Meaning is up to the action. */
+    std::array<double, 3> args {};
+    /** Seconds since the command started. 0 on the first tick. */
+    double elapsed { 0.0 };
+    /** Free for the action to track progress with. Starts at 0. */
+    int phase { 0 };
+};
+
+/** Something a command does.
+
+    Actions are created once and registered with the scheduler. Each command
+    that uses an action gets its own CommandState, so one action can back
+    many commands. None of these are called from more than one thread.
+*/
+class Action {
+public:
+    virtual ~Action() = default;
+
+    /** Name used to build commands from Lua. */
+    virtual std::string_view name() const noexcept = 0;
+
+    /** Subsystems used, as bits. Two scheduled commands never share one. */
+    virtual uint32_t requirements() const noexcept { return 0; }
+
+    /** Called on the first tick before execute(). */
+    virtual void initialize (CommandState&) {}
+
+    /** Called every tick. Return true when finished. */
+    virtual bool execute (CommandState& state) = 0;
+
+    /** Called once after finishing or being interrupted. */
+    virtual void end (CommandState&, bool /*interrupted*/) {}
+};
+
+//==============================================================================
+/** Runs commands built from actions, waits and groups.
+
+    Everything lives in fixed-size pools allocated with the scheduler, so
+    building, scheduling and running commands never allocates. Commands are
+    referred to by Id. An Id goes stale when its command finishes or is
+    cancelled and is then ignored, so holding on to one is safe.
+
+    Scheduling a command interrupts any scheduled command that shares one of
+    its requirements. Groups require everything their children do.
+
+    Building commands is cheap but not free, do it in init or prepare and only
+    schedule them per tick.
+*/
+class CommandScheduler final {
+public:
+    using Id = int32_t;
+
+    static constexpr Id Invalid       = -1;
+    static constexpr int MaxCommands  = 64; ///> Commands, including group children.
+    static constexpr int MaxScheduled = 8;  ///> Top level commands running at once.
+    static constexpr int MaxChildren  = 8;  ///> Children per group.
+    static constexpr int MaxActions   = 16; ///> Registered actions.
+
+    CommandScheduler();
+    ~CommandScheduler() = default;
+
+    CommandScheduler (const CommandScheduler&)            = delete;
+    CommandScheduler& operator= (const CommandScheduler&) = delete;
+
+    /** Register an action so Lua can build commands from it by name. The
+        action must outlive the scheduler. Returns false if full or the
+        name is taken.
+    */
+    bool addAction (Action& action);
+
+    /** Returns a registered action or nullptr. */
+    Action* findAction (std::string_view name) const noexcept;
+
+    //==========================================================================
+    /** Build a command that runs an action. Returns Invalid when the pool is
+        full.
+    */
+    Id action (Action& action, double arg0 = 0.0, double arg1 = 0.0, double arg2 = 0.0) noexcept;
+
+    /** Build a command from a registered action's name. */
+    Id action (std::string_view name, double arg0 = 0.0, double arg1 = 0.0, double arg2 = 0.0) noexcept;
+
+    /** Build a command that finishes after some seconds. */
+    Id wait (double seconds) noexcept;
+
+    /** Build a group running children one after another. Children must be
+        freshly built, they can't be scheduled or in another group. Returns
+        Invalid if any child isn't, and the children are left alone.
+    */
+    Id sequence (const Id* children, int count) noexcept;
+    Id sequence (std::initializer_list<Id> children) noexcept { return sequence (children.begin(), (int) children.size()); }
+
+    /** Build a group running children together until all have finished. */
+    Id parallel (const Id* children, int count) noexcept;
+    Id parallel (std::initializer_list<Id> children) noexcept { return parallel (children.begin(), (int) children.size()); }
+
+    /** Build a group running children together until any one finishes. The
+        rest are interrupted.
+    */
+    Id race (const Id* children, int count) noexcept;
+    Id race (std::initializer_list<Id> children) noexcept { return race (children.begin(), (int) children.size()); }
+
+    /** Build a race between a command and a wait. */
+    Id timeout (Id command, double seconds) noexcept;
+
+    //==========================================================================
+    /** Start running a command on the next tick, interrupting commands with
+        shared requirements. Returns false if the Id is stale, the command is
+        part of a group, or every slot is taken.
+    */
+    bool schedule (Id command) noexcept;
+
+    /** Interrupt a scheduled command, or discard one that was built but not
+        scheduled. Children of groups can't be cancelled on their own.
+    */
+    void cancel (Id command) noexcept;
+
+    /** Interrupt every scheduled command. */
+    void cancelAll() noexcept;
+
+    /** Interrupt everything and discard every command built. */
+    void reset() noexcept;
+
+    /** Returns true if the command is scheduled and hasn't finished. */
+    bool isScheduled (Id command) const noexcept;
+
+    /** Returns the requirements of a command, 0 if stale. */
+    uint32_t requirements (Id command) const noexcept;
+
+    /** Run scheduled commands one tick.
+        @param dt Seconds since the last call.
+    */
+    void run (double dt) noexcept;
+
+    /** Returns the number of scheduled commands. */
+    int numScheduled() const noexcept;
+
+    /** Returns the number of commands that can still be built. */
+    int numAvailable() const noexcept { return numFree; }
+
+    //==========================================================================
+    /** Counters since the last reset. */
+    struct Stats {
+        int64_t scheduled { 0 }, finished { 0 }, interrupted { 0 };
+        /** Builds or schedules that failed for lack of space. */
+        int64_t rejected { 0 };
+    };
+
+    /** Returns the counters. */
+    const Stats& stats() const noexcept { return _stats; }
+
+    /** Returns the time spent in run(). */
+    const snider::TimingStats& cost() const noexcept { return _cost; }
+
+    /** Write counters and run times to a stream. */
+    void report (std::ostream& out) const;
+
+    /** Reset counters and run times. */
+    void resetStats() noexcept;
+
+private:
+    friend class RobotMain;
+    /** Bind to lua. see bindings.cpp */
+    static void bind (CommandScheduler*);
+
+    enum class Kind : uint8_t {
+        Action,
+        Wait,
+        Sequence,
+        Parallel,
+        Race
+    };
+
+    struct Node {
+        Kind kind { Kind::Wait };
+        Action* action { nullptr };
+        CommandState state;
+        uint32_t requirements { 0 };
+        std::array<int16_t, MaxChildren> children {};
+        int numChildren { 0 };
+        int current { 0 };
+        int16_t parent { -1 };
+        uint16_t generation { 0 };
+        bool used { false }, scheduled { false }, initialized { false }, finished { false };
+    };
+
+    std::array<Node, MaxCommands> nodes {};
+    std::array<int16_t, MaxCommands> freeList {};
+    int numFree { 0 };
+    std::array<int16_t, MaxScheduled> slots {};
+    std::array<Action*, MaxActions> actions {};
+    int numActions { 0 };
+
+    Stats _stats;
+    snider::TimingStats _cost;
+
+    Node* find (Id id) noexcept;
+    const Node* find (Id id) const noexcept;
+    Id makeId (int index) const noexcept;
+    int allocate (Kind kind) noexcept;
+    void release (int index) noexcept;
+    Id group (Kind kind, const Id* children, int count) noexcept;
+    bool step (int index, double dt) noexcept;
+    void interrupt (int index) noexcept;
+    void unschedule (int slot, bool interrupted) noexcept;
+};
@@ -1,7 +1,32 @@
+#include <frc/trajectory/TrajectoryGenerator.h>
+
 #include "config.hpp"
 #include "scripting.hpp"
 
 namespace config {
+namespace detail {
+
+// make a pose2d from a lua table.
+static frc::Pose2d makePose2d (sol::table tbl) {
+    return frc::Pose2d (
+        units::meter_t (tbl[1].get<double>()),
+        units::meter_t (tbl[2].get<double>()),
+        frc::Rotation2d (units::radian_t (tbl[3].get<double>())));
+}
+
+// make a trajectory config from a lua table.
+static frc::TrajectoryConfig makeTrajectoryConfig (sol::table tbl) {
+    return frc::TrajectoryConfig (
+        units::meters_per_second_t (tbl[1].get<double>()),
+        units::meters_per_second_squared_t (tbl[2].get<double>()));
+}
+
+static sol::table trajectoryTable (std::string_view symbol) {
+    sol::function trajectory = lua::state()["config"]["trajectory"];
+    return trajectory (symbol);
+}
+
+} // namespace detail
 
 double number (std::string_view cat, std::string_view sym, double fallback) {
     if (cat.empty() || sym.empty())
@@ -20,6 +45,32 @@ int integer (std::string_view cat, std::string_view sym, int fallback) {
     return static_cast<int> (number (cat, sym, (double) fallback));
 }
 
+bool boolean (std::string_view cat, std::string_view sym, bool fallback) {
+    if (cat.empty() || sym.empty())
+        return fallback;
+
+    auto obj = lua::state()["config"][cat];
+    if (obj.is<sol::table>()) {
+        sol::table tbl = obj;
+        return tbl.get_or (sym, fallback);
+    }
+
+    return fallback;
+}
+
+std::string string (std::string_view cat, std::string_view sym, std::string_view fallback) {
+    if (cat.empty() || sym.empty())
+        return std::string (fallback);
+
+    auto obj = lua::state()["config"][cat];
+    if (obj.is<sol::table>()) {
+        sol::table tbl = obj;
+        return tbl.get_or (sym, std::string (fallback));
+    }
+
+    return std::string (fallback);
+}
+
 double gamepad_skew_factor() {
     sol::table tbl = lua::state()["config"]["gamepad"];
     return tbl.get_or ("skew_factor", 1.0);
@@ -62,4 +113,41 @@ std::vector<std::string> trajectory_names() {
     return out;
 }
 
+frc::Trajectory trajectory (std::string_view name) {
+    sol::table tbl = detail::trajectoryTable (name);
+    return frc::TrajectoryGenerator::GenerateTrajectory (
+        detail::makePose2d (tbl["start"]),
+        {},
+        detail::makePose2d (tbl["stop"]),
+        detail::makeTrajectoryConfig (tbl["config"]));
+}
+
+bool trajectory_reverse (std::string_view name, bool fallback) {
+    return detail::trajectoryTable (name).get_or ("reverse", fallback);
+}
+
+bool trajectory_shoot (std::string_view name, bool fallback) {
+    return detail::trajectoryTable (name).get_or ("shoot", fallback);
+}
+
+std::vector<Program> teleop_programs() {
+    std::vector<Program> out;
+    sol::object obj = lua::state()["config"]["engine"]["teleop"];
+    if (! obj.is<sol::table>())
+        return { { "teleop.bot", 1 } };
+
+    for (const auto& i : obj.as<sol::table>()) {
+        if (! i.second.is<sol::table>())
+            continue;
+        sol::table tbl = i.second;
+        Program p;
+        p.file    = tbl.get_or ("program", std::string());
+        p.divisor = static_cast<int> (tbl.get_or ("divisor", 1.0));
+        if (! p.file.empty())
+            out.push_back (p);
+    }
+
+    return out;
+}
+
 } // namespace config
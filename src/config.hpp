@@ -3,6 +3,10 @@
 #include <string>
 #include <vector>
 
+namespace frc {
+class Trajectory;
+}
+
 namespace config {
 
 /** Return a number (double) by category and symbol. */
@@ -14,6 +18,12 @@ double number (std::string_view cat, std::string_view sym, double fallback = 0.0
 */
 int integer (std::string_view cat, std::string_view sym, int fallback = 0);
 
+/** Return a boolean by category and symbol. */
+bool boolean (std::string_view cat, std::string_view sym, bool fallback = false);
+
+/** Return a string by category and symbol. */
+std::string string (std::string_view cat, std::string_view sym, std::string_view fallback = {});
+
 /** Returns the default gamepad skew factor. */
 double gamepad_skew_factor();
 
@@ -35,4 +45,24 @@ std::string match_start_position();
 /** Trajectory names */
 std::vector<std::string> trajectory_names();
 
+/** Returns the trajectory for a name in `config.trajectories`. Throws if
+    it can't be read.
+*/
+frc::Trajectory trajectory (std::string_view name);
+
+/** Returns true if a trajectory is driven in reverse. */
+bool trajectory_reverse (std::string_view name, bool fallback = true);
+
+/** Returns true if a note is shot while starting a trajectory. */
+bool trajectory_shoot (std::string_view name, bool fallback = true);
+
+/** A bot program file and how often it runs. */
+struct Program {
+    std::string file;
+    int divisor { 1 }; ///> Run every `divisor` engine ticks.
+};
+
+/** Programs to run in teleop mode. see `config.engine.teleop` */
+std::vector<Program> teleop_programs();
+
 } // namespace config
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <limits>
+
+#include <frc/controller/SimpleMotorFeedforward.h>
+
+#include "drivecontrol.hpp"
+
+DriveControl::DriveControl (units::meter_t trackWidth, const Gains& gains)
+    : _gains (gains),
+      kinematics (trackWidth),
+      leftPID (gains.kP, gains.kI, gains.kD, units::second_t (period)),
+      rightPID (gains.kP, gains.kI, gains.kD, units::second_t (period)) {}
+
+void DriveControl::setGains (const Gains& gains) {
+    _gains = gains;
+    for (auto* pid : { &leftPID, &rightPID })
+        pid->SetPID (_gains.kP, _gains.kI, _gains.kD);
+}
+
+void DriveControl::setPeriod (double seconds) {
+    period = std::max (0.001, seconds);
+    // the PID period is fixed when made.
+    leftPID  = frc::PIDController (_gains.kP, _gains.kI, _gains.kD, units::second_t (period));
+    rightPID = frc::PIDController (_gains.kP, _gains.kI, _gains.kD, units::second_t (period));
+}
+
+void DriveControl::reset() {
+    leftPID.Reset();
+    rightPID.Reset();
+    leftAccel = rightAccel = units::meters_per_second_squared_t { 0.0 };
+    ticksSinceDrive = accelTicks = 0;
+    lastInterval    = 0;
+}
+
+void DriveControl::drive (units::meters_per_second_t xSpeed, units::radians_per_second_t rot) {
+    const auto next = kinematics.ToWheelSpeeds ({ xSpeed, 0_mps, rot });
+
+    // over the time since the last target, at least one tick.
+    const int gap = std::max (1, ticksSinceDrive);
+    accelTicks    = lastInterval > 0 ? std::min (gap, lastInterval) : gap;
+    if (ticksSinceDrive > 0)
+        lastInterval = gap;
+    const units::second_t interval { accelTicks * period };
+    leftAccel       = (next.left - _target.left) / interval;
+    rightAccel      = (next.right - _target.right) / interval;
+    ticksSinceDrive = 0;
+    _target         = next;
+}
+
+std::pair<units::volt_t, units::volt_t> DriveControl::calculate (double leftRate, double rightRate) {
+    const frc::SimpleMotorFeedforward<units::meters> feedforward {
+        units::volt_t { _gains.kS },
+        units::volt_t { _gains.kV } / 1_mps,
+        units::volt_t { _gains.kA } / 1_mps_sq
+    };
+    const bool accelerating = ticksSinceDrive < accelTicks;
+    if (ticksSinceDrive < std::numeric_limits<int>::max())
+        ++ticksSinceDrive;
+    const units::meters_per_second_squared_t none { 0.0 };
+    auto leftFeedforward  = feedforward.Calculate (_target.left, accelerating ? leftAccel : none);
+    auto rightFeedforward = feedforward.Calculate (_target.right, accelerating ? rightAccel : none);
+
+    const double leftOutput  = leftPID.Calculate (leftRate, _target.left.value());
+    const double rightOutput = rightPID.Calculate (rightRate, _target.right.value());
+    return { units::volt_t { leftOutput } + leftFeedforward,
+             units::volt_t { rightOutput } + rightFeedforward };
+}
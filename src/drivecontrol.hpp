@@ -0,0 +1,74 @@
+#pragma once
+
+#include <utility>
+
+#include <frc/controller/PIDController.h>
+#include <frc/kinematics/DifferentialDriveKinematics.h>
+#include <frc/kinematics/DifferentialDriveWheelSpeeds.h>
+#include <units/acceleration.h>
+#include <units/angular_velocity.h>
+#include <units/length.h>
+#include <units/velocity.h>
+#include <units/voltage.h>
+
+/** The drivetrain's velocity loop. Chassis speeds become wheel speeds,
+    then each side gets a PID on its measured rate plus a feedforward with
+    kA applied to the change in target speed.
+
+    Targets usually come slower than the loop runs, e.g. drive() at the
+    command rate and calculate() at the drivetrain rate. A change in target
+    is spread over the calculate() calls it took to arrive, so kA sees the
+    real acceleration on every tick instead of all of it on one.
+
+    Touches no hardware, so the Drivetrain and DriveKernel run the same
+    control.
+*/
+class DriveControl final {
+public:
+    /** Velocity loop gains. see `config.drivetrain` */
+    struct Gains {
+        double kP { 0.0 }, kI { 0.0 }, kD { 0.0 };
+        double kS { 0.0 }, kV { 0.0 }, kA { 0.0 };
+    };
+
+    DriveControl (units::meter_t trackWidth, const Gains& gains);
+
+    /** Set the gains. PID state carries on. */
+    void setGains (const Gains& gains);
+
+    /** Returns the gains in use. */
+    const Gains& gains() const noexcept { return _gains; }
+
+    /** Set how often calculate() is called in seconds. Resets the PIDs. */
+    void setPeriod (double seconds);
+
+    /** Set the target by chassis speeds. */
+    void drive (units::meters_per_second_t xSpeed, units::radians_per_second_t rot);
+
+    /** Returns the wheel speeds being aimed for. */
+    const frc::DifferentialDriveWheelSpeeds& target() const noexcept { return _target; }
+
+    /** Returns the voltage for each side, left then right, given their
+        measured rates (m/s)
+    */
+    std::pair<units::volt_t, units::volt_t> calculate (double leftRate, double rightRate);
+
+    /** Clear the PIDs and take the current target as reached, so kA isn't
+        applied to a change from before, e.g. after the loop was bypassed.
+    */
+    void reset();
+
+private:
+    Gains _gains;
+    double period { 0.02 };
+    frc::DifferentialDriveKinematics kinematics;
+    frc::PIDController leftPID, rightPID;
+    // Wheel speeds requested by the last call to drive().
+    frc::DifferentialDriveWheelSpeeds _target {};
+    // The acceleration to the target, applied with kA for `accelTicks`
+    // calculate() calls after drive(), the interval it was measured over.
+    // `lastInterval` is the gap before the previous drive(), 0 if unknown,
+    // so a target after a pause isn't spread over the whole pause.
+    units::meters_per_second_squared_t leftAccel { 0.0 }, rightAccel { 0.0 };
+    int ticksSinceDrive { 0 }, accelTicks { 0 }, lastInterval { 0 };
+};
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+
+#include <frc/geometry/Transform2d.h>
+#include <frc/geometry/Twist2d.h>
+#include <frc/kinematics/DifferentialDriveOdometry.h>
+#include <frc/system/Discretization.h>
+#include <frc/system/plant/LinearSystemId.h>
+
+#include "config.hpp"
+#include "drivekernel.hpp"
+#include "scripting.hpp"
+
+namespace detail {
+
+// returns a rate group's period in seconds.
+static double ratePeriod (std::string_view group, double fallback) {
+    sol::object obj = lua::config::get ("rates", group);
+    if (! obj.is<sol::table>())
+        return fallback;
+    sol::table tbl = obj;
+    return std::max (1.0, tbl.get_or ("period", fallback * 1000.0)) / 1000.0;
+}
+
+} // namespace detail
+
+//==============================================================================
+DriveKernel::Settings DriveKernel::Settings::fromConfig() {
+    Settings s;
+    s.gains.kP = config::number ("drivetrain", "kp", s.gains.kP);
+    s.gains.kI = config::number ("drivetrain", "ki", s.gains.kI);
+    s.gains.kD = config::number ("drivetrain", "kd", s.gains.kD);
+    s.gains.kS = config::number ("drivetrain", "ks", s.gains.kS);
+    s.gains.kV = config::number ("drivetrain", "kv", s.gains.kV);
+    s.gains.kA = config::number ("drivetrain", "ka", s.gains.kA);
+
+    s.plant.trackWidth = config::number ("drivetrain", "track_width", s.plant.trackWidth);
+    sol::object obj    = lua::config::get ("evaluator", "plant");
+    if (obj.is<sol::table>()) {
+        sol::table tbl    = obj;
+        s.plant.kV        = tbl.get_or ("kv", s.plant.kV);
+        s.plant.kA        = tbl.get_or ("ka", s.plant.kA);
+        s.plant.kVAngular = tbl.get_or ("kv_angular", s.plant.kVAngular);
+        s.plant.kAAngular = tbl.get_or ("ka_angular", s.plant.kAAngular);
+    }
+
+    s.controlPeriod     = detail::ratePeriod ("drivetrain", s.controlPeriod);
+    s.commandPeriod     = detail::ratePeriod ("commands", s.commandPeriod);
+    s.step              = std::max (0.01, config::number ("evaluator", "step", 1.0)) / 1000.0;
+    s.speedScale        = config::number ("evaluator", "speed_scale", s.speedScale);
+    s.settleTime        = std::max (0.0, config::number ("evaluator", "settle_time", s.settleTime));
+    s.positionTolerance = config::number ("evaluator", "position_tolerance", s.positionTolerance);
+    s.headingTolerance  = config::number ("evaluator", "heading_tolerance", s.headingTolerance);
+    return s;
+}
+
+//==============================================================================
+DriveKernel::DriveKernel (const Settings& s)
+    : _settings (s),
+      control (units::meter_t (s.plant.trackWidth), s.gains) {
+    control.setPeriod (_settings.controlPeriod);
+}
+
+DriveKernel::Result DriveKernel::run (const frc::Trajectory& trajectory, bool reverse, const Perturbation& p) {
+    const auto& plant      = _settings.plant;
+    const double h         = std::max (1.0e-4, _settings.step);
+    const int controlEvery = std::max (1, static_cast<int> (std::lround (_settings.controlPeriod / h)));
+    const int commandEvery = std::max (1, static_cast<int> (std::lround (_settings.commandPeriod / h)));
+    const double endTime   = trajectory.TotalTime().value();
+    const int ticks        = static_cast<int> (std::lround ((endTime + _settings.settleTime) / h));
+
+    // wheel velocities, stepped exactly for a held input.
+    const auto system = frc::LinearSystemId::IdentifyDrivetrainSystem (
+        decltype (1_V / 1_mps) { plant.kV * p.kVScale },
+        decltype (1_V / 1_mps_sq) { plant.kA * p.kAScale },
+        decltype (1_V / 1_mps) { plant.kVAngular * p.kVScale },
+        decltype (1_V / 1_mps_sq) { plant.kAAngular * p.kAScale });
+    frc::Matrixd<2, 2> A;
+    frc::Matrixd<2, 2> B;
+    frc::DiscretizeAB<2, 2> (system.A(), system.B(), units::second_t (h), &A, &B);
+    frc::Vectord<2> x { 0.0, 0.0 }, u { 0.0, 0.0 };
+
+    // the bot thinks it's at the start, it's really off by the perturbation.
+    const auto start = trajectory.InitialPose();
+    const auto goal  = trajectory.States().back().pose;
+    auto truth       = start.TransformBy (frc::Transform2d (
+        frc::Translation2d (units::meter_t (p.x), units::meter_t (p.y)),
+        frc::Rotation2d (units::degree_t (p.heading))));
+    double leftDistance = 0.0, rightDistance = 0.0;
+    frc::DifferentialDriveOdometry odometry { truth.Rotation(), 0_m, 0_m, start };
+
+    control.reset();
+    control.drive (0_mps, 0_rad_per_s);
+
+    Result result;
+    double arrived = -1.0;
+    for (int tick = 0; tick < ticks; ++tick) {
+        const double now = tick * h;
+
+        // odometry then the velocity loop at the drivetrain rate, Ramsete
+        // at the command rate, like the robot.
+        if (tick % controlEvery == 0)
+            odometry.Update (truth.Rotation(), units::meter_t (leftDistance), units::meter_t (rightDistance));
+
+        if (tick % commandEvery == 0) {
+            if (now <= endTime) {
+                auto speeds = ramsete.Calculate (odometry.GetPose(), trajectory.Sample (units::second_t (now)));
+                if (reverse)
+                    speeds.vx *= -1.0;
+                control.drive (speeds.vx * _settings.speedScale, speeds.omega);
+            } else {
+                control.drive (0_mps, 0_rad_per_s);
+            }
+        }
+
+        if (tick % controlEvery == 0) {
+            const auto [left, right] = control.calculate (x (0), x (1));
+            u (0)                    = std::clamp (left.value(), -plant.maxVoltage, plant.maxVoltage);
+            u (1)                    = std::clamp (right.value(), -plant.maxVoltage, plant.maxVoltage);
+        }
+
+        const frc::Vectord<2> next = A * x + B * u;
+        const double left          = 0.5 * (x (0) + next (0)) * h;
+        const double right         = 0.5 * (x (1) + next (1)) * h;
+        x                          = next;
+
+        // the encoders count wheel turns, the floor only sees what didn't slip.
+        leftDistance += left;
+        rightDistance += right;
+        const double floorLeft  = left * (1.0 - p.leftSlip);
+        const double floorRight = right * (1.0 - p.rightSlip);
+        truth                   = truth.Exp (frc::Twist2d {
+            units::meter_t (0.5 * (floorLeft + floorRight)),
+            0_m,
+            units::radian_t ((floorRight - floorLeft) / plant.trackWidth) });
+
+        result.positionError = truth.Translation().Distance (goal.Translation()).value();
+        result.headingError  = std::abs ((truth.Rotation() - goal.Rotation()).Degrees().value());
+        const bool within    = result.positionError <= _settings.positionTolerance
+                            && result.headingError <= _settings.headingTolerance;
+        if (! within)
+            arrived = -1.0;
+        else if (arrived < 0.0)
+            arrived = now + h;
+    }
+
+    result.success        = arrived >= 0.0;
+    result.completionTime = arrived;
+    return result;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <frc/controller/RamseteController.h>
+#include <frc/trajectory/Trajectory.h>
+
+#include "drivecontrol.hpp"
+
+/** The autonomous drive path without any hardware.
+
+    Follows a trajectory the way FollowTrajectoryAction does: Ramsete on the
+    odometry pose at the command rate, the DriveControl velocity loop at the
+    drivetrain rate, and a drivetrain plant stepped in between. The plant is
+    the same linear system the simulator uses, its pose integrated from how
+    far each wheel actually moved over the floor.
+
+    An episode can be perturbed: the bot starts off its intended pose, its
+    wheels slip so the encoders read more than the floor moved, and the plant
+    can be slower or heavier than the gains were tuned for.
+
+    Runs as fast as the CPU allows and touches no hardware or HAL. Kernels
+    share nothing, so one per thread can run episodes in parallel.
+*/
+class DriveKernel final {
+public:
+    /** The drivetrain plant, as identified by characterization. */
+    struct Plant {
+        double kV { 1.98 }, kA { 0.2 };               ///> linear V/(m/s) and V/(m/s^2)
+        double kVAngular { 1.5 }, kAAngular { 0.3 };  ///> angular, the same units
+        double trackWidth { 0.559 };                   ///> meters
+        double maxVoltage { 12.0 };
+    };
+
+    /** see `config.evaluator` */
+    struct Settings {
+        Plant plant;
+        DriveControl::Gains gains;
+        /** Plant step and the drivetrain and command rates (seconds) */
+        double step { 0.001 }, controlPeriod { 0.005 }, commandPeriod { 0.02 };
+        /** The follow action's speed scale. */
+        double speedScale { 0.5 };
+        /** Time to settle after the trajectory ends (seconds) */
+        double settleTime { 1.0 };
+        /** How close to the end pose counts as arrived. */
+        double positionTolerance { 0.1 }; ///> meters
+        double headingTolerance { 5.0 };  ///> degrees
+
+        /** Returns settings read from `config.evaluator`, `config.drivetrain`
+            and `config.rates`
+        */
+        static Settings fromConfig();
+    };
+
+    /** How one episode differs from the plan. */
+    struct Perturbation {
+        /** Start pose error, relative to the start (meters, degrees) */
+        double x { 0.0 }, y { 0.0 }, heading { 0.0 };
+        /** Fraction of each wheel's travel lost to slip. */
+        double leftSlip { 0.0 }, rightSlip { 0.0 };
+        /** Plant gains relative to `Settings::plant` */
+        double kVScale { 1.0 }, kAScale { 1.0 };
+    };
+
+    /** How an episode went. */
+    struct Result {
+        /** Within tolerance of the end pose when the episode ended. */
+        bool success { false };
+        /** When it arrived and stayed within tolerance, or negative. */
+        double completionTime { -1.0 };
+        /** Distance (meters) and heading (degrees) from the end pose. */
+        double positionError { 0.0 }, headingError { 0.0 };
+    };
+
+    explicit DriveKernel (const Settings& settings);
+
+    /** Run an episode. */
+    Result run (const frc::Trajectory& trajectory, bool reverse, const Perturbation& perturbation);
+
+    /** Returns the settings in use. */
+    const Settings& settings() const noexcept { return _settings; }
+
+private:
+    Settings _settings;
+    DriveControl control;
+    frc::RamseteController ramsete;
+};
@@ -2,18 +2,22 @@
 #include "robot.hpp"
 #include <iostream>
 
+#include <frc/Timer.h>
+
+#include "realtime.hpp"
+
 Drivetrain::Drivetrain() {
     gyro.Reset();
     for (auto* const motor : motors) {
-        motor->SetIdleMode (IdleMode::kBrake);
+        motor->motor().SetIdleMode (IdleMode::kBrake);
     }
-    leftFollower.Follow (leftLeader);
-    rightFollower.Follow (rightLeader);
+    leftFollower.motor().Follow (leftLeader.motor());
+    rightFollower.motor().Follow (rightLeader.motor());
 
     // We need to invert one side of the drivetrain so that positive voltages
     // result in both sides moving forward. Depending on how your robot's
     // gearbox is constructed, you might have to invert the left side instead.
-    rightLeader.SetInverted (true);
+    rightLeader.motor().SetInverted (true);
 
 #if 1
     // Set the distance per pulse for the drive encoders. We can simply use the
@@ -24,37 +28,78 @@ Drivetrain::Drivetrain() {
     leftEncoder.Reset();
     rightEncoder.Reset();
 #endif
+
+    odometryNotifier.SetName ("Odometry");
+    odometryNotifier.StartPeriodic (odometryPeriod);
 }
 
 Drivetrain::~Drivetrain() {
+    odometryNotifier.Stop();
     simulation.reset();
 }
 
 void Drivetrain::drive (MetersPerSecond xSpeed, RadiansPerSecond rot) {
-    setSpeeds (kinematics.ToWheelSpeeds ({ xSpeed, 0_mps, rot }));
+    control.drive (xSpeed, rot);
+}
+
+void Drivetrain::process() {
+    const auto latest = tunables.read();
+    if (latest.version != gains.version) {
+        gains = latest;
+        control.setGains (controlGains (gains));
+    }
+
+    const auto [left, right] = control.calculate (leftEncoder.GetRate(), rightEncoder.GetRate());
+    leftLeader.setVoltage (left * powerScale);
+    rightLeader.setVoltage (right * powerScale);
+    if (simulation != nullptr)
+        simulation->command();
 }
 
 void Drivetrain::driveNormalized (double speed, double rotation) noexcept {
     drive (calculateSpeed (speed), calculateRotation (rotation));
 }
 
-void Drivetrain::setSpeeds (const frc::DifferentialDriveWheelSpeeds& speeds) {
-    auto leftFeedforward  = feedforward.Calculate (speeds.left);
-    auto rightFeedforward = feedforward.Calculate (speeds.right);
+void Drivetrain::driveVolts (units::volt_t left, units::volt_t right) {
+    leftLeader.setVoltage (left);
+    rightLeader.setVoltage (right);
+    control.reset();
+    if (simulation != nullptr)
+        simulation->command();
+}
 
-    double leftOutput = leftPIDController.Calculate (
-        leftEncoder.GetRate(), speeds.left.value());
-    double rightOutput = rightPIDController.Calculate (
-        rightEncoder.GetRate(), speeds.right.value());
+DriveControl::Gains Drivetrain::controlGains (const Tunables::Block& block) noexcept {
+    DriveControl::Gains g;
+    g.kP = block[Tunable::DriveP];
+    g.kI = block[Tunable::DriveI];
+    g.kD = block[Tunable::DriveD];
+    g.kS = block[Tunable::DriveS];
+    g.kV = block[Tunable::DriveV];
+    g.kA = block[Tunable::DriveA];
+    return g;
+}
 
-    leftLeader.SetVoltage (units::volt_t { leftOutput } + leftFeedforward);
-    rightLeader.SetVoltage (units::volt_t { rightOutput } + rightFeedforward);
+double Drivetrain::drawnCurrent() const {
+    if (simulation != nullptr)
+        return simulation->current();
+
+    double amps = 0.0;
+    for (auto* m : motors)
+        amps += m->motor().GetOutputCurrent();
+    return amps;
 }
 
-void Drivetrain::postProcess() {
-    updateOdometry();
-    if (simulation)
-        simulation->onPostProcess();
+void Drivetrain::writeTelemetry (TelemetryFrame& frame) const {
+    const auto pose     = estimatedPosition();
+    frame.poseX         = pose.X().value();
+    frame.poseY         = pose.Y().value();
+    frame.poseHeading   = pose.Rotation().Degrees().value();
+    frame.leftVelocity  = leftEncoder.GetRate();
+    frame.rightVelocity = rightEncoder.GetRate();
+    frame.leftTarget    = control.target().left.value();
+    frame.rightTarget   = control.target().right.value();
+    frame.leftVolts     = leftLeader.lastVoltage().value();
+    frame.rightVolts    = rightLeader.lastVoltage().value();
 }
 
 const MetersPerSecond Drivetrain::calculateSpeed (double value) noexcept {
@@ -68,7 +113,7 @@ const MetersPerSecond Drivetrain::calculateSpeed (double value) noexcept {
 }
 
 const RadiansPerSecond Drivetrain::calculateRotation (double value) noexcept {
-    value *= rotationThrottle;
+    value *= gains[Tunable::RotationThrottle];
     if (frc::RobotBase::IsReal()) {
         // if real bot, invert direction of rotation.
         value *= -1.0;
@@ -76,19 +121,47 @@ const RadiansPerSecond Drivetrain::calculateRotation (double value) noexcept {
     return -rotLimiter.Calculate (value) * maxAngularSpeed;
 }
 
+frc::Pose2d Drivetrain::estimatedPosition() const {
+    if (auto sample = history.latest())
+        return sample->pose;
+    std::lock_guard<std::mutex> sl (odometryLock);
+    return estimator.pose();
+}
+
 void Drivetrain::updateOdometry() {
-    odometry.Update (gyro.GetRotation2d(),
-                     units::meter_t { leftEncoder.GetDistance() },
-                     units::meter_t { rightEncoder.GetDistance() });
+    // the loop reads these samples every tick, keep them off the helper CPU.
+    if (! odometryFollowsLoop)
+        odometryFollowsLoop = rt::followLoop() != rt::Status::Unsupported;
+
+    // sensors are read under the lock so a reset can't land between reading
+    // them and updating.
+    units::second_t timestamp;
+    frc::Pose2d pose;
+    {
+        std::lock_guard<std::mutex> sl (odometryLock);
+        timestamp = frc::Timer::GetFPGATimestamp();
+        pose      = estimator.update (timestamp,
+                                      gyro.GetRotation2d(),
+                                      units::meter_t { leftEncoder.GetDistance() },
+                                      units::meter_t { rightEncoder.GetDistance() });
+    }
+    history.add (timestamp, pose);
 }
 
 void Drivetrain::resetOdometry (const frc::Pose2d& pose) {
-    leftEncoder.Reset();
-    rightEncoder.Reset();
-    odometry.ResetPosition (gyro.GetRotation2d(),
-                            units::meter_t { leftEncoder.GetDistance() },
-                            units::meter_t { rightEncoder.GetDistance() },
-                            pose);
+    {
+        std::lock_guard<std::mutex> sl (odometryLock);
+        leftEncoder.Reset();
+        rightEncoder.Reset();
+        estimator.reset (gyro.GetRotation2d(),
+                         units::meter_t { leftEncoder.GetDistance() },
+                         units::meter_t { rightEncoder.GetDistance() },
+                         pose);
+        // old samples are in the previous frame.
+        history.clear();
+        history.add (frc::Timer::GetFPGATimestamp(), pose);
+    }
+
     if (simulation)
         simulation->onOdometryReset (pose);
 }
@@ -100,10 +173,8 @@ void Drivetrain::initializeSimulation() {
 }
 
 void Drivetrain::updateSimulation() {
-    // To update our simulation, we set motor voltage inputs, update the
-    // simulation, and write the simulated positions and velocities to our
-    // simulated encoder and gyro. We negate the right side so that positive
-    // voltages make the right side move forward.
+    // Voltages are recorded as they're sent, this steps the physics up to
+    // now and refreshes the simulated sensors. see SimulatedDrive
     if (simulation)
         simulation->update();
 }
@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <string>
 
+#include "luabundle.hpp"
 #include "scripting.hpp"
 #include "sol/sol.hpp"
 
@@ -18,33 +19,26 @@ public:
     static std::unique_ptr<Engine> instantiate (lua_State* state, std::string_view bot_file) {
         auto self = std::unique_ptr<Engine> (new Engine (state));
 
-        if (! std::filesystem::exists (bot_file)) {
-            self->_error = "file does not exist: ";
-            self->_error += bot_file;
-            return self;
-        }
-
-        sol::state_view L (state);
         Path path (bot_file);
         path.make_preferred();
 
         try {
-            LoadResult res { L.load_file (path.string()) };
-            if (! res.valid()) {
-                sol::error err = res;
-                self->_error   = err.what();
+            // from the script bundle if it has this file, see luabundle.hpp
+            if (lua::load_chunk (state, lua::bundle(), path.string()) != 0) {
+                const char* msg = lua_tostring (state, -1);
+                self->_error    = msg != nullptr ? msg : "could not load " + path.string();
+                lua_pop (state, 1);
                 return self;
             }
 
-            {
-                sol::object obj = res;
-                if (obj.get_type() != sol::type::function) {
-                    self->_error = "Did not get a factory function";
-                    return self;
-                }
+            if (lua_type (state, -1) != LUA_TFUNCTION) {
+                lua_pop (state, 1);
+                self->_error = "Did not get a factory function";
+                return self;
             }
 
-            Factory factory                   = res;
+            Factory factory (state, -1);
+            lua_pop (state, 1);
             sol::protected_function_result pr = factory();
             if (! pr.valid() || pr.get_type() != sol::type::table) {
                 self->_error = "Did not get an engine descriptor table";
@@ -121,7 +115,6 @@ private:
         : L (state) {
     }
     using Factory    = sol::protected_function;
-    using LoadResult = sol::load_result;
     using Path       = std::filesystem::path;
     sol::state_view L;
     sol::table M;
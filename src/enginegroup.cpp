@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "enginegroup.hpp"
+
+bool EngineGroup::add (std::string_view name, EnginePtr engine, int divisor) {
+    if (engine == nullptr || engine->have_error()) {
+        std::cerr << "[lua] " << name << ": "
+                  << (engine != nullptr ? engine->error() : std::string ("not instantiated"))
+                  << std::endl;
+        return false;
+    }
+
+    if (! engine->init()) {
+        std::cerr << "[lua] " << name << ": init: " << engine->error() << std::endl;
+        return false;
+    }
+
+    Slot slot;
+    slot.name    = name;
+    slot.engine  = std::move (engine);
+    slot.divisor = std::max (1, divisor);
+    // stagger slow programs so they don't all land on the same tick.
+    slot.counter = static_cast<int> (slots.size()) % slot.divisor;
+    slots.push_back (std::move (slot));
+    return true;
+}
+
+bool EngineGroup::prepare() {
+    bool ok = true;
+    for (auto& slot : slots) {
+        slot.failed = false;
+        slot.stats.reset();
+        if (! slot.engine->prepare()) {
+            fail (slot, slot.engine->error());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void EngineGroup::run (bool protectedCalls) {
+    for (auto& slot : slots) {
+        if (slot.failed)
+            continue;
+
+        if (++slot.counter < slot.divisor)
+            continue;
+        slot.counter = 0;
+
+        snider::TimingStats::Scope timed (slot.stats);
+
+        if (protectedCalls) {
+            if (! slot.engine->safe_run())
+                fail (slot, slot.engine->error());
+            continue;
+        }
+
+        try {
+            slot.engine->run();
+        } catch (const std::exception& e) {
+            fail (slot, e.what());
+        }
+    }
+}
+
+bool EngineGroup::cleanup() {
+    bool ok = true;
+    for (auto& slot : slots) {
+        if (slot.failed)
+            continue;
+        if (! slot.engine->cleanup()) {
+            fail (slot, slot.engine->error());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool EngineGroup::anyFailed() const noexcept {
+    return std::any_of (slots.begin(), slots.end(), [] (const Slot& s) { return s.failed; });
+}
+
+bool EngineGroup::allFailed() const noexcept {
+    return std::all_of (slots.begin(), slots.end(), [] (const Slot& s) { return s.failed; });
+}
+
+void EngineGroup::report (std::ostream& out) const {
+    for (const auto& slot : slots) {
+        out << "[bot] " << std::left << std::setw (16) << slot.name
+            << " 1/" << slot.divisor
+            << " runs=" << slot.stats.count()
+            << std::fixed << std::setprecision (1)
+            << " avg=" << slot.stats.averageMicros() << "us"
+            << " max=" << slot.stats.maxMicros() << "us"
+            << (slot.failed ? " (failed)" : "")
+            << std::endl;
+    }
+}
+
+void EngineGroup::fail (Slot& slot, const std::string& what) {
+    slot.failed = true;
+    std::cerr << "[lua] " << slot.name << ": error: "
+              << (what.empty() ? std::string ("unknown Lua error") : what)
+              << std::endl;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "engine.hpp"
+#include "snider/timingstats.hpp"
+
+/** Runs several bot programs side by side.
+
+    Every program has a rate divisor. A divisor of 1 runs the program every
+    tick, 3 runs it every third tick, and so on.  Each program keeps its own
+    error state and timing stats so a failing program does not stop the
+    others from running.
+*/
+class EngineGroup final {
+public:
+    EngineGroup()  = default;
+    ~EngineGroup() = default;
+
+    /** A loaded program and its run state. */
+    struct Slot {
+        std::string name;
+        EnginePtr engine;
+        int divisor { 1 };
+        int counter { 0 };
+        bool failed { false };
+        snider::TimingStats stats;
+    };
+
+    /** Remove all programs. This does not call cleanup. */
+    void clear() noexcept { slots.clear(); }
+
+    /** Add an instantiated program and call its init function.
+
+        @param name A name used when logging. e.g. the bot file name.
+        @param engine The engine to add.
+        @param divisor Run every `divisor` ticks. Clamped to 1 or more.
+
+        @returns false if the engine is in error state or init failed. In that
+                 case the program is not added.
+    */
+    bool add (std::string_view name, EnginePtr engine, int divisor = 1);
+
+    /** Call prepare on every program. Returns false if any failed. */
+    bool prepare();
+
+    /** Run programs that are due this tick. Failed programs are skipped.
+
+        @param protectedCalls When true calls go through `Engine::safe_run`.
+    */
+    void run (bool protectedCalls);
+
+    /** Call cleanup on every program that hasn't failed. */
+    bool cleanup();
+
+    /** Returns true if no programs are loaded. */
+    bool empty() const noexcept { return slots.empty(); }
+
+    /** Returns the number of programs loaded. */
+    std::size_t size() const noexcept { return slots.size(); }
+
+    /** Returns true if at least one program is in error state. */
+    bool anyFailed() const noexcept;
+
+    /** Returns true if empty or every program is in error state. */
+    bool allFailed() const noexcept;
+
+    /** Returns the program slots. */
+    const std::vector<Slot>& programs() const noexcept { return slots; }
+
+    /** Write per program timing stats to a stream. */
+    void report (std::ostream& out) const;
+
+private:
+    std::vector<Slot> slots;
+
+    void fail (Slot& slot, const std::string& what);
+};
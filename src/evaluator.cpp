@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "config.hpp"
+#include "evaluator.hpp"
+#include "snider/workpool.hpp"
+
+namespace detail {
+
+// returns a value at a fraction through sorted values.
+static double percentile (const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty())
+        return 0.0;
+    const auto i = static_cast<std::size_t> (fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min (i, sorted.size() - 1)];
+}
+
+} // namespace detail
+
+//==============================================================================
+Evaluator::Settings Evaluator::Settings::fromConfig() {
+    Settings s;
+    s.runs         = std::max (1, config::integer ("evaluator", "runs", s.runs));
+    s.seed         = static_cast<unsigned int> (config::integer ("evaluator", "seed", s.seed));
+    s.startXY      = std::max (0.0, config::number ("evaluator", "start_xy", s.startXY));
+    s.startHeading = std::max (0.0, config::number ("evaluator", "start_heading", s.startHeading));
+    s.maxSlip      = std::clamp (config::number ("evaluator", "max_slip", s.maxSlip), 0.0, 0.9);
+    s.gainError    = std::clamp (config::number ("evaluator", "gain_error", s.gainError), 0.0, 0.5);
+    s.kernel       = DriveKernel::Settings::fromConfig();
+    return s;
+}
+
+//==============================================================================
+Evaluator::Evaluator (const Settings& s)
+    : _settings (s) {}
+
+DriveKernel::Perturbation Evaluator::perturbation (int index) const {
+    std::seed_seq seq { _settings.seed, static_cast<unsigned int> (index) };
+    std::mt19937 random (seq);
+    std::normal_distribution<double> normal (0.0, 1.0);
+    std::uniform_real_distribution<double> slip (0.0, _settings.maxSlip);
+
+    // gain errors are clamped so the plant stays physical.
+    auto scale = [&]() { return std::clamp (1.0 + _settings.gainError * normal (random), 0.5, 1.5); };
+
+    DriveKernel::Perturbation p;
+    p.x         = _settings.startXY * normal (random);
+    p.y         = _settings.startXY * normal (random);
+    p.heading   = _settings.startHeading * normal (random);
+    p.leftSlip  = slip (random);
+    p.rightSlip = slip (random);
+    p.kVScale   = scale();
+    p.kAScale   = scale();
+    return p;
+}
+
+Evaluator::Stats Evaluator::evaluate (std::string_view name, const frc::Trajectory& trajectory,
+                                      bool reverse, snider::WorkPool& pool) const {
+    // one kernel per worker, results by episode so nothing is shared.
+    std::vector<std::unique_ptr<DriveKernel>> kernels;
+    for (int i = 0; i < pool.size(); ++i)
+        kernels.push_back (std::make_unique<DriveKernel> (_settings.kernel));
+    std::vector<DriveKernel::Result> results (_settings.runs);
+
+    const auto started = std::chrono::steady_clock::now();
+    pool.run (_settings.runs, [&] (int index, int worker) {
+        results[index] = kernels[worker]->run (trajectory, reverse, perturbation (index));
+    });
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+
+    Stats stats;
+    stats.name          = std::string (name);
+    stats.runs          = _settings.runs;
+    stats.workers       = pool.size();
+    stats.seconds       = elapsed.count();
+    stats.runsPerSecond = stats.seconds > 0.0 ? stats.runs / stats.seconds : 0.0;
+
+    std::vector<double> times, errors;
+    times.reserve (results.size());
+    errors.reserve (results.size());
+    for (const auto& r : results) {
+        errors.push_back (r.positionError);
+        if (r.success) {
+            ++stats.successes;
+            times.push_back (r.completionTime);
+        }
+    }
+    std::sort (times.begin(), times.end());
+    std::sort (errors.begin(), errors.end());
+
+    if (! times.empty()) {
+        stats.completionMean = std::accumulate (times.begin(), times.end(), 0.0) / times.size();
+        stats.completionP50  = detail::percentile (times, 0.5);
+        stats.completionP90  = detail::percentile (times, 0.9);
+        stats.completionP99  = detail::percentile (times, 0.99);
+        stats.completionMax  = times.back();
+    }
+    stats.errorP50 = detail::percentile (errors, 0.5);
+    stats.errorP90 = detail::percentile (errors, 0.9);
+    stats.errorMax = errors.empty() ? 0.0 : errors.back();
+    return stats;
+}
+
+void Evaluator::report (std::ostream& out, const Stats& s) {
+    out << "[eval] " << s.name << ": " << s.successes << "/" << s.runs << " ok ("
+        << std::fixed << std::setprecision (1) << 100.0 * s.successRate() << "%)"
+        << std::setprecision (2)
+        << " completion mean=" << s.completionMean << "s p50=" << s.completionP50
+        << "s p90=" << s.completionP90 << "s p99=" << s.completionP99
+        << "s max=" << s.completionMax << "s"
+        << std::setprecision (3)
+        << " error p50=" << s.errorP50 << "m p90=" << s.errorP90 << "m max=" << s.errorMax << "m"
+        << std::setprecision (0)
+        << " (" << s.runsPerSecond << " runs/s on " << s.workers << " workers)" << std::endl;
+}
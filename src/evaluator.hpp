@@ -0,0 +1,71 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+#include "drivekernel.hpp"
+
+namespace snider {
+class WorkPool;
+}
+
+/** Monte Carlo evaluation of an autonomous trajectory.
+
+    Runs thousands of DriveKernel episodes, each with its own start pose
+    error, wheel slip and plant gain error, spread over a WorkPool. Every
+    episode draws its perturbation from a generator seeded by the run seed
+    and its index, so results don't depend on how many threads ran them.
+    see tools/evaluator
+*/
+class Evaluator final {
+public:
+    /** see `config.evaluator` */
+    struct Settings {
+        /** Episodes per trajectory. */
+        int runs { 2000 };
+        unsigned int seed { 2024 };
+        /** Standard deviation of start pose error (meters, degrees) */
+        double startXY { 0.05 }, startHeading { 2.0 };
+        /** Most wheel slip on either side, drawn evenly from 0 (fraction) */
+        double maxSlip { 0.05 };
+        /** Standard deviation of plant kV and kA error (fraction) */
+        double gainError { 0.1 };
+        DriveKernel::Settings kernel;
+
+        /** Returns settings read from `config.evaluator` */
+        static Settings fromConfig();
+    };
+
+    /** How a trajectory did over every episode. Times are in seconds. */
+    struct Stats {
+        std::string name;
+        int runs { 0 }, successes { 0 }, workers { 0 };
+        /** Completion times of successful episodes. */
+        double completionMean { 0.0 }, completionP50 { 0.0 }, completionP90 { 0.0 };
+        double completionP99 { 0.0 }, completionMax { 0.0 };
+        /** Final distance from the end pose of every episode (meters) */
+        double errorP50 { 0.0 }, errorP90 { 0.0 }, errorMax { 0.0 };
+        /** Wall time and throughput. */
+        double seconds { 0.0 }, runsPerSecond { 0.0 };
+
+        double successRate() const noexcept { return runs > 0 ? static_cast<double> (successes) / runs : 0.0; }
+    };
+
+    explicit Evaluator (const Settings& settings);
+
+    /** Run every episode of a trajectory on a pool. */
+    Stats evaluate (std::string_view name, const frc::Trajectory& trajectory, bool reverse, snider::WorkPool& pool) const;
+
+    /** Returns the perturbation for an episode. */
+    DriveKernel::Perturbation perturbation (int index) const;
+
+    /** Returns the settings in use. */
+    const Settings& settings() const noexcept { return _settings; }
+
+    /** Write a trajectory's stats on one line. */
+    static void report (std::ostream& out, const Stats& stats);
+
+private:
+    Settings _settings;
+};
@@ -0,0 +1,156 @@
+#include <algorithm>
+
+#include <frc/geometry/Pose2d.h>
+#include <frc/geometry/Rotation2d.h>
+#include <frc/geometry/Transform2d.h>
+#include <frc/geometry/Translation2d.h>
+#include <frc/geometry/Twist2d.h>
+#include <wpi/MathExtras.h>
+
+#include "geometry.hpp"
+
+namespace detail {
+
+static_assert (sizeof (frc_Pose2d) == 4 * sizeof (double));
+static_assert (sizeof (frc_Transform2d) == sizeof (frc_Pose2d));
+static_assert (sizeof (frc_Twist2d) == 3 * sizeof (double));
+
+static frc::Translation2d toFrc (const frc_Translation2d& t) {
+    return { units::meter_t (t.x), units::meter_t (t.y) };
+}
+
+// cos and sin are kept unit length by everything here, Rotation2d's (x, y)
+// constructor normalizes again.
+static frc::Rotation2d toFrc (const frc_Rotation2d& r) { return { r.cos, r.sin }; }
+static frc::Pose2d toFrc (const frc_Pose2d& p) { return { toFrc (p.translation), toFrc (p.rotation) }; }
+static frc::Transform2d toFrc (const frc_Transform2d& t) { return { toFrc (t.translation), toFrc (t.rotation) }; }
+
+static frc::Twist2d toFrc (const frc_Twist2d& t) {
+    return { units::meter_t (t.dx), units::meter_t (t.dy), units::radian_t (t.dtheta) };
+}
+
+static void fromFrc (const frc::Translation2d& t, frc_Translation2d* out) {
+    out->x = t.X().value();
+    out->y = t.Y().value();
+}
+
+static void fromFrc (const frc::Rotation2d& r, frc_Rotation2d* out) {
+    out->cos = r.Cos();
+    out->sin = r.Sin();
+}
+
+static void fromFrc (const frc::Pose2d& p, frc_Pose2d* out) {
+    fromFrc (p.Translation(), &out->translation);
+    fromFrc (p.Rotation(), &out->rotation);
+}
+
+static void fromFrc (const frc::Transform2d& t, frc_Transform2d* out) {
+    fromFrc (t.Translation(), &out->translation);
+    fromFrc (t.Rotation(), &out->rotation);
+}
+
+static void fromFrc (const frc::Twist2d& t, frc_Twist2d* out) {
+    out->dx     = t.dx.value();
+    out->dy     = t.dy.value();
+    out->dtheta = t.dtheta.value();
+}
+
+// like the Java interpolate() methods, 0 is the start and 1 the end.
+static double unit (double t) { return std::clamp (t, 0.0, 1.0); }
+
+//==============================================================================
+static void rotation_from_radians (double radians, frc_Rotation2d* out) {
+    fromFrc (frc::Rotation2d (units::radian_t (radians)), out);
+}
+
+static double rotation_radians (const frc_Rotation2d* self) {
+    return toFrc (*self).Radians().value();
+}
+
+static void rotation_rotate_by (const frc_Rotation2d* self, const frc_Rotation2d* other, frc_Rotation2d* out) {
+    fromFrc (toFrc (*self).RotateBy (toFrc (*other)), out);
+}
+
+static void rotation_interpolate (const frc_Rotation2d* self, const frc_Rotation2d* end, double t, frc_Rotation2d* out) {
+    fromFrc (wpi::Lerp (toFrc (*self), toFrc (*end), unit (t)), out);
+}
+
+static double translation_distance (const frc_Translation2d* self, const frc_Translation2d* other) {
+    return toFrc (*self).Distance (toFrc (*other)).value();
+}
+
+static void translation_rotate_by (const frc_Translation2d* self, const frc_Rotation2d* rotation, frc_Translation2d* out) {
+    fromFrc (toFrc (*self).RotateBy (toFrc (*rotation)), out);
+}
+
+static void translation_interpolate (const frc_Translation2d* self, const frc_Translation2d* end, double t, frc_Translation2d* out) {
+    fromFrc (wpi::Lerp (toFrc (*self), toFrc (*end), unit (t)), out);
+}
+
+static void pose_transform_by (const frc_Pose2d* self, const frc_Transform2d* transform, frc_Pose2d* out) {
+    fromFrc (toFrc (*self).TransformBy (toFrc (*transform)), out);
+}
+
+static void pose_relative_to (const frc_Pose2d* self, const frc_Pose2d* other, frc_Pose2d* out) {
+    fromFrc (toFrc (*self).RelativeTo (toFrc (*other)), out);
+}
+
+// along the twist between them, same as frc::TimeInterpolatableBuffer does poses.
+static void pose_interpolate (const frc_Pose2d* self, const frc_Pose2d* end, double t, frc_Pose2d* out) {
+    const auto start = toFrc (*self);
+    fromFrc (start.Exp (start.Log (toFrc (*end)) * unit (t)), out);
+}
+
+static void pose_exp (const frc_Pose2d* self, const frc_Twist2d* twist, frc_Pose2d* out) {
+    fromFrc (toFrc (*self).Exp (toFrc (*twist)), out);
+}
+
+static void pose_log (const frc_Pose2d* self, const frc_Pose2d* end, frc_Twist2d* out) {
+    fromFrc (toFrc (*self).Log (toFrc (*end)), out);
+}
+
+static double pose_distance (const frc_Pose2d* self, const frc_Pose2d* other) {
+    return toFrc (self->translation).Distance (toFrc (other->translation)).value();
+}
+
+static void transform_between (const frc_Pose2d* initial, const frc_Pose2d* last, frc_Transform2d* out) {
+    fromFrc (frc::Transform2d (toFrc (*initial), toFrc (*last)), out);
+}
+
+static void transform_compose (const frc_Transform2d* self, const frc_Transform2d* other, frc_Transform2d* out) {
+    fromFrc (toFrc (*self) + toFrc (*other), out);
+}
+
+static void transform_inverse (const frc_Transform2d* self, frc_Transform2d* out) {
+    fromFrc (toFrc (*self).Inverse(), out);
+}
+
+} // namespace detail
+
+//==============================================================================
+const frc_GeometryApi* frc_geometry_api (void) {
+    // clang-format off
+    static const frc_GeometryApi api = {
+        detail::rotation_from_radians,
+        detail::rotation_radians,
+        detail::rotation_rotate_by,
+        detail::rotation_interpolate,
+
+        detail::translation_distance,
+        detail::translation_rotate_by,
+        detail::translation_interpolate,
+
+        detail::pose_transform_by,
+        detail::pose_relative_to,
+        detail::pose_interpolate,
+        detail::pose_exp,
+        detail::pose_log,
+        detail::pose_distance,
+
+        detail::transform_between,
+        detail::transform_compose,
+        detail::transform_inverse
+    };
+    // clang-format on
+    return &api;
+}
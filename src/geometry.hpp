@@ -0,0 +1,66 @@
+#pragma once
+
+/** Plain C geometry for LuaJIT's FFI.
+
+    Value types with the same layout as the cdefs in robot/geometry.lua, and
+    math on them behind a table of C function pointers. Lua gets the table's
+    address as `cxx.geometry.api` and calls through it as cdata, which the
+    JIT compiles to direct calls: no userdata, metatable lookups or garbage
+    per value like the sol usertypes.
+
+    Results go to an out pointer so callers choose where they live. The math
+    is WPILib's, each call converts to the frc:: types and back.
+*/
+extern "C" {
+
+typedef struct frc_Translation2d {
+    double x, y; ///> meters
+} frc_Translation2d;
+
+/** A rotation as a unit vector, like frc::Rotation2d keeps it. */
+typedef struct frc_Rotation2d {
+    double cos, sin;
+} frc_Rotation2d;
+
+typedef struct frc_Pose2d {
+    frc_Translation2d translation;
+    frc_Rotation2d rotation;
+} frc_Pose2d;
+
+typedef struct frc_Transform2d {
+    frc_Translation2d translation;
+    frc_Rotation2d rotation;
+} frc_Transform2d;
+
+typedef struct frc_Twist2d {
+    double dx, dy, dtheta; ///> meters, meters, radians
+} frc_Twist2d;
+
+/** The geometry functions. Append only, robot/geometry.lua declares the
+    same fields in the same order.
+*/
+typedef struct frc_GeometryApi {
+    void (*rotation_from_radians) (double radians, frc_Rotation2d* out);
+    double (*rotation_radians) (const frc_Rotation2d* self);
+    void (*rotation_rotate_by) (const frc_Rotation2d* self, const frc_Rotation2d* other, frc_Rotation2d* out);
+    void (*rotation_interpolate) (const frc_Rotation2d* self, const frc_Rotation2d* end, double t, frc_Rotation2d* out);
+
+    double (*translation_distance) (const frc_Translation2d* self, const frc_Translation2d* other);
+    void (*translation_rotate_by) (const frc_Translation2d* self, const frc_Rotation2d* rotation, frc_Translation2d* out);
+    void (*translation_interpolate) (const frc_Translation2d* self, const frc_Translation2d* end, double t, frc_Translation2d* out);
+
+    void (*pose_transform_by) (const frc_Pose2d* self, const frc_Transform2d* transform, frc_Pose2d* out);
+    void (*pose_relative_to) (const frc_Pose2d* self, const frc_Pose2d* other, frc_Pose2d* out);
+    void (*pose_interpolate) (const frc_Pose2d* self, const frc_Pose2d* end, double t, frc_Pose2d* out);
+    void (*pose_exp) (const frc_Pose2d* self, const frc_Twist2d* twist, frc_Pose2d* out);
+    void (*pose_log) (const frc_Pose2d* self, const frc_Pose2d* end, frc_Twist2d* out);
+    double (*pose_distance) (const frc_Pose2d* self, const frc_Pose2d* other);
+
+    void (*transform_between) (const frc_Pose2d* initial, const frc_Pose2d* last, frc_Transform2d* out);
+    void (*transform_compose) (const frc_Transform2d* self, const frc_Transform2d* other, frc_Transform2d* out);
+    void (*transform_inverse) (const frc_Transform2d* self, frc_Transform2d* out);
+} frc_GeometryApi;
+
+/** Returns the geometry functions. */
+const frc_GeometryApi* frc_geometry_api (void);
+}
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <sstream>
+
+#include "jitdiag.hpp"
+#include "sol/sol.hpp"
+
+namespace lua {
+namespace detail {
+
+// profile just often enough to see the VM state of short runs.
+static Profiler::Settings diagnosticProfile() {
+    Profiler::Settings s;
+    s.interval = 1;
+    s.depth    = 1;
+    s.slots    = 256;
+    s.arena    = 16 * 1024;
+    return s;
+}
+
+} // namespace detail
+
+//==============================================================================
+std::vector<JitDiagnostics::Input> JitDiagnostics::synthetic (int ticks) {
+    using std::numbers::pi;
+    std::vector<Input> out (static_cast<std::size_t> (std::max (0, ticks)));
+    for (int t = 0; t < ticks; ++t) {
+        auto& in   = out[t];
+        in.axes[0] = std::sin (2.0 * pi * t / 120.0);
+        in.axes[1] = std::cos (2.0 * pi * t / 120.0);
+        in.axes[2] = 0.5 + 0.5 * std::sin (2.0 * pi * t / 150.0);
+        in.axes[3] = 0.5 - 0.5 * std::sin (2.0 * pi * t / 150.0);
+        in.axes[4] = std::sin (2.0 * pi * t / 90.0);
+        in.axes[5] = 0.5 * std::sin (2.0 * pi * t / 200.0);
+
+        // each button held for 10 of every 30 ticks, then the next one.
+        if (t % 30 < 10)
+            in.buttons = 1u << ((t / 30) % 10);
+
+        // a dpad direction for 20 of every 60 ticks.
+        if (t % 60 < 20)
+            in.pov = 90 * ((t / 60) % 4);
+    }
+    return out;
+}
+
+std::vector<JitDiagnostics::Input> JitDiagnostics::load (const std::string& path) {
+    std::vector<Input> out;
+    std::ifstream file (path);
+    std::string line;
+    while (std::getline (file, line)) {
+        line = line.substr (0, line.find ('#'));
+        std::replace (line.begin(), line.end(), ',', ' ');
+        std::istringstream fields (line);
+        Input in;
+        if (fields >> in.axes[0] >> in.axes[1] >> in.axes[2] >> in.axes[3] >> in.axes[4] >> in.axes[5]
+                   >> in.buttons >> in.pov)
+            out.push_back (in);
+    }
+    return out;
+}
+
+//==============================================================================
+JitDiagnostics::JitDiagnostics (lua_State* state)
+    : L (state),
+      profiler (detail::diagnosticProfile()) {}
+
+JitDiagnostics::~JitDiagnostics() {
+    if (attached)
+        end ({});
+}
+
+bool JitDiagnostics::begin() {
+    _error.clear();
+    if (! module.valid()) {
+        sol::protected_function require = L["require"];
+        sol::protected_function_result res = require ("jitdiag");
+        if (! res.valid()) {
+            sol::error err = res;
+            _error         = err.what();
+            return false;
+        }
+        if (res.get_type() != sol::type::table) {
+            _error = "jitdiag did not return a table";
+            return false;
+        }
+        module = res;
+    }
+
+    sol::protected_function attach = module["attach"];
+    auto res                        = attach();
+    if (! res.valid()) {
+        sol::error err = res;
+        _error         = err.what();
+        return false;
+    }
+
+    // another profiler could have the VM, the trace counts still work.
+    profiler.start (L.lua_state());
+    attached = true;
+    return true;
+}
+
+JitDiagnostics::Report JitDiagnostics::end (std::string_view program) {
+    Report report;
+    report.program = std::string (program);
+    if (! attached)
+        return report;
+
+    profiler.stop();
+    attached = false;
+
+    sol::protected_function detach = module["detach"];
+    sol::protected_function result = module["result"];
+    detach();
+    sol::protected_function_result res = result();
+    if (! res.valid() || res.get_type() != sol::type::table)
+        return report;
+
+    sol::table T     = res;
+    report.started   = T.get_or ("started", 0);
+    report.compiled  = T.get_or ("compiled", 0);
+    report.aborted   = T.get_or ("aborted", 0);
+    report.flushed   = T.get_or ("flushed", 0);
+
+    sol::table traces = T["traces"];
+    for (std::size_t i = 1; i <= traces.size(); ++i) {
+        sol::table t = traces[i];
+        report.traces.push_back ({ t.get_or ("location", std::string()), t.get_or ("count", 0) });
+    }
+
+    sol::table aborts = T["aborts"];
+    for (std::size_t i = 1; i <= aborts.size(); ++i) {
+        sol::table a = aborts[i];
+        report.aborts.push_back ({ a.get_or ("reason", std::string()),
+                                   a.get_or ("location", std::string()),
+                                   a.get_or ("count", 0) });
+    }
+
+    report.samples     = profiler.samples();
+    const double inLua = static_cast<double> (profiler.samplesIn ('I') + profiler.samplesIn ('N'));
+    if (inLua > 0.0)
+        report.interpreted = profiler.samplesIn ('I') / inLua;
+    if (report.samples > 0) {
+        report.inC  = static_cast<double> (profiler.samplesIn ('C')) / report.samples;
+        report.inGC = static_cast<double> (profiler.samplesIn ('G')) / report.samples;
+    }
+    return report;
+}
+
+void JitDiagnostics::print (std::ostream& out, const Report& r, int limit) {
+    out << "[jit] " << r.program << ": traces started=" << r.started << " compiled=" << r.compiled
+        << " aborted=" << r.aborted << " flushed=" << r.flushed
+        << std::fixed << std::setprecision (1)
+        << " interpreted=" << 100.0 * r.interpreted << "% C=" << 100.0 * r.inC
+        << "% GC=" << 100.0 * r.inGC << "% (" << r.samples << " samples)"
+        << std::defaultfloat << std::endl;
+
+    for (int i = 0; i < std::min (limit, static_cast<int> (r.aborts.size())); ++i) {
+        const auto& a = r.aborts[i];
+        out << "[jit]   abort x" << a.count << " " << a.location << ": " << a.reason << std::endl;
+    }
+    if (static_cast<int> (r.aborts.size()) > limit)
+        out << "[jit]   ... " << r.aborts.size() - limit << " more" << std::endl;
+}
+
+} // namespace lua
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "profiler.hpp"
+#include "sol/state_view.hpp"
+#include "sol/table.hpp"
+
+namespace lua {
+
+/** Which parts of a bot program LuaJIT compiles, and why the rest doesn't.
+
+    Loads robot/jitdiag.lua, which counts compiled and aborted traces with
+    the abort reason and source location from `jit.attach` events. While
+    attached a Profiler samples the VM state, giving the share of time spent
+    in the interpreter rather than compiled code.
+
+    Meant to run headless: feed the bot an Input stream, synthetic or
+    recorded, and call begin() and end() around the ticks of interest. see
+    test/jitdiagtest.cpp which reports on every .bot in the robot directory.
+*/
+class JitDiagnostics final {
+public:
+    /** One tick of gamepad input. */
+    struct Input {
+        double axes[6] {};      ///> raw axes: left x, left y, left trigger, right trigger, right x, right y
+        uint32_t buttons { 0 }; ///> bit n is button n + 1
+        int pov { -1 };
+    };
+
+    /** Returns `ticks` of input that sweeps the sticks and triggers and
+        presses every button and dpad direction in turn.
+    */
+    static std::vector<Input> synthetic (int ticks);
+
+    /** Read recorded input, one tick per line: the six axes, the buttons
+        bit mask and the dpad angle, comma separated. '#' starts a comment.
+        @returns the ticks read, empty if the file couldn't be opened.
+    */
+    static std::vector<Input> load (const std::string& path);
+
+    struct Abort {
+        std::string reason, location;
+        int count { 0 };
+    };
+
+    struct Trace {
+        std::string location;
+        int count { 0 };
+    };
+
+    /** What happened between begin() and end() */
+    struct Report {
+        std::string program;
+        int started { 0 }, compiled { 0 }, aborted { 0 }, flushed { 0 };
+        std::vector<Trace> traces; ///> compiled, by where they start, most first
+        std::vector<Abort> aborts; ///> by reason and location, most first
+        int64_t samples { 0 };
+        /** Share of samples in Lua that were interpreted, 0 to 1. */
+        double interpreted { 0.0 };
+        /** Share of all samples in C functions and the GC, 0 to 1. */
+        double inC { 0.0 }, inGC { 0.0 };
+    };
+
+    explicit JitDiagnostics (lua_State* L);
+    ~JitDiagnostics();
+
+    /** Flush compiled traces and start counting.
+        @returns false if jitdiag.lua couldn't be loaded, see error()
+    */
+    bool begin();
+
+    /** Stop counting and return what happened. */
+    Report end (std::string_view program);
+
+    /** Returns an error string if begin() failed. */
+    const std::string& error() const noexcept { return _error; }
+
+    /** Write a report, listing at most `limit` aborts. */
+    static void print (std::ostream& out, const Report& report, int limit = 10);
+
+private:
+    sol::state_view L;
+    sol::table module;
+    Profiler profiler;
+    bool attached { false };
+    std::string _error;
+};
+
+} // namespace lua
@@ -1,66 +1,266 @@
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
 #include "robot.hpp"
+#include "scripting.hpp"
+
+namespace detail {
+
+static double sign (double x) noexcept {
+    return x > 0.0 ? 1.0 : x < 0.0 ? -1.0 : 0.0;
+}
+
+} // namespace detail
+
+//==============================================================================
+std::optional<double> Lifter::Settings::setpoint (std::string_view name) const {
+    if (auto it = setpoints.find (name); it != setpoints.end())
+        return it->second;
+    return std::nullopt;
+}
+
+double Lifter::Settings::feedforward (double degrees, double velocity) const noexcept {
+    constexpr double radiansPerDegree = std::numbers::pi / 180.0;
+    return kS * detail::sign (velocity)
+           + kG * std::cos (degrees * radiansPerDegree)
+           + kV * velocity;
+}
+
+Lifter::Settings Lifter::Settings::fromConfig() {
+    Settings s;
+    s.gearRatio       = config::number ("lifter", "gear_ratio", s.gearRatio);
+    s.manualVoltage   = config::number ("lifter", "manual_voltage", s.manualVoltage);
+    s.startPosition   = config::number ("lifter", "start_position", s.startPosition);
+    s.minPosition     = config::number ("lifter", "min_position", s.minPosition);
+    s.maxPosition     = config::number ("lifter", "max_position", s.maxPosition);
+    s.maxVelocity     = config::number ("lifter", "max_velocity", s.maxVelocity);
+    s.maxAcceleration = config::number ("lifter", "max_acceleration", s.maxAcceleration);
+    s.tolerance       = config::number ("lifter", "tolerance", s.tolerance);
+    s.kP              = config::number ("lifter", "kP", s.kP);
+    s.kI              = config::number ("lifter", "kI", s.kI);
+    s.kD              = config::number ("lifter", "kD", s.kD);
+    s.kS              = config::number ("lifter", "kS", s.kS);
+    s.kG              = config::number ("lifter", "kG", s.kG);
+    s.kV              = config::number ("lifter", "kV", s.kV);
+    s.simArmLength    = config::number ("lifter", "sim_arm_length", s.simArmLength);
+    s.simArmMass      = config::number ("lifter", "sim_arm_mass", s.simArmMass);
+
+    if (s.maxPosition < s.minPosition)
+        std::swap (s.minPosition, s.maxPosition);
+
+    sol::object onboard = lua::config::get ("lifter", "onboard");
+    if (onboard.is<sol::table>()) {
+        sol::table tbl = onboard;
+        s.onboardPid   = tbl.get_or ("enabled", s.onboardPid);
+        s.onboardP     = tbl.get_or ("kP", s.onboardP);
+        s.onboardI     = tbl.get_or ("kI", s.onboardI);
+        s.onboardD     = tbl.get_or ("kD", s.onboardD);
+    }
 
-Lifter::Lifter() {
-    for (auto m : motors) {
-        m->SetInverted (false);
-        m->SetSmartCurrentLimit (40, 30);
+    sol::object setpoints = lua::config::get ("lifter", "setpoints");
+    if (setpoints.is<sol::table>()) {
+        for (const auto& [key, value] : setpoints.as<sol::table>())
+            if (key.is<std::string>() && value.is<double>())
+                s.setpoints[key.as<std::string>()] = s.clamp (value.as<double>());
     }
+
+    return s;
+}
+
+//==============================================================================
+Lifter::Lifter()
+    : _settings (Settings::fromConfig()),
+      profile ({ Profile::Velocity_t { _settings.maxVelocity },
+                 Profile::Acceleration_t { _settings.maxAcceleration } }),
+      pids { frc::PIDController { _settings.kP, _settings.kI, _settings.kD },
+             frc::PIDController { _settings.kP, _settings.kI, _settings.kD } } {
+    const double lower = toTurns (_settings.minPosition);
+    const double upper = toTurns (_settings.maxPosition);
+
+    for (int i = 0; i < 2; ++i) {
+        auto& spark = motors[i]->motor();
+        spark.SetInverted (false);
+        spark.SetSmartCurrentLimit (40, 30);
+        spark.SetIdleMode (rev::CANSparkMax::IdleMode::kBrake);
+
+        // soft limits are in motor turns: no conversion factor is set.
+        spark.SetSoftLimit (rev::CANSparkMax::SoftLimitDirection::kReverse, static_cast<float> (lower));
+        spark.SetSoftLimit (rev::CANSparkMax::SoftLimitDirection::kForward, static_cast<float> (upper));
+        spark.EnableSoftLimit (rev::CANSparkMax::SoftLimitDirection::kReverse, true);
+        spark.EnableSoftLimit (rev::CANSparkMax::SoftLimitDirection::kForward, true);
+
+        onboardPids[i].SetP (_settings.onboardP);
+        onboardPids[i].SetI (_settings.onboardI);
+        onboardPids[i].SetD (_settings.onboardD);
+
+        encoders[i]->SetMeasurementPeriod (16);
+        encoders[i]->SetAverageDepth (2);
+        encoders[i]->SetPosition (toTurns (_settings.startPosition));
+        positions[i] = _settings.startPosition;
+    }
+
+    _goal = setpoint = { units::degree_t (_settings.startPosition), units::degrees_per_second_t (0.0) };
+}
+
+void Lifter::setProcessPeriod (int ms) {
+    period = units::millisecond_t (std::max (1, ms));
+    for (auto& pid : pids)
+        pid = frc::PIDController { _settings.kP, _settings.kI, _settings.kD, period };
 }
 
 void Lifter::moveUp() {
-    maybeInstantiateEncoders();
-    for (auto m : motors)
-        m->SetVoltage (units::volt_t { 0.3 * 12.0 });
-#if USE_LIFTER_ENCODERS
-    std::clog << "[lifter] pos: " << encL->GetPosition()
-              << " - " << encR->GetPosition() << std::endl;
-#endif
+    mode      = Manual;
+    direction = 1.0;
 }
 
 void Lifter::moveDown() {
-    maybeInstantiateEncoders();
-    for (auto m : motors)
-        m->SetVoltage (units::volt_t { 0.3 * -12.0 });
-#if USE_LIFTER_ENCODERS
-    std::clog << "[lifter] pos: " << encL->GetPosition()
-              << " - " << encR->GetPosition() << std::endl;
-#endif
+    mode      = Manual;
+    direction = -1.0;
+}
+
+bool Lifter::moveTo (std::string_view name) {
+    if (auto degrees = _settings.setpoint (name)) {
+        moveTo (*degrees);
+        return true;
+    }
+    return false;
+}
+
+void Lifter::moveTo (double degrees) {
+    // start from where the arms are, not where the last move left off.
+    if (mode != Profiled)
+        setpoint = { units::degree_t (position()), units::degrees_per_second_t (0.0) };
+    _goal = { units::degree_t (_settings.clamp (degrees)), units::degrees_per_second_t (0.0) };
+    mode  = Profiled;
+
+    for (auto& pid : pids)
+        pid.Reset();
+    moveTicks = 0;
+    arrived   = false;
 }
 
 void Lifter::stop() {
-    maybeInstantiateEncoders();
-    for (auto m : motors)
-        m->SetVoltage (units::volt_t { 0.0 });
+    mode      = Stopped;
+    direction = 0.0;
 }
 
-void Lifter::resetEncoders() {
-#if USE_LIFTER_ENCODERS
-    static bool hasInit = false;
-    if (hasInit)
-        return;
-    std::array<EncoderType*, 2> encs { encL.get(), encR.get() };
-    [[maybe_unused]] constexpr auto wheelRadius = 0.1;
-
-    for (auto e : encs) {
-        e->SetPositionConversionFactor (2 * std::numbers::pi * wheelRadius / 4096);
-        e->SetAverageDepth (8);
-        e->SetMeasurementPeriod (15);
-        e->SetPosition (0);
-        // e->SetInverted (false);
+bool Lifter::atGoal() const noexcept {
+    if (mode != Profiled)
+        return false;
+    const double tolerance = _settings.tolerance;
+    return std::abs (positions[0] - goal()) <= tolerance
+           && std::abs (positions[1] - goal()) <= tolerance;
+}
+
+void Lifter::readPositions() noexcept {
+    for (int i = 0; i < 2; ++i)
+        positions[i] = simulation != nullptr ? simulation->position (i)
+                                             : toDegrees (encoders[i]->GetPosition());
+}
+
+void Lifter::process() noexcept {
+    readPositions();
+
+    switch (mode) {
+        case Stopped: {
+            for (auto* m : motors)
+                m->setVoltage (units::volt_t { 0.0 });
+            break;
+        }
+
+        case Manual: {
+            // the controllers' soft limits do this too. stopping here keeps
+            // the simulator and a misconfigured controller honest.
+            const bool limited = direction > 0.0 ? position() >= _settings.maxPosition
+                                                 : position() <= _settings.minPosition;
+            const units::volt_t volts { limited ? 0.0 : direction * _settings.manualVoltage * powerScale };
+            for (auto* m : motors)
+                m->setVoltage (volts);
+            break;
+        }
+
+        case Profiled: {
+            setpoint              = profile.Calculate (period, setpoint, _goal);
+            const double target   = setpoint.position.value();
+            const double velocity = setpoint.velocity.value();
+
+            for (int i = 0; i < 2; ++i) {
+                const double ff = powerScale * _settings.feedforward (positions[i], velocity);
+                if (useOnboardPid()) {
+                    onboardPids[i].SetReference (toTurns (target), rev::CANSparkMax::ControlType::kPosition,
+                                                 0, ff, rev::SparkPIDController::ArbFFUnits::kVoltage);
+                    motors[i]->invalidate();
+                } else {
+                    const double volts = ff + powerScale * pids[i].Calculate (positions[i], target);
+                    motors[i]->setVoltage (units::volt_t { std::clamp (volts, -12.0, 12.0) });
+                }
+            }
+
+            ++moveTicks;
+            if (! arrived && atGoal()) {
+                arrived = true;
+                moveTime.add (std::chrono::duration_cast<snider::TimingStats::duration> (
+                    std::chrono::duration<double> (moveTicks * period.value())));
+            }
+            break;
+        }
     }
+}
+
+double Lifter::drawnCurrent() const noexcept {
+    if (simulation != nullptr)
+        return simulation->current();
+
+    double amps = 0.0;
+    for (auto* m : motors)
+        amps += m->motor().GetOutputCurrent();
+    return amps;
+}
+
+void Lifter::report (std::ostream& out) const {
+    out << "[lifter] moves=" << moveTime.count()
+        << std::fixed << std::setprecision (1)
+        << " avg=" << moveTime.averageMicros() / 1000.0 << "ms"
+        << " max=" << moveTime.maxMicros() / 1000.0 << "ms"
+        << " position=" << position() << "deg"
+        << std::endl;
+}
 
-    hasInit = true;
-#endif
+void Lifter::resetStats() noexcept {
+    moveTime.reset();
 }
 
-void Lifter::maybeInstantiateEncoders() {
-#if USE_LIFTER_ENCODERS
-    if (encL == nullptr || encR == nullptr) {
-        encL = std::make_unique<EncoderType> (
-            leftArm.GetEncoder (EncoderType::Type::kHallSensor, 42));
-        encR = std::make_unique<EncoderType> (
-            rightArm.GetEncoder (EncoderType::Type::kHallSensor, 42));
-        resetEncoders();
+//==============================================================================
+Lifter::Simulation::Simulation (Lifter& o)
+    : owner (o),
+      arms { [&o]() {
+          const auto& s = o.settings();
+          const units::meter_t length { s.simArmLength };
+          const auto moi = frc::sim::SingleJointedArmSim::EstimateMOI (length, units::kilogram_t (s.simArmMass));
+          // hard stops a little past the soft limits.
+          frc::sim::SingleJointedArmSim arm { frc::DCMotor::NEO (1), s.gearRatio, moi, length,
+                                              units::degree_t (s.minPosition - 5.0),
+                                              units::degree_t (s.maxPosition + 5.0),
+                                              true, units::degree_t (s.startPosition) };
+          return std::array<frc::sim::SingleJointedArmSim, 2> { arm, arm };
+      }() } {}
+
+void Lifter::Simulation::update() {
+    const units::millisecond_t dt { enginePeriodMs };
+    for (int i = 0; i < 2; ++i) {
+        arms[i].SetInputVoltage (owner.motors[i]->lastVoltage());
+        arms[i].Update (dt);
     }
-#endif
+}
+
+void Lifter::initializeSimulation() {
+    if (simulation != nullptr)
+        return;
+    simulation = std::make_unique<Simulation> (*this);
+}
+
+void Lifter::updateSimulation() {
+    if (simulation)
+        simulation->update();
 }
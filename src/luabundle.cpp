@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#ifdef _WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include "luabundle.hpp"
+extern "C" {
+#include "lauxlib.h"
+#include "lua.h"
+}
+
+namespace fs = std::filesystem;
+
+namespace lua {
+namespace detail {
+
+// see util/bundle-lua.py for the layout. Both the roboRIO and desktops are
+// little endian, fields are read as they are.
+static constexpr char bundleMagic[4]  = { 'S', 'N', 'L', 'B' };
+static constexpr uint32_t bundleVersion = 2;
+static constexpr uint32_t flagBytecode  = 1;
+static constexpr std::size_t headerSize = 16;
+static constexpr std::size_t entrySize  = 24;
+
+template <typename T>
+static T read (const char* at) noexcept {
+    T value;
+    std::memcpy (&value, at, sizeof (T));
+    return value;
+}
+
+// package searcher: upvalue 1 is the bundle.
+static int search (lua_State* L) {
+    const auto* bundle = static_cast<const Bundle*> (lua_touserdata (L, lua_upvalueindex (1)));
+    std::string name   = luaL_checkstring (L, 1);
+    std::replace (name.begin(), name.end(), '.', '/');
+
+    for (const auto& file : { name + ".lua", name + "/init.lua" }) {
+        if (const auto* chunk = bundle->find (file)) {
+            if (bundle->load (L, *chunk))
+                return 1;
+            // an override or a bad chunk, let the file searcher have it.
+            lua_pushfstring (L, "\n\tbundled '%s' skipped", file.c_str());
+            return 1;
+        }
+    }
+
+    lua_pushfstring (L, "\n\tno chunk '%s.lua' in bundle", name.c_str());
+    return 1;
+}
+
+} // namespace detail
+
+//==============================================================================
+Bundle::~Bundle() {
+#ifdef _WIN32
+    if (data != nullptr)
+        UnmapViewOfFile (data);
+    if (mapping != nullptr)
+        CloseHandle (mapping);
+    if (file != nullptr && file != INVALID_HANDLE_VALUE)
+        CloseHandle (file);
+#else
+    if (data != nullptr)
+        munmap (const_cast<char*> (data), length);
+#endif
+}
+
+std::unique_ptr<Bundle> Bundle::open (const std::string& file) {
+    auto self        = std::unique_ptr<Bundle> (new Bundle());
+    self->_directory = fs::path (file).parent_path().make_preferred().string();
+
+#ifdef _WIN32
+    self->file = CreateFileA (file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (self->file == INVALID_HANDLE_VALUE)
+        return nullptr;
+    LARGE_INTEGER size;
+    if (! GetFileSizeEx (self->file, &size) || size.QuadPart <= 0)
+        return nullptr;
+    self->mapping = CreateFileMappingA (self->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (self->mapping == nullptr)
+        return nullptr;
+    self->data = static_cast<const char*> (MapViewOfFile (self->mapping, FILE_MAP_READ, 0, 0, 0));
+    if (self->data == nullptr)
+        return nullptr;
+    self->length = static_cast<std::size_t> (size.QuadPart);
+#else
+    const int fd = ::open (file.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat info;
+    if (fstat (fd, &info) != 0 || info.st_size <= 0) {
+        ::close (fd);
+        return nullptr;
+    }
+    void* mapped = mmap (nullptr, static_cast<std::size_t> (info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close (fd);
+    if (mapped == MAP_FAILED)
+        return nullptr;
+    self->data   = static_cast<const char*> (mapped);
+    self->length = static_cast<std::size_t> (info.st_size);
+#endif
+
+    const char* base = self->data;
+    if (self->length < detail::headerSize
+        || std::memcmp (base, detail::bundleMagic, sizeof (detail::bundleMagic)) != 0
+        || detail::read<uint32_t> (base + 4) != detail::bundleVersion) {
+        std::cerr << "[lua] not a script bundle: " << file << std::endl;
+        return nullptr;
+    }
+
+    const auto count = detail::read<uint32_t> (base + 8);
+    if (count > (self->length - detail::headerSize) / detail::entrySize) {
+        std::cerr << "[lua] truncated script bundle: " << file << std::endl;
+        return nullptr;
+    }
+
+    self->_chunks.reserve (count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const char* entry     = base + detail::headerSize + i * detail::entrySize;
+        const auto nameOffset = detail::read<uint32_t> (entry);
+        const auto nameSize   = detail::read<uint32_t> (entry + 4);
+        const auto dataOffset = detail::read<uint32_t> (entry + 8);
+        const auto dataSize   = detail::read<uint32_t> (entry + 12);
+        if (uint64_t (nameOffset) + nameSize > self->length || uint64_t (dataOffset) + dataSize > self->length) {
+            std::cerr << "[lua] truncated script bundle: " << file << std::endl;
+            return nullptr;
+        }
+
+        Chunk chunk;
+        chunk.name     = std::string_view (base + nameOffset, nameSize);
+        chunk.data     = std::string_view (base + dataOffset, dataSize);
+        chunk.bytecode = (detail::read<uint32_t> (entry + 16) & detail::flagBytecode) != 0;
+        self->_chunks.push_back (chunk);
+    }
+
+    std::error_code ec;
+    self->_overrides = fs::exists (fs::path (self->_directory) / overridesFile, ec);
+    if (self->_overrides)
+        std::clog << "[lua] " << overridesFile << " found: scripts next to the bundle override it" << std::endl;
+
+    // the bundler sorts them already, don't rely on it.
+    std::sort (self->_chunks.begin(), self->_chunks.end(), [] (const Chunk& a, const Chunk& b) {
+        return a.name < b.name;
+    });
+    return self;
+}
+
+const Bundle::Chunk* Bundle::find (std::string_view name) const noexcept {
+    auto iter = std::lower_bound (_chunks.begin(), _chunks.end(), name, [] (const Chunk& c, std::string_view n) {
+        return c.name < n;
+    });
+    return iter != _chunks.end() && iter->name == name ? &(*iter) : nullptr;
+}
+
+bool Bundle::load (lua_State* L, const Chunk& chunk) const {
+    std::error_code ec;
+    if (_overrides && fs::exists (fs::path (_directory) / fs::path (chunk.name), ec)) {
+        _overridden.fetch_add (1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const std::string chunkname = "@" + std::string (chunk.name);
+    if (luaL_loadbuffer (L, chunk.data.data(), chunk.data.size(), chunkname.c_str()) != 0) {
+        std::cerr << "[lua] bundled " << chunk.name << ": " << lua_tostring (L, -1) << std::endl;
+        lua_pop (L, 1);
+        return false;
+    }
+
+    _loaded.fetch_add (1, std::memory_order_relaxed);
+    return true;
+}
+
+//==============================================================================
+int load_chunk (lua_State* L, const Bundle* bundle, std::string_view file) {
+    const auto path = fs::path (file).lexically_normal().make_preferred();
+
+    if (bundle != nullptr && path.parent_path().string() == fs::path (bundle->directory()).lexically_normal().string()) {
+        const auto* chunk = bundle->find (path.filename().string());
+        if (chunk != nullptr && bundle->load (L, *chunk))
+            return 0;
+    }
+
+    std::error_code ec;
+    if (! fs::exists (path, ec)) {
+        lua_pushfstring (L, "file does not exist: %s", path.string().c_str());
+        return LUA_ERRFILE;
+    }
+
+    return luaL_loadfile (L, path.string().c_str());
+}
+
+void add_searcher (lua_State* L, const Bundle& bundle) {
+    lua_getglobal (L, "package");
+    lua_getfield (L, -1, "loaders");
+    if (! lua_istable (L, -1)) {
+        lua_pop (L, 1);
+        lua_getfield (L, -1, "searchers");
+    }
+    if (! lua_istable (L, -1)) {
+        lua_pop (L, 2);
+        return;
+    }
+
+    // after preload, ahead of the file searchers.
+    const int count = static_cast<int> (lua_objlen (L, -1));
+    for (int i = count; i >= 2; --i) {
+        lua_rawgeti (L, -1, i);
+        lua_rawseti (L, -2, i + 1);
+    }
+    lua_pushlightuserdata (L, const_cast<Bundle*> (&bundle));
+    lua_pushcclosure (L, detail::search, 1);
+    lua_rawseti (L, -2, 2);
+    lua_pop (L, 2);
+}
+
+} // namespace lua
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct lua_State;
+
+namespace lua {
+
+/** Precompiled robot scripts in one file, mapped read only.
+
+    Written by util/bundle-lua.py at build time and deployed next to
+    config.lua. Chunks are keyed by their path relative to the robot
+    directory, e.g. "config.lua" or "teleop.bot", and hold LuaJIT bytecode,
+    or source when the build couldn't make bytecode for the target.
+
+    Scripts in the search directory are ignored for bundled chunks, unless
+    the directory has an `overridesFile` in it. Then a script copied next to
+    the bundle wins over its chunk, so an edited file can be tried on the
+    robot without rebuilding anything. Deploying removes the marker and any
+    loose scripts, see build.gradle
+*/
+class Bundle final {
+public:
+    /** The bundle's file name in the search directory. */
+    static constexpr const char* fileName = "robot.luab";
+
+    /** Create this file next to the bundle to let scripts override it. */
+    static constexpr const char* overridesFile = "lua-overrides";
+
+    /** A chunk, pointing in to the mapped file. */
+    struct Chunk {
+        std::string_view name;
+        std::string_view data;
+        bool bytecode { false };
+    };
+
+    ~Bundle();
+
+    /** Map a bundle file.
+        @returns the bundle or nullptr if missing or not a valid bundle.
+    */
+    static std::unique_ptr<Bundle> open (const std::string& file);
+
+    /** Returns a chunk by name or nullptr. */
+    const Chunk* find (std::string_view name) const noexcept;
+
+    /** Push a chunk's function, unless overrides are on and its script is in
+        the directory, or it doesn't load (e.g. bytecode for another LuaJIT).
+        @returns true if pushed, false leaves the stack as it was.
+    */
+    bool load (lua_State* L, const Chunk& chunk) const;
+
+    /** Returns true if scripts in the directory override chunks. */
+    bool overrides() const noexcept { return _overrides; }
+
+    /** Returns the directory the bundle was opened from. */
+    const std::string& directory() const noexcept { return _directory; }
+
+    /** Returns every chunk, sorted by name. */
+    const std::vector<Chunk>& chunks() const noexcept { return _chunks; }
+
+    /** Returns the size of the mapped file in bytes. */
+    std::size_t bytes() const noexcept { return length; }
+
+    /** Chunks loaded from memory and scripts that overrode a chunk. */
+    int loaded() const noexcept { return _loaded.load (std::memory_order_relaxed); }
+    int overridden() const noexcept { return _overridden.load (std::memory_order_relaxed); }
+
+private:
+    Bundle() = default;
+    Bundle (const Bundle&)            = delete;
+    Bundle& operator= (const Bundle&) = delete;
+
+    const char* data { nullptr };
+    std::size_t length { 0 };
+#ifdef _WIN32
+    void* file { nullptr };
+    void* mapping { nullptr };
+#endif
+    std::string _directory;
+    bool _overrides { false };
+    std::vector<Chunk> _chunks;
+    mutable std::atomic<int> _loaded { 0 }, _overridden { 0 };
+};
+
+/** Load a script file, from the bundle when it's in the bundle's directory
+    and not overridden. A null bundle always loads the file.
+
+    Pushes the loaded function, or an error message on failure.
+    @returns 0 (LUA_OK) on success or a Lua error code.
+*/
+int load_chunk (lua_State* L, const Bundle* bundle, std::string_view file);
+
+/** Add a package searcher ahead of the file searcher that serves `require`
+    from the bundle. The bundle must outlive the state.
+*/
+void add_searcher (lua_State* L, const Bundle& bundle);
+
+} // namespace lua
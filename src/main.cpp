@@ -1,32 +1,44 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <regex>
 #include <string>
 
 #include <frc/Filesystem.h>
+#include <frc/Notifier.h>
+#include <frc/PowerDistribution.h>
 #include <frc/TimedRobot.h>
 #include <frc/XboxController.h>
-#include <frc/controller/RamseteController.h>
 #include <frc/filter/SlewRateLimiter.h>
-#include <frc/smartdashboard/Field2d.h>
+#include <frc/simulation/BatterySim.h>
+#include <frc/simulation/RoboRioSim.h>
 #include <frc/smartdashboard/SendableChooser.h>
 #include <frc/smartdashboard/SmartDashboard.h>
 #include <frc/trajectory/TrajectoryGenerator.h>
 
-#include <cameraserver/CameraServer.h>
-#if 0
-#    include <opencv2/core/core.hpp>
-#    include <opencv2/core/types.hpp>
-#    include <opencv2/imgproc/imgproc.hpp>
-#endif
-
+#include "snider/jittermonitor.hpp"
 #include "snider/padmode.hpp"
 
+#include "actions.hpp"
+#include "canbus.hpp"
+#include "characterization.hpp"
+#include "commands.hpp"
 #include "config.hpp"
 #include "engine.hpp"
+#include "enginegroup.hpp"
+#include "luabundle.hpp"
 #include "normalisablerange.hpp"
+#include "overrun.hpp"
 #include "parameters.hpp"
+#include "powermanager.hpp"
+#include "profiler.hpp"
+#include "ratescheduler.hpp"
+#include "realtime.hpp"
 #include "scripting.hpp"
+#include "telemetry.hpp"
+#include "vision.hpp"
+#include "worker.hpp"
 
 #include "robot.hpp"
 #include "sol/table.hpp"
@@ -35,48 +47,11 @@
 
 namespace lua {
 extern void bind_gamepad (frc::XboxController*);
+extern void bind_geometry();
 }
 
 namespace detail {
 
-// make a pose2d from a lua table.
-frc::Pose2d makePose2d (sol::table tbl) {
-    return frc::Pose2d (
-        units::meter_t (tbl[1].get<double>()),
-        units::meter_t (tbl[2].get<double>()),
-        frc::Rotation2d (units::radian_t (tbl[3].get<double>())));
-}
-
-// make a trajectory config from a lua table.
-frc::TrajectoryConfig makeTrajectoryConfig (sol::table tbl) {
-    return frc::TrajectoryConfig (
-        units::meters_per_second_t (tbl[1].get<double>()),
-        units::meters_per_second_squared_t (tbl[2].get<double>()));
-}
-
-static bool trajectoryShouldShoot (std::string_view symbol, bool otherwise = true) {
-    sol::function trajectory = lua::state()["config"]["trajectory"];
-    sol::table tbl           = trajectory (symbol);
-    return tbl.get_or ("shoot", otherwise);
-}
-
-static bool trajectoryIsReverse (std::string_view symbol, bool otherwise = true) {
-    sol::function trajectory = lua::state()["config"]["trajectory"];
-    sol::table tbl           = trajectory (symbol);
-    return tbl.get_or ("reverse", otherwise);
-}
-
-// compose a trajectory from lua configuration.
-frc::Trajectory makeTrajectory (std::string_view symbol) {
-    sol::function trajectory = lua::state()["config"]["trajectory"];
-    sol::table tbl           = trajectory (symbol);
-    return frc::TrajectoryGenerator::GenerateTrajectory (
-        makePose2d (tbl["start"]),
-        {},
-        makePose2d (tbl["stop"]),
-        makeTrajectoryConfig (tbl["config"]));
-}
-
 static void displayBanner() {
     // display engine and bot info.
     lua::print_version();
@@ -126,6 +101,16 @@ public:
                     files.push_back ((*iter).path().filename().string());
             }
 
+            // deployed programs may only be in the bundle.
+            if (const auto* bundle = lua::bundle()) {
+                for (const auto& chunk : bundle->chunks()) {
+                    std::string name (chunk.name);
+                    if (fs::path (name).extension() == ".bot"
+                        && std::find (files.begin(), files.end(), name) == files.end())
+                        files.push_back (name);
+                }
+            }
+
             chooser.SetDefaultOption (defaultTest, defaultTest);
             for (const auto& f : files)
                 chooser.AddOption (f, f);
@@ -171,9 +156,9 @@ public:
     AutoModeInfo info() const {
         AutoModeInfo info;
         info.name       = get();
-        info.shoot      = detail::trajectoryShouldShoot (info.name, info.shoot);
-        info.reverse    = detail::trajectoryIsReverse (info.name, info.reverse);
-        info.trajectory = detail::makeTrajectory (info.name);
+        info.shoot      = config::trajectory_shoot (info.name, info.shoot);
+        info.reverse    = config::trajectory_reverse (info.name, info.reverse);
+        info.trajectory = config::trajectory (info.name);
         return info;
     }
 
@@ -214,33 +199,96 @@ public:
         Shooter::bind (&shooter);
         Lifter::bind (&lifter);
         Drivetrain::bind (&drivetrain);
+        lua::Worker::bind (&worker);
         lua::bind_gamepad (&gamepad);
+        lua::bind_geometry();
+
+        for (auto* action : std::initializer_list<Action*> {
+                 &driveAction, &followAction, &shootAction, &intakeAction, &liftAction, &liftToAction })
+            commands.addAction (*action);
+        CommandScheduler::bind (&commands);
+        Characterization::bind (&characterization);
+
+        if (config::boolean ("tunables", "enabled"))
+            Tunables::get().startNetworkTables();
+
+        // Rate groups run independent of the engine period. see config.rates
+        const double period = config::number ("engine", "period");
+        rates.add ("commands", [this]() { commands.run (commandPeriod); }, period);
+        // the drivetrain's physics steps on its own, so its sensors are
+        // fresh for a control loop faster than the engine. see SimulatedDrive
+        if (RobotBase::IsSimulation())
+            rates.add ("simulation", [this]() { drivetrain.updateSimulation(); }, period);
+        rates.add ("drivetrain", [this]() {
+            if (characterization.active())
+                characterize();
+            else
+                drivetrain.process();
+        },
+                   period);
+        rates.add ("mechanisms", [this]() {
+            // state machines and their timers hold while disabled.
+            if (! IsEnabled())
+                return;
+            shooter.process();
+            lifter.process();
+        },
+                   period);
+        rates.add ("power", [this]() { managePower(); }, period);
+        rates.add ("telemetry", [this]() {
+            if (overruns.shouldRun (Deferrable::Telemetry))
+                captureTelemetry();
+        },
+                   20.0);
+        // rate groups run outside the mode periodics, count them in the tick.
+        rates.attach (*this, [this] (snider::TimingStats::duration elapsed) {
+            overruns.addWork (elapsed);
+        });
+        commandPeriod = rates.periodMs ("commands") / 1000.0;
+        shooter.setProcessPeriod (static_cast<int> (rates.periodMs ("mechanisms")));
+        lifter.setProcessPeriod (static_cast<int> (rates.periodMs ("mechanisms")));
+        drivetrain.setProcessPeriod (static_cast<int> (rates.periodMs ("drivetrain")));
+        powerPeriod = rates.periodMs ("power") / 1000.0;
+        if (config::boolean ("power", "pdp", true) && RobotBase::IsReal())
+            pdp = std::make_unique<frc::PowerDistribution>();
 
         detail::displayBanner();
+        can::report (std::clog);
     }
 
     ~RobotMain() {
-        engine.reset();
+        engines.clear();
+        commands.reset();
+        camera.reset();
+        telemetry.stop();
+        worker.stop();
 
         // release instances from lua
         Parameters::bind (nullptr);
         Shooter::bind (nullptr);
         Lifter::bind (nullptr);
         Drivetrain::bind (nullptr);
+        Characterization::bind (nullptr);
+        lua::Worker::bind (nullptr);
         lua::bind_gamepad (nullptr);
+        CommandScheduler::bind (nullptr);
     }
 
     void RobotInit() override {
         testProgram = std::make_unique<TestProgramChooser>();
         autoMode    = std::make_unique<AutoModeChooser>();
         reloadTrajectory();
-        collectGarbage();
 
-// #ifndef RUNNING_FRC_TESTS
-#if 0
-        std::thread vision (visionThread);
-        vision.detach();
-#endif
+        const auto realtime = rt::options();
+        worker.setCpu (realtime.enabled ? realtime.helperCpu : -1);
+        startWorker();
+        startCamera();
+        telemetry.start (config::integer ("telemetry", "period", 50));
+        collectGarbage();
+        // the HAL notifier wakes the loop, run it at the loop's priority.
+        if (realtime.enabled && realtime.priority > 0)
+            frc::Notifier::SetHALThreadPriority (true, realtime.priority);
+        rt::setup (realtime);
     }
 
     /** Called periodically no matter the mode. This RUNS AFTER the mode 
@@ -248,100 +296,122 @@ public:
         integrated updating.
      */
     void RobotPeriodic() override {
-        drivetrain.postProcess();
+        jitter.tick();
+        runDeferrable();
+        overruns.endTick();
     }
 
     void AutonomousInit() override {
-        reloadTrajectory();
-
-        timer.Restart();
+        // usually already loaded while disabled.
+        if (autoRequested != autoMode->get())
+            reloadTrajectory();
+        commands.reset();
         drivetrain.resetOdometry (autoInfo.trajectory.InitialPose());
+
+        // always shoot the preloaded note while starting down the path, then
+        // turn in place for a bit.
+        followAction.setTrajectory (autoInfo.trajectory, autoInfo.reverse);
+        autoCommand = commands.parallel ({ commands.action (shootAction, 1.0),
+                                           commands.action (followAction, 0.5, 3.0, 60.0 * 0.3) });
+        commands.schedule (autoCommand);
+
         collectGarbage();
     }
 
     void AutonomousPeriodic() override {
-        // This is so you only shoot once.
-        if (! hasShot) {
-            shooter.shoot();
-            hasShot = true;
-        }
-        shooter.process();
-
-        if (shooter.isShooting()) {
-            driveDisabled();
-            return;
-        }
-
-        // begin motion.
-        if (! hasStartedMoving) {
-            hasStartedMoving = true;
-            // Restart the timer so we can count how many seconds have passed since shooting.
-            timer.Restart();
-        }
-
-        const auto& trajectory = autoInfo.trajectory;
-        auto elapsed           = timer.Get();
-        auto reference         = trajectory.Sample (elapsed);
-        auto speeds            = ramsete.Calculate (drivetrain.estimatedPosition(), reference);
-
-        if (autoInfo.reverse)
-            speeds.vx *= -1.0;
-
-        const double speedAdjustment    = 0.5;
-        const double rotationAdjustment = 0.3;
-
-        if (elapsed <= trajectory.TotalTime()) {
-            drivetrain.drive (speeds.vx * speedAdjustment, speeds.omega);
-        } else if (elapsed < trajectory.TotalTime() + units::time::second_t (3)) {
-            drivetrain.drive (MetersPerSecond (0),
-                              DegreesPerSecond (60.0 * rotationAdjustment));
-        } else {
+        overruns.beginTick();
+        if (! commands.isScheduled (autoCommand))
             driveDisabled();
-        }
     }
 
     void AutonomousExit() override {
+        commands.cancelAll();
+        statsPending = true;
         collectGarbage();
     }
 
     //==========================================================================
     void TeleopInit() override {
         protectedLuaCalls = false;
-        if (! safeLoadEngine ("teleop.bot"))
+        if (! safeLoadEngines (config::teleop_programs()))
             return;
         luaPrepare();
     }
-    void TeleopPeriodic() override { luaPeriodic(); }
+    void TeleopPeriodic() override {
+        overruns.beginTick();
+        luaPeriodic();
+    }
     void TeleopExit() override { luaExit(); }
 
     //==========================================================================
-    void DisabledInit() override { collectGarbage(); }
-    void DisabledPeriodic() override { driveDisabled(); }
+    void DisabledInit() override {
+        commands.cancelAll();
+        characterization.stop();
+        collectGarbage();
+    }
+    void DisabledPeriodic() override {
+        overruns.beginTick();
+        driveDisabled();
+
+        // load the auto mode when it's picked, not when autonomous starts.
+        if (overruns.shouldRun (Deferrable::Dashboard) && autoRequested != autoMode->get())
+            reloadTrajectory();
+    }
     void DisabledExit() override { collectGarbage(); }
 
     //==========================================================================
     void TestInit() override {
         protectedLuaCalls   = true;
         luaErrorEncountered = false;
-        if (! safeLoadEngine (testProgram->get()))
+        if (! safeLoadEngines ({ { testProgram->get(), 1 } }))
             return;
         luaPrepare();
+        if (profiler.settings().enabled && ! profiler.start (lua::state().lua_state()))
+            std::cerr << "[profile] could not start the profiler" << std::endl;
     }
 
-    void TestPeriodic() override { luaPeriodic(); }
-    void TestExit() override { luaExit(); }
+    void TestPeriodic() override {
+        overruns.beginTick();
+        luaPeriodic();
+    }
+    void TestExit() override {
+        const bool profiled = profiler.running();
+        profiler.stop();
+        luaExit();
+        if (profiled)
+            saveProfile();
+    }
 
     //==========================================================================
     void SimulationInit() override {
         drivetrain.initializeSimulation();
+        shooter.initializeSimulation();
+        lifter.initializeSimulation();
     }
 
     void SimulationPeriodic() override {
-        drivetrain.updateSimulation();
+        shooter.updateSimulation();
+        lifter.updateSimulation();
+
+        // sag the simulated battery under the load.
+        frc::sim::RoboRioSim::SetVInVoltage (frc::sim::BatterySim::Calculate (
+            12_V, batteryResistance, { units::ampere_t (drivetrain.drawnCurrent()),
+                                       units::ampere_t (shooter.drawnCurrent()),
+                                       units::ampere_t (lifter.drawnCurrent()) }));
     }
 
 private:
-    EnginePtr engine;
+#ifdef RUNNING_FRC_TESTS
+    friend TelemetryFrame step_rate_groups (frc::TimedRobot*, double);
+    friend Shooter& simulated_shooter (frc::TimedRobot*);
+    friend Lifter& simulated_lifter (frc::TimedRobot*);
+#endif
+
+    EngineGroup engines;
+    RateScheduler rates;
+    lua::Worker worker;
+    std::unique_ptr<vision::Pipeline> camera;
+    Telemetry telemetry;
     Parameters params;
 
     frc::XboxController gamepad { config::port ("gamepad") };
@@ -349,47 +419,162 @@ private:
     Lifter lifter;
     Shooter shooter;
 
+    // Commands and the actions they're built from. see commands.lua
+    CommandScheduler commands;
+    double commandPeriod { 0.02 };
+    DriveAction driveAction { drivetrain };
+    FollowTrajectoryAction followAction { drivetrain };
+    ShootAction shootAction { shooter };
+    IntakeAction intakeAction { shooter };
+    LiftAction liftAction { lifter };
+    LiftToAction liftToAction { lifter };
+    CommandScheduler::Id autoCommand { CommandScheduler::Invalid };
+
+    // battery current shared out by priority. see config.power
+    PowerManager power { PowerManager::Settings::fromConfig() };
+    std::unique_ptr<frc::PowerDistribution> pdp;
+    double powerPeriod { 0.02 };
+    const units::ohm_t batteryResistance { power.settings().resistance };
+
+    // drivetrain feedforward measurement. see characterize.bot
+    Characterization characterization { Characterization::Settings::fromConfig() };
+    lua::Profiler profiler { lua::Profiler::Settings::fromConfig() };
+
     bool gamepadConnected = false; // Track controller connection state.
 
     std::unique_ptr<TestProgramChooser> testProgram;
 
     std::unique_ptr<AutoModeChooser> autoMode;
     AutoModeInfo autoInfo;
-    frc::RamseteController ramsete;
-    frc::Timer timer;
-    bool hasShot          = false; // Track auto bot shoot started
-    bool hasStartedMoving = false; // track auto bot movement started
+    std::string autoRequested; // chooser value autoInfo was loaded for.
 
     bool luaErrorEncountered = false;
     bool protectedLuaCalls   = false;
+    sol::protected_function inputDispatch;
+
+    OverrunManager overruns { OverrunManager::fromConfig() };
+    const int gcStep { config::integer ("overrun", "gc_step", 0) };
+    bool statsPending = false; // stats are printed when there's time.
+
+    snider::JitterMonitor jitter { std::chrono::milliseconds (config::integer ("engine", "period")) };
     //==========================================================================
+    void startWorker() {
+        if (! config::boolean ("worker", "enabled") || worker.running())
+            return;
+        worker.start (detail::findLuaDir(),
+                      config::string ("worker", "program", "background.lua"),
+                      config::integer ("worker", "period", 50));
+    }
+
+    // copy subsystem state for the telemetry thread to publish. Cheap enough
+    // for the control thread: no NetworkTables calls happen here.
+    void captureTelemetry() {
+        auto& frame = telemetry.write();
+        drivetrain.writeTelemetry (frame);
+        shooter.writeTelemetry (frame);
+        frame.loopJitterMax = jitter.maxMicros();
+        frame.luaError      = luaErrorEncountered;
+        telemetry.commit();
+    }
+
+    // log how closely the main loop kept its period, how long each rate
+    // group took and how many CAN writes were skipped, then start over.
+    void reportStats() {
+        std::clog << "[bot] loop jitter: mean=" << jitter.meanMicros()
+                  << "us p99=" << jitter.percentileMicros (0.99)
+                  << "us max=" << jitter.maxMicros()
+                  << "us (" << jitter.count() << " ticks)" << std::endl;
+        jitter.reset();
+        overruns.report (std::clog);
+        overruns.resetStats();
+        rates.report (std::clog);
+        rates.resetStats();
+        commands.report (std::clog);
+        commands.resetStats();
+        power.report (std::clog);
+        power.resetStats();
+        shooter.report (std::clog);
+        shooter.resetStats();
+        lifter.report (std::clog);
+        lifter.resetStats();
+        CachedMotor::report (std::clog);
+        drivetrain.estimator.report (std::clog);
+        drivetrain.estimator.resetStats();
+        if (drivetrain.simulation != nullptr) {
+            drivetrain.simulation->report (std::clog);
+            drivetrain.simulation->resetStats();
+        }
+        telemetry.report (std::clog);
+        telemetry.resetStats();
+        if (camera != nullptr) {
+            camera->report (std::clog);
+            camera->resetStats();
+        }
+    }
+
+    // share the battery out. see PowerManager
+    void managePower() {
+        const std::array<double, PowerManager::NumConsumers> drawn {
+            drivetrain.drawnCurrent(), shooter.drawnCurrent(), lifter.drawnCurrent()
+        };
+        power.update (frc::RobotController::GetInputVoltage(),
+                      pdp != nullptr ? pdp->GetTotalCurrent() : -1.0,
+                      drawn,
+                      powerPeriod);
+        drivetrain.setPowerScale (power.scale (Consumer::Drivetrain));
+        shooter.setPowerScale (power.scale (Consumer::Shooter));
+        lifter.setPowerScale (power.scale (Consumer::Lifter));
+    }
+
+    // one characterization step in place of the velocity loop.
+    void characterize() {
+        const double volts = characterization.step (frc::Timer::GetFPGATimestamp().value(),
+                                                    drivetrain.measuredSpeed(),
+                                                    drivetrain.measuredDistance());
+        drivetrain.driveVolts (units::volt_t (volts), units::volt_t (volts));
+    }
+
+    // Work that can wait for a tick with time to spare. see OverrunManager
+    void runDeferrable() {
+        if (statsPending && overruns.shouldRun (Deferrable::Logging)) {
+            statsPending = false;
+            reportStats();
+        }
+
+        if (gcStep >= 0 && overruns.shouldRun (Deferrable::Garbage))
+            lua::state().step_gc (gcStep);
+    }
+
     void collectGarbage() {
         lua::state().collect_garbage();
     }
 
-    // Load a bot program by name e.g. teleop.bot or engine_test.bot
-    // will throw a runtime error if the loaded engine is in error state.
-    void loadEngine (std::string_view bot) {
-        auto newEngine = detail::instantiateRobot (bot);
-        if (newEngine != nullptr) {
-            if (newEngine->have_error()) {
-                throw std::runtime_error (newEngine->error());
-            }
+    // Load bot programs by name e.g. teleop.bot or engine_test.bot. Programs
+    // that fail to load are skipped. Will throw a runtime error if none of
+    // them could be loaded.
+    void loadEngines (const std::vector<config::Program>& programs) {
+        engines.clear();
+        commands.reset();
+        resetInput();
+
+        for (const auto& program : programs) {
+            const auto started = std::chrono::steady_clock::now();
+            auto engine        = detail::instantiateRobot (program.file);
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - started;
+            if (engines.add (program.file, std::move (engine), program.divisor))
+                std::clog << "[bot] program loaded: " << program.file
+                          << " (1/" << program.divisor << ") in " << elapsed.count() << " ms" << std::endl;
+        }
 
-            newEngine->init();
-            std::swap (engine, newEngine);
-            newEngine.reset();
-            std::clog << "[bot] program loaded: " << bot << std::endl;
-        } else {
+        if (engines.empty())
             throw std::runtime_error ("Failed to instantiate Lua engine");
-        }
     }
 
-    bool safeLoadEngine (std::string_view bot) {
+    bool safeLoadEngines (const std::vector<config::Program>& programs) {
         luaErrorEncountered = false;
 
         try {
-            loadEngine (bot);
+            loadEngines (programs);
         } catch (const std::exception& e) {
             std::cerr << "[lua] exception: " << e.what() << std::endl;
             std::flush (std::cerr);
@@ -401,10 +586,11 @@ private:
 
     // reloads/resets the currently selected AutoMode info.
     void reloadTrajectory() {
+        // remember the request even if it fails, so a bad script is
+        // reported once and not parsed again every tick.
+        autoRequested = autoMode->get();
         try {
-            autoInfo         = autoMode->info();
-            hasShot          = ! detail::trajectoryShouldShoot (autoMode->get());
-            hasStartedMoving = false;
+            autoInfo = autoMode->info();
         } catch (const std::exception& e) {
             std::cerr
                 << "[bot] error: lua trajectory could not be parsed." << std::endl
@@ -421,19 +607,13 @@ private:
     }
 
     //==========================================================================
-    void luaLogErrorIfPresent() {
-        if (! luaErrorEncountered)
-            return;
-        const auto msg = engine->have_error() ? engine->error() : std::string ("unknown Lua error");
-        std::cerr << "[lua] error: " << msg << std::endl;
-    }
-
     void luaPrepare() {
         shooter.reset();
+        lifter.stop();
 
         if (! luaErrorEncountered) {
-            luaErrorEncountered = ! engine->prepare();
-            luaLogErrorIfPresent();
+            engines.prepare();
+            luaErrorEncountered = engines.allFailed();
         }
 
         collectGarbage();
@@ -444,27 +624,39 @@ private:
             driveDisabled();
         } else {
             processParameters();
+            dispatchInput();
 
-            if (! protectedLuaCalls) {
-                engine->run();
-            } else if (! luaErrorEncountered) {
-                luaErrorEncountered = ! engine->safe_run();
-                luaLogErrorIfPresent();
-            }
-        }
+            // The failed program could be the one driving. Stop the drivetrain
+            // unless a healthy program drives it this tick.
+            if (engines.anyFailed())
+                driveDisabled();
 
-        shooter.process();
+            engines.run (protectedLuaCalls);
+            luaErrorEncountered = engines.allFailed();
+        }
     }
 
     void luaExit() {
         if (! luaErrorEncountered) {
-            luaErrorEncountered = ! engine->cleanup();
-            luaLogErrorIfPresent();
+            engines.cleanup();
+            luaErrorEncountered = engines.allFailed();
         }
 
+        engines.report (std::clog);
+        statsPending = true;
         collectGarbage();
     }
 
+    // write the test mode profile next to config.lua for flamegraph.pl
+    void saveProfile() {
+        profiler.report (std::clog);
+        auto path = std::filesystem::path (detail::findLuaDir()) / profiler.settings().output;
+        if (profiler.save (path.string()))
+            std::clog << "[profile] folded stacks written to " << path.string() << std::endl;
+        else
+            std::cerr << "[profile] could not write " << path.string() << std::endl;
+    }
+
     //==========================================================================
     void driveDisabled() {
         drivetrain.drive (MetersPerSecond (0), RadiansPerSecond (0));
@@ -480,6 +672,31 @@ private:
         return gamepadConnected;
     }
 
+    // Drop input handlers left by previously loaded programs. see input.lua
+    void resetInput() {
+        sol::function require = lua::state()["require"];
+        sol::table input      = require ("input");
+        sol::function clear   = input["clear"];
+        clear();
+        inputDispatch = input["dispatch"];
+        params.clearEvents();
+    }
+
+    // Call Lua handlers for input edges found since the last tick. Nothing
+    // runs in Lua when no input changed.
+    void dispatchInput() {
+        const int count = params.numEvents();
+        for (int i = 0; i < count && inputDispatch.valid(); ++i) {
+            const auto& event = params.getEvent (i);
+            auto result       = inputDispatch ((int) event.type, event.index, event.value);
+            if (! result.valid()) {
+                sol::error err = result;
+                std::cerr << "[lua] input handler: " << err.what() << std::endl;
+            }
+        }
+        params.clearEvents();
+    }
+
     // Filter parameter values before driving the bot.
     void processParameters() {
         Parameters::Context ctx;
@@ -504,56 +721,42 @@ private:
         params.process (ctx);
     }
 
-    static void visionThread() {
-#if SIM_CAMERA_DISABLED
-        if (RobotBase::IsSimulation())
+    void startCamera() {
+        if (! config::boolean ("camera", "enabled") || camera != nullptr)
             return;
-#endif
-        const auto cameraName = "Camera 1";
-        const auto width      = 640;
-        const auto height     = 360;
-        const auto fps        = 20;
-
-        // Get the USB camera from CameraServer
-        cs::UsbCamera camera = frc::CameraServer::StartAutomaticCapture (cameraName, 0);
-        camera.SetExposureAuto();
-        camera.SetWhiteBalanceAuto();
-
-        // Set the resolution
-        camera.SetResolution (width, height);
-        camera.SetFPS (fps);
-
-#if 0
-        // Get a CvSink. This will capture Mats from the Camera
-        cs::CvSink cvSink = frc::CameraServer::GetVideo();
-        // Setup a CvSource. This will send images back to the Dashboard
-        cs::CvSource outputStream =
-            frc::CameraServer::PutVideo (cameraName, width, height);
-
-        // Mats are very memory expensive. Lets reuse this Mat.
-        cv::Mat mat;
-
-        while (true) {
-            // Tell the CvSink to grab a frame from the camera and
-            // put it
-            // in the source mat.  If there is an error notify the
-            // output.
-            if (cvSink.GrabFrame (mat) == 0) {
-                // Send the output the error.
-                outputStream.NotifyError (cvSink.GetError());
-                // skip the rest of the current iteration
-                continue;
+
+        std::unique_ptr<vision::FrameSource> source;
+        const auto settings = vision::Settings::fromConfig();
+        if (config::string ("camera", "source", "camera") == "files") {
+            auto path = std::filesystem::path (detail::findLuaDir())
+                        / config::string ("camera", "files", "images");
+            if (! std::filesystem::is_directory (path)) {
+                std::cerr << "[camera] no images in " << path.string() << std::endl;
+                return;
             }
-#    if 0
-            // Put a rectangle on the image
-            rectangle (mat, cv::Point (100, 100), 
-                            cv::Point (400, 400), 
-                            cv::Scalar (255, 255, 255), 5);
-            // Give the output stream a new image to display
-            outputStream.PutFrame (mat);
-#    endif
-        }
+            source = std::make_unique<vision::FileFrameSource> (
+                path.string(), settings.width, settings.height,
+                config::number ("camera", "fps", 20.0), true);
+        } else {
+#if SIM_CAMERA_DISABLED
+            if (RobotBase::IsSimulation())
+                return;
 #endif
+            source = std::make_unique<vision::CameraFrameSource> (
+                config::string ("camera", "name", "Camera 1"),
+                config::integer ("camera", "device", 0),
+                settings.width, settings.height,
+                config::integer ("camera", "fps", 20));
+        }
+
+        // frames are allocated here, only when the camera is used.
+        camera = std::make_unique<vision::Pipeline> (settings);
+        camera->start (std::move (source), nullptr, [] (const vision::Frame& frame) {
+            frc::SmartDashboard::PutBoolean ("Vision/has_target", frame.hasTarget);
+            frc::SmartDashboard::PutNumber ("Vision/target_x", frame.targetX);
+            frc::SmartDashboard::PutNumber ("Vision/target_y", frame.targetY);
+            frc::SmartDashboard::PutNumber ("Vision/target_area", frame.targetArea);
+        });
     }
 };
 
@@ -576,4 +779,34 @@ frc::TimedRobot* instantiate_robot() {
     bot->RobotInit();
     return bot;
 }
+
+/** Run the rate groups due by `nowMs` like the robot's loop would, and
+    return the drive and shooter outputs they left.
+*/
+TelemetryFrame step_rate_groups (frc::TimedRobot* robot, double nowMs) {
+    auto& bot = *static_cast<RobotMain*> (robot);
+    bot.rates.runUntil (nowMs);
+    TelemetryFrame frame;
+    bot.drivetrain.writeTelemetry (frame);
+    bot.shooter.writeTelemetry (frame);
+    return frame;
+}
+
+/** Returns the robot's shooter with its flywheel physics running.
+    SimulationPeriodic() steps them.
+*/
+Shooter& simulated_shooter (frc::TimedRobot* robot) {
+    auto& bot = *static_cast<RobotMain*> (robot);
+    bot.shooter.initializeSimulation();
+    return bot.shooter;
+}
+
+/** Returns the robot's lifter with its arm physics running.
+    SimulationPeriodic() steps them.
+*/
+Lifter& simulated_lifter (frc::TimedRobot* robot) {
+    auto& bot = *static_cast<RobotMain*> (robot);
+    bot.lifter.initializeSimulation();
+    return bot.lifter;
+}
 #endif
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cmath>
+
+#include "config.hpp"
+#include "notedetector.hpp"
+#include "scripting.hpp"
+
+namespace detail {
+
+// the table at config.shooter[symbol], or nil
+static sol::object shooterTable (std::string_view symbol) {
+    sol::object obj = lua::config::get ("shooter", symbol);
+    return obj.is<sol::table>() ? obj : sol::object();
+}
+
+} // namespace detail
+
+//==============================================================================
+NoteDetector::Settings NoteDetector::Settings::fromConfig() {
+    Settings s;
+    s.timeout       = config::number ("shooter", "intake_time", s.timeout);
+    sol::object obj = detail::shooterTable ("note_detect");
+    if (! obj.is<sol::table>())
+        return s;
+
+    sol::table tbl   = obj;
+    s.enabled        = tbl.get_or ("enabled", s.enabled);
+    s.filterTime     = tbl.get_or ("filter_time", s.filterTime);
+    s.blankTime      = tbl.get_or ("blank_time", s.blankTime);
+    s.spikeCurrent   = tbl.get_or ("spike_current", s.spikeCurrent);
+    s.plateauTime    = tbl.get_or ("plateau_time", s.plateauTime);
+    s.minFreeCurrent = tbl.get_or ("min_free_current", s.minFreeCurrent);
+    s.maxFreeCurrent = std::max (s.minFreeCurrent, tbl.get_or ("max_free_current", s.maxFreeCurrent));
+    return s;
+}
+
+NoteDetector::NoteDetector (const Settings& s, double p) noexcept
+    : _settings (s),
+      period (std::max (1.0e-4, p)),
+      alpha (1.0 - std::exp (-period / std::max (1.0e-4, s.filterTime))) {
+    reset();
+}
+
+void NoteDetector::reset() noexcept {
+    _filtered       = _baseline = _elapsed = above = 0.0;
+    baselineSamples = _rejected = 0;
+    _detected       = false;
+    _baselineValid  = true;
+}
+
+bool NoteDetector::update (double amps) noexcept {
+    if (_detected)
+        return true;
+
+    // start the filter at the first sample rather than ramping from zero.
+    _filtered = _elapsed > 0.0 ? _filtered + alpha * (amps - _filtered) : amps;
+    _elapsed += period;
+
+    if (! _settings.enabled || _elapsed <= _settings.blankTime)
+        return false;
+
+    if (baselineSamples == 0) {
+        // out of range is a note already in, or a motor not running.
+        _baseline       = std::clamp (_filtered, _settings.minFreeCurrent, _settings.maxFreeCurrent);
+        _baselineValid  = _baseline == _filtered;
+        baselineSamples = 1;
+        return false;
+    }
+
+    if (_filtered > _baseline + _settings.spikeCurrent) {
+        above += period;
+        _detected = above >= _settings.plateauTime;
+        return _detected;
+    }
+
+    if (above > 0.0)
+        ++_rejected;
+    above = 0.0;
+
+    // track slow drift (battery sag, warming motors) while running free.
+    ++baselineSamples;
+    _baseline += (_filtered - _baseline) / static_cast<double> (std::min<int64_t> (baselineSamples, 50));
+    _baseline = std::clamp (_baseline, _settings.minFreeCurrent, _settings.maxFreeCurrent);
+    return false;
+}
+
+//==============================================================================
+double IntakeCurrentProfile::operator() (double seconds) const noexcept {
+    double amps = freeCurrent;
+    if (inrushTime > 0.0)
+        amps += (inrushCurrent - freeCurrent) * std::exp (-seconds / inrushTime);
+    if (noteTime >= 0.0 && seconds >= noteTime)
+        amps += noteCurrent;
+    return amps;
+}
+
+IntakeCurrentProfile IntakeCurrentProfile::fromConfig() {
+    IntakeCurrentProfile p;
+    sol::object obj = detail::shooterTable ("sim_intake");
+    if (! obj.is<sol::table>())
+        return p;
+
+    sol::table tbl  = obj;
+    p.freeCurrent   = tbl.get_or ("free_current", p.freeCurrent);
+    p.inrushCurrent = tbl.get_or ("inrush_current", p.inrushCurrent);
+    p.inrushTime    = tbl.get_or ("inrush_time", p.inrushTime);
+    p.noteTime      = tbl.get_or ("note_time", p.noteTime);
+    p.noteCurrent   = tbl.get_or ("note_current", p.noteCurrent);
+    return p;
+}
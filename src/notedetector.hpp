@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+
+/** Tells when a note is seated from intake motor current.
+
+    Running free the intake draws a steady current. A note being squeezed
+    into place loads the motors, so current jumps and stays up. The raw
+    current is low-pass filtered, the motor start inrush is ignored, and the
+    free running level is learned as a baseline, kept inside the range a
+    free running intake can draw so a note already in doesn't become the
+    baseline. A note is seated once the filtered current has stayed a margin
+    above the baseline for a plateau time. Shorter bumps are counted and
+    ignored. Intaking gives up after a timeout with no note.
+
+    Plain C++ with no allocation. Call update() once per tick while intaking.
+*/
+class NoteDetector final {
+public:
+    /** Detector tuning. see `config.shooter.note_detect` */
+    struct Settings {
+        bool enabled { true };
+        /** Low-pass filter time constant (seconds) */
+        double filterTime { 0.04 };
+        /** Time after starting to ignore while the motors spin up (seconds) */
+        double blankTime { 0.25 };
+        /** Amps above the baseline that count as loaded. */
+        double spikeCurrent { 6.0 };
+        /** How long current must stay up to be a note (seconds) */
+        double plateauTime { 0.12 };
+        /** Range of free running current the baseline is kept in (amps) */
+        double minFreeCurrent { 1.0 }, maxFreeCurrent { 14.0 };
+        /** Longest time to intake without a note, 0 for no limit (seconds).
+            `config.shooter.intake_time`
+        */
+        double timeout { 3.0 };
+
+        /** Returns settings read from `config.shooter.note_detect` */
+        static Settings fromConfig();
+    };
+
+    /** @param settings Detector tuning.
+        @param period Seconds between update() calls.
+    */
+    NoteDetector (const Settings& settings, double period) noexcept;
+
+    /** Start over. Call when the intake starts. */
+    void reset() noexcept;
+
+    /** Add a current sample in amps. Returns true once a note is seated, and
+        keeps returning true until reset. Only counts time when disabled.
+    */
+    bool update (double amps) noexcept;
+
+    /** Returns true if a note has been detected since the last reset. */
+    constexpr bool detected() const noexcept { return _detected; }
+
+    /** Returns true if the timeout passed with no note since the last reset. */
+    constexpr bool timedOut() const noexcept {
+        return ! _detected && _settings.timeout > 0.0 && _elapsed >= _settings.timeout;
+    }
+
+    /** Returns false if the first free running current was out of range and
+        the baseline started from the nearest limit instead.
+    */
+    constexpr bool baselineValid() const noexcept { return _baselineValid; }
+
+    /** Returns the filtered current. */
+    constexpr double filtered() const noexcept { return _filtered; }
+
+    /** Returns the learned free running current. */
+    constexpr double baseline() const noexcept { return _baseline; }
+
+    /** Returns seconds since reset. */
+    constexpr double elapsed() const noexcept { return _elapsed; }
+
+    /** Returns how many bumps were too short to be a note since reset. */
+    constexpr int64_t rejected() const noexcept { return _rejected; }
+
+    /** Returns the settings in use. */
+    const Settings& settings() const noexcept { return _settings; }
+
+private:
+    Settings _settings;
+    double period;
+    double alpha;
+
+    double _filtered { 0.0 }, _baseline { 0.0 }, _elapsed { 0.0 };
+    double above { 0.0 };
+    int64_t baselineSamples { 0 }, _rejected { 0 };
+    bool _detected { false };
+    bool _baselineValid { true };
+};
+
+//==============================================================================
+/** A made up intake current for the simulator and tests: a decaying start
+    inrush over a steady free current, then a step once the note arrives.
+    see `config.shooter.sim_intake`
+*/
+struct IntakeCurrentProfile {
+    double freeCurrent { 8.0 };
+    double inrushCurrent { 30.0 };
+    double inrushTime { 0.15 };
+    /** Seconds after starting that the note arrives, negative for never. */
+    double noteTime { 1.0 };
+    double noteCurrent { 16.0 };
+
+    /** Returns the current in amps at a time since the intake started. */
+    double operator() (double seconds) const noexcept;
+
+    /** Returns a profile read from `config.shooter.sim_intake` */
+    static IntakeCurrentProfile fromConfig();
+};
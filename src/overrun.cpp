@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "config.hpp"
+#include "overrun.hpp"
+
+OverrunManager::OverrunManager (clock::duration p, double margin)
+    : period (std::max (clock::duration (std::chrono::milliseconds (1)), p)),
+      budget (std::chrono::duration_cast<clock::duration> (period * std::clamp (margin, 0.0, 1.0))) {
+}
+
+OverrunManager OverrunManager::fromConfig() {
+    const auto period = std::chrono::duration<double, std::milli> (config::number ("engine", "period", 20.0));
+    return OverrunManager (std::chrono::duration_cast<clock::duration> (period),
+                           config::number ("overrun", "margin", 0.75));
+}
+
+void OverrunManager::beginTick (clock::time_point now) noexcept {
+    // a tick starting half a period late means something before it ran long,
+    // even if the last tick itself finished in time.
+    if (_ticks > 0 && ! lastOverran && now - tickStart > period + period / 2) {
+        lastOverran = true;
+        ++_overruns;
+    }
+
+    tickStart = now;
+    inTick    = true;
+}
+
+void OverrunManager::endTick (clock::time_point now) noexcept {
+    if (! inTick)
+        return;
+
+    const auto elapsed = now - tickStart + outside;
+    outside            = clock::duration::zero();
+    lastOverran        = elapsed > period;
+    inTick             = false;
+
+    ++_ticks;
+    if (lastOverran)
+        ++_overruns;
+    _longest = std::max (_longest, elapsed);
+}
+
+bool OverrunManager::shouldRun (Deferrable work, clock::time_point now) noexcept {
+    const bool nearDeadline = now - tickStart + outside >= budget;
+    if (lastOverran || nearDeadline) {
+        ++_shed[index (work)];
+        return false;
+    }
+    return true;
+}
+
+std::string_view OverrunManager::name (Deferrable work) noexcept {
+    switch (work) {
+        case Deferrable::Telemetry:
+            return "telemetry";
+        case Deferrable::Garbage:
+            return "gc";
+        case Deferrable::Dashboard:
+            return "dashboard";
+        case Deferrable::Logging:
+            return "logging";
+        case Deferrable::NumDeferrable:
+            break;
+    }
+    return "unknown";
+}
+
+void OverrunManager::report (std::ostream& out) const {
+    out << "[overrun] ticks=" << _ticks
+        << " overruns=" << _overruns
+        << std::fixed << std::setprecision (1)
+        << " longest=" << std::chrono::duration<double, std::micro> (_longest).count() << "us"
+        << " shed:";
+    for (int i = 0; i < NumDeferrable; ++i)
+        out << " " << name (static_cast<Deferrable> (i)) << "=" << _shed[i];
+    out << std::endl;
+}
+
+void OverrunManager::resetStats() noexcept {
+    _ticks = _overruns = 0;
+    _longest           = clock::duration::zero();
+    _shed.fill (0);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+
+/** Work that can be skipped when the main loop is short on time. */
+enum class Deferrable : int {
+    Telemetry, ///> Copying state for the telemetry thread.
+    Garbage,   ///> Lua garbage collector steps.
+    Dashboard, ///> Polling dashboard choosers.
+    Logging,   ///> Stats and other console output.
+    NumDeferrable
+};
+
+/** Decides when to shed deferrable work.
+
+    The main loop marks the start and end of each tick. Work the main thread
+    does between ticks, e.g. rate groups, is added with addWork() and counts
+    toward the next tick to end. A tick overruns when it and that work take
+    longer than the period, or it starts so late that the one before must
+    have. After an overrun, and whenever the current tick is past a
+    margin of its period, deferrable work is shed until a tick finishes on
+    time. Critical work (drive output, shooter, commands) never asks and
+    always runs.
+
+    Everything here runs on the main thread. Nothing locks or allocates.
+*/
+class OverrunManager final {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr int NumDeferrable = static_cast<int> (Deferrable::NumDeferrable);
+
+    /** @param period The main loop period.
+        @param margin Fraction of the period after which deferrable work is
+                      shed, e.g. 0.75
+    */
+    OverrunManager (clock::duration period, double margin);
+
+    /** Returns a manager using the engine period and `config.overrun` */
+    static OverrunManager fromConfig();
+
+    /** Call at the start of every main loop tick. */
+    void beginTick (clock::time_point now = clock::now()) noexcept;
+
+    /** Call at the end of every main loop tick. */
+    void endTick (clock::time_point now = clock::now()) noexcept;
+
+    /** Count time the main thread spent outside the tick, e.g. in a rate
+        group, toward the tick in progress or the next one.
+    */
+    void addWork (clock::duration elapsed) noexcept { outside += elapsed; }
+
+    /** Returns true if deferrable work may run now. Counts a shed event for
+        the category when it may not.
+    */
+    bool shouldRun (Deferrable work, clock::time_point now = clock::now()) noexcept;
+
+    /** Returns true if the last finished tick overran. */
+    bool overran() const noexcept { return lastOverran; }
+
+    /** Returns the number of ticks, overruns and the longest tick. */
+    int64_t ticks() const noexcept { return _ticks; }
+    int64_t overruns() const noexcept { return _overruns; }
+    clock::duration longest() const noexcept { return _longest; }
+
+    /** Returns how many times a category was shed. */
+    int64_t shed (Deferrable work) const noexcept { return _shed[index (work)]; }
+
+    /** Returns a category's name e.g. "telemetry" */
+    static std::string_view name (Deferrable work) noexcept;
+
+    /** Write counters to a stream. */
+    void report (std::ostream& out) const;
+
+    /** Reset counters. The overrun state is kept. */
+    void resetStats() noexcept;
+
+private:
+    clock::duration period;
+    clock::duration budget;
+
+    clock::time_point tickStart {};
+    clock::duration outside { clock::duration::zero() };
+    bool inTick { false };
+    bool lastOverran { false };
+
+    int64_t _ticks { 0 }, _overruns { 0 };
+    clock::duration _longest { clock::duration::zero() };
+    std::array<int64_t, NumDeferrable> _shed {};
+
+    static constexpr int index (Deferrable work) noexcept { return static_cast<int> (work); }
+};
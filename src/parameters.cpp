@@ -12,6 +12,38 @@
 void Parameters::reset() noexcept {
     values.reset();
     lastValues.reset();
+    clearEvents();
+}
+
+void Parameters::addEvent (Event::Type type, int index, double value) noexcept {
+    if (_numEvents >= MaxEvents) {
+        ++_droppedEvents;
+        return;
+    }
+    events[_numEvents++] = { type, index, value };
+}
+
+// queue an event for every edge between the last and current values.
+void Parameters::detectEvents() noexcept {
+    for (int i = 0; i < MaxButtons; ++i) {
+        if (values.buttons[i] != lastValues.buttons[i])
+            addEvent (values.buttons[i] ? Event::ButtonDown : Event::ButtonUp, i, values.buttons[i] ? 1.0 : 0.0);
+    }
+
+    for (int i = 0; i < MaxPOVs; ++i) {
+        if (values.povs[i] != lastValues.povs[i])
+            addEvent (Event::POV, i, values.povs[i]);
+    }
+
+    for (int i = 0; i < MaxAxes; ++i) {
+        const auto threshold = axisThresholds[i];
+        if (threshold <= 0.0)
+            continue;
+        const bool above    = std::abs (values.axis[i]) >= threshold;
+        const bool wasAbove = std::abs (lastValues.axis[i]) >= threshold;
+        if (above != wasAbove)
+            addEvent (above ? Event::AxisAbove : Event::AxisBelow, i, values.axis[i]);
+    }
 }
 
 void Parameters::process (const Context& context) noexcept {
@@ -35,6 +67,8 @@ void Parameters::process (const Context& context) noexcept {
             std::clog << "[bot] dpad #" << i << " = " << values.povs[i] << std::endl;
 #endif
 
+    detectEvents();
+
     // Save the context in the previous one for change detection and future
     // interpolations...
     lastValues = values;
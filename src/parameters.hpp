@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+#include <cstdint>
 #include <cstring> // for memcpy, memset
 
 #include "snider/padmode.hpp"
@@ -47,7 +49,8 @@ public:
     enum : int {
         MaxAxes    = 32, ///> Max number of axes supported.
         MaxPOVs    = 1,  ///> Max number of dpads supported.
-        MaxButtons = 16  ///> Max number of buttons supported.
+        MaxButtons = 16, ///> Max number of buttons supported.
+        MaxEvents  = 64  ///> Max number of events queued between clears.
     };
 
     enum Indexes : int {
@@ -116,9 +119,50 @@ public:
         }
     };
 
+    /** An input edge found by process(). */
+    struct Event {
+        enum Type : int {
+            ButtonDown, ///> A button was pressed. value is 1
+            ButtonUp,   ///> A button was released. value is 0
+            POV,        ///> A dpad changed. value is the angle or -1
+            AxisAbove,  ///> An axis magnitude rose to its threshold. value is the axis value
+            AxisBelow   ///> An axis magnitude fell below its threshold. value is the axis value
+        };
+
+        Type type { ButtonDown };
+        int index { 0 }; ///> Button, dpad or axis index
+        double value { 0.0 };
+    };
+
     /** Reset all values to default. */
     void reset() noexcept;
 
+    /** Returns the number of events queued since the last clearEvents() */
+    int numEvents() const noexcept { return _numEvents; }
+
+    /** Returns a queued event. */
+    const Event& getEvent (int index) const noexcept { return events[index]; }
+
+    /** Clear queued events. Call after dispatching them. */
+    void clearEvents() noexcept { _numEvents = 0; }
+
+    /** Returns the number of events lost because the queue was full. */
+    int64_t droppedEvents() const noexcept { return _droppedEvents; }
+
+    /** Report AxisAbove/AxisBelow events when an axis magnitude crosses a
+        threshold. 0 to stop reporting.
+    */
+    void setAxisThreshold (int axis, double threshold) noexcept {
+        if (axis >= 0 && axis < MaxAxes)
+            axisThresholds[axis] = std::abs (threshold);
+    }
+
+    /** Stop reporting axis events on every axis. */
+    void clearAxisThresholds() noexcept {
+        for (auto& t : axisThresholds)
+            t = 0.0;
+    }
+
     /** Returns the current gamepad mode. */
     constexpr auto getPadMode() const noexcept { return padMode; }
 
@@ -256,4 +300,12 @@ private:
     Context values;
     Context lastValues;
     PadMode padMode { PadMode::Standard };
+
+    Event events[MaxEvents];
+    int _numEvents { 0 };
+    int64_t _droppedEvents { 0 };
+    double axisThresholds[MaxAxes] = { 0 };
+
+    void addEvent (Event::Type type, int index, double value) noexcept;
+    void detectEvents() noexcept;
 };
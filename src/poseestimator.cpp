@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "poseestimator.hpp"
+#include "scripting.hpp"
+
+namespace detail {
+
+static void readStdDevs (sol::object obj, std::array<double, 3>& out) {
+    if (! obj.is<sol::table>())
+        return;
+    sol::table tbl = obj;
+    for (int i = 0; i < 3; ++i)
+        out[i] = std::max (1.0e-6, tbl.get_or (i + 1, out[i]));
+}
+
+static wpi::array<double, 3> toWpi (const std::array<double, 3>& a) {
+    return { a[0], a[1], a[2] };
+}
+
+} // namespace detail
+
+PoseEstimator::Settings PoseEstimator::Settings::fromConfig() {
+    Settings s;
+    detail::readStdDevs (lua::config::get ("vision", "state_std_devs"), s.stateStdDevs);
+    detail::readStdDevs (lua::config::get ("vision", "measurement_std_devs"), s.measurementStdDevs);
+    sol::object age = lua::config::get ("vision", "max_age");
+    if (age.is<double>())
+        s.maxAge = units::millisecond_t (age.as<double>());
+    return s;
+}
+
+PoseEstimator::PoseEstimator (frc::DifferentialDriveKinematics& kinematics,
+                              const frc::Rotation2d& heading,
+                              units::meter_t leftDistance,
+                              units::meter_t rightDistance,
+                              const frc::Pose2d& initialPose,
+                              const Settings& s)
+    : settings (s),
+      estimator (kinematics, heading, leftDistance, rightDistance, initialPose,
+                 detail::toWpi (s.stateStdDevs),
+                 detail::toWpi (s.measurementStdDevs)) {}
+
+bool PoseEstimator::submit (const VisionMeasurement& measurement) noexcept {
+    if (queue.push (measurement))
+        return true;
+    _dropped.fetch_add (1, std::memory_order_relaxed);
+    return false;
+}
+
+frc::Pose2d PoseEstimator::update (units::second_t now,
+                                   const frc::Rotation2d& heading,
+                                   units::meter_t leftDistance,
+                                   units::meter_t rightDistance) {
+    estimator.UpdateWithTime (now, heading, leftDistance, rightDistance);
+
+    VisionMeasurement m;
+    while (queue.pop (m))
+        apply (m, now);
+
+    return estimator.GetEstimatedPosition();
+}
+
+void PoseEstimator::reset (const frc::Rotation2d& heading,
+                           units::meter_t leftDistance,
+                           units::meter_t rightDistance,
+                           const frc::Pose2d& pose) {
+    VisionMeasurement m;
+    while (queue.pop (m)) {
+    }
+    estimator.ResetPosition (heading, leftDistance, rightDistance, pose);
+}
+
+void PoseEstimator::apply (const VisionMeasurement& m, units::second_t now) {
+    // the estimator silently ignores measurements older than its history, so
+    // count them here. Anything from the future is a clock mixup.
+    if (m.timestamp > now || now - m.timestamp > settings.maxAge) {
+        ++_rejected;
+        return;
+    }
+
+    auto stdDevs = m.stdDevs;
+    for (int i = 0; i < 3; ++i)
+        if (stdDevs[i] <= 0.0)
+            stdDevs[i] = settings.measurementStdDevs[i];
+
+    snider::AtomicTimingStats::Scope timed (_cost);
+    estimator.AddVisionMeasurement (m.pose, m.timestamp, detail::toWpi (stdDevs));
+    ++_applied;
+}
+
+void PoseEstimator::report (std::ostream& out) const {
+    out << "[vision] measurements: applied=" << applied()
+        << " rejected=" << rejected()
+        << " dropped=" << dropped()
+        << std::fixed << std::setprecision (1)
+        << " cost avg=" << _cost.averageMicros() << "us"
+        << " max=" << _cost.maxMicros() << "us"
+        << std::endl;
+}
+
+void PoseEstimator::resetStats() noexcept {
+    _applied.store (0, std::memory_order_relaxed);
+    _rejected.store (0, std::memory_order_relaxed);
+    _dropped.store (0, std::memory_order_relaxed);
+    _cost.reset();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+
+#include <frc/estimator/DifferentialDrivePoseEstimator.h>
+#include <frc/geometry/Pose2d.h>
+#include <frc/kinematics/DifferentialDriveKinematics.h>
+#include <units/length.h>
+#include <units/time.h>
+
+#include "snider/spscqueue.hpp"
+#include "snider/timingstats.hpp"
+
+/** A field pose measured by something other than the wheels, e.g. a camera.
+
+    Plain data so it can be passed through a lock-free queue.
+*/
+struct VisionMeasurement {
+    /** FPGA time the measurement was taken, not when it arrived. */
+    units::second_t timestamp { 0.0 };
+    /** The measured pose. */
+    frc::Pose2d pose;
+    /** Standard deviations (x m, y m, heading rad). Zeros use the configured
+        default. */
+    std::array<double, 3> stdDevs { 0.0, 0.0, 0.0 };
+};
+
+/** Fuses wheel odometry with asynchronous, latency delayed measurements.
+
+    Built on frc::DifferentialDrivePoseEstimator which keeps its own odometry
+    history and replays it from the time of each measurement. Measurements can
+    be submitted from one other thread without locking, they are applied on
+    the next update().
+*/
+class PoseEstimator final {
+public:
+    /** Queue of measurements waiting to be applied. */
+    using Queue = snider::SpscQueue<VisionMeasurement, 32>;
+
+    /** Estimator tuning. see `config.vision` */
+    struct Settings {
+        /** Trust in the wheel odometry (x m, y m, heading rad) */
+        std::array<double, 3> stateStdDevs { 0.02, 0.02, 0.01 };
+        /** Default trust in measurements (x m, y m, heading rad) */
+        std::array<double, 3> measurementStdDevs { 0.3, 0.3, 0.5 };
+        /** Measurements older than this are rejected. */
+        units::second_t maxAge { 1.0 };
+
+        /** Returns settings read from `config.vision` */
+        static Settings fromConfig();
+    };
+
+    PoseEstimator (frc::DifferentialDriveKinematics& kinematics,
+                   const frc::Rotation2d& heading,
+                   units::meter_t leftDistance,
+                   units::meter_t rightDistance,
+                   const frc::Pose2d& initialPose = {},
+                   const Settings& settings       = Settings::fromConfig());
+    ~PoseEstimator() = default;
+
+    /** Queue a measurement. Safe to call from a single thread other than the
+        one calling update(). Returns false if the queue is full.
+    */
+    bool submit (const VisionMeasurement& measurement) noexcept;
+
+    /** Update with new wheel distances then apply queued measurements.
+        Returns the new estimate.
+    */
+    frc::Pose2d update (units::second_t now,
+                        const frc::Rotation2d& heading,
+                        units::meter_t leftDistance,
+                        units::meter_t rightDistance);
+
+    /** Reset the estimate to a known pose. Queued measurements are dropped. */
+    void reset (const frc::Rotation2d& heading,
+                units::meter_t leftDistance,
+                units::meter_t rightDistance,
+                const frc::Pose2d& pose);
+
+    /** Returns the current estimate. */
+    frc::Pose2d pose() const { return estimator.GetEstimatedPosition(); }
+
+    /** Returns the number of measurements applied. */
+    int64_t applied() const noexcept { return _applied.load (std::memory_order_relaxed); }
+
+    /** Returns the number of measurements rejected for being too old or from
+        the future. */
+    int64_t rejected() const noexcept { return _rejected.load (std::memory_order_relaxed); }
+
+    /** Returns the number of measurements dropped because the queue was full. */
+    int64_t dropped() const noexcept { return _dropped.load (std::memory_order_relaxed); }
+
+    /** Returns the time spent applying each measurement. Safe to read while
+        the odometry thread applies. */
+    const snider::AtomicTimingStats& cost() const noexcept { return _cost; }
+
+    /** Write measurement counts and cost to a stream. */
+    void report (std::ostream& out) const;
+
+    /** Reset counts and cost. */
+    void resetStats() noexcept;
+
+private:
+    Settings settings;
+    frc::DifferentialDrivePoseEstimator estimator;
+    Queue queue;
+    std::atomic<int64_t> _applied { 0 }, _rejected { 0 }, _dropped { 0 };
+    snider::AtomicTimingStats _cost;
+
+    void apply (const VisionMeasurement& m, units::second_t now);
+};
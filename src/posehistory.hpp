@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+
+#include <frc/geometry/Pose2d.h>
+#include <units/time.h>
+
+/** A fixed size history of timestamped poses.
+
+    Written by the odometry notifier, read from the main loop. Samples live in
+    a ring buffer so adding never allocates; the oldest sample is dropped once
+    full. The lock is only held long enough to copy a few poses.
+
+    @tparam Capacity Number of samples kept.
+*/
+template <std::size_t Capacity>
+class PoseHistory final {
+public:
+    static_assert (Capacity >= 2, "PoseHistory needs at least two samples");
+
+    PoseHistory()  = default;
+    ~PoseHistory() = default;
+
+    /** A pose and the time it was measured. */
+    struct Sample {
+        units::second_t timestamp { 0.0 };
+        frc::Pose2d pose;
+    };
+
+    /** Add a sample. Samples older than the newest one are ignored. */
+    void add (units::second_t timestamp, const frc::Pose2d& pose) {
+        std::lock_guard<std::mutex> sl (lock);
+        if (count > 0 && timestamp < at (count - 1).timestamp)
+            return;
+
+        samples[(head + count) % Capacity] = { timestamp, pose };
+        if (count < Capacity)
+            ++count;
+        else
+            head = (head + 1) % Capacity;
+    }
+
+    /** Remove all samples. */
+    void clear() {
+        std::lock_guard<std::mutex> sl (lock);
+        head = count = 0;
+    }
+
+    /** Returns the number of samples held. */
+    std::size_t size() const {
+        std::lock_guard<std::mutex> sl (lock);
+        return count;
+    }
+
+    /** Returns the maximum number of samples held. */
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+    /** Returns the newest sample if there is one. */
+    std::optional<Sample> latest() const {
+        std::lock_guard<std::mutex> sl (lock);
+        if (count == 0)
+            return std::nullopt;
+        return at (count - 1);
+    }
+
+    /** Returns the pose at a point in time, interpolated between the two
+        samples either side of it. Times outside the history are clamped to
+        the oldest or newest sample. Returns nothing when empty.
+    */
+    std::optional<frc::Pose2d> poseAt (units::second_t timestamp) const {
+        std::lock_guard<std::mutex> sl (lock);
+        if (count == 0)
+            return std::nullopt;
+        if (timestamp <= at (0).timestamp)
+            return at (0).pose;
+        if (timestamp >= at (count - 1).timestamp)
+            return at (count - 1).pose;
+
+        // binary search for the first sample newer than the timestamp.
+        std::size_t lo = 1, hi = count - 1;
+        while (lo < hi) {
+            const auto mid = (lo + hi) / 2;
+            if (at (mid).timestamp <= timestamp)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        const auto& a  = at (lo - 1);
+        const auto& b  = at (lo);
+        const auto dt  = b.timestamp - a.timestamp;
+        const double t = dt > 0_s ? (timestamp - a.timestamp) / dt : 1.0;
+        return a.pose.Exp (a.pose.Log (b.pose) * t);
+    }
+
+private:
+    mutable std::mutex lock;
+    std::array<Sample, Capacity> samples {};
+    std::size_t head { 0 }, count { 0 };
+
+    // sample by age, 0 being the oldest.
+    const Sample& at (std::size_t index) const noexcept {
+        return samples[(head + index) % Capacity];
+    }
+};
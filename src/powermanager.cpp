@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+#include "config.hpp"
+#include "powermanager.hpp"
+#include "scripting.hpp"
+
+//==============================================================================
+PowerManager::Settings PowerManager::Settings::fromConfig() {
+    Settings s;
+    s.enabled     = config::boolean ("power", "enabled", s.enabled);
+    s.minVoltage  = config::number ("power", "min_voltage", s.minVoltage);
+    s.resistance  = std::max (1.0e-4, config::number ("power", "resistance", s.resistance));
+    s.minBudget   = config::number ("power", "min_budget", s.minBudget);
+    s.maxBudget   = std::max (s.minBudget, config::number ("power", "max_budget", s.maxBudget));
+    s.filterTime  = config::number ("power", "filter_time", s.filterTime);
+    s.recoverRate = config::number ("power", "recover_rate", s.recoverRate);
+    s.minScale    = std::clamp (config::number ("power", "min_scale", s.minScale), 0.0, 1.0);
+
+    for (int i = 0; i < NumConsumers; ++i) {
+        sol::object obj = lua::config::get ("power", name (static_cast<Consumer> (i)));
+        if (! obj.is<sol::table>())
+            continue;
+        sol::table tbl         = obj;
+        s.shares[i].priority   = tbl.get_or ("priority", s.shares[i].priority);
+        s.shares[i].minCurrent = tbl.get_or ("min_current", s.shares[i].minCurrent);
+    }
+
+    return s;
+}
+
+//==============================================================================
+PowerManager::PowerManager (const Settings& s)
+    : _settings (s) {
+    std::iota (order.begin(), order.end(), 0);
+    std::stable_sort (order.begin(), order.end(), [this] (int a, int b) {
+        return _settings.shares[a].priority < _settings.shares[b].priority;
+    });
+    scales.fill (1.0);
+    allocations.fill (_settings.maxBudget);
+    _budget = _settings.maxBudget;
+}
+
+void PowerManager::update (double volts, double totalAmps,
+                           const std::array<double, NumConsumers>& drawn,
+                           double dt) noexcept {
+    if (! _settings.enabled)
+        return;
+
+    const double managed = std::accumulate (drawn.begin(), drawn.end(), 0.0);
+    const double total   = totalAmps >= 0.0 ? std::max (totalAmps, managed) : managed;
+
+    // open circuit voltage is the bus voltage plus the drop across the
+    // battery. the budget is the current that drops it to the minimum.
+    const double openCircuit = volts + total * _settings.resistance;
+    const double target      = std::clamp ((openCircuit - _settings.minVoltage) / _settings.resistance,
+                                      _settings.minBudget,
+                                      _settings.maxBudget);
+    const double alpha       = _settings.filterTime > 0.0 ? 1.0 - std::exp (-dt / _settings.filterTime) : 1.0;
+    // budgets only drop at once, they grow through the filter.
+    _budget = ! primed || target < _budget ? target : _budget + alpha * (target - _budget);
+    primed  = true;
+
+    // minimums first, then by priority up to what each is drawing. current
+    // that isn't ours to manage comes off the top. a minimum always stands,
+    // but only the part in use is taken from the others.
+    double remaining = _budget - (total - managed);
+    for (int i = 0; i < NumConsumers; ++i) {
+        allocations[i] = std::min (_settings.shares[i].minCurrent, drawn[i]);
+        remaining -= allocations[i];
+    }
+    for (int i : order) {
+        const double extra = std::clamp (drawn[i] - allocations[i], 0.0, std::max (0.0, remaining));
+        allocations[i] = std::max (allocations[i] + extra, _settings.shares[i].minCurrent);
+        remaining -= extra;
+    }
+    // anything left over is headroom for whoever asks first.
+    for (int i : order) {
+        allocations[i] += std::max (0.0, remaining);
+        remaining = 0.0;
+    }
+
+    for (int i = 0; i < NumConsumers; ++i) {
+        if (drawn[i] > allocations[i] && drawn[i] > 0.0) {
+            // drawing at this scale, so scale down in proportion.
+            scales[i] = std::max (_settings.minScale, scales[i] * allocations[i] / drawn[i]);
+            ++limited[i];
+        } else {
+            scales[i] = std::min (1.0, scales[i] + _settings.recoverRate * dt);
+        }
+    }
+
+    ++ticks;
+    budgetSum += _budget;
+    _lowestVoltage = std::min (_lowestVoltage, volts);
+}
+
+void PowerManager::report (std::ostream& out) const {
+    out << "[power] " << std::fixed << std::setprecision (1)
+        << "budget avg=" << (ticks > 0 ? budgetSum / ticks : 0.0) << "A"
+        << " lowest=" << (ticks > 0 ? _lowestVoltage : 0.0) << "V"
+        << " limited:";
+    for (int i = 0; i < NumConsumers; ++i)
+        out << " " << name (static_cast<Consumer> (i)) << "="
+            << (ticks > 0 ? 100.0 * limited[i] / ticks : 0.0) << "%";
+    out << std::endl;
+}
+
+void PowerManager::resetStats() noexcept {
+    ticks = 0;
+    limited.fill (0);
+    budgetSum      = 0.0;
+    _lowestVoltage = 1.0e9;
+}
+
+std::string_view PowerManager::name (Consumer c) noexcept {
+    switch (c) {
+        case Consumer::Drivetrain:
+            return "drivetrain";
+        case Consumer::Shooter:
+            return "shooter";
+        case Consumer::Lifter:
+            return "lifter";
+        case Consumer::NumConsumers:
+            break;
+    }
+    return "";
+}
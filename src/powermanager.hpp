@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+
+/** Subsystems that share the battery. */
+enum class Consumer : int {
+    Drivetrain,
+    Shooter,
+    Lifter,
+    NumConsumers
+};
+
+/** Shares battery current between subsystems so the bus stays up.
+
+    Each tick the battery's open circuit voltage is estimated from the bus
+    voltage and total current, which gives the most current that can be
+    drawn without the bus falling under `min_voltage`. That budget is handed
+    out by priority: every subsystem is guaranteed its minimum, then the
+    rest goes in priority order up to what each is drawing.
+
+    A subsystem drawing more than its share has its output scaled down at
+    once, in proportion. Scales recover slowly once there's room again, so
+    limiting doesn't oscillate. Subsystems multiply their output voltages by
+    their scale. Scaling happens here rather than through controller current
+    limits, which are slow CAN writes and only work on brushless motors.
+
+    Everything here runs on the main thread. Nothing locks or allocates.
+*/
+class PowerManager final {
+public:
+    static constexpr int NumConsumers = static_cast<int> (Consumer::NumConsumers);
+
+    /** see `config.power` */
+    struct Settings {
+        bool enabled { true };
+        /** Bus voltage to stay above (volts) */
+        double minVoltage { 8.0 };
+        /** Battery and wiring resistance (ohms) */
+        double resistance { 0.02 };
+        /** Budget bounds (amps) */
+        double minBudget { 60.0 }, maxBudget { 400.0 };
+        /** Budget low-pass time constant (seconds) */
+        double filterTime { 0.1 };
+        /** How fast scales recover (per second) and the lowest they go. */
+        double recoverRate { 1.0 }, minScale { 0.25 };
+
+        struct Share {
+            int priority { 1 };       ///> lower goes first.
+            double minCurrent { 20 }; ///> amps always allowed.
+        };
+        std::array<Share, NumConsumers> shares { { { 1, 60.0 }, { 3, 20.0 }, { 2, 20.0 } } };
+
+        /** Returns settings read from `config.power` */
+        static Settings fromConfig();
+    };
+
+    explicit PowerManager (const Settings& settings);
+
+    /** Run once per tick.
+        @param volts Bus voltage.
+        @param totalAmps Current out of the battery, including anything not
+                         managed here. Negative to use the sum of `drawn`.
+        @param drawn Current drawn by each consumer (amps)
+        @param dt Seconds since the last update.
+    */
+    void update (double volts, double totalAmps,
+                 const std::array<double, NumConsumers>& drawn,
+                 double dt) noexcept;
+
+    /** Returns the factor a consumer should scale its output by, 0 to 1. */
+    double scale (Consumer c) const noexcept { return scales[index (c)]; }
+
+    /** Returns the current a consumer may draw (amps) */
+    double allocation (Consumer c) const noexcept { return allocations[index (c)]; }
+
+    /** Returns the current budget (amps) */
+    constexpr double budget() const noexcept { return _budget; }
+
+    /** Returns the settings in use. */
+    const Settings& settings() const noexcept { return _settings; }
+
+    /** Returns the lowest bus voltage seen since the stats were reset. */
+    constexpr double lowestVoltage() const noexcept { return _lowestVoltage; }
+
+    /** Returns ticks a consumer was scaled down since the stats were reset. */
+    int64_t limitedTicks (Consumer c) const noexcept { return limited[index (c)]; }
+
+    /** Write budget and limiting stats to a stream. */
+    void report (std::ostream& out) const;
+
+    /** Reset stats. */
+    void resetStats() noexcept;
+
+    /** Returns the name of a consumer e.g. "drivetrain" */
+    static std::string_view name (Consumer c) noexcept;
+
+private:
+    Settings _settings;
+    std::array<int, NumConsumers> order {};
+    std::array<double, NumConsumers> scales {}, allocations {};
+    double _budget { 0.0 };
+    bool primed { false };
+
+    int64_t ticks { 0 };
+    std::array<int64_t, NumConsumers> limited {};
+    double _lowestVoltage { 1.0e9 }, budgetSum { 0.0 };
+
+    static constexpr int index (Consumer c) noexcept { return static_cast<int> (c); }
+};
@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "config.hpp"
+#include "profiler.hpp"
+
+extern "C" {
+#include "lua.h"
+#include "luajit.h"
+}
+
+namespace lua {
+namespace detail {
+
+static constexpr char vmstateNames[] = "NICGJ";
+
+static int vmstateIndex (int vmstate) noexcept {
+    const char* at = std::strchr (vmstateNames, vmstate);
+    return at != nullptr && vmstate != 0 ? static_cast<int> (at - vmstateNames) : -1;
+}
+
+// a leaf frame for time not spent running Lua.
+static std::string_view vmstateLeaf (int vmstate) noexcept {
+    switch (vmstate) {
+        case 'C': return ";[C]";
+        case 'G': return ";[GC]";
+        case 'J': return ";[JIT]";
+        default: break;
+    }
+    return {};
+}
+
+static uint64_t fnv1a (std::string_view text, uint64_t hash = 14695981039346656037ull) noexcept {
+    for (const char c : text) {
+        hash ^= static_cast<unsigned char> (c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// the only VM being profiled, LuaJIT's profiler is process wide.
+static Profiler* active { nullptr };
+
+} // namespace detail
+
+//==============================================================================
+Profiler::Settings Profiler::Settings::fromConfig() {
+    Settings s;
+    s.enabled  = config::boolean ("profiler", "enabled", s.enabled);
+    s.interval = std::max (1, config::integer ("profiler", "interval", s.interval));
+    s.depth    = std::clamp (config::integer ("profiler", "depth", s.depth), 1, 256);
+    s.slots    = std::max (16, config::integer ("profiler", "slots", s.slots));
+    s.arena    = std::max (4096, config::integer ("profiler", "arena", s.arena));
+    s.output   = config::string ("profiler", "output", s.output);
+    return s;
+}
+
+//==============================================================================
+Profiler::Profiler (const Settings& s)
+    : _settings (s) {
+    uint32_t size = 16;
+    while (size < static_cast<uint32_t> (std::max (16, _settings.slots)))
+        size <<= 1;
+    slots = std::make_unique<Slot[]> (size);
+    mask  = size - 1;
+    arena = std::make_unique<char[]> (static_cast<std::size_t> (std::max (0, _settings.arena)));
+}
+
+Profiler::~Profiler() { stop(); }
+
+bool Profiler::start (lua_State* L) {
+    if (L == nullptr || running() || detail::active != nullptr)
+        return false;
+
+    clear();
+    const std::string mode = "fi" + std::to_string (_settings.interval);
+    state                  = L;
+    detail::active         = this;
+    luaJIT_profile_start (L, mode.c_str(), &Profiler::sample, this);
+    return true;
+}
+
+void Profiler::stop() {
+    if (! running())
+        return;
+    luaJIT_profile_stop (state);
+    state          = nullptr;
+    detail::active = nullptr;
+}
+
+void Profiler::clear() noexcept {
+    std::fill (slots.get(), slots.get() + mask + 1, Slot {});
+    arenaUsed = 0;
+    _samples = _dropped = 0;
+    _stacks             = 0;
+    std::fill (std::begin (vmstates), std::end (vmstates), 0);
+}
+
+void Profiler::sample (void* data, lua_State* L, int samples, int vmstate) {
+    auto* self        = static_cast<Profiler*> (data);
+    std::size_t len   = 0;
+    // root first, separators only between frames.
+    const char* stack = luaJIT_profile_dumpstack (L, "FZ;", -self->_settings.depth, &len);
+    self->record (std::string_view (stack, len), samples, vmstate);
+}
+
+void Profiler::record (std::string_view stack, int samples, int vmstate) noexcept {
+    _samples += samples;
+    if (const int index = detail::vmstateIndex (vmstate); index >= 0)
+        vmstates[index] += samples;
+
+    const auto leaf   = detail::vmstateLeaf (vmstate);
+    const auto length = stack.size() + leaf.size();
+    uint64_t hash     = detail::fnv1a (leaf, detail::fnv1a (stack));
+    if (hash == 0)
+        hash = 1;
+
+    // open addressing, linear probing. a full table drops the sample.
+    for (uint32_t probe = 0, i = static_cast<uint32_t> (hash) & mask; probe <= mask; ++probe, i = (i + 1) & mask) {
+        auto& slot = slots[i];
+        if (slot.hash == hash && slot.length == length
+            && std::memcmp (arena.get() + slot.offset, stack.data(), stack.size()) == 0
+            && std::memcmp (arena.get() + slot.offset + stack.size(), leaf.data(), leaf.size()) == 0) {
+            slot.count += samples;
+            return;
+        }
+
+        if (slot.hash == 0) {
+            if (arenaUsed + length > static_cast<std::size_t> (_settings.arena))
+                break;
+            std::memcpy (arena.get() + arenaUsed, stack.data(), stack.size());
+            std::memcpy (arena.get() + arenaUsed + stack.size(), leaf.data(), leaf.size());
+            slot.hash   = hash;
+            slot.offset = static_cast<uint32_t> (arenaUsed);
+            slot.length = static_cast<uint32_t> (length);
+            slot.count  = samples;
+            arenaUsed += length;
+            ++_stacks;
+            return;
+        }
+    }
+
+    _dropped += samples;
+}
+
+void Profiler::write (std::ostream& out) const {
+    std::vector<const Slot*> used;
+    used.reserve (static_cast<std::size_t> (_stacks));
+    for (uint32_t i = 0; i <= mask; ++i)
+        if (slots[i].hash != 0)
+            used.push_back (&slots[i]);
+    auto text = [this] (const Slot* slot) { return std::string_view (arena.get() + slot->offset, slot->length); };
+    std::sort (used.begin(), used.end(), [&] (const Slot* a, const Slot* b) {
+        return a->count != b->count ? a->count > b->count : text (a) < text (b);
+    });
+
+    for (const auto* slot : used) {
+        // a sample in a C function called from C has no Lua frames.
+        const auto stack = text (slot);
+        if (stack.empty() || stack.front() == ';')
+            out << "[vm]";
+        out << stack << ' ' << slot->count << '\n';
+    }
+}
+
+bool Profiler::save (const std::string& path) const {
+    std::ofstream out (path, std::ios::trunc);
+    if (! out)
+        return false;
+    write (out);
+    return static_cast<bool> (out);
+}
+
+int64_t Profiler::samplesIn (int vmstate) const noexcept {
+    const int index = detail::vmstateIndex (vmstate);
+    return index >= 0 ? vmstates[index] : 0;
+}
+
+void Profiler::report (std::ostream& out) const {
+    out << "[profile] samples=" << _samples << " stacks=" << _stacks << " dropped=" << _dropped;
+    if (_samples > 0) {
+        out << std::fixed << std::setprecision (1);
+        for (int i = 0; i < 5; ++i)
+            out << " " << detail::vmstateNames[i] << "=" << 100.0 * vmstates[i] / _samples << "%";
+        out << std::defaultfloat;
+    }
+    out << std::endl;
+}
+
+} // namespace lua
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+
+struct lua_State;
+
+namespace lua {
+
+/** Samples where bot Lua code spends its time.
+
+    Uses LuaJIT's built in profiler: a timer interrupts the VM every
+    `interval` ms and the stack at that point, root first, is counted in a
+    fixed size hash table. Stack text lives in an arena reserved up front,
+    so sampling never allocates. Stacks that don't fit are counted as
+    dropped. GC, JIT compiler and C function samples get a leaf frame of
+    their own so they show up in a flamegraph.
+
+    Writes folded stacks, one "frame;frame;frame count" per line, which
+    flamegraph.pl and speedscope read. LuaJIT profiles one VM at a time.
+    see `config.profiler`
+*/
+class Profiler final {
+public:
+    /** see `config.profiler` */
+    struct Settings {
+        /** Profile test mode programs. */
+        bool enabled { false };
+        /** Sample interval (milliseconds) */
+        int interval { 1 };
+        /** Deepest stack recorded, frames past it are left off the root end. */
+        int depth { 32 };
+        /** Distinct stacks kept, rounded up to a power of 2. */
+        int slots { 4096 };
+        /** Bytes reserved for stack text. */
+        int arena { 256 * 1024 };
+        /** Folded stacks written next to config.lua */
+        std::string output { "profile.folded" };
+
+        /** Returns settings read from `config.profiler` */
+        static Settings fromConfig();
+    };
+
+    explicit Profiler (const Settings& settings);
+    ~Profiler();
+
+    /** Start sampling a state, clearing the last profile.
+        @returns false if already running or another profiler has the VM.
+    */
+    bool start (lua_State* L);
+
+    /** Stop sampling. Recorded stacks are kept until the next start. */
+    void stop();
+
+    /** Returns true while sampling. */
+    bool running() const noexcept { return state != nullptr; }
+
+    /** Forget every sample. */
+    void clear() noexcept;
+
+    /** Count samples of a stack, frames separated by ';' root first.
+        `vmstate` is LuaJIT's: 'N' compiled, 'I' interpreted, 'C' in a C
+        function, 'G' garbage collecting, 'J' compiling. Never allocates.
+    */
+    void record (std::string_view stack, int samples, int vmstate) noexcept;
+
+    /** Write folded stacks, most samples first. */
+    void write (std::ostream& out) const;
+
+    /** Write folded stacks to a file. @returns false if it couldn't. */
+    bool save (const std::string& path) const;
+
+    /** Total samples, distinct stacks and samples that didn't fit. */
+    int64_t samples() const noexcept { return _samples; }
+    int stacks() const noexcept { return _stacks; }
+    int64_t dropped() const noexcept { return _dropped; }
+
+    /** Samples taken in one of LuaJIT's vm states, e.g. 'I' */
+    int64_t samplesIn (int vmstate) const noexcept;
+
+    /** Returns the settings in use. */
+    const Settings& settings() const noexcept { return _settings; }
+
+    /** Log sample counts and where the VM was. */
+    void report (std::ostream& out) const;
+
+private:
+    struct Slot {
+        uint64_t hash { 0 };
+        uint32_t offset { 0 }, length { 0 };
+        int64_t count { 0 };
+    };
+
+    Settings _settings;
+    lua_State* state { nullptr };
+    std::unique_ptr<Slot[]> slots;
+    uint32_t mask { 0 };
+    std::unique_ptr<char[]> arena;
+    std::size_t arenaUsed { 0 };
+
+    int64_t _samples { 0 }, _dropped { 0 };
+    int _stacks { 0 };
+    int64_t vmstates[5] {};
+
+    static void sample (void* data, lua_State* L, int samples, int vmstate);
+};
+
+} // namespace lua
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include <frc/TimedRobot.h>
+
+#include "ratescheduler.hpp"
+#include "scripting.hpp"
+
+void RateScheduler::add (std::string_view name, std::function<void()> task, double fallbackPeriodMs) {
+    if (attached)
+        throw std::runtime_error ("RateScheduler: groups can't be added after attach()");
+
+    auto group      = std::make_unique<Group>();
+    group->name     = name;
+    group->task     = std::move (task);
+    group->periodMs = fallbackPeriodMs;
+
+    sol::object obj = lua::config::get ("rates", name);
+    if (obj.is<sol::table>()) {
+        sol::table tbl  = obj;
+        group->periodMs = tbl.get_or ("period", fallbackPeriodMs);
+        group->offsetMs = tbl.get_or ("offset", 0.0);
+    }
+
+    group->periodMs = std::max (1.0, group->periodMs);
+    group->offsetMs = std::clamp (group->offsetMs, 0.0, group->periodMs);
+    group->nextMs   = group->offsetMs;
+    _groups.push_back (std::move (group));
+}
+
+void RateScheduler::attach (frc::TimedRobot& robot, Observer obs) {
+    if (attached)
+        return;
+
+    observer = std::move (obs);
+    for (auto& g : _groups) {
+        auto* group = g.get();
+        robot.AddPeriodic ([this, group]() { run (*group); },
+                           units::millisecond_t (group->periodMs),
+                           units::millisecond_t (group->offsetMs));
+    }
+
+    attached = true;
+}
+
+void RateScheduler::runUntil (double nowMs) {
+    for (;;) {
+        Group* due = nullptr;
+        for (auto& g : _groups)
+            if (g->nextMs <= nowMs && (due == nullptr || g->nextMs < due->nextMs))
+                due = g.get();
+        if (due == nullptr)
+            return;
+
+        run (*due);
+        due->nextMs += due->periodMs;
+    }
+}
+
+void RateScheduler::run (Group& group) {
+    const auto start = snider::TimingStats::clock::now();
+    group.task();
+    const auto elapsed = snider::TimingStats::clock::now() - start;
+    group.stats.add (elapsed);
+    if (observer)
+        observer (elapsed);
+}
+
+double RateScheduler::periodMs (std::string_view name) const noexcept {
+    for (const auto& g : _groups)
+        if (g->name == name)
+            return g->periodMs;
+    return 0.0;
+}
+
+void RateScheduler::report (std::ostream& out) const {
+    for (const auto& g : _groups) {
+        out << "[rate] " << std::left << std::setw (12) << g->name
+            << std::fixed << std::setprecision (1)
+            << " " << g->periodMs << "ms"
+            << " runs=" << g->stats.count()
+            << " avg=" << g->stats.averageMicros() << "us"
+            << " max=" << g->stats.maxMicros() << "us"
+            << std::endl;
+    }
+}
+
+void RateScheduler::resetStats() noexcept {
+    for (auto& g : _groups)
+        g->stats.reset();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "snider/timingstats.hpp"
+
+namespace frc {
+class TimedRobot;
+}
+
+/** Runs groups of work at their own rates.
+
+    Built on `TimedRobot::AddPeriodic` so every group runs on the robot's
+    main thread, each with its own period and phase offset. Fast control
+    loops are no longer held back by the engine period, and slow work doesn't
+    run more often than it needs to. Periods and offsets come from
+    `config.rates`.
+*/
+class RateScheduler final {
+public:
+    RateScheduler()  = default;
+    ~RateScheduler() = default;
+
+    /** A named group of work and its timing. */
+    struct Group {
+        std::string name;
+        double periodMs { 20.0 };
+        double offsetMs { 0.0 };
+        std::function<void()> task;
+        snider::TimingStats stats;
+        double nextMs { 0.0 }; ///> next run for runUntil()
+    };
+
+    /** Add a group. Must be called before attach().
+
+        @param name The group name. Used to look up `config.rates[name]`
+        @param task The work to run.
+        @param fallbackPeriodMs Period used when not configured.
+    */
+    void add (std::string_view name, std::function<void()> task, double fallbackPeriodMs);
+
+    /** Called with how long a group took, after every run. */
+    using Observer = std::function<void (snider::TimingStats::duration)>;
+
+    /** Register all groups with the robot's periodic callbacks. Call once
+        from the robot's constructor.
+        @param observer Optional, told how long each run took.
+    */
+    void attach (frc::TimedRobot& robot, Observer observer = {});
+
+    /** Run the groups due by `nowMs` in the order attach() would, each at
+        its own period and offset from 0. Lets tests step the groups without
+        starting the robot's loop.
+    */
+    void runUntil (double nowMs);
+
+    /** Returns the period of a group in milliseconds or 0 if not found. */
+    double periodMs (std::string_view name) const noexcept;
+
+    /** Returns all groups. */
+    const std::vector<std::unique_ptr<Group>>& groups() const noexcept { return _groups; }
+
+    /** Write per group execution times to a stream. */
+    void report (std::ostream& out) const;
+
+    /** Reset the execution times of all groups. */
+    void resetStats() noexcept;
+
+private:
+    std::vector<std::unique_ptr<Group>> _groups;
+    Observer observer;
+
+    void run (Group& group);
+    bool attached { false };
+};
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#    include <alloca.h>
+#    include <malloc.h>
+#    include <pthread.h>
+#    include <sched.h>
+#    include <sys/mman.h>
+#    include <sys/resource.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+#include "config.hpp"
+#include "realtime.hpp"
+#include "scripting.hpp"
+
+namespace rt {
+namespace detail {
+
+// CPU and priority of the loop thread once setup() has run, for followLoop().
+static std::atomic<int> loop_cpu { -1 }, loop_priority { 0 };
+static std::atomic<bool> loop_ready { false };
+
+#ifdef __linux__
+static Status from_errno (int err) noexcept {
+    return (err == EPERM || err == EACCES) ? Status::Denied : Status::Failed;
+}
+
+static pid_t thread_id() noexcept {
+    return static_cast<pid_t> (syscall (SYS_gettid));
+}
+
+static Status set_affinity (pid_t tid, int cpu) noexcept {
+    cpu_set_t set;
+    CPU_ZERO (&set);
+    CPU_SET (cpu, &set);
+    return sched_setaffinity (tid, sizeof (set), &set) == 0 ? Status::Applied : from_errno (errno);
+}
+
+// the HAL notifier and threads that followed the loop already run SCHED_FIFO.
+static bool is_realtime (pid_t tid) noexcept {
+    const int policy = sched_getscheduler (tid);
+    return policy == SCHED_FIFO || policy == SCHED_RR;
+}
+#endif
+
+static void log (const char* step, Status status) {
+    std::clog << "[rt] " << step << ": " << describe (status) << std::endl;
+}
+
+} // namespace detail
+
+const char* describe (Status status) noexcept {
+    switch (status) {
+        case Status::Applied:
+            return "applied";
+        case Status::Unsupported:
+            return "unsupported";
+        case Status::Denied:
+            return "denied (no privileges)";
+        case Status::Failed:
+            return "failed";
+    }
+    return "unknown";
+}
+
+Options options() {
+    Options opts;
+    opts.enabled       = config::boolean ("realtime", "enabled", opts.enabled);
+    opts.lockMemory    = config::boolean ("realtime", "lock_memory", opts.lockMemory);
+    opts.priority      = config::integer ("realtime", "priority", opts.priority);
+    opts.cpu           = config::integer ("realtime", "cpu", opts.cpu);
+    opts.helperCpu     = config::integer ("realtime", "helper_cpu", opts.helperCpu);
+    opts.stackBytes    = static_cast<std::size_t> (std::max (0.0, config::number ("realtime", "prefault_stack")));
+    opts.luaArenaBytes = static_cast<std::size_t> (std::max (0.0, config::number ("realtime", "prefault_lua")));
+    return opts;
+}
+
+Status lockMemory() {
+#ifdef __linux__
+    // keep freed memory in the process, otherwise it would fault in again.
+    mallopt (M_TRIM_THRESHOLD, -1);
+    mallopt (M_MMAP_MAX, 0);
+    return mlockall (MCL_CURRENT | MCL_FUTURE) == 0 ? Status::Applied : detail::from_errno (errno);
+#else
+    return Status::Unsupported;
+#endif
+}
+
+Status prefaultStack (std::size_t bytes) {
+    if (bytes == 0)
+        return Status::Applied;
+#ifdef __linux__
+    // Don't touch more than the stack has, leave room for frames above us.
+    struct rlimit lim;
+    if (getrlimit (RLIMIT_STACK, &lim) == 0 && lim.rlim_cur != RLIM_INFINITY)
+        bytes = std::min<std::size_t> (bytes, lim.rlim_cur / 2);
+    auto* block = static_cast<volatile unsigned char*> (alloca (bytes));
+    const auto page = static_cast<std::size_t> (sysconf (_SC_PAGESIZE));
+    for (std::size_t i = 0; i < bytes; i += page)
+        block[i] = 0;
+    return Status::Applied;
+#else
+    return Status::Unsupported;
+#endif
+}
+
+Status setFifoPriority (int priority) {
+#ifdef __linux__
+    struct sched_param param;
+    std::memset (&param, 0, sizeof (param));
+    param.sched_priority = std::clamp (priority,
+                                       sched_get_priority_min (SCHED_FIFO),
+                                       sched_get_priority_max (SCHED_FIFO));
+    const int err = pthread_setschedparam (pthread_self(), SCHED_FIFO, &param);
+    return err == 0 ? Status::Applied : detail::from_errno (err);
+#else
+    (void) priority;
+    return Status::Unsupported;
+#endif
+}
+
+Status lowerPriority (int nice) {
+#ifdef __linux__
+    return setpriority (PRIO_PROCESS, static_cast<id_t> (detail::thread_id()), std::max (0, nice)) == 0
+               ? Status::Applied
+               : detail::from_errno (errno);
+#else
+    (void) nice;
+    return Status::Unsupported;
+#endif
+}
+
+Status pinCurrentThread (int cpu) {
+    if (cpu < 0 || cpu >= numCpus())
+        return Status::Failed;
+#ifdef __linux__
+    return detail::set_affinity (detail::thread_id(), cpu);
+#else
+    return Status::Unsupported;
+#endif
+}
+
+Status pinOtherThreads (int cpu) {
+    if (cpu < 0 || cpu >= numCpus())
+        return Status::Failed;
+#ifdef __linux__
+    namespace fs   = std::filesystem;
+    const auto me  = detail::thread_id();
+    Status outcome = Status::Applied;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator ("/proc/self/task", ec)) {
+        const auto tid = static_cast<pid_t> (std::stol (entry.path().filename().string()));
+        if (tid == me || detail::is_realtime (tid))
+            continue;
+        const auto status = detail::set_affinity (tid, cpu);
+        if (status != Status::Applied)
+            outcome = status;
+    }
+    return ec ? Status::Failed : outcome;
+#else
+    return Status::Unsupported;
+#endif
+}
+
+Status followLoop() {
+    if (! detail::loop_ready.load (std::memory_order_acquire))
+        return Status::Unsupported;
+    const int cpu      = detail::loop_cpu.load (std::memory_order_relaxed);
+    const int priority = detail::loop_priority.load (std::memory_order_relaxed);
+    Status outcome     = Status::Applied;
+    if (cpu >= 0)
+        outcome = pinCurrentThread (cpu);
+    if (priority > 1) {
+        const auto status = setFifoPriority (priority - 1);
+        if (status != Status::Applied)
+            outcome = status;
+    }
+    return outcome;
+}
+
+int numCpus() noexcept {
+    return std::max (1, static_cast<int> (std::thread::hardware_concurrency()));
+}
+
+void setup (const Options& opts) {
+    if (! opts.enabled)
+        return;
+
+    if (opts.lockMemory)
+        detail::log ("lock memory", lockMemory());
+    if (opts.stackBytes > 0)
+        detail::log ("prefault stack", prefaultStack (opts.stackBytes));
+    if (opts.luaArenaBytes > 0)
+        detail::log ("prefault lua", lua::prefault (opts.luaArenaBytes) ? Status::Applied : Status::Failed);
+    if (opts.helperCpu >= 0)
+        detail::log ("pin helper threads", pinOtherThreads (opts.helperCpu));
+    if (opts.cpu >= 0)
+        detail::log ("pin loop thread", pinCurrentThread (opts.cpu));
+    if (opts.priority > 0)
+        detail::log ("SCHED_FIFO", setFifoPriority (opts.priority));
+
+    detail::loop_cpu.store (opts.cpu, std::memory_order_relaxed);
+    detail::loop_priority.store (opts.priority, std::memory_order_relaxed);
+    detail::loop_ready.store (true, std::memory_order_release);
+}
+
+} // namespace rt
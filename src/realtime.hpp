@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+
+/** Realtime setup for the control loop thread.
+
+    Memory locking, page pre-faulting, SCHED_FIFO priority and CPU pinning.
+    Every step degrades gracefully: on non-Linux systems, or without the
+    privileges to do it, the step reports its status and nothing else changes.
+*/
+namespace rt {
+
+/** Outcome of a realtime setup step. */
+enum class Status : int {
+    Applied,     ///> The step was applied.
+    Unsupported, ///> Not supported on this platform.
+    Denied,      ///> Not enough privileges.
+    Failed       ///> Supported and permitted, but failed anyway.
+};
+
+/** Returns a short description of a status. */
+const char* describe (Status status) noexcept;
+
+/** Realtime options. see `config.realtime` */
+struct Options {
+    bool enabled { false };          ///> Master switch.
+    bool lockMemory { true };        ///> mlockall current and future pages.
+    int priority { 40 };             ///> SCHED_FIFO priority of the loop thread.
+    int cpu { -1 };                  ///> CPU for the loop thread. Negative to not pin.
+    int helperCpu { -1 };            ///> CPU for helper threads. Negative to not pin.
+    std::size_t stackBytes { 0 };    ///> Stack bytes to pre-fault.
+    std::size_t luaArenaBytes { 0 }; ///> Lua heap bytes to pre-fault.
+};
+
+/** Read options from `config.realtime` */
+Options options();
+
+/** Lock current and future pages in RAM and stop malloc from giving memory
+    back to the system, so it is never paged out again.
+*/
+Status lockMemory();
+
+/** Touch a number of bytes of the calling thread's stack. */
+Status prefaultStack (std::size_t bytes);
+
+/** Raise the calling thread to SCHED_FIFO at the given priority. */
+Status setFifoPriority (int priority);
+
+/** Lower the calling thread's priority with a positive nice value. */
+Status lowerPriority (int nice);
+
+/** Pin the calling thread to one CPU. */
+Status pinCurrentThread (int cpu);
+
+/** Pin every other thread in the process to one CPU. Threads already
+    running SCHED_FIFO or SCHED_RR, like the HAL notifier, are left alone.
+*/
+Status pinOtherThreads (int cpu);
+
+/** Move the calling thread next to the loop thread: onto its CPU, at a
+    SCHED_FIFO priority one below it. For notifier callbacks the loop
+    depends on. Returns Unsupported until setup() has run enabled.
+*/
+Status followLoop();
+
+/** Returns the number of CPUs available. */
+int numCpus() noexcept;
+
+/** Apply options to the calling thread and log the result of each step.
+    Call from the control loop thread.
+*/
+void setup (const Options& opts);
+
+} // namespace rt
@@ -2,29 +2,49 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
 #include <numbers>
+#include <optional>
 
 #include <frc/AnalogGyro.h>
 #include <frc/Encoder.h>
+#include <frc/Notifier.h>
 #include <frc/RobotBase.h>
 #include <frc/RobotController.h>
+#include <frc/Timer.h>
 #include <frc/controller/PIDController.h>
 #include <frc/controller/SimpleMotorFeedforward.h>
 #include <frc/filter/SlewRateLimiter.h>
 #include <frc/kinematics/DifferentialDriveKinematics.h>
-#include <frc/kinematics/DifferentialDriveOdometry.h>
 #include <frc/simulation/AnalogGyroSim.h>
 #include <frc/simulation/DifferentialDrivetrainSim.h>
 #include <frc/simulation/EncoderSim.h>
-#include <frc/smartdashboard/Field2d.h>
+#include <frc/simulation/FlywheelSim.h>
+#include <frc/simulation/SingleJointedArmSim.h>
 #include <frc/smartdashboard/SmartDashboard.h>
 #include <frc/system/plant/LinearSystemId.h>
+#include <frc/trajectory/TrapezoidProfile.h>
 
 #include <rev/CANSparkMax.h>
 #include <rev/CANSparkMaxLowLevel.h>
 
+#include "cachedmotor.hpp"
 #include "config.hpp"
+#include "drivecontrol.hpp"
 #include "normalisablerange.hpp"
+#include "notedetector.hpp"
+#include "poseestimator.hpp"
+#include "posehistory.hpp"
+#include "simulateddrive.hpp"
+#include "snider/timingstats.hpp"
+#include "snider/velocitygate.hpp"
+#include "syntheticvision.hpp"
+#include "telemetry.hpp"
+#include "tunables.hpp"
 #include "types.hpp"
 
 /** Represents a differential drive style drivetrain. */
@@ -33,17 +53,56 @@ public:
     Drivetrain();
     ~Drivetrain();
 
-    /** Drive the bot by FRC units. */
+    /** Drive the bot by FRC units. This sets the target speeds, the control
+        loop in process() moves the wheels toward them.
+    */
     void drive (MetersPerSecond xSpeed, RadiansPerSecond rot);
 
     /** Drive the bot by normalized speed and rotation (-1.0 to 1.0) */
     void driveNormalized (double speed, double rotation) noexcept;
 
+    /** Apply voltages straight to each side, skipping the velocity loop.
+        Only for characterization: the loop takes over again on the next
+        process().
+    */
+    void driveVolts (units::volt_t left, units::volt_t right);
+
+    /** Returns the measured speed, average of both sides (m/s) */
+    double measuredSpeed() const { return 0.5 * (leftEncoder.GetRate() + rightEncoder.GetRate()); }
+
+    /** Returns the distance driven since odometry was reset, average of both
+        sides (meters)
+    */
+    double measuredDistance() const { return 0.5 * (leftEncoder.GetDistance() + rightEncoder.GetDistance()); }
+
+    /** Set how often process() is called in milliseconds. */
+    void setProcessPeriod (int ms) { control.setPeriod (std::max (1, ms) / 1000.0); }
+
+    /** Scale motor output, 0 to 1. see PowerManager */
+    void setPowerScale (double scale) noexcept { powerScale = std::clamp (scale, 0.0, 1.0); }
+
+    /** Returns the current drawn by all four drive motors (amps) */
+    double drawnCurrent() const;
+
     /** Reset odometry. */
     void resetOdometry (const frc::Pose2d& pose);
 
-    /** Get estimated field position. */
-    frc::Pose2d estimatedPosition() const { return odometry.GetPose(); }
+    /** Queue a timestamped field pose to be fused with odometry. Call from
+        one thread only. Returns false if the queue was full.
+    */
+    bool addVisionMeasurement (const VisionMeasurement& measurement) noexcept {
+        return estimator.submit (measurement);
+    }
+
+    /** Get estimated field position. This is the newest odometry sample. */
+    frc::Pose2d estimatedPosition() const;
+
+    /** Get the estimated field position at an FPGA timestamp, interpolated
+        from the odometry history. Returns nothing before the first sample.
+    */
+    std::optional<frc::Pose2d> poseAt (units::second_t timestamp) const {
+        return history.poseAt (timestamp);
+    }
 
 private:
     friend class RobotMain;
@@ -64,47 +123,43 @@ private:
     const int encoderResolution {
         static_cast<int> (config::number ("drivetrain", "encoder_resolution"))
     };
-    const double rotationThrottle {
-        config::number ("drivetrain", "rotation_throttle")
-    };
-
-    rev::CANSparkMax leftLeader {
-        config::port ("drive_left_leader"),
-        MotorType::kBrushed
-    };
-    rev::CANSparkMax leftFollower {
-        config::port ("drive_left_follower"),
-        MotorType::kBrushed
-    };
 
-    rev::CANSparkMax rightLeader {
-        config::port ("drive_right_leader"),
-        MotorType::kBrushed
-    };
-    rev::CANSparkMax rightFollower {
-        config::port ("drive_right_follower"),
-        MotorType::kBrushed
-    };
-    std::array<rev::CANSparkMax*, 4> motors { &leftLeader, &leftFollower, &rightLeader, &rightFollower };
+    CachedMotor leftLeader { "drive_left_leader", MotorType::kBrushed };
+    CachedMotor leftFollower { "drive_left_follower", MotorType::kBrushed };
+    CachedMotor rightLeader { "drive_right_leader", MotorType::kBrushed };
+    CachedMotor rightFollower { "drive_right_follower", MotorType::kBrushed };
+    std::array<CachedMotor*, 4> motors { &leftLeader, &leftFollower, &rightLeader, &rightFollower };
 
     //==========================================================================
     frc::Encoder leftEncoder { 0, 1 };
     frc::Encoder rightEncoder { 2, 3 };
 
-    frc::PIDController leftPIDController { 8.5, 0.0, 0.0 };
-    frc::PIDController rightPIDController { 8.5, 0.0, 0.0 };
+    // Gains, feedforward and rotation throttle are live tunables. `gains` is
+    // refreshed once per process() tick.
+    Tunables::Reader tunables { Tunables::get().reader() };
+    Tunables::Block gains { tunables.read() };
+
+    DriveControl control { trackWidth, controlGains (gains) };
 
     frc::AnalogGyro gyro { 0 };
 
     frc::DifferentialDriveKinematics kinematics { trackWidth };
-    frc::DifferentialDriveOdometry odometry {
+    PoseEstimator estimator {
+        kinematics,
         gyro.GetRotation2d(),
         units::meter_t { 0.0 },
         units::meter_t { 0.0 }
     };
 
-    // Gains are for example purposes only: must be determined for your own bot!
-    frc::SimpleMotorFeedforward<units::meters> feedforward { 1_V, 3_V / 1_mps };
+    // Odometry is sampled on its own notifier thread, faster than the main
+    // loop. The lock guards `estimator` which both threads touch.
+    mutable std::mutex odometryLock;
+    PoseHistory<256> history;
+    const units::millisecond_t odometryPeriod {
+        std::max (1.0, config::number ("drivetrain", "odometry_period", 5.0))
+    };
+    frc::Notifier odometryNotifier { [this]() { updateOdometry(); } };
+    bool odometryFollowsLoop { false }; // notifier thread only.
 
     struct SpeedRange : public juce::NormalisableRange<double> {
         using range_type = juce::NormalisableRange<double>;
@@ -117,10 +172,16 @@ private:
     frc::SlewRateLimiter<units::scalar> speedLimiter { 3 / 1_s };
     frc::SlewRateLimiter<units::scalar> rotLimiter { 3 / 1_s };
 
-    void postProcess();
+    double powerScale { 1.0 };
+
+    /** Run the velocity control loop. Called from the "drivetrain" rate group. */
+    void process();
+    /** Fill in dashboard values. Called from the "telemetry" rate group. */
+    void writeTelemetry (TelemetryFrame& frame) const;
     const MetersPerSecond calculateSpeed (double value) noexcept;
     const RadiansPerSecond calculateRotation (double value) noexcept;
-    void setSpeeds (const frc::DifferentialDriveWheelSpeeds& speeds);
+    static DriveControl::Gains controlGains (const Tunables::Block& block) noexcept;
+    /** Sample the encoders and gyro. Runs on the odometry notifier. */
     void updateOdometry();
 
     //==========================================================================
@@ -128,53 +189,65 @@ private:
     public:
         Simulation() = delete;
         Simulation (Drivetrain& o) : owner (o) {
-            frc::SmartDashboard::PutData ("Field", &fieldSim);
+            if (vision.settings().enabled)
+                std::clog << "[sim] synthetic vision enabled" << std::endl;
+            if (physics.settings().reference)
+                std::clog << "[sim] drivetrain reference enabled" << std::endl;
+        }
+
+        /** Record the voltages just sent to the motors. */
+        void command() {
+            physics.command (frc::Timer::GetFPGATimestamp().value(),
+                             owner.leftLeader.lastVoltage().value(),
+                             owner.rightLeader.lastVoltage().value());
         }
 
         /** Update the overall state of the simulation. */
         void update() {
-            // To update our simulation, we set motor voltage inputs, update the
-            // simulation, and write the simulated positions and velocities to our
-            // simulated encoder and gyro. We negate the right side so that positive
-            // voltages make the right side move forward.
-            drivetrainSimulator.SetInputs (
-                units::volt_t { owner.leftLeader.Get() } * frc::RobotController::GetInputVoltage(),
-                units::volt_t { owner.rightLeader.Get() } * frc::RobotController::GetInputVoltage());
-
-            auto engineMillis = units::time::millisecond_t (enginePeriodMs);
-            drivetrainSimulator.Update (engineMillis);
-
-            leftEncoderSim.SetDistance (drivetrainSimulator.GetLeftPosition().value());
-            leftEncoderSim.SetRate (drivetrainSimulator.GetLeftVelocity().value());
-            rightEncoderSim.SetDistance (
-                drivetrainSimulator.GetRightPosition().value());
-            rightEncoderSim.SetRate (drivetrainSimulator.GetRightVelocity().value());
-            gyroSim.SetAngle (-drivetrainSimulator.GetHeading().Degrees().value());
+            // Step the physics up to now, and write the simulated positions
+            // and velocities to our simulated encoder and gyro.
+            const auto now = frc::Timer::GetFPGATimestamp();
+            physics.advance (now.value());
+
+            const auto& sensors = physics.sensors();
+            leftEncoderSim.SetDistance (sensors.leftDistance);
+            leftEncoderSim.SetRate (sensors.leftRate);
+            rightEncoderSim.SetDistance (sensors.rightDistance);
+            rightEncoderSim.SetRate (sensors.rightRate);
+            gyroSim.SetAngle (-sensors.heading);
+
+            if (vision.settings().enabled) {
+                if (auto m = vision.sample (physics.pose(), now))
+                    owner.addVisionMeasurement (*m);
+            }
         }
 
-        /** Called from the drive train during "RobotPeriodic" */
-        void onPostProcess() {
-            fieldSim.SetRobotPose (owner.odometry.GetPose());
-        }
+        /** Returns the current drawn by both sides. */
+        double current() const { return physics.current(); }
 
         /** Called when the drivetrain resets its Odometry. */
         void onOdometryReset (const frc::Pose2d& pose) {
-            drivetrainSimulator.SetPose (pose);
+            physics.setPose (pose);
         }
 
-    private:
-        const int enginePeriodMs { static_cast<int> (config::number ("engine", "period")) };
+        /** Write physics stats to a stream. */
+        void report (std::ostream& out) const { physics.report (out); }
 
+        /** Reset physics stats. */
+        void resetStats() noexcept { physics.resetStats(); }
+
+    private:
         Drivetrain& owner;
         frc::sim::AnalogGyroSim gyroSim { owner.gyro };
         frc::sim::EncoderSim leftEncoderSim { owner.leftEncoder };
         frc::sim::EncoderSim rightEncoderSim { owner.rightEncoder };
-        frc::Field2d fieldSim;
-        frc::LinearSystem<2, 2, 2> drivetrainSystem =
-            frc::LinearSystemId::IdentifyDrivetrainSystem (
-                1.98_V / 1_mps, 0.2_V / 1_mps_sq, 1.5_V / 1_mps, 0.3_V / 1_mps_sq);
-        frc::sim::DifferentialDrivetrainSim drivetrainSimulator {
-            drivetrainSystem, owner.trackWidth, frc::DCMotor::CIM (2), 8, 2_in
+        SyntheticVision vision;
+        SimulatedDrive physics {
+            frc::sim::DifferentialDrivetrainSim {
+                frc::LinearSystemId::IdentifyDrivetrainSystem (
+                    1.98_V / 1_mps, 0.2_V / 1_mps_sq, 1.5_V / 1_mps, 0.3_V / 1_mps_sq),
+                owner.trackWidth, frc::DCMotor::CIM (2), 8, 2_in },
+            SimulatedDrive::Settings::fromConfig()
         };
     };
 
@@ -185,36 +258,198 @@ private:
 };
 
 //==============================================================================
-#define USE_LIFTER_ENCODERS 0
+/** The climbing arms.
 
+    Arms move to named positions from `config.lifter.setpoints` along a
+    trapezoidal motion profile. Position comes from the NEO hall sensor
+    encoders, each arm following the profile with its own loop so both end
+    up level. The loop runs on the roboRIO, or on the SPARK MAXes when
+    `config.lifter.onboard.enabled` is set.
+
+    Positions are arm angles in degrees from horizontal. Arms are assumed
+    to start at `start_position`. Soft limits keep them between
+    `min_position` and `max_position`, both here and on the controllers.
+*/
 class Lifter {
 public:
+    /** Lifter tuning. see `config.lifter` */
+    struct Settings {
+        double gearRatio { 60.0 };
+        double manualVoltage { 3.6 };
+        double startPosition { -80.0 };
+        double minPosition { -85.0 }, maxPosition { 95.0 };
+        double maxVelocity { 180.0 }, maxAcceleration { 360.0 };
+        double tolerance { 2.0 };
+        double kP { 0.2 }, kI { 0.0 }, kD { 0.0 };
+        double kS { 0.1 }, kG { 0.4 }, kV { 0.021 };
+        bool onboardPid { false };
+        double onboardP { 0.05 }, onboardI { 0.0 }, onboardD { 0.0 };
+        double simArmLength { 0.5 }, simArmMass { 2.0 };
+        std::map<std::string, double, std::less<>> setpoints;
+
+        /** Returns a setpoint's position or nothing if there isn't one. */
+        std::optional<double> setpoint (std::string_view name) const;
+
+        /** Returns a position clamped to the soft limits. */
+        double clamp (double degrees) const noexcept {
+            return std::clamp (degrees, minPosition, maxPosition);
+        }
+
+        /** Returns volts to hold an arm at a position moving at a velocity
+            (degrees, degrees/s) against friction and gravity.
+        */
+        double feedforward (double degrees, double velocity) const noexcept;
+
+        /** Returns settings read from `config.lifter` */
+        static Settings fromConfig();
+    };
+
     Lifter();
     ~Lifter() = default;
 
     /** Bind to lua. See `bindings.cpp` */
     static void bind (Lifter*);
 
-    /** Move arms up. */
+    /** Move arms up by hand until stopped or at the upper soft limit. */
     void moveUp();
 
-    /** Move arms down. */
+    /** Move arms down by hand until stopped or at the lower soft limit. */
     void moveDown();
 
+    /** Move arms to a named setpoint. Returns false if there isn't one. */
+    bool moveTo (std::string_view setpoint);
+
+    /** Move arms to a position in degrees, clamped to the soft limits. */
+    void moveTo (double degrees);
+
     /** Stop arm motors. */
     void stop();
 
+    /** Returns the average arm position in degrees. */
+    double position() const noexcept { return 0.5 * (positions[0] + positions[1]); }
+
+    /** Returns the position being moved to in degrees. */
+    constexpr double goal() const noexcept { return _goal.position.value(); }
+
+    /** Returns true if moving to a position and both arms are there. */
+    bool atGoal() const noexcept;
+
+    /** Returns the settings in use. */
+    const Settings& settings() const noexcept { return _settings; }
+
+    /** Scale motor output, 0 to 1. Only the feedforward is scaled when the
+        loop runs on the controllers. see PowerManager
+    */
+    void setPowerScale (double scale) noexcept { powerScale = std::clamp (scale, 0.0, 1.0); }
+
+    /** Returns the current drawn by both arm motors (amps) */
+    double drawnCurrent() const noexcept;
+
+    /** Returns the average of the voltages last sent to the arm motors. */
+    double outputVoltage() const noexcept {
+        return 0.5 * (leftArm.lastVoltage() + rightArm.lastVoltage()).value();
+    }
+
+    /** Run the motors for the current move. Called by the mechanisms rate
+        group.
+    */
+    void process() noexcept;
+
+    /** Set how often process() is called in milliseconds. */
+    void setProcessPeriod (int ms);
+
+    /** Returns how often process() is called in milliseconds. */
+    int processPeriod() const noexcept {
+        return static_cast<int> (std::lround (units::millisecond_t (period).value()));
+    }
+
+    /** Returns how long each move took to arrive, from moveTo() until both
+        arms were at the goal.
+    */
+    const snider::TimingStats& moveTimes() const noexcept { return moveTime; }
+
+    /** Write move counts and times to a stream. */
+    void report (std::ostream& out) const;
+
+    /** Reset move stats. */
+    void resetStats() noexcept;
+
 private:
-#if USE_LIFTER_ENCODERS
-    using EncoderType = rev::SparkRelativeEncoder;
-    std::unique_ptr<EncoderType> encL, encR;
-#endif
-    rev::CANSparkMax leftArm { config::port ("arm_left"), MotorType::kBrushless };
-    rev::CANSparkMax rightArm { config::port ("arm_right"), MotorType::kBrushless };
-    std::array<rev::CANSparkMax*, 2> motors { &leftArm, &rightArm };
-
-    void maybeInstantiateEncoders();
-    void resetEncoders();
+    friend class RobotMain;
+    using Profile = frc::TrapezoidProfile<units::degrees>;
+
+    enum Mode : int { Stopped, Manual, Profiled };
+
+    Settings _settings;
+    Mode mode { Stopped };
+    double direction { 0.0 };
+    double powerScale { 1.0 };
+    units::second_t period { 0.02 };
+
+    Profile profile;
+    Profile::State _goal, setpoint;
+    std::array<frc::PIDController, 2> pids;
+    std::array<double, 2> positions {};
+
+    // time from moveTo() to both arms being there.
+    int moveTicks { 0 };
+    bool arrived { false };
+    snider::TimingStats moveTime;
+
+    CachedMotor leftArm { "arm_left", MotorType::kBrushless };
+    CachedMotor rightArm { "arm_right", MotorType::kBrushless };
+    std::array<CachedMotor*, 2> motors { &leftArm, &rightArm };
+
+    // the NEOs' hall sensors, in motor turns.
+    rev::SparkRelativeEncoder leftEncoder {
+        leftArm.motor().GetEncoder (rev::SparkRelativeEncoder::Type::kHallSensor, 42)
+    };
+    rev::SparkRelativeEncoder rightEncoder {
+        rightArm.motor().GetEncoder (rev::SparkRelativeEncoder::Type::kHallSensor, 42)
+    };
+    std::array<rev::SparkRelativeEncoder*, 2> encoders { &leftEncoder, &rightEncoder };
+    std::array<rev::SparkPIDController, 2> onboardPids {
+        leftArm.motor().GetPIDController(), rightArm.motor().GetPIDController()
+    };
+
+    double toTurns (double degrees) const noexcept { return degrees * _settings.gearRatio / 360.0; }
+    double toDegrees (double turns) const noexcept { return turns * 360.0 / _settings.gearRatio; }
+    bool useOnboardPid() const noexcept { return _settings.onboardPid && simulation == nullptr; }
+    void readPositions() noexcept;
+
+    //==========================================================================
+    /** Arm physics for the simulator. REV controllers can't be simulated
+        here, so the lifter reads positions from this instead of the
+        encoders while it exists.
+    */
+    class Simulation {
+    public:
+        Simulation() = delete;
+        explicit Simulation (Lifter& o);
+
+        /** Step both arms by the voltages last sent. */
+        void update();
+
+        /** Returns an arm's angle in degrees. */
+        double position (int arm) const {
+            return units::degree_t (arms[arm].GetAngle()).value();
+        }
+
+        /** Returns the current drawn by both arms. */
+        double current() const {
+            return std::abs (arms[0].GetCurrentDraw().value()) + std::abs (arms[1].GetCurrentDraw().value());
+        }
+
+    private:
+        const int enginePeriodMs { static_cast<int> (config::number ("engine", "period")) };
+        Lifter& owner;
+        std::array<frc::sim::SingleJointedArmSim, 2> arms;
+    };
+
+    std::unique_ptr<Simulation> simulation;
+
+    void initializeSimulation();
+    void updateSimulation();
 };
 
 //==============================================================================
@@ -224,6 +459,14 @@ private:
     state machine with three states: Idle, Shooting, Loading. Idle can 
     transition to Shooting or Loading then back to Idle.  Shooting and Loading 
     do not transition directly to each other which prevents shoot/load overlaps.
+
+    A shot spins up the primary flywheels and feeds the note with the
+    secondaries as soon as both flywheels read within tolerance of the
+    target speed for the shoot level. `warmup_time` is only a fallback for
+    when they never get there.
+
+    Loading ends by itself once the intake motor current says a note is
+    seated. see NoteDetector
 */
 class Shooter {
 public:
@@ -271,6 +514,66 @@ public:
     /** Set appropriate motor speed and update state if needed. */
     void process() noexcept;
 
+    /** Fill in dashboard values. */
+    void writeTelemetry (TelemetryFrame& frame) const noexcept {
+        frame.shooterState = static_cast<int64_t> (_state);
+        frame.shootLevel   = _shootLevel;
+    }
+
+    /** Set how often process() is called in milliseconds. Timings are
+        counted in process() calls, so this must match the caller's rate.
+    */
+    void setProcessPeriod (int ms) noexcept {
+        periodMs     = std::max (1, ms);
+        noteDetector = NoteDetector (noteDetector.settings(), periodMs / 1000.0);
+    }
+
+    /** Returns how often process() is called in milliseconds. */
+    constexpr int processPeriod() const noexcept { return periodMs; }
+
+    /** Replace the simulated intake current, amps by seconds since loading
+        started. Does nothing unless simulating.
+    */
+    void setIntakeCurrentProfile (std::function<double (double)> profile) {
+        if (simulation != nullptr)
+            simulation->setIntakeCurrentProfile (std::move (profile));
+    }
+
+    /** Scale motor output, 0 to 1. see PowerManager */
+    void setPowerScale (double scale) noexcept { powerScale = std::clamp (scale, 0.0, 1.0); }
+
+    /** Returns the current drawn by all shooter motors (amps) */
+    double drawnCurrent() const noexcept;
+
+    /** Returns the flywheel speed a shot at the current level aims for,
+        scaled with the voltage when power is limited (RPM)
+    */
+    double targetRpm() const noexcept;
+
+    /** Returns the slower of the two flywheel speeds (RPM) */
+    double flywheelRpm() const noexcept { return std::min (topRpm, bottomRpm); }
+
+    /** Returns true if the flywheels were at speed as of the last process() */
+    bool flywheelsReady() const noexcept { return readyGate.ready(); }
+
+    /** Returns true if a shot is feeding the note to the flywheels. */
+    bool isFeeding() const noexcept { return _state == Shooting && feeding; }
+
+    /** Returns how many shots were fed with the flywheels at speed. */
+    int64_t feedsAtSpeed() const noexcept { return readyFeeds; }
+
+    /** Returns how many shots were fed when the spin-up timed out. */
+    int64_t feedsOnTimeout() const noexcept { return timeoutFeeds; }
+
+    /** Returns how long each shot spun up before feeding. */
+    const snider::TimingStats& spinUpTimes() const noexcept { return spinUp; }
+
+    /** Write spin-up times and how shots were fed to a stream. */
+    void report (std::ostream& out) const;
+
+    /** Reset spin-up stats. */
+    void resetStats() noexcept;
+
 private:
     friend class RobotMain;
     /** Bind to lua. see bindings.cpp */
@@ -281,45 +584,111 @@ private:
 
     double _shootLevel { 1.0 };
     // see `config.lua`
-    const int intakeTimeMs;
     const int warmTimeMs;
     const int shootTimeMs;
 
-    int totalTimeMs {};
     int periodMs { 20 };
-    int tick       = 0;
-    int delay      = 0;
-    int delayTicks = 2; // delayTicks x 20ms = totalDelay
+    int tick       = 0;     // feed ticks left.
+    int delay      = 0;     // spin-up ticks so far.
+    int delayTicks = 2;     // delayTicks x 20ms = longest spin-up
+    bool feeding   = false; // secondaries running.
+
+    // flywheel speeds read in process(). see `config.shooter`
+    const double rpmPerVolt;
+    snider::VelocityGate readyGate;
+    double topRpm { 0.0 }, bottomRpm { 0.0 };
+
+    // time from shoot() to feeding, and how feeding started.
+    snider::TimingStats spinUp;
+    int64_t readyFeeds { 0 }, timeoutFeeds { 0 };
 
+    // ends Loading when a note is seated. see `config.shooter.note_detect`
+    NoteDetector noteDetector { NoteDetector::Settings::fromConfig(), periodMs / 1000.0 };
+    snider::TimingStats intakeTime;
+    int64_t intakeTimeouts { 0 };
+
+    double powerScale { 1.0 };
+
+    // motor powers are live tunables, read once per process() tick.
+    Tunables::Reader tunables { Tunables::get().reader() };
     double shootPower { -3.0 },
         intakePrimaryPower { -6.0 },
         intakeSecondaryPower { -3.0 };
 
-    rev::CANSparkMax secondaryTop {
-        config::port ("shooter_secondary_top"),
-        MotorType::kBrushed
-    };
+    CachedMotor secondaryTop { "shooter_secondary_top", MotorType::kBrushed };
+    CachedMotor secondaryBottom { "shooter_secondary_bottom", MotorType::kBrushed };
+    CachedMotor primaryTop { "shooter_primary_top", MotorType::kBrushless };
+    CachedMotor primaryBottom { "shooter_primary_bottom", MotorType::kBrushless };
 
-    rev::CANSparkMax secondaryBottom {
-        config::port ("shooter_secondary_bottom"),
-        MotorType::kBrushed
+    std::array<CachedMotor*, 4> motors {
+        &primaryTop, &primaryBottom, &secondaryTop, &secondaryBottom
     };
+    std::array<CachedMotor*, 2> primaryMotors { &primaryTop, &primaryBottom };
+    std::array<CachedMotor*, 2> secondaryMotors { &secondaryTop, &secondaryBottom };
 
-    rev::CANSparkMax primaryTop {
-        config::port ("shooter_primary_top"),
-        MotorType::kBrushless
-    };
+    // the brushless primaries' built in encoders.
+    rev::SparkRelativeEncoder topEncoder { primaryTop.motor().GetEncoder() };
+    rev::SparkRelativeEncoder bottomEncoder { primaryBottom.motor().GetEncoder() };
 
-    rev::CANSparkMax primaryBottom {
-        config::port ("shooter_primary_bottom"),
-        MotorType::kBrushless
-    };
+    std::string stateString() const noexcept;
+    void readPowers() noexcept;
+    void readFlywheels() noexcept;
+    double intakeCurrent() const noexcept;
 
-    std::array<rev::CANSparkMax*, 4> motors {
-        &primaryTop, &primaryBottom, &secondaryTop, &secondaryBottom
+    //==========================================================================
+    /** Flywheel physics for the simulator. REV controllers can't be
+        simulated here, so the shooter reads speeds from this instead of the
+        encoders while it exists.
+    */
+    class Simulation {
+    public:
+        Simulation() = delete;
+        Simulation (Shooter& o) : owner (o) {}
+
+        /** Step both flywheels by the voltages last sent, and the intake
+            current by the time spent loading.
+        */
+        void update() {
+            const units::millisecond_t dt { enginePeriodMs };
+            top.SetInputVoltage (owner.primaryTop.lastVoltage());
+            bottom.SetInputVoltage (owner.primaryBottom.lastVoltage());
+            top.Update (dt);
+            bottom.Update (dt);
+            loadingTime = owner.isLoading() ? loadingTime + units::second_t (dt).value() : 0.0;
+        }
+
+        /** Returns the current drawn by the intake motors. */
+        double intakeCurrent() const { return profile (loadingTime); }
+
+        /** Returns the current drawn by all the motors. */
+        double current() const {
+            return std::abs (top.GetCurrentDraw().value()) + std::abs (bottom.GetCurrentDraw().value())
+                   + (owner.isLoading() ? intakeCurrent() : 0.0);
+        }
+
+        void setIntakeCurrentProfile (std::function<double (double)> p) {
+            profile = p ? std::move (p) : std::function<double (double)> (IntakeCurrentProfile::fromConfig());
+        }
+
+        double topRpm() const { return units::revolutions_per_minute_t (top.GetAngularVelocity()).value(); }
+        double bottomRpm() const { return units::revolutions_per_minute_t (bottom.GetAngularVelocity()).value(); }
+
+    private:
+        const int enginePeriodMs { static_cast<int> (config::number ("engine", "period")) };
+
+        Shooter& owner;
+        const units::kilogram_square_meter_t moi {
+            config::number ("shooter", "sim_moi", 0.0008)
+        };
+        frc::sim::FlywheelSim top { frc::DCMotor::NEO (1), 1.0, moi };
+        frc::sim::FlywheelSim bottom { frc::DCMotor::NEO (1), 1.0, moi };
+
+        double loadingTime { 0.0 };
+        std::function<double (double)> profile { IntakeCurrentProfile::fromConfig() };
     };
-    std::array<rev::CANSparkMax*, 2> primaryMotors { &primaryTop, &primaryBottom };
-    std::array<rev::CANSparkMax*, 2> secondaryMotors { &secondaryTop, &secondaryBottom };
 
-    std::string stateString() const noexcept;
+    std::unique_ptr<Simulation> simulation;
+
+    void initializeSimulation();
+    void updateSimulation();
 };
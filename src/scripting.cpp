@@ -1,10 +1,14 @@
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <iomanip>
 #include <memory>
 #include <sstream>
 
 #include <frc/Filesystem.h>
 
+#include "luabundle.hpp"
 #include "scripting.hpp"
 #include "sol/state.hpp"
 extern "C" {
@@ -21,6 +25,7 @@ static sol::state* _state { nullptr };
 static bool boostraped { false };
 static std::string path;
 static std::string search_dir;
+static std::unique_ptr<Bundle> bundle;
 
 static void init() {
     if (_state != nullptr)
@@ -34,10 +39,28 @@ static void destroy() {
         return;
     delete _state;
     _state = nullptr;
+    bundle.reset();
 }
 
 static bool has_custom_path() { return ! path.empty(); }
 
+static std::size_t heap_bytes (lua_State* L) {
+    return static_cast<std::size_t> (lua_gc (L, LUA_GCCOUNT, 0)) * 1024
+           + static_cast<std::size_t> (lua_gc (L, LUA_GCCOUNTB, 0));
+}
+
+// makes a table with arg 1 array slots, returns the heap size holding it.
+static int prefault_table (lua_State* L) {
+    lua_createtable (L, static_cast<int> (lua_tointeger (L, 1)), 0);
+    lua_pushnumber (L, static_cast<lua_Number> (heap_bytes (L)));
+    return 1;
+}
+
+// scripts are deployed as files, a bundle, or both.
+static bool has_scripts (const fs::path& dir) {
+    return fs::exists (dir / "config.lua") || fs::exists (dir / Bundle::fileName);
+}
+
 static char separator() {
 #ifdef _WIN32
     return '\\';
@@ -113,29 +136,52 @@ const std::string& search_directory() {
     return detail::search_dir;
 }
 
+const Bundle* bundle() {
+    return detail::bundle.get();
+}
+
+bool prefault (std::size_t bytes) {
+    auto L = state().lua_state();
+    // a table's array part is a single allocation of one TValue per slot.
+    const auto slots  = std::min<std::size_t> (bytes / sizeof (double), 1u << 26);
+    const auto before = detail::heap_bytes (L);
+
+    // protected, the allocation may fail.
+    lua_pushcfunction (L, detail::prefault_table);
+    lua_pushinteger (L, static_cast<lua_Integer> (slots));
+    const bool called = lua_pcall (L, 1, 1, 0) == 0;
+    const auto peak   = called ? static_cast<std::size_t> (lua_tonumber (L, -1)) : before;
+    lua_pop (L, 1);
+    lua_gc (L, LUA_GCCOLLECT, 0);
+
+    return called && peak >= before + slots * sizeof (double);
+}
+
 bool bootstrap() {
     if (detail::boostraped)
         return true;
 
+    const auto started = std::chrono::steady_clock::now();
+
     if (! detail::has_custom_path()) {
         set_path ([]() -> std::string {
             fs::path path;
 
             path = frc::filesystem::GetDeployDirectory();
 
-            if (! fs::exists (path / "config.lua")) {
+            if (! detail::has_scripts (path)) {
                 path = frc::filesystem::GetOperatingDirectory();
                 path /= "robot";
             }
 
-            if (! fs::exists (path / "config.lua")) {
+            if (! detail::has_scripts (path)) {
                 path = frc::filesystem::GetLaunchDirectory();
                 path /= "robot";
             }
 
             path.make_preferred();
 
-            if (! fs::exists (path / "config.lua"))
+            if (! detail::has_scripts (path))
                 return "";
 
             std::clog << "[bot] bootstrap: lua path: " << path.string() << std::endl;
@@ -144,6 +190,14 @@ bool bootstrap() {
     }
 
     auto& ls = state();
+    if (! detail::search_dir.empty() && detail::bundle == nullptr) {
+        auto file = fs::path (detail::search_dir) / Bundle::fileName;
+        if (fs::exists (file))
+            detail::bundle = Bundle::open (file.string());
+        if (detail::bundle != nullptr)
+            add_searcher (ls.lua_state(), *detail::bundle);
+    }
+
     sol::safe_function_result result;
 
     try {
@@ -161,6 +215,16 @@ bool bootstrap() {
         return false;
     }
 
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - started;
+    std::clog << "[bot] bootstrap: config loaded in " << std::fixed << std::setprecision (2)
+              << elapsed.count() << " ms" << std::defaultfloat;
+    if (const auto* b = detail::bundle.get())
+        std::clog << " (bundle: " << b->chunks().size() << " chunks, " << b->bytes() << " bytes, "
+                  << b->loaded() << " loaded, " << b->overridden() << " overridden)";
+    else
+        std::clog << " (no bundle)";
+    std::clog << std::endl;
+
     detail::boostraped = true;
     return detail::boostraped;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 
@@ -8,6 +9,8 @@
 
 namespace lua {
 
+class Bundle;
+
 /** Initialize and destroy Lua with RAII pattern. Instantiating this class more 
     than once will throw a runtime exception. Using lua::state() before the 
     Lifecycle is present will crash badly.
@@ -39,7 +42,23 @@ void set_path (std::string_view path);
 /** Returns the search directory for Lua. */
 const std::string& search_directory();
 
+/** Returns the script bundle found by bootstrap(), or nullptr if there isn't
+    one in the search directory. see luabundle.hpp
+*/
+const Bundle* bundle();
+
+/** Grow the Lua heap by about `bytes` then release it, so its pages are
+    already mapped (and locked when memory locking is on) before the control
+    loop starts.
+    @returns true if the heap grew by `bytes`, false if the allocation
+    failed or was smaller. Sizes are capped at 512 MiB.
+*/
+bool prefault (std::size_t bytes);
+
 /** Bootstrap the interpreter (call once before robot init)
+
+    Maps the script bundle if the search directory has one, so `require`
+    is served from memory, then loads the config and logs how long it took.
     @returns true if Lua could be bootstrapped.
 */
 bool bootstrap();
@@ -1,4 +1,8 @@
 
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
 #include "config.hpp"
 #include "robot.hpp"
 
@@ -12,27 +16,38 @@
 
 // clang-format off
 Shooter::Shooter()
-    : intakeTimeMs { int(1000.0 * config::number ("shooter", "intake_time")) },
-      warmTimeMs { int(1000.0 * config::number ("shooter", "warmup_time")) },
-      shootTimeMs { int(1000.0 * config::number ("shooter", "shoot_time")) }
+    : warmTimeMs { int(1000.0 * config::number ("shooter", "warmup_time")) },
+      shootTimeMs { int(1000.0 * config::number ("shooter", "shoot_time")) },
+      periodMs { config::integer ("engine", "period", 20) },
+      rpmPerVolt { config::number ("shooter", "rpm_per_volt", 440.0) },
+      readyGate { config::number ("shooter", "ready_tolerance", 0.05),
+                  config::number ("shooter", "ready_exit_tolerance", 0.10),
+                  config::integer ("shooter", "ready_samples", 2) }
 {
     reset();
 
-    primaryTop.SetInverted (false);
-    primaryBottom.SetInverted (! primaryTop.GetInverted());
+    // shorter velocity averaging so readiness isn't judged on stale speeds.
+    for (auto* encoder : { &topEncoder, &bottomEncoder }) {
+        encoder->SetMeasurementPeriod (16);
+        encoder->SetAverageDepth (2);
+    }
+
+    // a backstop under the power manager's limiting.
+    for (auto* m : primaryMotors)
+        m->motor().SetSmartCurrentLimit (40);
+
+    primaryTop.motor().SetInverted (false);
+    primaryBottom.motor().SetInverted (! primaryTop.motor().GetInverted());
     for (auto* const mt : secondaryMotors) {
-        mt->SetInverted (true);
+        mt->motor().SetInverted (true);
     }
 }
 // clang-format on
 
 void Shooter::reset() {
     _state = lastState   = Idle;
-    periodMs             = config::integer ("engine", "period");
-    _shootLevel          = 1.0;
-    shootPower           = std::max (1.0, config::number ("shooter", "shoot_power"));
-    intakePrimaryPower   = -1.0 * std::max (1.0, config::number ("shooter", "intake_primary_power"));
-    intakeSecondaryPower = -1.0 * std::max (1.0, config::number ("shooter", "intake_secondary_power"));
+    _shootLevel = 1.0;
+    readPowers();
 
     // clang-format off
     SHOOTER_DBG("shootPower=" << shootPower 
@@ -45,22 +60,25 @@ void Shooter::intake() {
     if (_state != Idle)
         return;
     _state = Loading;
+    noteDetector.reset();
 }
 
 void Shooter::shoot() {
     if (_state != Idle)
         return;
 
-    _state      = Shooting;
-    totalTimeMs = warmTimeMs + shootTimeMs;
-    tick        = std::max (periodMs, totalTimeMs / periodMs);
-    delayTicks  = std::max (periodMs, warmTimeMs / periodMs);
-    delay       = 0;
+    _state     = Shooting;
+    tick       = std::max (1, shootTimeMs / periodMs);
+    delayTicks = std::max (1, warmTimeMs / periodMs);
+    delay      = 0;
+    feeding    = false;
+    readyGate.reset();
 
     // clang-format off
     SHOOTER_DBG ("shoot(): periodMs=" << periodMs
         << " warmTime=" << warmTimeMs
         << " shootTime=" << shootTimeMs
+        << " targetRpm=" << targetRpm()
         << " ticks=" << tick
         << " delayTicks=" << delayTicks);
     // clang-format on
@@ -70,41 +88,107 @@ void Shooter::stop() {
     _state = Idle;
 }
 
+void Shooter::readPowers() noexcept {
+    const auto values    = tunables.read();
+    shootPower           = std::max (1.0, values[Tunable::ShootPower]);
+    intakePrimaryPower   = -1.0 * std::max (1.0, values[Tunable::IntakePrimaryPower]);
+    intakeSecondaryPower = -1.0 * std::max (1.0, values[Tunable::IntakeSecondaryPower]);
+}
+
+double Shooter::targetRpm() const noexcept {
+    // the speed the flywheels can reach with the voltage actually applied.
+    return shootPower * std::max (0.2, std::min (1.0, _shootLevel)) * powerScale * rpmPerVolt;
+}
+
+void Shooter::readFlywheels() noexcept {
+    if (simulation != nullptr) {
+        topRpm    = std::abs (simulation->topRpm());
+        bottomRpm = std::abs (simulation->bottomRpm());
+    } else {
+        // the bottom wheel is inverted, only the magnitude matters.
+        topRpm    = std::abs (topEncoder.GetVelocity());
+        bottomRpm = std::abs (bottomEncoder.GetVelocity());
+    }
+}
+
+double Shooter::drawnCurrent() const noexcept {
+    if (simulation != nullptr)
+        return simulation->current();
+
+    double amps = 0.0;
+    for (auto* m : motors)
+        amps += m->motor().GetOutputCurrent();
+    return amps;
+}
+
+double Shooter::intakeCurrent() const noexcept {
+    // on the robot the note detector reads all the shooter motors.
+    return simulation != nullptr ? simulation->intakeCurrent() : drawnCurrent();
+}
+
 void Shooter::process() noexcept {
+    readPowers();
+    readFlywheels();
     switch (_state) {
         case Loading: {
-            primaryTop.SetVoltage (units::volt_t { intakePrimaryPower });
-            primaryBottom.SetVoltage (units::volt_t { intakePrimaryPower });
-            secondaryTop.SetVoltage (units::volt_t { intakeSecondaryPower });
-            secondaryBottom.SetVoltage (units::volt_t { intakeSecondaryPower });
+            primaryTop.setVoltage (units::volt_t { intakePrimaryPower * powerScale });
+            primaryBottom.setVoltage (units::volt_t { intakePrimaryPower * powerScale });
+            secondaryTop.setVoltage (units::volt_t { intakeSecondaryPower * powerScale });
+            secondaryBottom.setVoltage (units::volt_t { intakeSecondaryPower * powerScale });
+
+            if (noteDetector.update (intakeCurrent())) {
+                // note seated. the Idle case stops the motors next tick.
+                _state = Idle;
+                intakeTime.add (std::chrono::duration_cast<snider::TimingStats::duration> (
+                    std::chrono::duration<double> (noteDetector.elapsed())));
+                SHOOTER_DBG ("note seated after " << noteDetector.elapsed() << "s at "
+                                                  << noteDetector.filtered() << "A"
+                                                  << (noteDetector.baselineValid() ? "" : " (baseline out of range)"));
+            } else if (noteDetector.timedOut()) {
+                // no note came, don't run the intake forever.
+                _state = Idle;
+                ++intakeTimeouts;
+                SHOOTER_DBG ("no note after " << noteDetector.elapsed() << "s");
+            }
             break;
         }
         case Shooting: {
             const double level = std::max (0.2, std::min (1.0, _shootLevel));
-            units::volt_t volts { shootPower * level };
+            units::volt_t volts { shootPower * level * powerScale };
             for (auto* m : primaryMotors)
-                m->SetVoltage (volts);
+                m->setVoltage (volts);
+
+            // feed once both flywheels are at speed, or when done waiting.
+            if (! feeding) {
+                const bool ready = readyGate.update (targetRpm(), flywheelRpm());
+                ++delay; // counts this tick, fed or not.
+                if (ready || delay >= delayTicks) {
+                    feeding = true;
+                    ++(ready ? readyFeeds : timeoutFeeds);
+                    spinUp.add (std::chrono::milliseconds (delay * periodMs));
+                    SHOOTER_DBG ("feeding after " << delay * periodMs << "ms at "
+                                                  << flywheelRpm() << " rpm"
+                                                  << (ready ? "" : " (timeout)"));
+                }
+            }
 
-            if (delay >= delayTicks) {
+            if (feeding) {
                 for (auto* m : secondaryMotors)
-                    m->SetVoltage (volts);
+                    m->setVoltage (volts);
+                if (--tick <= 0) {
+                    // shoot load seq. finished. transition back to Idle.
+                    _state = Idle;
+                }
             }
-
-            ++delay;
             break;
         }
         case Idle: {
             for (auto* m : motors)
-                m->SetVoltage (units::volt_t { 0.0 });
+                m->setVoltage (units::volt_t { 0.0 });
             break;
         }
     }
 
-    if (isShooting() && --tick <= 0) {
-        // shoot load seq. finished. transition back to Idle.
-        _state = Idle;
-    }
-
     lastState = _state;
 }
 
@@ -123,3 +207,36 @@ std::string Shooter::stateString() const noexcept {
 
     return "unknown";
 }
+
+void Shooter::report (std::ostream& out) const {
+    out << "[shooter] shots=" << spinUp.count()
+        << " at_speed=" << readyFeeds
+        << " timeout=" << timeoutFeeds
+        << std::fixed << std::setprecision (1)
+        << " spin-up avg=" << spinUp.averageMicros() / 1000.0 << "ms"
+        << " max=" << spinUp.maxMicros() / 1000.0 << "ms"
+        << std::endl
+        << "[shooter] notes=" << intakeTime.count()
+        << " timeouts=" << intakeTimeouts
+        << " intake avg=" << intakeTime.averageMicros() / 1000.0 << "ms"
+        << " max=" << intakeTime.maxMicros() / 1000.0 << "ms"
+        << std::endl;
+}
+
+void Shooter::resetStats() noexcept {
+    spinUp.reset();
+    intakeTime.reset();
+    readyFeeds = timeoutFeeds = intakeTimeouts = 0;
+}
+
+//==============================================================================
+void Shooter::initializeSimulation() {
+    if (simulation != nullptr)
+        return;
+    simulation = std::make_unique<Simulation> (*this);
+}
+
+void Shooter::updateSimulation() {
+    if (simulation)
+        simulation->update();
+}
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+#include "config.hpp"
+#include "simulateddrive.hpp"
+
+//==============================================================================
+SimulatedDrive::Settings SimulatedDrive::Settings::fromConfig() {
+    Settings s;
+    s.step            = std::max (0.01, config::number ("simulation", "step", 1.0)) / 1000.0;
+    s.controllerDelay = std::max (0.0, config::number ("simulation", "controller_delay", 1.0)) / 1000.0;
+    s.sensorLatency   = std::max (0.0, config::number ("simulation", "sensor_latency", 0.0)) / 1000.0;
+    s.rateNoise       = std::max (0.0, config::number ("simulation", "rate_noise", s.rateNoise));
+    s.gyroNoise       = std::max (0.0, config::number ("simulation", "gyro_noise", s.gyroNoise));
+    s.seed            = static_cast<unsigned int> (config::integer ("simulation", "seed", s.seed));
+    s.reference       = config::boolean ("simulation", "reference", s.reference);
+    s.referenceStep   = std::max (0.001, config::number ("simulation", "reference_step", 0.1)) / 1000.0;
+    return s;
+}
+
+//==============================================================================
+SimulatedDrive::SimulatedDrive (const frc::sim::DifferentialDrivetrainSim& p, const Settings& s)
+    : _settings (s),
+      plant (p),
+      referencePlant (p),
+      random (s.seed) {}
+
+void SimulatedDrive::command (double now, double left, double right) noexcept {
+    if (numCommands == static_cast<int> (commands.size())) {
+        // full: the oldest has long since been applied.
+        firstCommand = (firstCommand + 1) % commands.size();
+        --numCommands;
+    }
+    auto& c = commands[(firstCommand + numCommands) % commands.size()];
+    c.time  = now + _settings.controllerDelay;
+    c.left  = left;
+    c.right = right;
+    ++numCommands;
+}
+
+void SimulatedDrive::advance (double now) {
+    if (_time < 0.0) {
+        _time = referenceTime = now;
+        record (_time);
+        _sensors = sampleAt (_time);
+        return;
+    }
+
+    // only whole steps, like a fixed step integrator. the remainder waits
+    // for the next call.
+    constexpr double epsilon = 1.0e-9;
+    const double step        = std::max (1.0e-5, _settings.step);
+    while (now - _time >= step - epsilon) {
+        const auto& c = commandAt (_time + epsilon);
+        plant.SetInputs (units::volt_t (c.left), units::volt_t (c.right));
+        plant.Update (units::second_t (step));
+        _time += step;
+        ++_steps;
+        record (_time);
+    }
+
+    if (_settings.reference) {
+        // the reference steps finely and also breaks its steps where a new
+        // voltage lands, so its input is exact.
+        const double h = std::max (1.0e-6, _settings.referenceStep);
+        while (_time - referenceTime > epsilon) {
+            const double end = std::min ({ referenceTime + h, _time, nextCommandAfter (referenceTime + epsilon) });
+            const auto& c    = commandAt (referenceTime + epsilon);
+            referencePlant.SetInputs (units::volt_t (c.left), units::volt_t (c.right));
+            referencePlant.Update (units::second_t (end - referenceTime));
+            referenceTime = end;
+        }
+        referenceTime = _time;
+        measureError();
+    }
+
+    dropAppliedCommands();
+
+    _sensors = sampleAt (now - _settings.sensorLatency);
+    if (_settings.rateNoise > 0.0) {
+        _sensors.leftRate += _settings.rateNoise * unitNoise (random);
+        _sensors.rightRate += _settings.rateNoise * unitNoise (random);
+    }
+    if (_settings.gyroNoise > 0.0)
+        _sensors.heading += _settings.gyroNoise * unitNoise (random);
+}
+
+void SimulatedDrive::setPose (const frc::Pose2d& pose) {
+    plant.SetPose (pose);
+    referencePlant.SetPose (pose);
+    numSamples = 0;
+    if (_time >= 0.0) {
+        record (_time);
+        _sensors = sampleAt (_time);
+    }
+}
+
+std::optional<SimulatedDrive::Error> SimulatedDrive::error() const noexcept {
+    if (! _settings.reference)
+        return std::nullopt;
+    Error e;
+    e.maxPosition = maxPosition;
+    e.rmsPosition = errorSamples > 0 ? std::sqrt (sumSquaredPosition / errorSamples) : 0.0;
+    e.maxHeading  = maxHeading;
+    e.maxVelocity = maxVelocity;
+    e.samples     = errorSamples;
+    return e;
+}
+
+void SimulatedDrive::report (std::ostream& out) const {
+    out << "[sim] drivetrain steps=" << _steps << " step=" << std::fixed << std::setprecision (2)
+        << 1000.0 * _settings.step << "ms";
+    if (auto e = error()) {
+        out << " reference error: position max=" << 1000.0 * e->maxPosition << "mm"
+            << " rms=" << 1000.0 * e->rmsPosition << "mm"
+            << " heading max=" << std::setprecision (3) << e->maxHeading << "deg"
+            << " velocity max=" << e->maxVelocity << "m/s";
+    }
+    out << std::endl;
+}
+
+void SimulatedDrive::resetStats() noexcept {
+    _steps = errorSamples = 0;
+    maxPosition = sumSquaredPosition = maxHeading = maxVelocity = 0.0;
+}
+
+//==============================================================================
+const SimulatedDrive::Command& SimulatedDrive::commandAt (double time) const noexcept {
+    static const Command stopped;
+    for (int i = numCommands; --i >= 0;) {
+        const auto& c = commands[(firstCommand + i) % commands.size()];
+        if (c.time <= time)
+            return c;
+    }
+    return stopped;
+}
+
+double SimulatedDrive::nextCommandAfter (double time) const noexcept {
+    for (int i = 0; i < numCommands; ++i) {
+        const auto& c = commands[(firstCommand + i) % commands.size()];
+        if (c.time > time)
+            return c.time;
+    }
+    return std::numeric_limits<double>::max();
+}
+
+void SimulatedDrive::dropAppliedCommands() noexcept {
+    // keep the newest command that both plants have reached, it's still
+    // being applied.
+    const double reached = _settings.reference ? std::min (_time, referenceTime) : _time;
+    while (numCommands > 1 && commands[(firstCommand + 1) % commands.size()].time <= reached) {
+        firstCommand = (firstCommand + 1) % commands.size();
+        --numCommands;
+    }
+}
+
+void SimulatedDrive::record (double time) {
+    lastSample = (lastSample + 1) % history.size();
+    numSamples = std::min (numSamples + 1, static_cast<int> (history.size()));
+
+    auto& s                 = history[lastSample];
+    s.time                  = time;
+    s.sensors.leftDistance  = plant.GetLeftPosition().value();
+    s.sensors.rightDistance = plant.GetRightPosition().value();
+    s.sensors.leftRate      = plant.GetLeftVelocity().value();
+    s.sensors.rightRate     = plant.GetRightVelocity().value();
+    s.sensors.heading       = plant.GetHeading().Degrees().value();
+}
+
+SimulatedDrive::Sensors SimulatedDrive::sampleAt (double time) const noexcept {
+    if (numSamples == 0)
+        return {};
+
+    // newest first, find the pair either side of the time.
+    const int size = static_cast<int> (history.size());
+    for (int i = 0; i < numSamples; ++i) {
+        const auto& a = history[(lastSample - i + size) % size];
+        if (a.time > time)
+            continue;
+        if (i == 0)
+            return a.sensors;
+
+        const auto& b   = history[(lastSample - i + 1 + size) % size];
+        const double t  = b.time > a.time ? (time - a.time) / (b.time - a.time) : 0.0;
+        auto lerp       = [t] (double x, double y) { return x + (y - x) * t; };
+        Sensors s;
+        s.leftDistance  = lerp (a.sensors.leftDistance, b.sensors.leftDistance);
+        s.rightDistance = lerp (a.sensors.rightDistance, b.sensors.rightDistance);
+        s.leftRate      = lerp (a.sensors.leftRate, b.sensors.leftRate);
+        s.rightRate     = lerp (a.sensors.rightRate, b.sensors.rightRate);
+        s.heading       = lerp (a.sensors.heading, b.sensors.heading);
+        return s;
+    }
+
+    // older than the history goes back, use the oldest.
+    return history[(lastSample - numSamples + 1 + size) % size].sensors;
+}
+
+void SimulatedDrive::measureError() {
+    const auto pose      = plant.GetPose();
+    const auto reference = referencePlant.GetPose();
+    const double dp      = pose.Translation().Distance (reference.Translation()).value();
+    const double dh      = std::abs ((pose.Rotation() - reference.Rotation()).Degrees().value());
+    const double dv      = std::max (
+        std::abs ((plant.GetLeftVelocity() - referencePlant.GetLeftVelocity()).value()),
+        std::abs ((plant.GetRightVelocity() - referencePlant.GetRightVelocity()).value()));
+
+    maxPosition = std::max (maxPosition, dp);
+    maxHeading  = std::max (maxHeading, dh);
+    maxVelocity = std::max (maxVelocity, dv);
+    sumSquaredPosition += dp * dp;
+    ++errorSamples;
+}
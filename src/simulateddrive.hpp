@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <random>
+
+#include <frc/geometry/Pose2d.h>
+#include <frc/simulation/DifferentialDrivetrainSim.h>
+
+/** The simulated drivetrain's physics, stepped apart from the control loop.
+
+    Voltages are recorded as they're sent and the physics is advanced to the
+    current time in fixed steps of `step`, each step taking the voltage the
+    motor controllers were applying when it began. Controllers apply a new
+    output `controller_delay` after it is sent. The sensors read the state
+    `sensor_latency` ago, with noise on the encoder rates and the gyro.
+
+    With `reference` enabled a second copy of the plant is stepped much more
+    finely, applying every voltage exactly when it lands, and the difference
+    between the two is kept as the integration error. Use it to pick a step
+    before trying faster control rates on the robot: if the error is small
+    at the step that matches the rate, the simulation can be trusted there.
+
+    Nothing here allocates after construction.
+*/
+class SimulatedDrive final {
+public:
+    /** see `config.simulation` */
+    struct Settings {
+        /** Physics step (seconds) */
+        double step { 0.001 };
+        /** Time for a motor controller to apply a new output (seconds) */
+        double controllerDelay { 0.001 };
+        /** Age of a sensor reading when it is read (seconds) */
+        double sensorLatency { 0.0 };
+        /** Standard deviation of encoder rate noise (m/s) */
+        double rateNoise { 0.0 };
+        /** Standard deviation of gyro noise (degrees) */
+        double gyroNoise { 0.0 };
+        /** Random seed so runs are repeatable. */
+        unsigned int seed { 5167 };
+        /** Step a fine reference alongside and keep the error. */
+        bool reference { false };
+        /** Reference step (seconds) */
+        double referenceStep { 0.0001 };
+
+        /** Returns settings read from `config.simulation` */
+        static Settings fromConfig();
+    };
+
+    /** What the encoders and gyro read. */
+    struct Sensors {
+        double leftDistance { 0.0 }, rightDistance { 0.0 }; ///> meters
+        double leftRate { 0.0 }, rightRate { 0.0 };         ///> m/s
+        double heading { 0.0 };                             ///> degrees, CCW positive
+    };
+
+    /** Integration error against the reference. */
+    struct Error {
+        double maxPosition { 0.0 };  ///> meters
+        double rmsPosition { 0.0 };  ///> meters
+        double maxHeading { 0.0 };   ///> degrees
+        double maxVelocity { 0.0 };  ///> m/s
+        int64_t samples { 0 };
+    };
+
+    SimulatedDrive (const frc::sim::DifferentialDrivetrainSim& plant, const Settings& settings);
+
+    /** Record the voltage sent to each side at a time (seconds). */
+    void command (double now, double left, double right) noexcept;
+
+    /** Step the physics up to a time (seconds) and update the sensors. */
+    void advance (double now);
+
+    /** Returns the sensors as of the last advance(). */
+    const Sensors& sensors() const noexcept { return _sensors; }
+
+    /** Returns the true pose. */
+    frc::Pose2d pose() const { return plant.GetPose(); }
+
+    /** Returns the current drawn by both sides (amps) */
+    double current() const { return plant.GetCurrentDraw().value(); }
+
+    /** Move the bot, and the reference with it. Clears sensor history. */
+    void setPose (const frc::Pose2d& pose);
+
+    /** Returns the time the physics has reached (seconds) */
+    constexpr double time() const noexcept { return _time; }
+
+    /** Returns physics steps taken since the stats were reset. */
+    constexpr int64_t steps() const noexcept { return _steps; }
+
+    /** Returns the error against the reference since the stats were reset,
+        or nothing if the reference is off.
+    */
+    std::optional<Error> error() const noexcept;
+
+    /** Returns the settings in use. */
+    const Settings& settings() const noexcept { return _settings; }
+
+    /** Write step counts and reference error to a stream. */
+    void report (std::ostream& out) const;
+
+    /** Reset stats. */
+    void resetStats() noexcept;
+
+private:
+    Settings _settings;
+    frc::sim::DifferentialDrivetrainSim plant, referencePlant;
+    double _time { -1.0 }, referenceTime { -1.0 };
+
+    struct Command {
+        double time { 0.0 }; // when it lands at the motors.
+        double left { 0.0 }, right { 0.0 };
+    };
+    std::array<Command, 64> commands {};
+    int firstCommand { 0 }, numCommands { 0 };
+
+    struct Sample {
+        double time { 0.0 };
+        Sensors sensors;
+    };
+    std::array<Sample, 512> history {};
+    int lastSample { 0 }, numSamples { 0 };
+
+    Sensors _sensors;
+    std::mt19937 random;
+    std::normal_distribution<double> unitNoise { 0.0, 1.0 };
+
+    int64_t _steps { 0 }, errorSamples { 0 };
+    double maxPosition { 0.0 }, sumSquaredPosition { 0.0 }, maxHeading { 0.0 }, maxVelocity { 0.0 };
+
+    const Command& commandAt (double time) const noexcept;
+    double nextCommandAfter (double time) const noexcept;
+    void dropAppliedCommands() noexcept;
+    void record (double time);
+    Sensors sampleAt (double time) const noexcept;
+    void measureError();
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+
+namespace snider {
+
+/** Fits motor feedforward gains by ordinary least squares.
+
+    Each sample is a voltage with the velocity and acceleration it produced,
+    fitted to `volts = kS * sign(velocity) + kV * velocity + kA * acceleration`.
+    Only the normal equations are kept, so samples can be added one at a
+    time without storing them.
+*/
+class FeedforwardFit {
+public:
+    /** Fitted gains and how well they explain the samples. */
+    struct Gains {
+        double kS { 0.0 }, kV { 0.0 }, kA { 0.0 };
+        /** Coefficient of determination, 1 is a perfect fit. */
+        double r2 { 0.0 };
+        /** Root mean square error in volts. */
+        double rmse { 0.0 };
+        int64_t samples { 0 };
+    };
+
+    /** Add a sample. */
+    void add (double volts, double velocity, double acceleration) noexcept {
+        const std::array<double, 3> x { sign (velocity), velocity, acceleration };
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 3; ++c)
+                xtx[r][c] += x[r] * x[c];
+            xty[r] += x[r] * volts;
+        }
+        sumY += volts;
+        sumYY += volts * volts;
+        ++count;
+    }
+
+    /** Forget all samples. */
+    void reset() noexcept { *this = {}; }
+
+    /** Returns the number of samples added. */
+    constexpr int64_t size() const noexcept { return count; }
+
+    /** Returns the fitted gains, or nothing if the samples can't separate
+        them e.g. too few, or only one velocity.
+    */
+    std::optional<Gains> solve() const noexcept {
+        if (count < 3)
+            return std::nullopt;
+
+        // gaussian elimination with partial pivoting on [XtX | Xty]
+        std::array<std::array<double, 4>, 3> m;
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 3; ++c)
+                m[r][c] = xtx[r][c];
+            m[r][3] = xty[r];
+        }
+
+        for (int col = 0; col < 3; ++col) {
+            int pivot = col;
+            for (int r = col + 1; r < 3; ++r)
+                if (std::abs (m[r][col]) > std::abs (m[pivot][col]))
+                    pivot = r;
+            if (std::abs (m[pivot][col]) < 1.0e-12 * (1.0 + std::abs (xtx[col][col])))
+                return std::nullopt;
+            std::swap (m[col], m[pivot]);
+
+            for (int r = 0; r < 3; ++r) {
+                if (r == col)
+                    continue;
+                const double f = m[r][col] / m[col][col];
+                for (int c = col; c < 4; ++c)
+                    m[r][c] -= f * m[col][c];
+            }
+        }
+
+        Gains g;
+        const std::array<double, 3> beta { m[0][3] / m[0][0], m[1][3] / m[1][1], m[2][3] / m[2][2] };
+        g.kS      = beta[0];
+        g.kV      = beta[1];
+        g.kA      = beta[2];
+        g.samples = count;
+
+        // residual sum of squares from the normal equations:
+        // yty - 2 b.Xty + b.XtX.b
+        double sse = sumYY;
+        for (int r = 0; r < 3; ++r) {
+            sse -= 2.0 * beta[r] * xty[r];
+            for (int c = 0; c < 3; ++c)
+                sse += beta[r] * xtx[r][c] * beta[c];
+        }
+        sse = std::max (0.0, sse);
+
+        const double n   = static_cast<double> (count);
+        const double sst = sumYY - sumY * sumY / n;
+        g.r2             = sst > 0.0 ? 1.0 - sse / sst : 0.0;
+        g.rmse           = std::sqrt (sse / n);
+        return g;
+    }
+
+private:
+    std::array<std::array<double, 3>, 3> xtx {};
+    std::array<double, 3> xty {};
+    double sumY { 0.0 }, sumYY { 0.0 };
+    int64_t count { 0 };
+
+    static constexpr double sign (double x) noexcept { return x > 0.0 ? 1.0 : x < 0.0 ? -1.0 : 0.0; }
+};
+
+} // namespace snider
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace snider {
+
+/** Measures how far a periodic loop strays from its expected period.
+
+    Call tick() once per iteration. Jitter is the absolute difference between
+    the measured interval and the expected one. Values are kept in a fixed
+    histogram so percentiles can be reported without allocating.
+*/
+class JitterMonitor final {
+public:
+    using clock = std::chrono::steady_clock;
+
+    /** @param expected The loop period. */
+    explicit JitterMonitor (std::chrono::nanoseconds expected)
+        : period (expected) {}
+
+    ~JitterMonitor() = default;
+
+    /** Histogram bin width in microseconds. */
+    static constexpr int64_t BinMicros = 50;
+
+    /** Number of bins. The last one collects everything beyond. */
+    static constexpr std::size_t NumBins = 200;
+
+    /** Record an iteration happening now. */
+    void tick() noexcept { tick (clock::now()); }
+
+    /** Record an iteration happening at a given time. */
+    void tick (clock::time_point now) noexcept {
+        if (last != clock::time_point {}) {
+            const auto interval = now - last;
+            const auto jitter   = interval > period ? interval - period : period - interval;
+            const auto us       = std::chrono::duration_cast<std::chrono::microseconds> (jitter).count();
+            ++bins[std::min<std::size_t> (static_cast<std::size_t> (us / BinMicros), NumBins - 1)];
+            ++_count;
+            _total += us;
+            _max = std::max<int64_t> (_max, us);
+        }
+        last = now;
+    }
+
+    /** Forget all measurements. */
+    void reset() noexcept {
+        bins.fill (0);
+        _count = _total = _max = 0;
+        last               = {};
+    }
+
+    /** Returns the number of intervals measured. */
+    constexpr int64_t count() const noexcept { return _count; }
+
+    /** Returns the mean jitter in microseconds. */
+    double meanMicros() const noexcept {
+        return _count > 0 ? static_cast<double> (_total) / static_cast<double> (_count) : 0.0;
+    }
+
+    /** Returns the worst jitter in microseconds. */
+    constexpr int64_t maxMicros() const noexcept { return _max; }
+
+    /** Returns an upper bound of the given percentile in microseconds.
+        @param p Percentile 0.0 to 1.0
+    */
+    int64_t percentileMicros (double p) const noexcept {
+        if (_count <= 0)
+            return 0;
+        const auto target = static_cast<int64_t> (p * static_cast<double> (_count));
+        int64_t seen      = 0;
+        for (std::size_t i = 0; i < NumBins; ++i) {
+            seen += bins[i];
+            if (seen > target)
+                return std::min<int64_t> (_max, static_cast<int64_t> (i + 1) * BinMicros);
+        }
+        return _max;
+    }
+
+private:
+    std::chrono::nanoseconds period;
+    clock::time_point last {};
+    std::array<uint32_t, NumBins> bins {};
+    int64_t _count { 0 }, _total { 0 }, _max { 0 };
+};
+
+} // namespace snider
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace snider {
+
+/** Decides when an output value actually needs to be sent.
+
+    A value within epsilon of the last one sent is suppressed, unless the
+    keep-alive interval has passed since the last send. The first value is
+    always sent. Counts sent and suppressed values.
+*/
+class OutputCache final {
+public:
+    using clock = std::chrono::steady_clock;
+
+    /** @param epsilon Values closer than this to the last one are suppressed.
+        @param keepAlive Resend at least this often, even if unchanged.
+    */
+    OutputCache (double epsilon, clock::duration keepAlive) noexcept
+        : _epsilon (std::abs (epsilon)), _keepAlive (keepAlive) {}
+
+    OutputCache() : OutputCache (0.0, clock::duration::zero()) {}
+    ~OutputCache() = default;
+
+    /** Returns true if the value should be sent and records it as sent.
+        Otherwise counts it as suppressed.
+    */
+    bool update (double value, clock::time_point now) noexcept {
+        if (valid && std::abs (value - last) <= _epsilon && now - lastSent < _keepAlive) {
+            ++_suppressed;
+            return false;
+        }
+
+        valid    = true;
+        last     = value;
+        lastSent = now;
+        ++_sent;
+        return true;
+    }
+
+    /** Same as above using the current time. */
+    bool update (double value) noexcept { return update (value, clock::now()); }
+
+    /** Forget the last value so the next one is always sent. */
+    void invalidate() noexcept { valid = false; }
+
+    /** Returns the last value sent. */
+    constexpr double lastValue() const noexcept { return last; }
+
+    /** Returns the number of values sent. */
+    constexpr int64_t sent() const noexcept { return _sent; }
+
+    /** Returns the number of values suppressed. */
+    constexpr int64_t suppressed() const noexcept { return _suppressed; }
+
+    /** Reset the counters. */
+    void resetCounts() noexcept { _sent = _suppressed = 0; }
+
+private:
+    double _epsilon;
+    clock::duration _keepAlive;
+    bool valid { false };
+    double last { 0.0 };
+    clock::time_point lastSent {};
+    int64_t _sent { 0 }, _suppressed { 0 };
+};
+
+} // namespace snider
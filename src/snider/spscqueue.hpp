@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace snider {
+
+/** A lock-free, fixed capacity, single producer single consumer queue.
+
+    Exactly one thread may push and exactly one other thread may pop. Neither
+    side allocates, locks or blocks, which makes it safe to use from the
+    realtime callbacks.
+
+    @tparam T A copyable type.
+    @tparam Capacity Maximum items held. Must be a power of two.
+*/
+template <typename T, std::size_t Capacity>
+class SpscQueue final {
+    static_assert (Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                   "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue()  = default;
+    ~SpscQueue() = default;
+
+    SpscQueue (const SpscQueue&)            = delete;
+    SpscQueue& operator= (const SpscQueue&) = delete;
+
+    /** Push an item. Producer thread only.
+        @returns false if the queue is full.
+    */
+    bool push (const T& item) noexcept {
+        const auto h = head.load (std::memory_order_relaxed);
+        if (h - tail.load (std::memory_order_acquire) >= Capacity)
+            return false;
+        buffer[h & mask] = item;
+        head.store (h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Pop an item. Consumer thread only.
+        @returns false if the queue is empty.
+    */
+    bool pop (T& item) noexcept {
+        const auto t = tail.load (std::memory_order_relaxed);
+        if (t == head.load (std::memory_order_acquire))
+            return false;
+        item = buffer[t & mask];
+        tail.store (t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Returns the approximate number of items queued. */
+    std::size_t size() const noexcept {
+        return head.load (std::memory_order_acquire) - tail.load (std::memory_order_acquire);
+    }
+
+    /** Returns true if nothing is queued. */
+    bool empty() const noexcept { return size() == 0; }
+
+    /** Returns the maximum number of items. */
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+private:
+    static constexpr std::size_t mask = Capacity - 1;
+    // keep the indexes on separate cache lines so the two threads don't fight.
+    alignas (64) std::atomic<std::size_t> head { 0 };
+    alignas (64) std::atomic<std::size_t> tail { 0 };
+    std::array<T, Capacity> buffer {};
+};
+
+} // namespace snider
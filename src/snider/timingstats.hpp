@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace snider {
+
+/** Accumulates execution times of a repeating task.
+
+    Cheap enough to use inside the realtime callbacks. It does not allocate or
+    lock, it only keeps a count, a total, the last and the worst time.
+*/
+class TimingStats {
+public:
+    using clock    = std::chrono::steady_clock;
+    using duration = std::chrono::nanoseconds;
+
+    TimingStats()  = default;
+    ~TimingStats() = default;
+
+    /** Times a block of code and adds the result when it goes out of scope. */
+    class Scope final {
+    public:
+        Scope() = delete;
+        explicit Scope (TimingStats& s) noexcept
+            : stats (s), start (clock::now()) {}
+        ~Scope() { stats.add (clock::now() - start); }
+
+        Scope (const Scope&)            = delete;
+        Scope& operator= (const Scope&) = delete;
+
+    private:
+        TimingStats& stats;
+        clock::time_point start;
+    };
+
+    /** Add an elapsed time. */
+    void add (duration elapsed) noexcept {
+        ++_count;
+        _last = elapsed;
+        _total += elapsed;
+        _max = std::max (_max, elapsed);
+    }
+
+    /** Clear all values. */
+    void reset() noexcept {
+        _count = 0;
+        _last = _total = _max = duration::zero();
+    }
+
+    /** Returns the number of times added. */
+    constexpr int64_t count() const noexcept { return _count; }
+
+    /** Returns the last time added. */
+    constexpr duration last() const noexcept { return _last; }
+
+    /** Returns the longest time added. */
+    constexpr duration max() const noexcept { return _max; }
+
+    /** Returns the sum of all times added. */
+    constexpr duration total() const noexcept { return _total; }
+
+    /** Returns the last time in microseconds. */
+    double lastMicros() const noexcept { return micros (_last); }
+
+    /** Returns the longest time in microseconds. */
+    double maxMicros() const noexcept { return micros (_max); }
+
+    /** Returns the average time in microseconds. */
+    double averageMicros() const noexcept {
+        return _count > 0 ? micros (_total) / static_cast<double> (_count) : 0.0;
+    }
+
+private:
+    int64_t _count { 0 };
+    duration _last { duration::zero() },
+        _total { duration::zero() },
+        _max { duration::zero() };
+
+    static double micros (duration d) noexcept {
+        return std::chrono::duration<double, std::micro> (d).count();
+    }
+};
+
+/** TimingStats that one thread can add to while another reads or resets.
+
+    Each value is a separate relaxed atomic, so a reader racing an add can see
+    the new count with the old total. That's fine for reporting, and still
+    doesn't lock or allocate.
+*/
+class AtomicTimingStats {
+public:
+    using clock    = TimingStats::clock;
+    using duration = TimingStats::duration;
+
+    AtomicTimingStats()  = default;
+    ~AtomicTimingStats() = default;
+
+    /** Times a block of code and adds the result when it goes out of scope. */
+    class Scope final {
+    public:
+        Scope() = delete;
+        explicit Scope (AtomicTimingStats& s) noexcept
+            : stats (s), start (clock::now()) {}
+        ~Scope() { stats.add (clock::now() - start); }
+
+        Scope (const Scope&)            = delete;
+        Scope& operator= (const Scope&) = delete;
+
+    private:
+        AtomicTimingStats& stats;
+        clock::time_point start;
+    };
+
+    /** Add an elapsed time. */
+    void add (duration elapsed) noexcept {
+        const auto ns = elapsed.count();
+        _count.fetch_add (1, std::memory_order_relaxed);
+        _last.store (ns, std::memory_order_relaxed);
+        _total.fetch_add (ns, std::memory_order_relaxed);
+        auto worst = _max.load (std::memory_order_relaxed);
+        while (ns > worst && ! _max.compare_exchange_weak (worst, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    /** Clear all values. */
+    void reset() noexcept {
+        for (auto* value : { &_count, &_last, &_total, &_max })
+            value->store (0, std::memory_order_relaxed);
+    }
+
+    /** Returns the number of times added. */
+    int64_t count() const noexcept { return _count.load (std::memory_order_relaxed); }
+
+    /** Returns the last time added. */
+    duration last() const noexcept { return duration (_last.load (std::memory_order_relaxed)); }
+
+    /** Returns the longest time added. */
+    duration max() const noexcept { return duration (_max.load (std::memory_order_relaxed)); }
+
+    /** Returns the sum of all times added. */
+    duration total() const noexcept { return duration (_total.load (std::memory_order_relaxed)); }
+
+    /** Returns the last time in microseconds. */
+    double lastMicros() const noexcept { return micros (last()); }
+
+    /** Returns the longest time in microseconds. */
+    double maxMicros() const noexcept { return micros (max()); }
+
+    /** Returns the average time in microseconds. */
+    double averageMicros() const noexcept {
+        const auto n = count();
+        return n > 0 ? micros (total()) / static_cast<double> (n) : 0.0;
+    }
+
+private:
+    std::atomic<int64_t> _count { 0 }, _last { 0 }, _total { 0 }, _max { 0 };
+
+    static double micros (duration d) noexcept {
+        return std::chrono::duration<double, std::micro> (d).count();
+    }
+};
+
+} // namespace snider
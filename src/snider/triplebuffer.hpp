@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace snider {
+
+/** Hands the latest value from one thread to another without locking.
+
+    The writer fills the back buffer and publishes it, the reader picks up the
+    newest published buffer when it's ready. Neither side blocks or waits on
+    the other. Values published faster than they're read are skipped, only
+    the newest is seen.
+
+    After publish() the writer gets an older buffer back, so it should write
+    every field each time.
+
+    @tparam T A default constructible type.
+*/
+template <typename T>
+class TripleBuffer final {
+public:
+    TripleBuffer()  = default;
+    ~TripleBuffer() = default;
+
+    TripleBuffer (const TripleBuffer&)            = delete;
+    TripleBuffer& operator= (const TripleBuffer&) = delete;
+
+    /** Returns the buffer to write. Writer thread only. */
+    T& write() noexcept { return buffers[back]; }
+
+    /** Publish the write buffer. Writer thread only. */
+    void publish() noexcept {
+        const auto old = middle.exchange (static_cast<uint8_t> (back | fresh), std::memory_order_acq_rel);
+        back           = old & index;
+    }
+
+    /** Pick up the newest published buffer. Reader thread only.
+        @returns true if there was a new one.
+    */
+    bool update() noexcept {
+        if ((middle.load (std::memory_order_relaxed) & fresh) == 0)
+            return false;
+        const auto old = middle.exchange (front, std::memory_order_acq_rel);
+        front          = old & index;
+        return true;
+    }
+
+    /** Returns the buffer picked up by the last update(). Reader thread only. */
+    const T& read() const noexcept { return buffers[front]; }
+
+private:
+    enum : uint8_t { index = 0x03, fresh = 0x04 };
+    std::array<T, 3> buffers {};
+    // index of the buffer between writer and reader, plus the fresh bit.
+    std::atomic<uint8_t> middle { 1 };
+    uint8_t back { 0 }, front { 2 };
+};
+
+} // namespace snider
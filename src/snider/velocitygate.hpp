@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+namespace snider {
+
+/** Says when a mechanism has reached its target speed.
+
+    Ready once the measured speed has been within `enter` of the target for
+    `settle` updates in a row, then stays ready until it strays further than
+    `exit`. Tolerances are fractions of the target so one gate works at any
+    target. The gap between the two keeps a noisy reading near the edge from
+    toggling readiness every update.
+*/
+class VelocityGate {
+public:
+    /** @param enter Fraction of the target to be within to become ready.
+        @param exit Fraction of the target to stray past to stop being ready.
+                    Clamped to at least `enter`.
+        @param settle Updates in a row within `enter` to become ready.
+    */
+    VelocityGate (double enter, double exit, int settle) noexcept
+        : enterTolerance (std::abs (enter)),
+          exitTolerance (std::max (enterTolerance, std::abs (exit))),
+          settleCount (std::max (1, settle)) {}
+
+    /** Compare a measured speed to the target. Returns true if ready. */
+    bool update (double target, double measured) noexcept {
+        const double error = std::abs (measured - target);
+        const double scale = std::abs (target);
+
+        if (_ready) {
+            _ready = error <= exitTolerance * scale;
+            inside = _ready ? inside : 0;
+            return _ready;
+        }
+
+        inside = error <= enterTolerance * scale ? inside + 1 : 0;
+        _ready = inside >= settleCount;
+        return _ready;
+    }
+
+    /** Start over, not ready. */
+    void reset() noexcept {
+        _ready = false;
+        inside = 0;
+    }
+
+    /** Returns true if ready as of the last update. */
+    constexpr bool ready() const noexcept { return _ready; }
+
+private:
+    double enterTolerance, exitTolerance;
+    int settleCount;
+    int inside { 0 };
+    bool _ready { false };
+};
+
+} // namespace snider
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace snider {
+
+/** A fixed set of threads that run batches of independent jobs.
+
+    A batch of `count` jobs is split evenly between the workers, the calling
+    thread included. Each worker takes jobs from the front of its own range
+    and once that runs dry steals the back half of the fullest range left,
+    so uneven jobs still keep every core busy. Ranges are a pair of indexes
+    packed in one atomic, taking and stealing never lock.
+
+    Jobs must not throw. One batch runs at a time.
+*/
+class WorkPool final {
+public:
+    /** A job is called with its index in the batch and the worker running
+        it, 0 to size() - 1. Worker 0 is the thread that called run().
+    */
+    using Job = std::function<void (int index, int worker)>;
+
+    /** Start the threads. 0 uses one worker per hardware thread. */
+    explicit WorkPool (int workers = 0) {
+        if (workers <= 0)
+            workers = static_cast<int> (std::max (1u, std::thread::hardware_concurrency()));
+        ranges = std::make_unique<Range[]> (workers);
+        total  = workers;
+        for (int i = 1; i < workers; ++i)
+            threads.emplace_back ([this, i]() { loop (i); });
+    }
+
+    ~WorkPool() {
+        {
+            std::lock_guard<std::mutex> sl (lock);
+            stopping = true;
+        }
+        started.notify_all();
+        for (auto& t : threads)
+            t.join();
+    }
+
+    WorkPool (const WorkPool&)            = delete;
+    WorkPool& operator= (const WorkPool&) = delete;
+
+    /** Returns the number of workers, the calling thread included. */
+    int size() const noexcept { return total; }
+
+    /** Run jobs 0 to count - 1 and return once all have finished. */
+    void run (int count, const Job& job) {
+        if (count <= 0)
+            return;
+
+        {
+            std::lock_guard<std::mutex> sl (lock);
+            for (int i = 0; i < total; ++i) {
+                const auto begin = static_cast<uint32_t> (static_cast<int64_t> (count) * i / total);
+                const auto end   = static_cast<uint32_t> (static_cast<int64_t> (count) * (i + 1) / total);
+                ranges[i].value.store (pack (begin, end), std::memory_order_relaxed);
+            }
+            current = &job;
+            busy    = total - 1;
+            ++generation;
+        }
+        started.notify_all();
+
+        work (0, job);
+
+        std::unique_lock<std::mutex> sl (lock);
+        finished.wait (sl, [this]() { return busy == 0; });
+        current = nullptr;
+    }
+
+private:
+    struct alignas (64) Range {
+        std::atomic<uint64_t> value { 0 };
+    };
+
+    std::unique_ptr<Range[]> ranges;
+    int total { 1 };
+    std::vector<std::thread> threads;
+
+    std::mutex lock;
+    std::condition_variable started, finished;
+    const Job* current { nullptr };
+    uint64_t generation { 0 };
+    int busy { 0 };
+    bool stopping { false };
+
+    static constexpr uint64_t pack (uint32_t begin, uint32_t end) noexcept {
+        return (static_cast<uint64_t> (begin) << 32) | end;
+    }
+    static constexpr uint32_t begin (uint64_t r) noexcept { return static_cast<uint32_t> (r >> 32); }
+    static constexpr uint32_t end (uint64_t r) noexcept { return static_cast<uint32_t> (r); }
+
+    void loop (int worker) {
+        uint64_t seen = 0;
+        for (;;) {
+            const Job* job = nullptr;
+            {
+                std::unique_lock<std::mutex> sl (lock);
+                started.wait (sl, [&]() { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+                job  = current;
+            }
+
+            work (worker, *job);
+
+            {
+                std::lock_guard<std::mutex> sl (lock);
+                --busy;
+            }
+            finished.notify_one();
+        }
+    }
+
+    void work (int worker, const Job& job) {
+        for (;;) {
+            int index = 0;
+            while (take (worker, index))
+                job (index, worker);
+            if (! steal (worker))
+                return;
+        }
+    }
+
+    // take the next job from the front of our own range.
+    bool take (int worker, int& index) noexcept {
+        auto& range = ranges[worker].value;
+        auto r      = range.load (std::memory_order_acquire);
+        while (begin (r) < end (r)) {
+            if (range.compare_exchange_weak (r, pack (begin (r) + 1, end (r)), std::memory_order_acq_rel)) {
+                index = static_cast<int> (begin (r));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // move the back half of the fullest range into ours. false when there
+    // is nothing left anywhere.
+    bool steal (int worker) noexcept {
+        for (;;) {
+            int victim        = -1;
+            uint32_t mostLeft = 0;
+            for (int i = 0; i < total; ++i) {
+                const auto r = ranges[i].value.load (std::memory_order_acquire);
+                if (i != worker && end (r) - begin (r) > mostLeft) {
+                    mostLeft = end (r) - begin (r);
+                    victim   = i;
+                }
+            }
+            if (victim < 0)
+                return false;
+
+            auto& range = ranges[victim].value;
+            auto r      = range.load (std::memory_order_acquire);
+            if (begin (r) >= end (r))
+                continue;
+            const uint32_t middle = begin (r) + (end (r) - begin (r)) / 2;
+            if (range.compare_exchange_strong (r, pack (begin (r), middle), std::memory_order_acq_rel)) {
+                ranges[worker].value.store (pack (middle, end (r)), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+};
+
+} // namespace snider
@@ -0,0 +1,52 @@
+#include <algorithm>
+
+#include "scripting.hpp"
+#include "syntheticvision.hpp"
+
+SyntheticVision::Settings SyntheticVision::Settings::fromConfig() {
+    Settings s;
+    sol::object obj = lua::config::get ("vision", "synthetic");
+    if (! obj.is<sol::table>())
+        return s;
+
+    sol::table tbl = obj;
+    s.enabled      = tbl.get_or ("enabled", s.enabled);
+    s.period       = units::millisecond_t (tbl.get_or ("period", 100.0));
+    s.latency      = units::millisecond_t (tbl.get_or ("latency", 50.0));
+    s.noiseXY      = tbl.get_or ("noise_xy", s.noiseXY);
+    s.noiseTheta   = tbl.get_or ("noise_theta", s.noiseTheta);
+    s.seed         = tbl.get_or ("seed", s.seed);
+    return s;
+}
+
+SyntheticVision::SyntheticVision (const Settings& s)
+    : _settings (s),
+      random (s.seed),
+      noiseXY (0.0, std::max (0.0, s.noiseXY)),
+      noiseTheta (0.0, std::max (0.0, s.noiseTheta)) {}
+
+std::optional<VisionMeasurement> SyntheticVision::sample (const frc::Pose2d& truth, units::second_t now) {
+    truths.add (now, truth);
+
+    if (! started) {
+        started  = true;
+        nextTime = now + _settings.latency;
+    }
+    if (now < nextTime)
+        return std::nullopt;
+    nextTime += std::max (_settings.period, units::second_t (0.001));
+    if (nextTime < now)
+        nextTime = now + _settings.period;
+
+    VisionMeasurement m;
+    m.timestamp = now - _settings.latency;
+    const auto seen = truths.poseAt (m.timestamp).value_or (truth);
+    m.pose          = frc::Pose2d (
+        seen.X() + units::meter_t (noiseXY (random)),
+        seen.Y() + units::meter_t (noiseXY (random)),
+        seen.Rotation() + frc::Rotation2d (units::radian_t (noiseTheta (random))));
+    m.stdDevs = { std::max (0.01, _settings.noiseXY),
+                  std::max (0.01, _settings.noiseXY),
+                  std::max (0.01, _settings.noiseTheta) };
+    return m;
+}
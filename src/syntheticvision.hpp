@@ -0,0 +1,56 @@
+#pragma once
+
+#include <optional>
+#include <random>
+
+#include <frc/geometry/Pose2d.h>
+#include <units/time.h>
+
+#include "poseestimator.hpp"
+#include "posehistory.hpp"
+
+/** Generates fake vision measurements from a known pose.
+
+    Used in simulation and tests so the pose estimator can be exercised
+    without a camera. Measurements arrive at a fixed rate, describe where the
+    bot was `latency` ago and have gaussian noise added.
+*/
+class SyntheticVision final {
+public:
+    /** see `config.vision.synthetic` */
+    struct Settings {
+        bool enabled { false };
+        /** Time between measurements. */
+        units::second_t period { 0.1 };
+        /** How old a measurement is when it arrives. */
+        units::second_t latency { 0.05 };
+        /** Standard deviation of the position noise in meters. */
+        double noiseXY { 0.05 };
+        /** Standard deviation of the heading noise in radians. */
+        double noiseTheta { 0.02 };
+        /** Random seed so runs are repeatable. */
+        unsigned int seed { 9431 };
+
+        /** Returns settings read from `config.vision.synthetic` */
+        static Settings fromConfig();
+    };
+
+    explicit SyntheticVision (const Settings& settings = Settings::fromConfig());
+    ~SyntheticVision() = default;
+
+    /** Record the true pose at a time and return a measurement if one is due.
+        Call at least as often as the measurement period.
+    */
+    std::optional<VisionMeasurement> sample (const frc::Pose2d& truth, units::second_t now);
+
+    /** Returns the settings in use. */
+    const Settings& settings() const noexcept { return _settings; }
+
+private:
+    Settings _settings;
+    PoseHistory<128> truths;
+    units::second_t nextTime { 0.0 };
+    bool started { false };
+    std::mt19937 random;
+    std::normal_distribution<double> noiseXY, noiseTheta;
+};
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#include <frc/geometry/Pose2d.h>
+#include <frc/smartdashboard/Field2d.h>
+#include <frc/smartdashboard/SmartDashboard.h>
+#include <networktables/BooleanTopic.h>
+#include <networktables/DoubleTopic.h>
+#include <networktables/IntegerTopic.h>
+#include <networktables/NetworkTable.h>
+#include <networktables/NetworkTableInstance.h>
+
+#include "realtime.hpp"
+#include "telemetry.hpp"
+
+namespace detail {
+
+template <typename T>
+struct TelemetryField {
+    const char* name;
+    T TelemetryFrame::*member;
+};
+
+// clang-format off
+static constexpr std::array<TelemetryField<double>, 11> doubleFields { {
+    { "drivetrain/pose_x",         &TelemetryFrame::poseX },
+    { "drivetrain/pose_y",         &TelemetryFrame::poseY },
+    { "drivetrain/heading",        &TelemetryFrame::poseHeading },
+    { "drivetrain/left_velocity",  &TelemetryFrame::leftVelocity },
+    { "drivetrain/right_velocity", &TelemetryFrame::rightVelocity },
+    { "drivetrain/left_target",    &TelemetryFrame::leftTarget },
+    { "drivetrain/right_target",   &TelemetryFrame::rightTarget },
+    { "drivetrain/left_volts",     &TelemetryFrame::leftVolts },
+    { "drivetrain/right_volts",    &TelemetryFrame::rightVolts },
+    { "shooter/level",             &TelemetryFrame::shootLevel },
+    { "loop/jitter_max",           &TelemetryFrame::loopJitterMax }
+} };
+
+static constexpr std::array<TelemetryField<int64_t>, 1> integerFields { {
+    { "shooter/state",             &TelemetryFrame::shooterState }
+} };
+
+static constexpr std::array<TelemetryField<bool>, 1> booleanFields { {
+    { "lua/error",                 &TelemetryFrame::luaError }
+} };
+// clang-format on
+
+} // namespace detail
+
+//==============================================================================
+struct Telemetry::Publishers {
+    std::array<nt::DoublePublisher, detail::doubleFields.size()> doubles;
+    std::array<nt::IntegerPublisher, detail::integerFields.size()> integers;
+    std::array<nt::BooleanPublisher, detail::booleanFields.size()> booleans;
+    frc::Field2d field;
+};
+
+Telemetry::Telemetry()
+    : publishers (std::make_unique<Publishers>()) {
+    auto table = nt::NetworkTableInstance::GetDefault().GetTable ("Telemetry");
+    for (std::size_t i = 0; i < detail::doubleFields.size(); ++i)
+        publishers->doubles[i] = table->GetDoubleTopic (detail::doubleFields[i].name).Publish();
+    for (std::size_t i = 0; i < detail::integerFields.size(); ++i)
+        publishers->integers[i] = table->GetIntegerTopic (detail::integerFields[i].name).Publish();
+    for (std::size_t i = 0; i < detail::booleanFields.size(); ++i)
+        publishers->booleans[i] = table->GetBooleanTopic (detail::booleanFields[i].name).Publish();
+}
+
+Telemetry::~Telemetry() {
+    stop();
+}
+
+void Telemetry::start (int periodMs) {
+    if (thread.joinable())
+        return;
+    frc::SmartDashboard::PutData ("Field", &publishers->field);
+    shouldExit.store (false, std::memory_order_release);
+    thread = std::thread (&Telemetry::run, this, std::max (1, periodMs));
+}
+
+void Telemetry::stop() {
+    shouldExit.store (true, std::memory_order_release);
+    if (thread.joinable())
+        thread.join();
+}
+
+int Telemetry::flush() {
+    if (! buffer.update())
+        return 0;
+
+    snider::AtomicTimingStats::Scope timed (cost);
+    const auto& frame = buffer.read();
+    const bool all    = ! publishedOnce;
+    int count         = 0;
+
+    for (std::size_t i = 0; i < detail::doubleFields.size(); ++i) {
+        const auto member = detail::doubleFields[i].member;
+        if (all || frame.*member != last.*member) {
+            publishers->doubles[i].Set (frame.*member);
+            ++count;
+        }
+    }
+    for (std::size_t i = 0; i < detail::integerFields.size(); ++i) {
+        const auto member = detail::integerFields[i].member;
+        if (all || frame.*member != last.*member) {
+            publishers->integers[i].Set (frame.*member);
+            ++count;
+        }
+    }
+    for (std::size_t i = 0; i < detail::booleanFields.size(); ++i) {
+        const auto member = detail::booleanFields[i].member;
+        if (all || frame.*member != last.*member) {
+            publishers->booleans[i].Set (frame.*member);
+            ++count;
+        }
+    }
+
+    if (all || frame.poseX != last.poseX || frame.poseY != last.poseY || frame.poseHeading != last.poseHeading) {
+        publishers->field.SetRobotPose (frc::Pose2d (units::meter_t (frame.poseX),
+                                             units::meter_t (frame.poseY),
+                                             units::degree_t (frame.poseHeading)));
+    }
+
+    last          = frame;
+    publishedOnce = true;
+    flushes.fetch_add (1, std::memory_order_relaxed);
+    fields.fetch_add (count, std::memory_order_relaxed);
+    return count;
+}
+
+void Telemetry::run (int periodMs) {
+    using namespace std::chrono;
+    rt::lowerPriority (5);
+
+    const auto period = milliseconds (periodMs);
+    auto next         = steady_clock::now();
+    while (! shouldExit.load (std::memory_order_acquire)) {
+        flush();
+        next += period;
+        std::this_thread::sleep_until (next);
+    }
+}
+
+void Telemetry::report (std::ostream& out) const {
+    const auto n = flushes.load (std::memory_order_relaxed);
+    out << "[telemetry] flushes=" << n
+        << " fields=" << fields.load (std::memory_order_relaxed)
+        << std::fixed << std::setprecision (1)
+        << " avg=" << cost.averageMicros() << "us"
+        << " max=" << cost.maxMicros() << "us"
+        << std::endl;
+}
+
+void Telemetry::resetStats() noexcept {
+    flushes.store (0, std::memory_order_relaxed);
+    fields.store (0, std::memory_order_relaxed);
+    cost.reset();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <thread>
+
+#include "snider/timingstats.hpp"
+#include "snider/triplebuffer.hpp"
+
+/** Everything sent to the dashboard, filled in by the subsystems. */
+struct TelemetryFrame {
+    // Drivetrain
+    double poseX { 0.0 };       ///> meters
+    double poseY { 0.0 };       ///> meters
+    double poseHeading { 0.0 }; ///> degrees
+    double leftVelocity { 0.0 }, rightVelocity { 0.0 }; ///> m/s
+    double leftTarget { 0.0 }, rightTarget { 0.0 };     ///> m/s
+    double leftVolts { 0.0 }, rightVolts { 0.0 };
+
+    // Shooter
+    int64_t shooterState { 0 };
+    double shootLevel { 0.0 };
+
+    // Main loop
+    double loopJitterMax { 0.0 }; ///> microseconds
+    bool luaError { false };
+};
+
+/** Publishes a TelemetryFrame to NetworkTables off the control thread.
+
+    The control thread fills write() and calls commit(), which only swaps a
+    triple buffer index. A background thread picks up the newest frame at
+    `config.telemetry.period` and publishes the fields that changed since
+    last time with NT4 publishers under `/Telemetry`. The robot pose also
+    goes to the "Field" widget.
+*/
+class Telemetry final {
+public:
+    Telemetry();
+    ~Telemetry();
+
+    Telemetry (const Telemetry&)            = delete;
+    Telemetry& operator= (const Telemetry&) = delete;
+
+    /** Returns the frame to fill. Control thread only. */
+    TelemetryFrame& write() noexcept { return buffer.write(); }
+
+    /** Hand the filled frame to the publisher. Control thread only. */
+    void commit() noexcept { buffer.publish(); }
+
+    /** Start publishing in the background. */
+    void start (int periodMs);
+
+    /** Stop the background thread. */
+    void stop();
+
+    /** Publish changes in the newest committed frame. Called by the
+        background thread, or directly when not started.
+        @returns the number of fields published.
+    */
+    int flush();
+
+    /** Write publishing counts and cost to a stream. Any thread. */
+    void report (std::ostream& out) const;
+
+    /** Reset counts and cost. Any thread. */
+    void resetStats() noexcept;
+
+private:
+    struct Publishers;
+    std::unique_ptr<Publishers> publishers;
+    snider::TripleBuffer<TelemetryFrame> buffer;
+    TelemetryFrame last;
+    bool publishedOnce { false };
+
+    std::thread thread;
+    std::atomic<bool> shouldExit { false };
+
+    std::atomic<int64_t> flushes { 0 }, fields { 0 };
+    snider::AtomicTimingStats cost;
+
+    void run (int periodMs);
+};
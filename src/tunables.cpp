@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <networktables/DoubleTopic.h>
+#include <networktables/NetworkTableInstance.h>
+
+#include "config.hpp"
+#include "scripting.hpp"
+#include "tunables.hpp"
+
+namespace detail {
+
+struct TunableInfo {
+    Tunable id;
+    std::string_view category;
+    std::string_view symbol;
+    double fallback;
+};
+
+// where each value comes from in config.lua, and its value if missing.
+static constexpr std::array<TunableInfo, Tunables::NumValues> tunableInfo { {
+    { Tunable::DriveP, "drivetrain", "kp", 8.5 },
+    { Tunable::DriveI, "drivetrain", "ki", 0.0 },
+    { Tunable::DriveD, "drivetrain", "kd", 0.0 },
+    { Tunable::DriveS, "drivetrain", "ks", 1.0 },
+    { Tunable::DriveV, "drivetrain", "kv", 3.0 },
+    { Tunable::DriveA, "drivetrain", "ka", 0.0 },
+    { Tunable::RotationThrottle, "drivetrain", "rotation_throttle", 0.54 },
+    { Tunable::ShootPower, "shooter", "shoot_power", 12.0 },
+    { Tunable::IntakePrimaryPower, "shooter", "intake_primary_power", 5.0 },
+    { Tunable::IntakeSecondaryPower, "shooter", "intake_secondary_power", 4.0 },
+} };
+
+// range from config.tunables[category][symbol] = { min, max }
+static std::pair<double, double> readRange (const TunableInfo& info) {
+    std::pair<double, double> range { -1.0e9, 1.0e9 };
+    sol::object cat = lua::config::get ("tunables", info.category);
+    if (! cat.is<sol::table>())
+        return range;
+    sol::object obj = cat.as<sol::table>()[info.symbol];
+    if (! obj.is<sol::table>())
+        return range;
+
+    sol::table tbl = obj;
+    range.first    = tbl.get_or (1, range.first);
+    range.second   = tbl.get_or (2, range.second);
+    if (range.second < range.first)
+        std::swap (range.first, range.second);
+    return range;
+}
+
+} // namespace detail
+
+//==============================================================================
+struct Tunables::NetworkTables {
+    std::array<nt::DoubleEntry, NumValues> entries;
+    std::vector<NT_Listener> listeners;
+};
+
+//==============================================================================
+Tunables::Reader::Reader (Reader&& other) noexcept
+    : owner (other.owner), slot (other.slot) {
+    other.owner = nullptr;
+}
+
+Tunables::Reader::~Reader() {
+    if (owner != nullptr)
+        owner->releaseSlot (slot);
+}
+
+Tunables::Block Tunables::Reader::read() const noexcept {
+    return owner->read (slot);
+}
+
+//==============================================================================
+Tunables& Tunables::get() {
+    static Tunables instance;
+    return instance;
+}
+
+Tunables::Tunables() {
+    for (const auto& info : detail::tunableInfo) {
+        const auto i = index (info.id);
+        ranges[i]    = detail::readRange (info);
+        shadow.values[i] = std::clamp (config::number (info.category, info.symbol, info.fallback),
+                                       ranges[i].first,
+                                       ranges[i].second);
+    }
+
+    std::lock_guard<std::mutex> sl (writeLock);
+    publish();
+}
+
+Tunables::~Tunables() {
+    stopNetworkTables();
+}
+
+Tunables::Reader Tunables::reader() {
+    for (int i = 0; i < MaxReaders; ++i) {
+        bool expected = false;
+        if (slotsUsed[i].compare_exchange_strong (expected, true))
+            return Reader (*this, i);
+    }
+    throw std::runtime_error ("Tunables: too many readers");
+}
+
+void Tunables::releaseSlot (int slot) noexcept {
+    hazards[slot].store (nullptr, std::memory_order_release);
+    slotsUsed[slot].store (false, std::memory_order_release);
+}
+
+Tunables::Block Tunables::read (int slot) const noexcept {
+    auto& hazard = hazards[slot];
+    const Block* block;
+
+    // announce the block, then make sure it's still current. After that the
+    // writer won't reuse it until the hazard is cleared.
+    do {
+        block = current.load (std::memory_order_acquire);
+        hazard.store (block, std::memory_order_seq_cst);
+    } while (block != current.load (std::memory_order_seq_cst));
+
+    Block copy = *block;
+    hazard.store (nullptr, std::memory_order_release);
+    return copy;
+}
+
+Tunables::Block Tunables::snapshot() const {
+    std::lock_guard<std::mutex> sl (writeLock);
+    return *current.load (std::memory_order_acquire);
+}
+
+bool Tunables::set (Tunable t, double value) {
+    if (t == Tunable::NumTunables)
+        return false;
+
+    const auto i = index (t);
+    double stored;
+    bool accepted = std::isfinite (value);
+    {
+        std::lock_guard<std::mutex> sl (writeLock);
+        if (accepted) {
+            shadow.values[i] = std::clamp (value, ranges[i].first, ranges[i].second);
+            publish();
+        }
+        stored = shadow.values[i];
+    }
+
+    // show the dashboard what was actually applied.
+    if (stored != value)
+        mirror (t, stored);
+    return accepted;
+}
+
+// called with writeLock held.
+void Tunables::publish() {
+    const Block* active = current.load (std::memory_order_relaxed);
+
+    for (auto& block : blocks) {
+        if (&block == active)
+            continue;
+
+        bool inUse = false;
+        for (const auto& hazard : hazards)
+            inUse |= hazard.load (std::memory_order_seq_cst) == &block;
+        if (inUse)
+            continue;
+
+        // one more block than readers plus the current, so there's always one.
+        block.values  = shadow.values;
+        block.version = active != nullptr ? active->version + 1 : 1;
+        current.store (&block, std::memory_order_seq_cst);
+        return;
+    }
+}
+
+void Tunables::mirror (Tunable t, double value) {
+    if (nt != nullptr)
+        nt->entries[index (t)].Set (value);
+}
+
+std::string_view Tunables::category (Tunable t) noexcept {
+    return t == Tunable::NumTunables ? std::string_view() : detail::tunableInfo[index (t)].category;
+}
+
+std::string_view Tunables::symbol (Tunable t) noexcept {
+    return t == Tunable::NumTunables ? std::string_view() : detail::tunableInfo[index (t)].symbol;
+}
+
+void Tunables::startNetworkTables() {
+    if (nt != nullptr)
+        return;
+
+    auto inst         = nt::NetworkTableInstance::GetDefault();
+    const auto values = snapshot();
+    nt                = std::make_unique<NetworkTables>();
+
+    for (const auto& info : detail::tunableInfo) {
+        const auto i  = index (info.id);
+        auto topic    = inst.GetDoubleTopic (std::string ("/Tunables/") + std::string (info.category) + "/" + std::string (info.symbol));
+        nt->entries[i] = topic.GetEntry (values.values[i]);
+        nt->entries[i].Set (values.values[i]);
+
+        // runs on the NetworkTables listener thread.
+        const auto id = info.id;
+        nt->listeners.push_back (inst.AddListener (topic, nt::EventFlags::kValueRemote, [this, id] (const nt::Event& event) {
+            if (auto* v = event.GetValueEventData(); v != nullptr && v->value.IsDouble())
+                set (id, v->value.GetDouble());
+        }));
+    }
+
+    std::clog << "[tunables] " << NumValues << " values published to /Tunables" << std::endl;
+}
+
+void Tunables::stopNetworkTables() {
+    if (nt == nullptr)
+        return;
+    for (auto listener : nt->listeners)
+        nt::NetworkTableInstance::RemoveListener (listener);
+    nt.reset();
+}
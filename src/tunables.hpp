@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
+
+/** Values that can be tuned live from the dashboard. */
+enum class Tunable : int {
+    DriveP,
+    DriveI,
+    DriveD,
+    DriveS,
+    DriveV,
+    DriveA,
+    RotationThrottle,
+    ShootPower,
+    IntakePrimaryPower,
+    IntakeSecondaryPower,
+    NumTunables
+};
+
+/** Live tunable values.
+
+    Each value starts from its `config.lua` setting, is mirrored to
+    NetworkTables under `/Tunables/<category>/<symbol>` and can be edited from
+    the dashboard. Edits arrive on the NetworkTables thread where they're
+    validated against `config.tunables` ranges into a shadow copy, then
+    published as a whole block by swapping an atomic pointer.
+
+    Control code reads a snapshot once per tick through a Reader. Reading
+    never locks, allocates or calls Lua. Each reader holds a hazard slot
+    while it copies so a block is never rewritten under it.
+*/
+class Tunables final {
+public:
+    static constexpr int NumValues  = static_cast<int> (Tunable::NumTunables);
+    static constexpr int MaxReaders = 4;
+
+    /** A complete set of values. */
+    struct Block {
+        std::array<double, NumValues> values {};
+        /** Increments every time a block is published. */
+        uint64_t version { 0 };
+
+        double operator[] (Tunable t) const noexcept { return values[static_cast<int> (t)]; }
+    };
+
+    /** Reads snapshots without locking. Use from one thread only. */
+    class Reader final {
+    public:
+        Reader (Reader&& other) noexcept;
+        ~Reader();
+        Reader (const Reader&)            = delete;
+        Reader& operator= (const Reader&) = delete;
+        Reader& operator= (Reader&&)      = delete;
+
+        /** Copy the current block. */
+        Block read() const noexcept;
+
+    private:
+        friend class Tunables;
+        Reader (Tunables& t, int s) noexcept : owner (&t), slot (s) {}
+        Tunables* owner;
+        int slot;
+    };
+
+    /** Returns the robot's tunables. Values are loaded from config the first
+        time this is called, so call it on the main thread first.
+    */
+    static Tunables& get();
+
+    /** Load values and ranges from config. Use get() instead. */
+    Tunables();
+    ~Tunables();
+
+    Tunables (const Tunables&)            = delete;
+    Tunables& operator= (const Tunables&) = delete;
+
+    /** Register a reader. Throws if all MaxReaders slots are taken. */
+    Reader reader();
+
+    /** Returns the current block. Takes the writer lock, so slower than a
+        Reader but usable from any thread.
+    */
+    Block snapshot() const;
+
+    /** Set a value. Out of range values are clamped and NaNs rejected.
+        Thread safe. Returns false if rejected.
+    */
+    bool set (Tunable t, double value);
+
+    /** Returns the category and symbol of a tunable e.g. "drivetrain", "kp" */
+    static std::string_view category (Tunable t) noexcept;
+    static std::string_view symbol (Tunable t) noexcept;
+
+    /** Returns the valid range of a tunable. */
+    double minimum (Tunable t) const noexcept { return ranges[index (t)].first; }
+    double maximum (Tunable t) const noexcept { return ranges[index (t)].second; }
+
+    /** Publish values to NetworkTables and listen for dashboard edits. */
+    void startNetworkTables();
+
+    /** Stop listening for dashboard edits. */
+    void stopNetworkTables();
+
+private:
+    static constexpr int NumBlocks = MaxReaders + 2;
+
+    std::array<Block, NumBlocks> blocks {};
+    std::atomic<Block*> current { nullptr };
+    mutable std::array<std::atomic<const Block*>, MaxReaders> hazards {};
+    std::array<std::atomic<bool>, MaxReaders> slotsUsed {};
+
+    // writers only: edits from NetworkTables and set() from the main thread.
+    mutable std::mutex writeLock;
+    Block shadow;
+    std::array<std::pair<double, double>, NumValues> ranges {};
+
+    struct NetworkTables;
+    std::unique_ptr<NetworkTables> nt;
+
+    static constexpr int index (Tunable t) noexcept { return static_cast<int> (t); }
+    Block read (int slot) const noexcept;
+    void publish();
+    void mirror (Tunable t, double value);
+    void releaseSlot (int slot) noexcept;
+};
@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <utility>
+
+#include <cameraserver/CameraServer.h>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "config.hpp"
+#include "realtime.hpp"
+#include "vision.hpp"
+
+namespace vision {
+//==============================================================================
+FileFrameSource::FileFrameSource (std::string_view directory, int width, int height, double fps, bool shouldLoop)
+    : loop (shouldLoop) {
+    namespace fs = std::filesystem;
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator (fs::path (directory))) {
+        const auto ext = entry.path().extension().string();
+        if (entry.is_regular_file() && std::regex_match (ext, std::regex ("\\.(?:png|jpg|jpeg)", std::regex::icase)))
+            files.push_back (entry.path());
+    }
+    std::sort (files.begin(), files.end());
+
+    for (const auto& file : files) {
+        cv::Mat image = cv::imread (file.string(), cv::IMREAD_COLOR);
+        if (image.empty())
+            continue;
+        if (image.cols != width || image.rows != height)
+            cv::resize (image, image, cv::Size (width, height));
+        images.push_back (std::move (image));
+    }
+
+    if (fps > 0.0)
+        period = std::chrono::duration_cast<Frame::clock::duration> (std::chrono::duration<double> (1.0 / fps));
+}
+
+bool FileFrameSource::grab (Frame& frame) {
+    if (images.empty())
+        return false;
+    if (index >= images.size()) {
+        if (! loop)
+            return false;
+        index = 0;
+    }
+
+    if (period > Frame::clock::duration::zero()) {
+        const auto now = Frame::clock::now();
+        if (next > now)
+            std::this_thread::sleep_until (next);
+        next = std::max (next, now) + period;
+    }
+
+    // same size and type, so copyTo reuses the frame's buffer.
+    images[index++].copyTo (frame.image);
+    frame.captured  = Frame::clock::now();
+    frame.timestamp = std::chrono::duration<double> (frame.captured.time_since_epoch()).count();
+    return true;
+}
+
+//==============================================================================
+struct CameraFrameSource::Impl {
+    cs::UsbCamera camera;
+    cs::CvSink sink;
+};
+
+CameraFrameSource::CameraFrameSource (std::string_view name, int device, int width, int height, int fps)
+    : impl (std::make_unique<Impl>()) {
+    impl->camera = frc::CameraServer::StartAutomaticCapture (name, device);
+    impl->camera.SetExposureAuto();
+    impl->camera.SetWhiteBalanceAuto();
+    impl->camera.SetResolution (width, height);
+    impl->camera.SetFPS (fps);
+    impl->sink = frc::CameraServer::GetVideo (impl->camera);
+}
+
+CameraFrameSource::~CameraFrameSource() = default;
+
+bool CameraFrameSource::grab (Frame& frame) {
+    // GrabFrame returns the capture time in FPGA microseconds, 0 on error.
+    const auto time = impl->sink.GrabFrame (frame.image, 0.25);
+    if (time == 0)
+        return false;
+    frame.captured  = Frame::clock::now();
+    frame.timestamp = static_cast<double> (time) * 1.0e-6;
+    return true;
+}
+
+//==============================================================================
+DropPolicy dropPolicy (std::string_view name) noexcept {
+    return name == "newest" ? DropPolicy::DropNewest : DropPolicy::DropOldest;
+}
+
+Settings Settings::fromConfig() {
+    Settings s;
+    s.width      = config::integer ("camera", "width", s.width);
+    s.height     = config::integer ("camera", "height", s.height);
+    s.poolSize   = config::integer ("camera", "pool_size", s.poolSize);
+    s.dropPolicy = dropPolicy (config::string ("camera", "drop_policy", "oldest"));
+
+    // a helper like the worker, see `config.realtime`
+    if (const auto realtime = rt::options(); realtime.enabled)
+        s.cpu = realtime.helperCpu;
+    return s;
+}
+
+//==============================================================================
+Pipeline::Pipeline (const Settings& s)
+    : settings (s) {
+    // at least one frame in each stage.
+    settings.poolSize = std::clamp (settings.poolSize, 3, MaxFrames);
+    for (int i = 0; i < settings.poolSize; ++i) {
+        auto frame    = std::make_unique<Frame>();
+        frame->image  = cv::Mat (settings.height, settings.width, CV_8UC3);
+        frame->work   = cv::Mat (settings.height, settings.width, CV_8UC3);
+        frame->mask   = cv::Mat (settings.height, settings.width, CV_8UC1);
+        frame->labels = cv::Mat (settings.height, settings.width, CV_32SC1);
+        fromPublish.push (frame.get());
+        pool.push_back (std::move (frame));
+    }
+    scratch.image = cv::Mat (settings.height, settings.width, CV_8UC3);
+}
+
+bool Pipeline::start (std::unique_ptr<FrameSource> newSource, Processor process, Publisher publish) {
+    if (running() || newSource == nullptr)
+        return false;
+
+    source    = std::move (newSource);
+    processor = process ? std::move (process) : Processor (&Pipeline::findTarget);
+    publisher = std::move (publish);
+
+    shouldExit.store (false, std::memory_order_release);
+    sourceDone.store (false, std::memory_order_release);
+    _running.store (true, std::memory_order_release);
+    resetStats();
+
+    publishThread = std::thread (&Pipeline::runPublish, this);
+    processThread = std::thread (&Pipeline::runProcess, this);
+    captureThread = std::thread (&Pipeline::runCapture, this);
+    return true;
+}
+
+void Pipeline::stop() {
+    shouldExit.store (true, std::memory_order_release);
+    shouldExit.notify_all();
+    processReady.notify();
+    publishReady.notify();
+    for (auto* t : { &captureThread, &processThread, &publishThread })
+        if (t->joinable())
+            t->join();
+
+    // hand every frame back to the pool for the next start.
+    Frame* frame = nullptr;
+    for (auto* link : { &toProcess, &toPublish, &fromProcess })
+        while (link->pop (frame))
+            fromPublish.push (frame);
+    if (held != nullptr)
+        fromPublish.push (std::exchange (held, nullptr));
+
+    _running.store (false, std::memory_order_release);
+}
+
+bool Pipeline::drained() const noexcept {
+    return sourceDone.load (std::memory_order_acquire)
+           && toProcess.empty() && toPublish.empty()
+           && captured.load() == published.load() + dropped.load();
+}
+
+Frame* Pipeline::acquire() noexcept {
+    Frame* frame = nullptr;
+    if (fromPublish.pop (frame) || fromProcess.pop (frame))
+        return frame;
+    return nullptr;
+}
+
+void Pipeline::setupThread() {
+    // vision is never more important than the control loop.
+    rt::lowerPriority (5);
+    if (settings.cpu >= 0)
+        rt::pinCurrentThread (settings.cpu);
+}
+
+void Pipeline::runCapture() {
+    setupThread();
+    Frame* frame = nullptr;
+
+    while (! shouldExit.load (std::memory_order_acquire)) {
+        if (source->finished()) {
+            sourceDone.store (true, std::memory_order_release);
+            shouldExit.wait (false, std::memory_order_acquire);
+            continue;
+        }
+
+        if (frame == nullptr && (frame = acquire()) == nullptr) {
+            // every buffer is downstream. Capture anyway so the source doesn't
+            // back up, and drop it. grab() waits for the source either way.
+            if (source->grab (scratch)) {
+                captured.fetch_add (1, std::memory_order_relaxed);
+                dropped.fetch_add (1, std::memory_order_relaxed);
+                starved.fetch_add (1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+
+        if (! source->grab (*frame))
+            continue;
+
+        frame->sequence  = ++sequence;
+        frame->hasTarget = false;
+        captured.fetch_add (1, std::memory_order_relaxed);
+
+        if (toProcess.push (frame)) {
+            frame = nullptr;
+            processReady.notify();
+        } else { // can't happen while the pool fits the queue. reuse the frame.
+            dropped.fetch_add (1, std::memory_order_relaxed);
+        }
+    }
+
+    // fromPublish is the publish thread's to push, stop() returns this one.
+    held = frame;
+}
+
+void Pipeline::runProcess() {
+    setupThread();
+    Frame* frame = nullptr;
+
+    while (! shouldExit.load (std::memory_order_acquire)) {
+        const auto seen = processReady.current();
+        if (! toProcess.pop (frame)) {
+            processReady.wait (seen);
+            continue;
+        }
+
+        if (settings.dropPolicy == DropPolicy::DropOldest) {
+            // skip ahead to the newest frame waiting.
+            Frame* newer = nullptr;
+            while (toProcess.pop (newer)) {
+                fromProcess.push (frame);
+                dropped.fetch_add (1, std::memory_order_relaxed);
+                frame = newer;
+            }
+        }
+
+        {
+            snider::AtomicTimingStats::Scope timed (processing);
+            processor (*frame);
+        }
+        processed.fetch_add (1, std::memory_order_relaxed);
+
+        if (toPublish.push (frame)) {
+            publishReady.notify();
+        } else {
+            fromProcess.push (frame);
+            dropped.fetch_add (1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Pipeline::runPublish() {
+    setupThread();
+    Frame* frame = nullptr;
+
+    while (! shouldExit.load (std::memory_order_acquire)) {
+        const auto seen = publishReady.current();
+        if (! toPublish.pop (frame)) {
+            publishReady.wait (seen);
+            continue;
+        }
+
+        if (publisher)
+            publisher (*frame);
+        latency.add (Frame::clock::now() - frame->captured);
+        published.fetch_add (1, std::memory_order_relaxed);
+        fromPublish.push (frame);
+    }
+}
+
+Pipeline::Stats Pipeline::stats() const {
+    Stats s;
+    s.captured   = captured.load (std::memory_order_relaxed);
+    s.processed  = processed.load (std::memory_order_relaxed);
+    s.published  = published.load (std::memory_order_relaxed);
+    s.dropped    = dropped.load (std::memory_order_relaxed);
+    s.starved    = starved.load (std::memory_order_relaxed);
+    s.latencyAvg = latency.averageMicros();
+    s.latencyMax = latency.maxMicros();
+    s.processAvg = processing.averageMicros();
+    s.processMax = processing.maxMicros();
+
+    const auto start     = Frame::clock::time_point (Frame::clock::duration (statsStart.load (std::memory_order_relaxed)));
+    const double seconds = std::chrono::duration<double> (Frame::clock::now() - start).count();
+    s.fps                = seconds > 0.0 ? static_cast<double> (s.published) / seconds : 0.0;
+    return s;
+}
+
+void Pipeline::report (std::ostream& out) const {
+    const auto s = stats();
+    out << "[camera] frames: captured=" << s.captured
+        << " processed=" << s.processed
+        << " published=" << s.published
+        << " dropped=" << s.dropped
+        << " starved=" << s.starved
+        << std::fixed << std::setprecision (1)
+        << " fps=" << s.fps << std::endl
+        << "[camera] latency avg=" << s.latencyAvg << "us max=" << s.latencyMax << "us"
+        << " process avg=" << s.processAvg << "us max=" << s.processMax << "us"
+        << std::endl;
+}
+
+void Pipeline::resetStats() {
+    for (auto* counter : { &captured, &processed, &published, &dropped, &starved })
+        counter->store (0, std::memory_order_relaxed);
+    latency.reset();
+    processing.reset();
+    statsStart.store (Frame::clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+void Pipeline::findTarget (Frame& frame) {
+    // notes are orange: threshold in HSV then take the largest blob.
+    cv::cvtColor (frame.image, frame.work, cv::COLOR_BGR2HSV);
+    cv::inRange (frame.work, cv::Scalar (5, 120, 120), cv::Scalar (20, 255, 255), frame.mask);
+
+    // label 0 is the background.
+    const int count = cv::connectedComponentsWithStats (frame.mask, frame.labels, frame.blobs,
+                                                        frame.centroids, 8, CV_32S);
+    int largest = 0, area = 0;
+    for (int i = 1; i < count; ++i) {
+        if (const int a = frame.blobs.at<int> (i, cv::CC_STAT_AREA); a > area) {
+            largest = i;
+            area    = a;
+        }
+    }
+
+    frame.hasTarget = area > 50;
+    if (frame.hasTarget) {
+        frame.targetX    = frame.centroids.at<double> (largest, 0);
+        frame.targetY    = frame.centroids.at<double> (largest, 1);
+        frame.targetArea = area;
+    }
+}
+
+} // namespace vision
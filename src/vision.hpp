@@ -0,0 +1,257 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+
+#include "snider/spscqueue.hpp"
+#include "snider/timingstats.hpp"
+
+namespace vision {
+
+/** A preallocated image and what was found in it. */
+struct Frame {
+    using clock = std::chrono::steady_clock;
+
+    /** The captured image. */
+    cv::Mat image;
+    /** Scratch images for processing, reused between frames. */
+    cv::Mat work, mask, labels;
+    /** Per blob stats and centers from the last findTarget(). */
+    cv::Mat blobs, centroids;
+
+    /** Increments with every capture. */
+    int64_t sequence { 0 };
+    /** When the frame was captured, for measuring latency. */
+    clock::time_point captured {};
+    /** Source timestamp in seconds, FPGA time for cameras. */
+    double timestamp { 0.0 };
+
+    /** True if a target was found. */
+    bool hasTarget { false };
+    /** Target center in pixels. */
+    double targetX { 0.0 }, targetY { 0.0 };
+    /** Target area in pixels. */
+    double targetArea { 0.0 };
+};
+
+//==============================================================================
+/** Where frames come from. Called from the capture thread only. */
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    /** Fill a frame's image and timestamp. Implementations should write into
+        the existing image so its buffer is reused, and wait for the next frame
+        up to some timeout. Returns false when no frame could be captured.
+    */
+    virtual bool grab (Frame& frame) = 0;
+
+    /** Returns true when there are no more frames, e.g. a file source that
+        doesn't loop.
+    */
+    virtual bool finished() const { return false; }
+};
+
+/** Reads recorded images from a directory.
+
+    All images are loaded and resized up front so capturing from disk doesn't
+    skew benchmarks. Frames are paced at `fps`, or as fast as possible if 0.
+*/
+class FileFrameSource final : public FrameSource {
+public:
+    /** @param directory A directory of .png or .jpg images, read in name order.
+        @param width Frame width to resize to.
+        @param height Frame height to resize to.
+        @param fps Frames per second. 0 for no pacing.
+        @param loop Start over after the last image.
+    */
+    FileFrameSource (std::string_view directory, int width, int height, double fps, bool loop);
+
+    bool grab (Frame& frame) override;
+    bool finished() const override { return images.empty() || (! loop && index >= images.size()); }
+
+    /** Returns the number of images loaded. */
+    std::size_t size() const noexcept { return images.size(); }
+
+private:
+    std::vector<cv::Mat> images;
+    std::size_t index { 0 };
+    bool loop { true };
+    Frame::clock::duration period {};
+    Frame::clock::time_point next {};
+};
+
+/** Captures from a USB camera through CameraServer. */
+class CameraFrameSource final : public FrameSource {
+public:
+    CameraFrameSource (std::string_view name, int device, int width, int height, int fps);
+    ~CameraFrameSource() override;
+
+    bool grab (Frame& frame) override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+//==============================================================================
+/** What to drop when processing can't keep up. */
+enum class DropPolicy {
+    /** Stale queued frames are skipped so only the newest is processed. Best
+        for steering, where an old answer is worse than none. */
+    DropOldest,
+    /** Every captured frame is processed in order. New captures are dropped
+        while all buffers are in use. Best for recording. */
+    DropNewest
+};
+
+/** Returns the policy named by a config string, "oldest" or "newest". */
+DropPolicy dropPolicy (std::string_view name) noexcept;
+
+/** Pipeline settings. see `config.camera` */
+struct Settings {
+    int width { 640 };
+    int height { 360 };
+    /** Number of frames preallocated. At most Pipeline::MaxFrames. */
+    int poolSize { 6 };
+    DropPolicy dropPolicy { DropPolicy::DropOldest };
+    /** CPU the pipeline threads run on, -1 to not pin. `realtime.helper_cpu`
+        when realtime is enabled. */
+    int cpu { -1 };
+
+    /** Returns settings read from `config.camera` */
+    static Settings fromConfig();
+};
+
+//==============================================================================
+/** A capture, process and publish pipeline on three threads.
+
+    Frames come from a fixed pool allocated up front and are passed between
+    threads by pointer through single producer single consumer queues, so no
+    image is copied or allocated once running. Each downstream thread hands
+    finished frames back to the capture thread on its own queue.
+*/
+class Pipeline final {
+public:
+    /** Largest pool size supported. */
+    static constexpr int MaxFrames = 8;
+
+    using Processor = std::function<void (Frame&)>;
+    using Publisher = std::function<void (const Frame&)>;
+
+    explicit Pipeline (const Settings& settings);
+    ~Pipeline() { stop(); }
+
+    Pipeline (const Pipeline&)            = delete;
+    Pipeline& operator= (const Pipeline&) = delete;
+
+    /** Start the threads. Returns false if already running.
+
+        @param source Where frames come from.
+        @param process Runs on the process thread. Defaults to findTarget.
+        @param publish Runs on the publish thread.
+    */
+    bool start (std::unique_ptr<FrameSource> source, Processor process, Publisher publish);
+
+    /** Stop the threads and wait for them to exit. */
+    void stop();
+
+    /** Returns true if running. */
+    bool running() const noexcept { return _running.load (std::memory_order_acquire); }
+
+    /** Returns true once the source has no more frames and all captured
+        frames have been published or dropped. */
+    bool drained() const noexcept;
+
+    /** Pipeline counters. */
+    struct Stats {
+        int64_t captured { 0 }, processed { 0 }, published { 0 };
+        /** Frames discarded by the drop policy. */
+        int64_t dropped { 0 };
+        /** Of those dropped, captures that arrived while every buffer was in
+            use. */
+        int64_t starved { 0 };
+        /** Published frames per second since start or the last reset. */
+        double fps { 0.0 };
+        /** Capture to publish latency in microseconds. */
+        double latencyAvg { 0.0 }, latencyMax { 0.0 };
+        /** Time spent in the processor in microseconds. */
+        double processAvg { 0.0 }, processMax { 0.0 };
+    };
+
+    /** Returns a snapshot of the counters. Safe to call from any thread, the
+        values may be a frame apart from each other.
+    */
+    Stats stats() const;
+
+    /** Write stats to a stream. */
+    void report (std::ostream& out) const;
+
+    /** Reset counters and timing. Safe to call from any thread. */
+    void resetStats();
+
+    /** Default processor: thresholds orange (notes) and records the center
+        and area of the largest orange blob.
+    */
+    static void findTarget (Frame& frame);
+
+private:
+    using Link = snider::SpscQueue<Frame*, MaxFrames>;
+
+    /** Wakes the thread waiting on a link. Take current() before trying the
+        link, then wait() on it if the link was empty: a push in between
+        changes the count so the wait returns straight away.
+    */
+    struct Signal {
+        std::atomic<uint32_t> count { 0 };
+        uint32_t current() const noexcept { return count.load (std::memory_order_acquire); }
+        void wait (uint32_t seen) const noexcept { count.wait (seen, std::memory_order_acquire); }
+        void notify() noexcept {
+            count.fetch_add (1, std::memory_order_release);
+            count.notify_one();
+        }
+    };
+
+    Settings settings;
+    std::vector<std::unique_ptr<Frame>> pool;
+    // captures with nowhere to go land here.
+    Frame scratch;
+    // capture -> process -> publish
+    Link toProcess, toPublish;
+    // frames handed back to capture by process and publish.
+    Link fromProcess, fromPublish;
+    Signal processReady, publishReady;
+    // the frame capture held when it exited, returned to the pool by stop().
+    Frame* held { nullptr };
+
+    std::unique_ptr<FrameSource> source;
+    Processor processor;
+    Publisher publisher;
+
+    std::thread captureThread, processThread, publishThread;
+    std::atomic<bool> shouldExit { false }, _running { false }, sourceDone { false };
+
+    std::atomic<int64_t> captured { 0 }, processed { 0 }, published { 0 },
+        dropped { 0 }, starved { 0 };
+    snider::AtomicTimingStats latency, processing;
+    std::atomic<Frame::clock::rep> statsStart { 0 };
+    int64_t sequence { 0 };
+
+    Frame* acquire() noexcept;
+    void runCapture();
+    void runProcess();
+    void runPublish();
+    void setupThread();
+};
+
+} // namespace vision
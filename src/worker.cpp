@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include "engine.hpp"
+#include "realtime.hpp"
+#include "sol/sol.hpp"
+#include "worker.hpp"
+
+namespace lua {
+namespace detail {
+
+// worker.post (topic, data) -> boolean
+static int worker_post (lua_State* L) {
+    auto* outgoing = static_cast<Worker::Channel*> (lua_touserdata (L, lua_upvalueindex (1)));
+    size_t tlen = 0, dlen = 0;
+    const char* topic = luaL_checklstring (L, 1, &tlen);
+    const char* data  = luaL_optlstring (L, 2, "", &dlen);
+
+    Message msg;
+    const bool sent = outgoing != nullptr
+                      && msg.assign ({ topic, tlen }, { data, dlen })
+                      && outgoing->push (msg);
+    lua_pushboolean (L, sent);
+    return 1;
+}
+
+// worker.poll() -> topic, data or nothing
+static int worker_poll (lua_State* L) {
+    auto* incoming = static_cast<Worker::Channel*> (lua_touserdata (L, lua_upvalueindex (1)));
+    Message msg;
+    if (incoming == nullptr || ! incoming->pop (msg))
+        return 0;
+    lua_pushstring (L, msg.topic);
+    lua_pushlstring (L, msg.data, msg.size);
+    return 2;
+}
+
+} // namespace detail
+
+//==============================================================================
+bool Message::assign (std::string_view t, std::string_view d) noexcept {
+    if (t.size() >= MaxTopic || d.size() > MaxData)
+        return false;
+    std::memcpy (topic, t.data(), t.size());
+    topic[t.size()] = '\0';
+    std::memcpy (data, d.data(), d.size());
+    size = static_cast<uint16_t> (d.size());
+    return true;
+}
+
+//==============================================================================
+bool Worker::start (std::string_view directory, std::string_view program, int periodMs) {
+    if (running() || thread.joinable())
+        return false;
+
+    shouldExit.store (false, std::memory_order_release);
+    _running.store (true, std::memory_order_release);
+    thread = std::thread (&Worker::run, this, std::string (directory), std::string (program), std::max (1, periodMs));
+    return true;
+}
+
+void Worker::stop() {
+    shouldExit.store (true, std::memory_order_release);
+    if (thread.joinable())
+        thread.join();
+    _running.store (false, std::memory_order_release);
+}
+
+bool Worker::post (std::string_view topic, std::string_view data) noexcept {
+    Message msg;
+    return msg.assign (topic, data) && toWorker.push (msg);
+}
+
+void Worker::bindChannels (lua_State* L, Channel* outgoing, Channel* incoming) {
+    lua_getglobal (L, "cxx");
+    if (! lua_istable (L, -1)) {
+        lua_pop (L, 1);
+        lua_newtable (L);
+        lua_pushvalue (L, -1);
+        lua_setglobal (L, "cxx");
+    }
+
+    // Modules cache this table, so update it in place when it already exists.
+    lua_getfield (L, -1, "worker");
+    if (! lua_istable (L, -1)) {
+        lua_pop (L, 1);
+        lua_createtable (L, 0, 2);
+        lua_pushvalue (L, -1);
+        lua_setfield (L, -3, "worker");
+    }
+
+    lua_pushlightuserdata (L, outgoing);
+    lua_pushcclosure (L, detail::worker_post, 1);
+    lua_setfield (L, -2, "post");
+    lua_pushlightuserdata (L, incoming);
+    lua_pushcclosure (L, detail::worker_poll, 1);
+    lua_setfield (L, -2, "poll");
+
+    lua_pop (L, 2);
+}
+
+void Worker::run (std::string directory, std::string program, int periodMs) {
+    using namespace std::chrono;
+    // Lower priority so the control loop always wins, and keep off its CPU.
+    rt::lowerPriority (10);
+    if (cpu >= 0)
+        rt::pinCurrentThread (cpu);
+
+    try {
+        sol::state L;
+        L.open_libraries();
+        sol::table package = L["package"];
+        package.set ("path", directory + "/?.lua;" + directory + "/?/init.lua");
+        if (const auto* bundle = lua::bundle())
+            add_searcher (L.lua_state(), *bundle);
+        L.script ("config = require ('config')");
+        bindChannels (L.lua_state(), &fromWorker, &toWorker);
+
+        auto path = std::filesystem::path (directory) / program;
+        path.make_preferred();
+        auto engine = Engine::instantiate (L.lua_state(), path.string());
+        if (engine->have_error() || ! engine->init() || ! engine->prepare()) {
+            std::cerr << "[worker] " << program << ": " << engine->error() << std::endl;
+            _running.store (false, std::memory_order_release);
+            return;
+        }
+
+        std::clog << "[worker] program loaded: " << program << std::endl;
+
+        const auto period = milliseconds (periodMs);
+        auto next         = steady_clock::now();
+
+        while (! shouldExit.load (std::memory_order_acquire)) {
+            if (! engine->safe_run()) {
+                std::cerr << "[worker] error: " << engine->error() << std::endl;
+                break;
+            }
+
+            lua_gc (L.lua_state(), LUA_GCSTEP, 0);
+
+            // don't try to catch up after a long run, just start over.
+            next += period;
+            const auto now = steady_clock::now();
+            if (next < now)
+                next = now;
+            std::this_thread::sleep_until (next);
+        }
+
+        engine->cleanup();
+    } catch (const std::exception& e) {
+        std::cerr << "[worker] exception: " << e.what() << std::endl;
+    }
+
+    _running.store (false, std::memory_order_release);
+}
+
+} // namespace lua
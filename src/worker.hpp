@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "snider/spscqueue.hpp"
+
+struct lua_State;
+
+namespace lua {
+
+/** A message passed between the realtime and worker Lua states. */
+struct Message {
+    enum : int {
+        MaxTopic = 32, ///> Max topic length including the null terminator.
+        MaxData  = 222 ///> Max payload bytes.
+    };
+
+    char topic[MaxTopic] = { 0 };
+    char data[MaxData]   = { 0 };
+    uint16_t size { 0 };
+
+    /** Fill from strings. Returns false if either is too long. */
+    bool assign (std::string_view t, std::string_view d) noexcept;
+};
+
+/** Runs a second Lua state on a dedicated low priority thread.
+
+    Heavy, non-realtime Lua (planning, auto selection, dashboards) goes here
+    so it never lands on the control loop. The two states talk through a pair
+    of lock-free queues. Both states see the same `cxx.worker` API: `post`
+    sends to the other side and `poll` receives from it. See `robot/worker.lua`
+*/
+class Worker final {
+public:
+    Worker() = default;
+    ~Worker() { stop(); }
+
+    Worker (const Worker&)            = delete;
+    Worker& operator= (const Worker&) = delete;
+
+    using Channel = snider::SpscQueue<Message, 64>;
+
+    /** Start the worker thread.
+
+        @param directory The Lua search directory.
+        @param program The program file to run, relative to directory.
+        @param periodMs How often the program's run function is called.
+
+        @returns false if already running.
+    */
+    bool start (std::string_view directory, std::string_view program, int periodMs);
+
+    /** Pin the worker thread to a CPU when it starts. Negative to not pin. */
+    void setCpu (int newCpu) noexcept { cpu = newCpu; }
+
+    /** Stop the thread and wait for it to exit. */
+    void stop();
+
+    /** Returns true if the worker thread is running. */
+    bool running() const noexcept { return _running.load (std::memory_order_acquire); }
+
+    /** Send a message to the worker. Realtime thread only. */
+    bool post (std::string_view topic, std::string_view data) noexcept;
+
+    /** Receive a message from the worker. Realtime thread only. */
+    bool poll (Message& msg) noexcept { return fromWorker.pop (msg); }
+
+    /** Bind to the root Lua state as `cxx.worker`. see bindings.cpp */
+    static void bind (Worker*);
+
+    /** Bind `cxx.worker` in a given state to a pair of channels.
+        @param L The state to bind.
+        @param outgoing Where `post` writes.
+        @param incoming Where `poll` reads.
+    */
+    static void bindChannels (lua_State* L, Channel* outgoing, Channel* incoming);
+
+private:
+    Channel toWorker, fromWorker;
+    std::thread thread;
+    std::atomic<bool> shouldExit { false };
+    std::atomic<bool> _running { false };
+    int cpu { -1 };
+
+    void run (std::string directory, std::string program, int periodMs);
+};
+
+} // namespace lua
@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+
+#include "canbus.hpp"
+#include "scripting.hpp"
+
+TEST (CanBusTest, FrameRate) {
+    can::StatusPeriods periods { 10, 20, 20, 50, 20, 200, 200 };
+    EXPECT_DOUBLE_EQ (can::frame_rate (periods), 100.0 + 50.0 + 50.0 + 20.0 + 50.0 + 5.0 + 5.0);
+    EXPECT_DOUBLE_EQ (can::frame_rate (can::default_status_periods()), can::frame_rate (periods));
+}
+
+TEST (CanBusTest, BusLoad) {
+    EXPECT_DOUBLE_EQ (can::bus_load (1000.0, 1.0e6, 135.0), 0.135);
+    EXPECT_DOUBLE_EQ (can::bus_load (1000.0, 0.0), 0.0);
+}
+
+TEST (CanBusTest, ConfigOverrides) {
+    auto frames = lua::config::get ("can", "status_frames").as<sol::table>();
+    const int defaultStatus0 = frames["default"]["status0"];
+    const int leaderStatus0  = frames["drive_left_leader"]["status0"];
+
+    const auto follower = can::status_periods ("drive_left_follower");
+    const auto leader   = can::status_periods ("drive_left_leader");
+    EXPECT_EQ (follower[0], defaultStatus0);
+    EXPECT_EQ (leader[0], leaderStatus0);
+    EXPECT_EQ (leader[1], follower[1]);
+
+    // configured periods should cut traffic compared to REV's defaults.
+    EXPECT_LT (can::frame_rate (follower), can::frame_rate (can::default_status_periods()));
+}
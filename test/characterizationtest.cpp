@@ -0,0 +1,168 @@
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <frc/simulation/DifferentialDrivetrainSim.h>
+#include <frc/system/plant/DCMotor.h>
+#include <frc/system/plant/LinearSystemId.h>
+#include <gtest/gtest.h>
+
+#include "characterization.hpp"
+#include "snider/feedforwardfit.hpp"
+
+namespace detail {
+
+/** A drivetrain side with friction, integrated finely. Velocity is only
+    measured every `sensorPeriod` like an encoder rate that updates slower
+    than it's read.
+*/
+struct FrictionPlant {
+    double kS, kV, kA;
+    double sensorPeriod { 0.02 };
+
+    double velocity { 0.0 }, position { 0.0 };
+    double measured { 0.0 }, sinceMeasured { 0.0 };
+
+    void update (double volts, double dt) {
+        constexpr int substeps = 20;
+        const double h         = dt / substeps;
+        for (int i = 0; i < substeps; ++i) {
+            double accel = 0.0;
+            if (velocity != 0.0 || std::abs (volts) > kS) {
+                const double friction = kS * (velocity != 0.0 ? std::copysign (1.0, velocity) : std::copysign (1.0, volts));
+                accel                 = (volts - friction - kV * velocity) / kA;
+            }
+            const double next = velocity + accel * h;
+            // friction stops the wheel rather than reversing it.
+            velocity = velocity != 0.0 && next * velocity < 0.0 && std::abs (volts) <= kS ? 0.0 : next;
+            position += velocity * h;
+        }
+
+        sinceMeasured += dt;
+        if (sinceMeasured >= sensorPeriod - 1.0e-9) {
+            sinceMeasured = 0.0;
+            measured      = velocity;
+        }
+    }
+};
+
+static Characterization::Settings settings() {
+    Characterization::Settings s;
+    s.rampRate        = 0.5;
+    s.stepVoltage     = 6.0;
+    s.quasistaticTime = 8.0;
+    s.dynamicTime     = 2.0;
+    s.restTime        = 0.5;
+    s.maxDistance     = 3.0;
+    return s;
+}
+
+} // namespace detail
+
+TEST (FeedforwardFitTest, ExactGains) {
+    snider::FeedforwardFit fit;
+    for (int i = 1; i <= 50; ++i) {
+        const double v = (i % 2 ? 1.0 : -1.0) * 0.1 * i;
+        const double a = std::sin (0.3 * i);
+        fit.add (0.4 * (v > 0.0 ? 1.0 : -1.0) + 2.0 * v + 0.25 * a, v, a);
+    }
+
+    auto gains = fit.solve();
+    ASSERT_TRUE (gains.has_value());
+    EXPECT_NEAR (gains->kS, 0.4, 1.0e-9);
+    EXPECT_NEAR (gains->kV, 2.0, 1.0e-9);
+    EXPECT_NEAR (gains->kA, 0.25, 1.0e-9);
+    EXPECT_NEAR (gains->r2, 1.0, 1.0e-9);
+    EXPECT_EQ (gains->samples, 50);
+}
+
+TEST (FeedforwardFitTest, NeedsVariedSamples) {
+    snider::FeedforwardFit fit;
+    EXPECT_FALSE (fit.solve().has_value());
+    for (int i = 0; i < 10; ++i)
+        fit.add (3.0, 1.0, 0.0);
+    EXPECT_FALSE (fit.solve().has_value());
+}
+
+// Run the whole routine against a plant with friction, read faster than its
+// sensor updates, like the 5ms drivetrain group reading a 20ms encoder rate.
+TEST (CharacterizationTest, RecoversFrictionPlant) {
+    detail::FrictionPlant plant { 0.6, 2.4, 0.35 };
+    Characterization routine (detail::settings());
+    routine.start();
+
+    constexpr double dt = 0.005;
+    double now          = 0.0;
+    while (routine.active() && now < 60.0) {
+        const double volts = routine.step (now, plant.measured, plant.position);
+        plant.update (volts, dt);
+        now += dt;
+    }
+
+    ASSERT_TRUE (routine.finished());
+    EXPECT_EQ (routine.dropped(), 0);
+    auto gains = routine.fit();
+    ASSERT_TRUE (gains.has_value());
+    // the plant is what the fit models, so gains come back almost exact.
+    EXPECT_NEAR (gains->kS, plant.kS, 0.02 * plant.kS);
+    EXPECT_NEAR (gains->kV, plant.kV, 0.02 * plant.kV);
+    EXPECT_NEAR (gains->kA, plant.kA, 0.02 * plant.kA);
+    EXPECT_GT (gains->r2, 0.999);
+}
+
+// The simulator's drivetrain is a known linear system. Characterizing it
+// should give back its gains.
+TEST (CharacterizationTest, RecoversSimulatedDrivetrain) {
+    frc::sim::DifferentialDrivetrainSim sim {
+        frc::LinearSystemId::IdentifyDrivetrainSystem (
+            1.98_V / 1_mps, 0.2_V / 1_mps_sq, 1.5_V / 1_mps, 0.3_V / 1_mps_sq),
+        0.559_m, frc::DCMotor::CIM (2), 8, 2_in
+    };
+
+    Characterization routine (detail::settings());
+    routine.start();
+
+    // the drivetrain group runs every 5ms, the simulator every 20ms.
+    double now = 0.0, volts = 0.0;
+    for (int tick = 0; routine.active() && tick < 12000; ++tick) {
+        const double speed    = 0.5 * (sim.GetLeftVelocity() + sim.GetRightVelocity()).value();
+        const double distance = 0.5 * (sim.GetLeftPosition() + sim.GetRightPosition()).value();
+        volts                 = routine.step (now, speed, distance);
+        now += 0.005;
+        if (tick % 4 == 3) {
+            sim.SetInputs (units::volt_t (volts), units::volt_t (volts));
+            sim.Update (20_ms);
+        }
+    }
+
+    ASSERT_TRUE (routine.finished());
+    auto gains = routine.fit();
+    ASSERT_TRUE (gains.has_value());
+    // no friction in the simulator. kA reads low, speeds are up to 15ms old
+    // when the routine sees them.
+    EXPECT_NEAR (gains->kS, 0.0, 0.05);
+    EXPECT_NEAR (gains->kV, 1.98, 0.03 * 1.98);
+    EXPECT_NEAR (gains->kA, 0.2, 0.15 * 0.2);
+    EXPECT_GT (gains->r2, 0.99);
+}
+
+TEST (CharacterizationTest, SavesOverlay) {
+    Characterization routine (detail::settings());
+    Characterization::Gains gains;
+    gains.kS = 0.5;
+    gains.kV = 2.25;
+    gains.kA = 0.125;
+
+    const auto path = std::filesystem::temp_directory_path() / "characterization_overlay.lua";
+    ASSERT_TRUE (routine.save (gains, path.string()));
+
+    std::ifstream in (path);
+    std::stringstream text;
+    text << in.rdbuf();
+    std::filesystem::remove (path);
+
+    EXPECT_NE (text.str().find ("drivetrain = {"), std::string::npos);
+    EXPECT_NE (text.str().find ("kv = 2.250000"), std::string::npos);
+    EXPECT_NE (text.str().find ("ka = 0.125000"), std::string::npos);
+}
@@ -0,0 +1,173 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "commands.hpp"
+
+namespace detail {
+
+/** Counts calls and finishes after a number of ticks. */
+class CountingAction final : public Action {
+public:
+    CountingAction (std::string n, uint32_t r) : _name (std::move (n)), req (r) {}
+
+    std::string_view name() const noexcept override { return _name; }
+    uint32_t requirements() const noexcept override { return req; }
+    void initialize (CommandState&) override { ++initialized; }
+    bool execute (CommandState& state) override {
+        ++executed;
+        // args[0] is the number of ticks to run for.
+        return ++state.phase >= static_cast<int> (state.args[0]);
+    }
+    void end (CommandState&, bool wasInterrupted) override {
+        ++ended;
+        interrupted += wasInterrupted ? 1 : 0;
+    }
+
+    int initialized { 0 }, executed { 0 }, ended { 0 }, interrupted { 0 };
+
+private:
+    std::string _name;
+    uint32_t req;
+};
+
+} // namespace detail
+
+class CommandsTest : public testing::Test {
+protected:
+    CommandScheduler commands;
+    detail::CountingAction drive { "drive", 1u << 0 };
+    detail::CountingAction shoot { "shoot", 1u << 1 };
+
+    void SetUp() override {
+        commands.addAction (drive);
+        commands.addAction (shoot);
+    }
+
+    void tick (int count = 1) {
+        for (int i = 0; i < count; ++i)
+            commands.run (0.02);
+    }
+};
+
+TEST_F (CommandsTest, RegistersActionsByName) {
+    EXPECT_EQ (commands.findAction ("drive"), &drive);
+    EXPECT_EQ (commands.findAction ("missing"), nullptr);
+    EXPECT_FALSE (commands.addAction (drive));
+    EXPECT_EQ (commands.action ("missing"), CommandScheduler::Invalid);
+}
+
+TEST_F (CommandsTest, RunsActionUntilFinished) {
+    const auto id = commands.action ("drive", 3);
+    ASSERT_TRUE (commands.schedule (id));
+    tick (2);
+    EXPECT_TRUE (commands.isScheduled (id));
+    tick();
+    EXPECT_FALSE (commands.isScheduled (id));
+    EXPECT_EQ (drive.initialized, 1);
+    EXPECT_EQ (drive.executed, 3);
+    EXPECT_EQ (drive.ended, 1);
+    EXPECT_EQ (drive.interrupted, 0);
+    EXPECT_EQ (commands.numAvailable(), CommandScheduler::MaxCommands);
+
+    // finished ids are stale.
+    EXPECT_FALSE (commands.schedule (id));
+}
+
+TEST_F (CommandsTest, SequenceRunsInOrder) {
+    const auto id = commands.sequence ({ commands.action (drive, 2), commands.action (shoot, 1) });
+    ASSERT_TRUE (commands.schedule (id));
+    tick (2);
+    EXPECT_EQ (drive.ended, 1);
+    EXPECT_EQ (shoot.executed, 0);
+    tick();
+    EXPECT_EQ (shoot.ended, 1);
+    EXPECT_FALSE (commands.isScheduled (id));
+}
+
+TEST_F (CommandsTest, ParallelWaitsForAll) {
+    const auto id = commands.parallel ({ commands.action (drive, 1), commands.action (shoot, 4) });
+    ASSERT_TRUE (commands.schedule (id));
+    tick();
+    EXPECT_EQ (drive.ended, 1);
+    EXPECT_TRUE (commands.isScheduled (id));
+    tick (3);
+    EXPECT_EQ (drive.executed, 1);
+    EXPECT_EQ (shoot.ended, 1);
+    EXPECT_FALSE (commands.isScheduled (id));
+}
+
+TEST_F (CommandsTest, RaceInterruptsTheRest) {
+    const auto id = commands.race ({ commands.action (drive, 100), commands.wait (0.05) });
+    ASSERT_TRUE (commands.schedule (id));
+    tick (3);
+    EXPECT_TRUE (commands.isScheduled (id));
+    tick();
+    EXPECT_FALSE (commands.isScheduled (id));
+    EXPECT_EQ (drive.ended, 1);
+    EXPECT_EQ (drive.interrupted, 1);
+}
+
+TEST_F (CommandsTest, SharedRequirementInterrupts) {
+    const auto first  = commands.action (drive, 100);
+    const auto second = commands.action (drive, 100);
+    const auto other  = commands.action (shoot, 100);
+    ASSERT_TRUE (commands.schedule (first));
+    ASSERT_TRUE (commands.schedule (other));
+    tick();
+
+    ASSERT_TRUE (commands.schedule (second));
+    EXPECT_FALSE (commands.isScheduled (first));
+    EXPECT_TRUE (commands.isScheduled (other));
+    EXPECT_EQ (drive.interrupted, 1);
+    EXPECT_EQ (commands.stats().interrupted, 1);
+}
+
+TEST_F (CommandsTest, GroupRequiresChildren) {
+    const auto id = commands.sequence ({ commands.action (drive, 1), commands.action (shoot, 1) });
+    EXPECT_EQ (commands.requirements (id), drive.requirements() | shoot.requirements());
+}
+
+TEST_F (CommandsTest, ChildrenCantBeReused) {
+    const auto child = commands.action (drive, 1);
+    const auto group = commands.sequence ({ child });
+    ASSERT_NE (group, CommandScheduler::Invalid);
+    EXPECT_EQ (commands.parallel ({ child }), CommandScheduler::Invalid);
+    EXPECT_FALSE (commands.schedule (child));
+}
+
+TEST_F (CommandsTest, CancelDiscardsUnscheduled) {
+    const auto id = commands.sequence ({ commands.action (drive, 1), commands.wait (1.0) });
+    EXPECT_EQ (commands.numAvailable(), CommandScheduler::MaxCommands - 3);
+    commands.cancel (id);
+    EXPECT_EQ (commands.numAvailable(), CommandScheduler::MaxCommands);
+    EXPECT_EQ (drive.ended, 0);
+}
+
+TEST_F (CommandsTest, PoolExhaustionIsRejected) {
+    for (int i = 0; i < CommandScheduler::MaxCommands; ++i)
+        ASSERT_NE (commands.wait (1.0), CommandScheduler::Invalid);
+    EXPECT_EQ (commands.wait (1.0), CommandScheduler::Invalid);
+    EXPECT_EQ (commands.stats().rejected, 1);
+
+    commands.reset();
+    EXPECT_EQ (commands.numAvailable(), CommandScheduler::MaxCommands);
+}
+
+TEST_F (CommandsTest, SlotsAreLimited) {
+    for (int i = 0; i < CommandScheduler::MaxScheduled; ++i)
+        ASSERT_TRUE (commands.schedule (commands.wait (1.0)));
+    EXPECT_FALSE (commands.schedule (commands.wait (1.0)));
+
+    // a conflicting command can still take a slot.
+    commands.cancelAll();
+    for (int i = 0; i < CommandScheduler::MaxScheduled; ++i)
+        ASSERT_TRUE (commands.schedule (i == 0 ? commands.action (drive, 100) : commands.wait (1.0)));
+    EXPECT_TRUE (commands.schedule (commands.action (drive, 100)));
+}
+
+TEST_F (CommandsTest, MeasuresRunCost) {
+    commands.schedule (commands.action (drive, 2));
+    tick (4);
+    EXPECT_EQ (commands.cost().count(), 4);
+}
@@ -0,0 +1,147 @@
+#include <frc/trajectory/TrajectoryGenerator.h>
+#include <gtest/gtest.h>
+
+#include "drivecontrol.hpp"
+#include "drivekernel.hpp"
+#include "evaluator.hpp"
+#include "snider/workpool.hpp"
+
+namespace detail {
+
+/** Gains that suit the plant, full speed. */
+static DriveKernel::Settings settings() {
+    DriveKernel::Settings s;
+    s.gains.kP   = 2.0;
+    s.gains.kS   = 0.0;
+    s.gains.kV   = s.plant.kV;
+    s.gains.kA   = s.plant.kA;
+    s.speedScale = 1.0;
+    s.settleTime = 1.0;
+    return s;
+}
+
+static frc::Trajectory straight() {
+    return frc::TrajectoryGenerator::GenerateTrajectory (
+        frc::Pose2d { 0_m, 0_m, 0_rad }, {}, frc::Pose2d { 2_m, 0_m, 0_rad },
+        frc::TrajectoryConfig (1_mps, 1_mps_sq));
+}
+
+} // namespace detail
+
+/** kA only: calculate() returns kA times the acceleration it applies. */
+TEST (DriveControlTest, SpreadsAccelerationOverDriveInterval) {
+    DriveControl::Gains gains;
+    gains.kA = 1.0;
+    DriveControl control (0.5_m, gains);
+    control.setPeriod (0.005);
+
+    // drive() every 4th tick, like the command rate against the drivetrain.
+    control.drive (0_mps, 0_rad_per_s);
+    for (int i = 0; i < 4; ++i)
+        EXPECT_DOUBLE_EQ (control.calculate (0.0, 0.0).first.value(), 0.0);
+
+    control.drive (0.2_mps, 0_rad_per_s);
+    for (int i = 0; i < 4; ++i) {
+        const auto [left, right] = control.calculate (0.0, 0.0);
+        EXPECT_NEAR (left.value(), 0.2 / 0.02, 1e-9) << "tick " << i;
+        EXPECT_NEAR (right.value(), 0.2 / 0.02, 1e-9) << "tick " << i;
+    }
+
+    // held target, no acceleration.
+    for (int i = 0; i < 8; ++i)
+        EXPECT_NEAR (control.calculate (0.0, 0.0).first.value(), 0.0, 1e-9);
+
+    // after a pause, a change is spread over the usual interval, not the pause.
+    control.drive (0.4_mps, 0_rad_per_s);
+    EXPECT_NEAR (control.calculate (0.0, 0.0).first.value(), 0.2 / 0.02, 1e-9);
+
+    // reset keeps the target as reached.
+    control.reset();
+    EXPECT_NEAR (control.calculate (0.0, 0.0).first.value(), 0.0, 1e-9);
+    control.drive (0.4_mps, 0_rad_per_s);
+    EXPECT_NEAR (control.calculate (0.0, 0.0).first.value(), 0.0, 1e-9);
+}
+
+TEST (DriveKernelTest, FollowsStraightPath) {
+    const auto trajectory = detail::straight();
+    DriveKernel kernel (detail::settings());
+    const auto result = kernel.run (trajectory, false, {});
+
+    EXPECT_TRUE (result.success);
+    EXPECT_LT (result.positionError, 0.05);
+    EXPECT_GT (result.completionTime, trajectory.TotalTime().value() - 0.5);
+    EXPECT_LT (result.completionTime, trajectory.TotalTime().value() + 1.0);
+
+    // the same episode twice gives the same result.
+    const auto again = kernel.run (trajectory, false, {});
+    EXPECT_DOUBLE_EQ (again.completionTime, result.completionTime);
+    EXPECT_DOUBLE_EQ (again.positionError, result.positionError);
+}
+
+// Slipping wheels count more than the floor moved. The odometry thinks the
+// bot arrived while it's still short.
+TEST (DriveKernelTest, SlipFallsShort) {
+    DriveKernel kernel (detail::settings());
+    DriveKernel::Perturbation p;
+    p.leftSlip = p.rightSlip = 0.3;
+    const auto result        = kernel.run (detail::straight(), false, p);
+
+    EXPECT_FALSE (result.success);
+    EXPECT_LT (result.completionTime, 0.0);
+    EXPECT_NEAR (result.positionError, 0.6, 0.1);
+}
+
+TEST (EvaluatorTest, Perturbations) {
+    Evaluator::Settings s;
+    s.maxSlip = 0.05;
+    Evaluator evaluator (s);
+
+    const auto a = evaluator.perturbation (0), b = evaluator.perturbation (1);
+    EXPECT_NE (a.x, b.x);
+    EXPECT_DOUBLE_EQ (a.x, evaluator.perturbation (0).x);
+    for (int i = 0; i < 100; ++i) {
+        const auto p = evaluator.perturbation (i);
+        EXPECT_GE (p.leftSlip, 0.0);
+        EXPECT_LE (p.leftSlip, s.maxSlip);
+        EXPECT_GE (p.kVScale, 0.5);
+        EXPECT_LE (p.kVScale, 1.5);
+    }
+}
+
+// Episodes draw their own perturbations, so the worker count changes the
+// speed and nothing else.
+TEST (EvaluatorTest, SameResultsOnAnyWorkers) {
+    Evaluator::Settings s;
+    s.runs   = 200;
+    s.kernel = detail::settings();
+    Evaluator evaluator (s);
+    const auto trajectory = detail::straight();
+
+    snider::WorkPool one (1), four (4);
+    const auto serial   = evaluator.evaluate ("straight", trajectory, false, one);
+    const auto parallel = evaluator.evaluate ("straight", trajectory, false, four);
+
+    EXPECT_EQ (serial.name, "straight");
+    EXPECT_EQ (serial.runs, 200);
+    EXPECT_EQ (parallel.runs, 200);
+    EXPECT_GT (serial.successes, 0);
+    EXPECT_EQ (serial.workers, 1);
+    EXPECT_EQ (parallel.workers, 4);
+
+    // bit for bit the same.
+    EXPECT_EQ (serial.successes, parallel.successes);
+    EXPECT_EQ (serial.completionMean, parallel.completionMean);
+    EXPECT_EQ (serial.completionP50, parallel.completionP50);
+    EXPECT_EQ (serial.completionP90, parallel.completionP90);
+    EXPECT_EQ (serial.completionP99, parallel.completionP99);
+    EXPECT_EQ (serial.completionMax, parallel.completionMax);
+    EXPECT_EQ (serial.errorP50, parallel.errorP50);
+    EXPECT_EQ (serial.errorP90, parallel.errorP90);
+    EXPECT_EQ (serial.errorMax, parallel.errorMax);
+
+    EXPECT_LE (serial.completionP50, serial.completionP90);
+    EXPECT_LE (serial.completionP90, serial.completionP99);
+    EXPECT_LE (serial.completionP99, serial.completionMax);
+    EXPECT_LE (serial.errorP50, serial.errorP90);
+    EXPECT_LE (serial.errorP90, serial.errorMax);
+}
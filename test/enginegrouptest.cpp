@@ -0,0 +1,81 @@
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "enginegroup.hpp"
+#include "scripting.hpp"
+
+namespace fs = std::filesystem;
+
+namespace detail {
+
+/** Write a bot program that counts its runs in a global, optionally failing
+    after a number of runs.
+*/
+static fs::path writeCounterBot (std::string_view name, int failAfter = -1) {
+    auto path = fs::temp_directory_path() / name;
+    std::ofstream out (path);
+    out << "local n = 0\n"
+        << "return {\n"
+        << "  run = function()\n"
+        << "    n = n + 1\n"
+        << "    _G['" << name << "'] = n\n"
+        << "    if " << failAfter << " > 0 and n >= " << failAfter << " then error('boom') end\n"
+        << "  end\n"
+        << "}\n";
+    return path;
+}
+
+static int runCount (std::string_view name) {
+    sol::object obj = lua::state()[name];
+    return obj.is<int>() ? obj.as<int>() : 0;
+}
+
+} // namespace detail
+
+class EngineGroupTest : public testing::Test {
+protected:
+    EngineGroup group;
+
+    EnginePtr instantiate (const fs::path& path) {
+        return Engine::instantiate (lua::state().lua_state(), path.string());
+    }
+};
+
+TEST_F (EngineGroupTest, Divisors) {
+    EXPECT_TRUE (group.add ("fast", instantiate (detail::writeCounterBot ("eg_fast.bot")), 1));
+    EXPECT_TRUE (group.add ("slow", instantiate (detail::writeCounterBot ("eg_slow.bot")), 3));
+    EXPECT_EQ (group.size(), 2u);
+    EXPECT_TRUE (group.prepare());
+
+    for (int i = 0; i < 30; ++i)
+        group.run (true);
+
+    EXPECT_EQ (detail::runCount ("eg_fast.bot"), 30);
+    EXPECT_EQ (detail::runCount ("eg_slow.bot"), 10);
+    EXPECT_EQ (group.programs()[0].stats.count(), 30);
+    EXPECT_EQ (group.programs()[1].stats.count(), 10);
+    EXPECT_FALSE (group.anyFailed());
+}
+
+TEST_F (EngineGroupTest, FailureIsIsolated) {
+    EXPECT_TRUE (group.add ("good", instantiate (detail::writeCounterBot ("eg_good.bot")), 1));
+    EXPECT_TRUE (group.add ("bad", instantiate (detail::writeCounterBot ("eg_bad.bot", 2)), 1));
+    EXPECT_TRUE (group.prepare());
+
+    for (int i = 0; i < 10; ++i)
+        group.run (true);
+
+    EXPECT_EQ (detail::runCount ("eg_good.bot"), 10);
+    EXPECT_EQ (detail::runCount ("eg_bad.bot"), 2);
+    EXPECT_TRUE (group.anyFailed());
+    EXPECT_FALSE (group.allFailed());
+    EXPECT_TRUE (group.cleanup());
+}
+
+TEST_F (EngineGroupTest, MissingFile) {
+    EXPECT_FALSE (group.add ("missing", instantiate ("does_not_exist.bot"), 1));
+    EXPECT_TRUE (group.empty());
+    EXPECT_TRUE (group.allFailed());
+}
@@ -1,6 +1,8 @@
 
+#include <cmath>
 #include <filesystem>
 
+#include <frc/simulation/DriverStationSim.h>
 #include <gtest/gtest.h>
 
 #include "test.hpp"
@@ -16,6 +18,22 @@ public:
         if (gTimedRobot != nullptr)
             gTimedRobot->RobotInit();
     }
+
+protected:
+    static void setEnabled (bool enabled, bool autonomous = false) {
+        frc::sim::DriverStationSim::SetAutonomous (autonomous);
+        frc::sim::DriverStationSim::SetEnabled (enabled);
+        frc::sim::DriverStationSim::NotifyNewData();
+    }
+
+    // rate groups run on their own clock, shared by every test.
+    static TelemetryFrame stepRateGroups (double ms) {
+        rateClockMs += ms;
+        return step_rate_groups (gTimedRobot, rateClockMs);
+    }
+
+private:
+    static inline double rateClockMs = 0.0;
 };
 
 TEST_F (EngineTest, Period) {
@@ -31,9 +49,49 @@ TEST_F (EngineTest, RunAutonomous) {
     int ticks = 1000 / period;
     while (--ticks >= 0) {
         gTimedRobot->AutonomousPeriodic();
+        stepRateGroups (period);
+        gTimedRobot->RobotPeriodic();
+    }
+    gTimedRobot->AutonomousExit();
+}
+
+TEST_F (EngineTest, RateGroupsRunAutonomous) {
+    // the auto command shoots while following the path, both only reach
+    // the motors through the rate groups.
+    constexpr int shooting = 1;
+    setEnabled (true, true);
+    gTimedRobot->AutonomousInit();
+    const double period = units::time::millisecond_t (gTimedRobot->GetPeriod()).value();
+    auto tick = [period]() {
+        gTimedRobot->AutonomousPeriodic();
+        auto frame = stepRateGroups (period);
         gTimedRobot->RobotPeriodic();
+        return frame;
+    };
+
+    double driveVolts = 0.0;
+    TelemetryFrame frame;
+    for (int i = 0; i < 10; ++i) {
+        frame      = tick();
+        driveVolts = std::max (driveVolts, std::abs (frame.leftVolts));
     }
+    EXPECT_GT (driveVolts, 0.0);
+    EXPECT_EQ (frame.shooterState, shooting);
+
+    // disabled: the shot holds where it was, however long it waits.
+    setEnabled (false);
+    for (int i = 0; i < 3000 / period; ++i)
+        frame = tick();
+    EXPECT_EQ (frame.shooterState, shooting);
+
+    // enabled again it finishes.
+    setEnabled (true, true);
+    for (int i = 0; i < 3000 / period; ++i)
+        frame = tick();
+    EXPECT_NE (frame.shooterState, shooting);
+
     gTimedRobot->AutonomousExit();
+    setEnabled (false);
 }
 
 TEST_F (EngineTest, RunTeleop) {
@@ -43,6 +101,7 @@ TEST_F (EngineTest, RunTeleop) {
     int ticks = 1000 / period;
     while (--ticks >= 0) {
         gTimedRobot->TeleopPeriodic();
+        stepRateGroups (period);
         gTimedRobot->RobotPeriodic();
     }
     gTimedRobot->TeleopExit();
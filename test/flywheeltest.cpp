@@ -0,0 +1,168 @@
+#include <frc/simulation/FlywheelSim.h>
+#include <frc/system/plant/DCMotor.h>
+#include <gtest/gtest.h>
+
+#include "config.hpp"
+#include "robot.hpp"
+#include "snider/velocitygate.hpp"
+#include "test.hpp"
+
+TEST (VelocityGateTest, SettlesBeforeReady) {
+    snider::VelocityGate gate (0.05, 0.10, 3);
+    EXPECT_FALSE (gate.update (1000.0, 500.0));
+    EXPECT_FALSE (gate.update (1000.0, 960.0));
+    EXPECT_FALSE (gate.update (1000.0, 970.0));
+    EXPECT_TRUE (gate.update (1000.0, 980.0));
+
+    // a reading outside starts the count over.
+    gate.reset();
+    EXPECT_FALSE (gate.update (1000.0, 990.0));
+    EXPECT_FALSE (gate.update (1000.0, 900.0));
+    EXPECT_FALSE (gate.update (1000.0, 990.0));
+    EXPECT_FALSE (gate.update (1000.0, 990.0));
+    EXPECT_TRUE (gate.update (1000.0, 990.0));
+}
+
+TEST (VelocityGateTest, Hysteresis) {
+    snider::VelocityGate gate (0.05, 0.10, 1);
+    EXPECT_TRUE (gate.update (1000.0, 1040.0));
+
+    // between the tolerances: stays ready.
+    EXPECT_TRUE (gate.update (1000.0, 920.0));
+    EXPECT_TRUE (gate.update (1000.0, 1080.0));
+
+    // past the exit tolerance: not ready until back inside the entry one.
+    EXPECT_FALSE (gate.update (1000.0, 880.0));
+    EXPECT_FALSE (gate.update (1000.0, 920.0));
+    EXPECT_TRUE (gate.update (1000.0, 960.0));
+}
+
+TEST (VelocityGateTest, ExitIsAtLeastEnter) {
+    snider::VelocityGate gate (0.10, 0.01, 1);
+    EXPECT_TRUE (gate.update (100.0, 95.0));
+    EXPECT_TRUE (gate.update (100.0, 91.0));
+}
+
+// Spin a simulated flywheel the way the shooter does and count how long it
+// takes to reach speed. Should beat the fixed warm-up it replaces.
+TEST (FlywheelTest, ReachesSpeedBeforeWarmup) {
+    const double volts      = config::number ("shooter", "shoot_power", 12.0);
+    const double rpmPerVolt = config::number ("shooter", "rpm_per_volt", 440.0);
+    const double warmupMs   = 1000.0 * config::number ("shooter", "warmup_time", 1.0);
+    const int periodMs      = config::integer ("engine", "period", 20);
+
+    frc::sim::FlywheelSim flywheel (frc::DCMotor::NEO (1), 1.0,
+                                    units::kilogram_square_meter_t (config::number ("shooter", "sim_moi", 0.0008)));
+    snider::VelocityGate gate (config::number ("shooter", "ready_tolerance", 0.05),
+                               config::number ("shooter", "ready_exit_tolerance", 0.10),
+                               config::integer ("shooter", "ready_samples", 2));
+
+    int ticks = 0;
+    for (; ticks * periodMs < warmupMs; ++ticks) {
+        const double rpm = units::revolutions_per_minute_t (flywheel.GetAngularVelocity()).value();
+        if (gate.update (volts * rpmPerVolt, rpm))
+            break;
+        flywheel.SetInputVoltage (units::volt_t (volts));
+        flywheel.Update (units::millisecond_t (periodMs));
+    }
+
+    // the flywheel's time constant is under 0.2 s, at speed in about half
+    // the warm-up.
+    const double spinUpMs = ticks * periodMs;
+    EXPECT_TRUE (gate.ready());
+    EXPECT_LT (spinUpMs, 0.6 * warmupMs);
+}
+
+// Shoot with the robot's shooter on simulated flywheels and check that
+// process() only feeds once they reach the target speed.
+class ShooterTest : public testing::Test {
+protected:
+    ShooterTest() : shooter (simulated_shooter (gTimedRobot)),
+                    robotPeriodMs (shooter.processPeriod()) {
+        shooter.reset();
+        shooter.resetStats();
+        shooter.setPowerScale (1.0);
+        shooter.setProcessPeriod (periodMs); // the physics step per process()
+    }
+
+    ~ShooterTest() {
+        shooter.stop();
+        shooter.process();
+        shooter.setPowerScale (1.0);
+        shooter.setProcessPeriod (robotPeriodMs);
+    }
+
+    // process and step the flywheels until feeding, returns the ticks taken.
+    int spinUp (bool spin = true) {
+        int ticks = 0;
+        while (shooter.isShooting() && ! shooter.isFeeding() && ticks < 1000) {
+            EXPECT_FALSE (shooter.flywheelsReady());
+            shooter.process();
+            if (spin)
+                gTimedRobot->SimulationPeriodic();
+            ++ticks;
+        }
+        return ticks;
+    }
+
+    // finish the shot and let the flywheels stop.
+    void finish() {
+        for (int i = 0; i < 3000 / periodMs; ++i) {
+            shooter.process();
+            gTimedRobot->SimulationPeriodic();
+        }
+        EXPECT_TRUE (shooter.isIdle());
+    }
+
+    const int periodMs { static_cast<int> (units::millisecond_t (gTimedRobot->GetPeriod()).value()) };
+    const int warmupTicks { std::max (1, int (1000.0 * config::number ("shooter", "warmup_time")) / periodMs) };
+    const double tolerance { config::number ("shooter", "ready_tolerance", 0.05) };
+    Shooter& shooter;
+    const int robotPeriodMs;
+};
+
+TEST_F (ShooterTest, FeedsAtSpeed) {
+    shooter.shoot();
+    const int ticks = spinUp();
+
+    EXPECT_TRUE (shooter.isFeeding());
+    EXPECT_TRUE (shooter.flywheelsReady());
+    EXPECT_LT (ticks, warmupTicks);
+    EXPECT_NEAR (shooter.flywheelRpm(), shooter.targetRpm(), tolerance * shooter.targetRpm());
+    EXPECT_EQ (shooter.feedsAtSpeed(), 1);
+    EXPECT_EQ (shooter.feedsOnTimeout(), 0);
+
+    // the tick that found the flywheels ready counts toward the spin-up.
+    EXPECT_EQ (shooter.spinUpTimes().count(), 1);
+    EXPECT_DOUBLE_EQ (shooter.spinUpTimes().maxMicros(), 1000.0 * ticks * periodMs);
+    finish();
+}
+
+TEST_F (ShooterTest, FeedsOnTimeoutBelowSpeed) {
+    // flywheels that never spin up are fed when the warm-up runs out.
+    finish();
+    shooter.shoot();
+    const int ticks = spinUp (false);
+
+    EXPECT_TRUE (shooter.isFeeding());
+    EXPECT_EQ (ticks, warmupTicks);
+    EXPECT_EQ (shooter.feedsAtSpeed(), 0);
+    EXPECT_EQ (shooter.feedsOnTimeout(), 1);
+    EXPECT_DOUBLE_EQ (shooter.spinUpTimes().maxMicros(), 1000.0 * warmupTicks * periodMs);
+    finish();
+}
+
+TEST_F (ShooterTest, PowerLimitedTargetIsReached) {
+    finish();
+    const double fullRpm = shooter.targetRpm();
+    shooter.setPowerScale (0.5);
+    EXPECT_DOUBLE_EQ (shooter.targetRpm(), 0.5 * fullRpm);
+
+    shooter.shoot();
+    const int ticks = spinUp();
+    EXPECT_TRUE (shooter.isFeeding());
+    EXPECT_LT (ticks, warmupTicks);
+    EXPECT_NEAR (shooter.flywheelRpm(), 0.5 * fullRpm, tolerance * 0.5 * fullRpm);
+    EXPECT_EQ (shooter.feedsAtSpeed(), 1);
+    finish();
+}
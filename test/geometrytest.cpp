@@ -0,0 +1,138 @@
+#include <cmath>
+#include <iostream>
+
+#include <frc/geometry/Pose2d.h>
+#include <frc/geometry/Transform2d.h>
+#include <gtest/gtest.h>
+
+#include "geometry.hpp"
+#include "scripting.hpp"
+#include "test.hpp"
+
+namespace detail {
+
+static frc_Pose2d pose (double x, double y, double radians) {
+    frc_Pose2d p;
+    p.translation = { x, y };
+    frc_geometry_api()->rotation_from_radians (radians, &p.rotation);
+    return p;
+}
+
+static void expectPose (const frc_Pose2d& actual, const frc::Pose2d& expected) {
+    EXPECT_NEAR (actual.translation.x, expected.X().value(), 1e-9);
+    EXPECT_NEAR (actual.translation.y, expected.Y().value(), 1e-9);
+    EXPECT_NEAR (actual.rotation.cos, expected.Rotation().Cos(), 1e-9);
+    EXPECT_NEAR (actual.rotation.sin, expected.Rotation().Sin(), 1e-9);
+}
+
+} // namespace detail
+
+TEST (GeometryTest, MatchesWPILib) {
+    using namespace units::literals;
+    const auto* api = frc_geometry_api();
+    const frc::Pose2d a (1_m, 2_m, 30_deg), b (-0.5_m, 4_m, -100_deg);
+    const auto fa = detail::pose (1, 2, units::radian_t (30_deg).value());
+    const auto fb = detail::pose (-0.5, 4, units::radian_t (-100_deg).value());
+
+    frc_Transform2d t;
+    api->transform_between (&fa, &fb, &t);
+    frc_Pose2d out;
+    api->pose_transform_by (&fa, &t, &out);
+    detail::expectPose (out, b);
+
+    api->pose_relative_to (&fb, &fa, &out);
+    detail::expectPose (out, b.RelativeTo (a));
+
+    frc_Twist2d twist;
+    api->pose_log (&fa, &fb, &twist);
+    EXPECT_NEAR (twist.dtheta, a.Log (b).dtheta.value(), 1e-9);
+    api->pose_exp (&fa, &twist, &out);
+    detail::expectPose (out, b);
+
+    api->pose_interpolate (&fa, &fb, 0.0, &out);
+    detail::expectPose (out, a);
+    api->pose_interpolate (&fa, &fb, 2.0, &out);
+    detail::expectPose (out, b);
+
+    frc_Transform2d inverse, identity;
+    api->transform_inverse (&t, &inverse);
+    api->transform_compose (&t, &inverse, &identity);
+    EXPECT_NEAR (identity.translation.x, 0.0, 1e-9);
+    EXPECT_NEAR (identity.translation.y, 0.0, 1e-9);
+    EXPECT_NEAR (identity.rotation.cos, 1.0, 1e-9);
+
+    EXPECT_NEAR (api->pose_distance (&fa, &fb), a.Translation().Distance (b.Translation()).value(), 1e-9);
+    EXPECT_NEAR (api->rotation_radians (&fb.rotation), b.Rotation().Radians().value(), 1e-9);
+}
+
+/** The FFI types in robot/geometry.lua against the sol usertypes, doing the
+    same pose math. The FFI loop writes to values made ahead of time and
+    should leave no garbage once compiled, the usertypes make a new pose
+    every step. Prints the time and garbage per operation of each.
+*/
+TEST (GeometryTest, FfiAgainstUsertypes) {
+    ASSERT_NE (gTimedRobot, nullptr);
+    auto& L = lua::state();
+
+    sol::load_result chunk = L.load (R"(
+        local geometry = require('geometry')
+        local usertypes = cxx.geometry
+        local N = ...
+
+        local function ffi_run(n)
+            local pose = geometry.Pose2d(1.0, 2.0, 0.5)
+            local step = geometry.Transform2d(0.01, 0.0, 0.001)
+            local next = geometry.Pose2d()
+            local d = 0.0
+            for _ = 1, n do
+                pose:transform_by(step, next)
+                d = d + next:distance(pose) + next.rotation:degrees()
+                pose, next = next, pose
+            end
+            return d, pose:x()
+        end
+
+        local function usertype_run(n)
+            local pose = usertypes.Pose2d.new(1.0, 2.0, 0.5)
+            local step = usertypes.Transform2d.new(0.01, 0.0, 0.001)
+            local d = 0.0
+            for _ = 1, n do
+                local next = pose:transformBy(step)
+                d = d + next:distance(pose) + next.rotation.degrees
+                pose = next
+            end
+            return d, pose.x
+        end
+
+        local function measure(fn, n)
+            fn(1000)
+            collectgarbage()
+            collectgarbage('stop')
+            local kb = collectgarbage('count')
+            local start = os.clock()
+            local d, x = fn(n)
+            local seconds = os.clock() - start
+            kb = collectgarbage('count') - kb
+            collectgarbage('restart')
+            return { ns = 1e9 * seconds / n, bytes = 1024 * kb / n, d = d, x = x }
+        end
+
+        return measure(ffi_run, N), measure(usertype_run, N)
+    )");
+    ASSERT_TRUE (chunk.valid()) << sol::error (chunk).what();
+    sol::protected_function run        = chunk;
+    sol::protected_function_result res = run (200000);
+    ASSERT_TRUE (res.valid()) << sol::error (res).what();
+
+    sol::table ffi = res[0], usertype = res[1];
+    for (const auto& [name, r] : { std::pair { "ffi", ffi }, std::pair { "usertype", usertype } })
+        std::clog << "[geometry] " << name << ": " << r.get<double> ("ns") << " ns/op, "
+                  << r.get<double> ("bytes") << " bytes/op" << std::endl;
+
+    // both walk the same path, give or take rounding over the steps.
+    const double d = usertype.get<double> ("d");
+    EXPECT_NEAR (ffi.get<double> ("d"), d, 1e-9 * std::abs (d));
+    EXPECT_NEAR (ffi.get<double> ("x"), usertype.get<double> ("x"), 1e-6);
+    EXPECT_LT (ffi.get<double> ("bytes"), 1.0);
+    EXPECT_GT (usertype.get<double> ("bytes"), 16.0);
+}
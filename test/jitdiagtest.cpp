@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include <frc/simulation/XboxControllerSim.h>
+#include <gtest/gtest.h>
+
+#include "config.hpp"
+#include "jitdiag.hpp"
+#include "scripting.hpp"
+#include "test.hpp"
+
+namespace fs = std::filesystem;
+
+namespace detail {
+
+// LuaJIT's jit/vmdef.lua turns abort reasons in to text, when the sdk has it.
+static void addVmdefPath (sol::state& L) {
+    const auto share = fs::path (__FILE__).parent_path().parent_path() / "vendordeps" / "sdk" / "linux64" / "share";
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator (share, ec)) {
+        if (fs::exists (entry.path() / "jit" / "vmdef.lua")) {
+            std::string path = L["package"]["path"];
+            L["package"]["path"] = path + ";" + (entry.path() / "?.lua").string();
+            return;
+        }
+    }
+}
+
+static std::vector<std::string> botPrograms() {
+    std::vector<std::string> out;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator (lua::search_directory(), ec))
+        if (entry.path().extension() == ".bot")
+            out.push_back (entry.path().filename().string());
+    std::sort (out.begin(), out.end());
+    return out;
+}
+
+} // namespace detail
+
+class JitDiagTest : public testing::Test {
+public:
+    JitDiagTest() {
+        if (gTimedRobot != nullptr)
+            gTimedRobot->RobotInit();
+    }
+};
+
+TEST (JitDiagInputTest, Synthetic) {
+    const auto input = lua::JitDiagnostics::synthetic (240);
+    ASSERT_EQ (input.size(), 240);
+    uint32_t buttons = 0;
+    bool pov         = false;
+    for (const auto& in : input) {
+        buttons |= in.buttons;
+        pov = pov || in.pov >= 0;
+        for (double a : in.axes) {
+            EXPECT_GE (a, -1.0);
+            EXPECT_LE (a, 1.0);
+        }
+    }
+    EXPECT_EQ (buttons, 0xffu); // the first 8 buttons in 240 ticks
+    EXPECT_TRUE (pov);
+}
+
+/** Runs every .bot in teleop against synthetic input, or the recording named
+    by JITDIAG_INPUT, and logs its trace report: compiled and aborted
+    traces, abort reasons with source locations and the interpreted share.
+    Checks the report adds up. see JitDiagnostics::load
+*/
+TEST_F (JitDiagTest, BotPrograms) {
+    ASSERT_NE (gTimedRobot, nullptr);
+    auto& L = lua::state();
+    detail::addVmdefPath (L);
+
+    const char* recording = std::getenv ("JITDIAG_INPUT");
+    const auto input      = recording != nullptr ? lua::JitDiagnostics::load (recording)
+                                                 : lua::JitDiagnostics::synthetic (600);
+    ASSERT_FALSE (input.empty());
+
+    // run one program at a time in teleop, put the config back after.
+    sol::table engine    = L["config"]["engine"];
+    sol::object programs = engine["teleop"];
+
+    frc::sim::XboxControllerSim pad (config::port ("gamepad"));
+    lua::JitDiagnostics diagnostics (L.lua_state());
+
+    for (const auto& program : detail::botPrograms()) {
+        engine["teleop"] = L.create_table_with (1, L.create_table_with ("program", program, "divisor", 1));
+        gTimedRobot->TeleopInit();
+        ASSERT_TRUE (diagnostics.begin()) << diagnostics.error();
+
+        for (const auto& in : input) {
+            for (int i = 0; i < 6; ++i)
+                pad.SetRawAxis (i, in.axes[i]);
+            for (int i = 0; i < 10; ++i)
+                pad.SetRawButton (i + 1, ((in.buttons >> i) & 1u) != 0);
+            pad.SetPOV (in.pov);
+            pad.NotifyNewData();
+            gTimedRobot->TeleopPeriodic();
+            gTimedRobot->RobotPeriodic();
+        }
+
+        const auto report = diagnostics.end (program);
+        gTimedRobot->TeleopExit();
+        lua::JitDiagnostics::print (std::clog, report);
+
+        EXPECT_EQ (report.program, program);
+        EXPECT_GT (report.started, 0) << program;
+
+        // every trace started stops or aborts, but one may still be recording.
+        EXPECT_LE (report.compiled + report.aborted, report.started) << program;
+        EXPECT_GE (report.compiled + report.aborted, report.started - 1) << program;
+
+        int compiled = 0;
+        for (const auto& t : report.traces) {
+            EXPECT_FALSE (t.location.empty()) << program;
+            compiled += t.count;
+        }
+        EXPECT_EQ (compiled, report.compiled) << program;
+
+        int aborted = 0;
+        for (const auto& a : report.aborts) {
+            EXPECT_FALSE (a.reason.empty()) << program;
+            EXPECT_FALSE (a.location.empty()) << program;
+            aborted += a.count;
+        }
+        EXPECT_EQ (aborted, report.aborted) << program;
+
+        auto mostFirst = [] (const auto& a, const auto& b) { return a.count > b.count; };
+        EXPECT_TRUE (std::is_sorted (report.traces.begin(), report.traces.end(), mostFirst)) << program;
+        EXPECT_TRUE (std::is_sorted (report.aborts.begin(), report.aborts.end(), mostFirst)) << program;
+
+        EXPECT_GE (report.interpreted, 0.0) << program;
+        EXPECT_LE (report.interpreted, 1.0) << program;
+        EXPECT_GE (report.inC, 0.0) << program;
+        EXPECT_GE (report.inGC, 0.0) << program;
+        EXPECT_LE (report.inC + report.inGC, 1.0 + 1e-9) << program;
+    }
+
+    engine["teleop"] = programs;
+}
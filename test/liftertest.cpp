@@ -0,0 +1,144 @@
+#include <frc/trajectory/TrapezoidProfile.h>
+#include <gtest/gtest.h>
+
+#include "robot.hpp"
+#include "test.hpp"
+
+TEST (LifterTest, Setpoints) {
+    const auto settings = Lifter::Settings::fromConfig();
+    EXPECT_LT (settings.minPosition, settings.maxPosition);
+    EXPECT_FALSE (settings.setpoints.empty());
+    for (const auto& [name, degrees] : settings.setpoints) {
+        EXPECT_GE (degrees, settings.minPosition) << name;
+        EXPECT_LE (degrees, settings.maxPosition) << name;
+    }
+
+    EXPECT_TRUE (settings.setpoint ("raised").has_value());
+    EXPECT_FALSE (settings.setpoint ("not a setpoint").has_value());
+    EXPECT_EQ (settings.clamp (1000.0), settings.maxPosition);
+    EXPECT_EQ (settings.clamp (-1000.0), settings.minPosition);
+}
+
+// Move the robot's lifter on simulated arms, one process() and physics
+// step per engine tick.
+class LifterSimTest : public testing::Test {
+protected:
+    LifterSimTest() : lifter (simulated_lifter (gTimedRobot)),
+                      settings (lifter.settings()),
+                      robotPeriodMs (lifter.processPeriod()) {
+        lifter.stop();
+        lifter.setPowerScale (1.0);
+        lifter.setProcessPeriod (periodMs); // the physics step per process()
+    }
+
+    ~LifterSimTest() {
+        lifter.stop();
+        lifter.process();
+        lifter.setPowerScale (1.0);
+        lifter.setProcessPeriod (robotPeriodMs);
+        lifter.resetStats();
+    }
+
+    // process and step the arms until both are at `degrees`.
+    void settle (double degrees) {
+        lifter.moveTo (degrees);
+        for (int tick = 0; tick < 5000 / periodMs && ! lifter.atGoal(); ++tick) {
+            gTimedRobot->SimulationPeriodic();
+            lifter.process();
+        }
+        EXPECT_TRUE (lifter.atGoal());
+    }
+
+    const int periodMs { config::integer ("engine", "period", 20) };
+    const double dt { periodMs / 1000.0 };
+    Lifter& lifter;
+    const Lifter::Settings& settings;
+    const int robotPeriodMs;
+};
+
+// Raised from stowed, the arms should arrive shortly after the profile ends
+// without passing the upper soft limit.
+TEST_F (LifterSimTest, ProfiledMoveReachesSetpoint) {
+    using Profile = frc::TrapezoidProfile<units::degrees>;
+    settle (*settings.setpoint ("stowed"));
+    lifter.stop(); // start the move from the arms, not the last profile.
+    lifter.resetStats();
+
+    EXPECT_FALSE (lifter.moveTo ("not a setpoint"));
+    ASSERT_TRUE (lifter.moveTo ("raised"));
+    const double goal = *settings.setpoint ("raised");
+    EXPECT_DOUBLE_EQ (lifter.goal(), goal);
+
+    Profile profile ({ Profile::Velocity_t { settings.maxVelocity },
+                       Profile::Acceleration_t { settings.maxAcceleration } });
+    profile.Calculate (units::second_t (dt),
+                       { units::degree_t (lifter.position()), units::degrees_per_second_t (0.0) },
+                       { units::degree_t (goal), units::degrees_per_second_t (0.0) });
+    const double profileTime = profile.TotalTime().value();
+
+    double arrived = -1.0, highest = lifter.position();
+    for (int tick = 0; tick * dt < profileTime + 2.0; ++tick) {
+        lifter.process();
+        highest = std::max (highest, lifter.position());
+        if (arrived < 0.0 && lifter.atGoal())
+            arrived = tick * dt;
+        gTimedRobot->SimulationPeriodic();
+    }
+
+    // the arms track the profile: there near its end, a small overshoot at
+    // most, and settled on the goal.
+    ASSERT_GE (arrived, 0.0);
+    EXPECT_GT (arrived, profileTime - 0.5);
+    EXPECT_LT (arrived, profileTime + 0.25);
+    EXPECT_LE (highest, goal + 2.0 * settings.tolerance);
+    EXPECT_LE (highest, settings.maxPosition);
+    EXPECT_TRUE (lifter.atGoal());
+    EXPECT_NEAR (lifter.position(), goal, 0.5 * settings.tolerance);
+
+    // the move time counts the tick that found both arms there.
+    EXPECT_EQ (lifter.moveTimes().count(), 1);
+    EXPECT_NEAR (lifter.moveTimes().maxMicros(), 1e6 * (arrived + dt), 1.0);
+}
+
+// Moved by hand, the arms are driven at the manual voltage until they reach
+// a soft limit, then the motors stop.
+TEST_F (LifterSimTest, ManualMoveStopsAtSoftLimits) {
+    settle (0.0);
+    for (const double direction : { 1.0, -1.0 }) {
+        const double limit = direction > 0.0 ? settings.maxPosition : settings.minPosition;
+        if (direction > 0.0)
+            lifter.moveUp();
+        else
+            lifter.moveDown();
+
+        bool reached = false;
+        for (int tick = 0; tick < 3000 / periodMs; ++tick) {
+            lifter.process();
+            const bool past = direction * (lifter.position() - limit) >= 0.0;
+            EXPECT_DOUBLE_EQ (lifter.outputVoltage(), past ? 0.0 : direction * settings.manualVoltage)
+                << "at " << lifter.position() << " degrees";
+            reached = reached || past;
+            gTimedRobot->SimulationPeriodic();
+        }
+        EXPECT_TRUE (reached) << "limit " << limit;
+        EXPECT_FALSE (lifter.atGoal());
+    }
+}
+
+TEST_F (LifterSimTest, PowerScale) {
+    settle (0.0);
+
+    lifter.setPowerScale (0.5);
+    lifter.moveUp();
+    lifter.process();
+    EXPECT_DOUBLE_EQ (lifter.outputVoltage(), 0.5 * settings.manualVoltage);
+
+    // clamped to full power.
+    lifter.setPowerScale (2.0);
+    lifter.process();
+    EXPECT_DOUBLE_EQ (lifter.outputVoltage(), settings.manualVoltage);
+
+    lifter.stop();
+    lifter.process();
+    EXPECT_DOUBLE_EQ (lifter.outputVoltage(), 0.0);
+}
@@ -0,0 +1,149 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "luabundle.hpp"
+#include "sol/sol.hpp"
+
+namespace fs = std::filesystem;
+
+namespace detail {
+
+struct Script {
+    std::string name, source;
+};
+
+template <typename T>
+static void put (std::string& out, T value) {
+    char bytes[sizeof (T)];
+    std::memcpy (bytes, &value, sizeof (T));
+    out.append (bytes, sizeof (T));
+}
+
+/** Write a bundle of source chunks the way util/bundle-lua.py does. */
+static fs::path writeBundle (const fs::path& dir, const std::vector<Script>& scripts) {
+    fs::create_directories (dir);
+    std::string index, names, data;
+    uint32_t nameOffset = 16 + 24 * static_cast<uint32_t> (scripts.size());
+    uint32_t dataOffset = nameOffset;
+    for (const auto& s : scripts)
+        dataOffset += static_cast<uint32_t> (s.name.size());
+
+    for (const auto& s : scripts) {
+        put<uint32_t> (index, nameOffset);
+        put<uint32_t> (index, static_cast<uint32_t> (s.name.size()));
+        put<uint32_t> (index, dataOffset);
+        put<uint32_t> (index, static_cast<uint32_t> (s.source.size()));
+        put<uint32_t> (index, 0);
+        put<uint32_t> (index, 0);
+        names += s.name;
+        data += s.source;
+        nameOffset += static_cast<uint32_t> (s.name.size());
+        dataOffset += static_cast<uint32_t> (s.source.size());
+    }
+
+    std::string header ("SNLB");
+    put<uint32_t> (header, 2);
+    put<uint32_t> (header, static_cast<uint32_t> (scripts.size()));
+    put<uint32_t> (header, 0);
+
+    auto path = dir / lua::Bundle::fileName;
+    std::ofstream out (path, std::ios::binary);
+    out << header << index << names << data;
+    return path;
+}
+
+} // namespace detail
+
+TEST (LuaBundleTest, OpenAndFind) {
+    const auto dir  = fs::temp_directory_path() / "luabundle_find";
+    const auto file = detail::writeBundle (dir, { { "b.lua", "return 2" }, { "a.lua", "return 1" } });
+    auto bundle     = lua::Bundle::open (file.string());
+    ASSERT_NE (bundle, nullptr);
+    EXPECT_EQ (bundle->chunks().size(), 2);
+    ASSERT_NE (bundle->find ("a.lua"), nullptr);
+    EXPECT_EQ (bundle->find ("a.lua")->data, "return 1");
+    EXPECT_EQ (bundle->find ("b.lua")->data, "return 2");
+    EXPECT_EQ (bundle->find ("c.lua"), nullptr);
+
+    // not a bundle.
+    std::ofstream (dir / "junk.luab") << "not a bundle at all";
+    EXPECT_EQ (lua::Bundle::open ((dir / "junk.luab").string()), nullptr);
+    EXPECT_EQ (lua::Bundle::open ((dir / "missing.luab").string()), nullptr);
+}
+
+TEST (LuaBundleTest, RequireFromMemory) {
+    const auto dir  = fs::temp_directory_path() / "luabundle_require";
+    const auto file = detail::writeBundle (dir, {
+                                                    { "answer.lua", "return { value = 42 }" },
+                                                    { "nested/init.lua", "return 'nested'" },
+                                                });
+    auto bundle     = lua::Bundle::open (file.string());
+    ASSERT_NE (bundle, nullptr);
+
+    sol::state L;
+    L.open_libraries();
+    L["package"]["path"] = (dir / "?.lua").string();
+    lua::add_searcher (L.lua_state(), *bundle);
+
+    EXPECT_EQ (L.script ("return require ('answer').value").get<int>(), 42);
+    EXPECT_EQ (L.script ("return require ('nested')").get<std::string>(), "nested");
+    EXPECT_EQ (bundle->loaded(), 2);
+
+    // a module in neither still fails like before.
+    sol::protected_function_result res = L.safe_script ("return require ('missing')", sol::script_pass_on_error);
+    EXPECT_FALSE (res.valid());
+}
+
+TEST (LuaBundleTest, FilesOverrideOnlyWithMarker) {
+    const auto dir  = fs::temp_directory_path() / "luabundle_override";
+    const auto file = detail::writeBundle (dir, { { "module.lua", "return 'bundled'" } });
+    fs::remove (dir / lua::Bundle::overridesFile);
+
+    // a loose script, newer than the bundle, like an older deploy leaves.
+    std::ofstream (dir / "module.lua") << "return 'file'";
+    for (bool marker : { false, true }) {
+        if (marker)
+            std::ofstream (dir / lua::Bundle::overridesFile);
+        auto bundle = lua::Bundle::open (file.string());
+        ASSERT_NE (bundle, nullptr);
+        EXPECT_EQ (bundle->overrides(), marker);
+
+        sol::state L;
+        L.open_libraries();
+        L["package"]["path"] = (dir / "?.lua").string();
+        lua::add_searcher (L.lua_state(), *bundle);
+
+        EXPECT_EQ (L.script ("return require ('module')").get<std::string>(), marker ? "file" : "bundled");
+        EXPECT_EQ (bundle->overridden(), marker ? 1 : 0);
+        EXPECT_EQ (bundle->loaded(), marker ? 0 : 1);
+    }
+    fs::remove (dir / lua::Bundle::overridesFile);
+}
+
+TEST (LuaBundleTest, LoadBotFile) {
+    const auto dir  = fs::temp_directory_path() / "luabundle_bot";
+    const auto file = detail::writeBundle (dir, { { "only.bot", "return { run = function() end }" } });
+    auto bundle     = lua::Bundle::open (file.string());
+    ASSERT_NE (bundle, nullptr);
+
+    sol::state L;
+    L.open_libraries();
+    auto state = L.lua_state();
+
+    // only in the bundle.
+    EXPECT_EQ (lua::load_chunk (state, bundle.get(), (dir / "only.bot").string()), 0);
+    EXPECT_EQ (lua_type (state, -1), LUA_TFUNCTION);
+    lua_pop (state, 1);
+
+    // the same name elsewhere isn't the bundle's.
+    const auto other = fs::temp_directory_path() / "only.bot";
+    fs::remove (other);
+    EXPECT_NE (lua::load_chunk (state, bundle.get(), other.string()), 0);
+    EXPECT_NE (std::string (lua_tostring (state, -1)).find ("file does not exist"), std::string::npos);
+    lua_pop (state, 1);
+    EXPECT_EQ (bundle->loaded(), 1);
+}
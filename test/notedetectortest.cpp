@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "notedetector.hpp"
+
+namespace detail {
+
+static constexpr double period = 0.02;
+
+/** Feed a current profile to a detector for some seconds. Returns the time
+    the note was detected or -1.
+*/
+template <typename Profile>
+static double run (NoteDetector& detector, Profile&& profile, double seconds) {
+    detector.reset();
+    for (double t = 0.0; t < seconds; t += period)
+        if (detector.update (profile (t)))
+            return t;
+    return -1.0;
+}
+
+} // namespace detail
+
+class NoteDetectorTest : public testing::Test {
+protected:
+    NoteDetector::Settings settings;
+    IntakeCurrentProfile profile;
+
+    void SetUp() override {
+        // fixed values so config changes don't break the tests.
+        settings           = {};
+        settings.blankTime = 0.3;
+        profile            = {};
+    }
+};
+
+TEST_F (NoteDetectorTest, DetectsNote) {
+    NoteDetector detector (settings, detail::period);
+    const double detected = detail::run (detector, profile, 3.0);
+    ASSERT_GE (detected, profile.noteTime);
+    EXPECT_LT (detected - profile.noteTime, 0.3);
+    EXPECT_NEAR (detector.baseline(), profile.freeCurrent, 0.5 * settings.spikeCurrent);
+}
+
+TEST_F (NoteDetectorTest, IgnoresInrush) {
+    profile.noteTime = -1.0;
+    NoteDetector detector (settings, detail::period);
+    EXPECT_LT (detail::run (detector, profile, 5.0), 0.0);
+    EXPECT_FALSE (detector.detected());
+}
+
+TEST_F (NoteDetectorTest, RejectsShortBumps) {
+    profile.noteTime = -1.0;
+    NoteDetector detector (settings, detail::period);
+    auto bumpy = [this] (double t) {
+        // a 60ms bump every half second, like hitting the bumper on a wall.
+        const double phase = std::fmod (t, 0.5);
+        return profile (t) + (t > 0.5 && phase < 0.06 ? 20.0 : 0.0);
+    };
+
+    EXPECT_LT (detail::run (detector, bumpy, 3.0), 0.0);
+    EXPECT_GT (detector.rejected(), 0);
+}
+
+TEST_F (NoteDetectorTest, Disabled) {
+    settings.enabled = false;
+    NoteDetector detector (settings, detail::period);
+    EXPECT_FALSE (detector.settings().enabled);
+
+    // never detects, still times out.
+    EXPECT_LT (detail::run (detector, profile, settings.timeout + 0.1), 0.0);
+    EXPECT_TRUE (detector.timedOut());
+}
+
+TEST_F (NoteDetectorTest, TimesOutWithoutNote) {
+    profile.noteTime = -1.0;
+    settings.timeout = 2.0;
+    NoteDetector detector (settings, detail::period);
+
+    for (double t = 0.0; t < 1.9; t += detail::period)
+        detector.update (profile (t));
+    EXPECT_FALSE (detector.timedOut());
+    EXPECT_LT (detail::run (detector, profile, 2.1), 0.0);
+    EXPECT_TRUE (detector.timedOut());
+
+    // a seated note never times out.
+    profile.noteTime = 1.0;
+    EXPECT_GE (detail::run (detector, profile, 3.0), 0.0);
+    for (int i = 0; i < 100; ++i)
+        detector.update (profile (3.0));
+    EXPECT_FALSE (detector.timedOut());
+}
+
+TEST_F (NoteDetectorTest, NoteLoadedAtStart) {
+    // the first free running sample is really a note: keep the baseline in
+    // range and detect it.
+    profile.noteTime = 0.0;
+    NoteDetector detector (settings, detail::period);
+    const double detected = detail::run (detector, profile, 1.0);
+    ASSERT_GE (detected, 0.0);
+    EXPECT_LE (detected, settings.blankTime + settings.plateauTime + 3 * detail::period);
+    EXPECT_FALSE (detector.baselineValid());
+    EXPECT_DOUBLE_EQ (detector.baseline(), settings.maxFreeCurrent);
+
+    // a normal start learns the real free current.
+    profile.noteTime = 1.0;
+    ASSERT_GE (detail::run (detector, profile, 3.0), profile.noteTime);
+    EXPECT_TRUE (detector.baselineValid());
+}
+
+// Run many noisy intakes, some never getting a note. Count detections before
+// the note arrived and how long detection took.
+TEST_F (NoteDetectorTest, FalsePositiveRate) {
+    std::mt19937 rng (2024);
+    std::normal_distribution<double> noise (0.0, 1.0);
+    std::uniform_real_distribution<double> arrival (0.5, 2.0);
+    std::bernoulli_distribution bump (0.02);
+
+    NoteDetector detector (settings, detail::period);
+    int runs = 0, falsePositives = 0, missed = 0;
+    double totalLatency = 0.0, maxLatency = 0.0;
+    int detections      = 0;
+
+    for (int i = 0; i < 500; ++i) {
+        profile.noteTime = i % 5 == 0 ? -1.0 : arrival (rng);
+        int bumpTicks    = 0;
+        auto noisy       = [&] (double t) {
+            // occasional 2-3 tick load bumps on top of sensor noise.
+            if (bumpTicks <= 0 && bump (rng))
+                bumpTicks = 2 + (int) (rng() % 2);
+            const double extra = bumpTicks-- > 0 ? 12.0 : 0.0;
+            return profile (t) + noise (rng) + extra;
+        };
+
+        const double detected = detail::run (detector, noisy, 3.0);
+        ++runs;
+        if (detected >= 0.0 && (profile.noteTime < 0.0 || detected < profile.noteTime)) {
+            ++falsePositives;
+        } else if (profile.noteTime >= 0.0) {
+            if (detected < 0.0) {
+                ++missed;
+            } else {
+                totalLatency += detected - profile.noteTime;
+                maxLatency = std::max (maxLatency, detected - profile.noteTime);
+                ++detections;
+            }
+        }
+    }
+
+    // every note found, none imagined, each a plateau and a few ticks late.
+    EXPECT_EQ (falsePositives, 0);
+    EXPECT_EQ (missed, 0);
+    EXPECT_EQ (detections, runs - runs / 5);
+    EXPECT_GT (totalLatency / detections, settings.plateauTime);
+    EXPECT_LT (totalLatency / detections, 0.2);
+    EXPECT_LT (maxLatency, 0.3);
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include "snider/outputcache.hpp"
+
+using namespace std::chrono_literals;
+using snider::OutputCache;
+
+TEST (OutputCacheTest, SuppressesRepeats) {
+    OutputCache cache (0.01, 100ms);
+    auto now = OutputCache::clock::time_point {} + 1s;
+
+    EXPECT_TRUE (cache.update (0.0, now));
+    for (int i = 0; i < 9; ++i)
+        EXPECT_FALSE (cache.update (0.005, now += 5ms));
+    EXPECT_TRUE (cache.update (1.0, now += 5ms));
+    EXPECT_EQ (cache.lastValue(), 1.0);
+
+    EXPECT_EQ (cache.sent(), 2);
+    EXPECT_EQ (cache.suppressed(), 9);
+}
+
+TEST (OutputCacheTest, KeepAlive) {
+    OutputCache cache (0.01, 100ms);
+    auto now = OutputCache::clock::time_point {} + 1s;
+
+    EXPECT_TRUE (cache.update (2.0, now));
+    EXPECT_FALSE (cache.update (2.0, now + 99ms));
+    EXPECT_TRUE (cache.update (2.0, now + 100ms));
+    EXPECT_FALSE (cache.update (2.0, now + 150ms));
+}
+
+TEST (OutputCacheTest, Invalidate) {
+    OutputCache cache (0.01, 1s);
+    auto now = OutputCache::clock::time_point {} + 1s;
+
+    EXPECT_TRUE (cache.update (0.0, now));
+    EXPECT_FALSE (cache.update (0.0, now));
+    cache.invalidate();
+    EXPECT_TRUE (cache.update (0.0, now));
+
+    cache.resetCounts();
+    EXPECT_EQ (cache.sent(), 0);
+    EXPECT_EQ (cache.suppressed(), 0);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "overrun.hpp"
+
+using namespace std::chrono_literals;
+
+class OverrunTest : public testing::Test {
+protected:
+    using clock = OverrunManager::clock;
+    OverrunManager overruns { 20ms, 0.75 };
+    clock::time_point start { clock::now() };
+
+    // run one tick of the given length starting at `start`
+    void tick (clock::duration length) {
+        overruns.beginTick (start);
+        overruns.endTick (start + length);
+        start += std::max (clock::duration (20ms), length);
+    }
+};
+
+TEST_F (OverrunTest, RunsWhenOnTime) {
+    tick (5ms);
+    overruns.beginTick (start);
+    EXPECT_TRUE (overruns.shouldRun (Deferrable::Telemetry, start + 2ms));
+    EXPECT_FALSE (overruns.overran());
+    EXPECT_EQ (overruns.shed (Deferrable::Telemetry), 0);
+}
+
+TEST_F (OverrunTest, ShedsNearDeadline) {
+    overruns.beginTick (start);
+    EXPECT_TRUE (overruns.shouldRun (Deferrable::Garbage, start + 14ms));
+    EXPECT_FALSE (overruns.shouldRun (Deferrable::Garbage, start + 15ms));
+    EXPECT_EQ (overruns.shed (Deferrable::Garbage), 1);
+    EXPECT_EQ (overruns.shed (Deferrable::Logging), 0);
+}
+
+TEST_F (OverrunTest, ShedsAfterOverrunUntilOnTime) {
+    tick (25ms);
+    EXPECT_TRUE (overruns.overran());
+    EXPECT_EQ (overruns.overruns(), 1);
+
+    overruns.beginTick (start);
+    EXPECT_FALSE (overruns.shouldRun (Deferrable::Dashboard, start + 1ms));
+    overruns.endTick (start + 5ms);
+    start += 20ms;
+
+    overruns.beginTick (start);
+    EXPECT_TRUE (overruns.shouldRun (Deferrable::Dashboard, start + 1ms));
+    EXPECT_EQ (overruns.shed (Deferrable::Dashboard), 1);
+}
+
+TEST_F (OverrunTest, LateStartCountsAsOverrun) {
+    tick (5ms);
+    start += 15ms; // something else held the loop.
+    overruns.beginTick (start);
+    EXPECT_TRUE (overruns.overran());
+    EXPECT_FALSE (overruns.shouldRun (Deferrable::Telemetry, start));
+    EXPECT_EQ (overruns.overruns(), 1);
+}
+
+TEST_F (OverrunTest, CountsWorkOutsideTheTick) {
+    // rate groups took 12ms of the period before the tick began.
+    overruns.addWork (12ms);
+    overruns.beginTick (start);
+    EXPECT_FALSE (overruns.shouldRun (Deferrable::Telemetry, start + 3ms));
+    overruns.endTick (start + 10ms);
+    EXPECT_TRUE (overruns.overran());
+    EXPECT_EQ (overruns.longest(), 22ms);
+    start += 20ms;
+
+    // counted once.
+    tick (5ms);
+    EXPECT_FALSE (overruns.overran());
+}
+
+TEST_F (OverrunTest, ResetKeepsState) {
+    tick (30ms);
+    overruns.resetStats();
+    EXPECT_EQ (overruns.overruns(), 0);
+    EXPECT_EQ (overruns.ticks(), 0);
+    EXPECT_TRUE (overruns.overran());
+}
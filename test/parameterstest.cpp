@@ -104,3 +104,89 @@ TEST_F (ParametersTest, Helpers) {
     EXPECT_EQ (params.getAxisValue (Parameters::TriggerLeft), params.getTriggerLeft());
     EXPECT_EQ (params.getAxisValue (Parameters::TriggerRight), params.getTriggerRight());
 }
+
+TEST_F (ParametersTest, ButtonEvents) {
+    Parameters::Context c;
+    params.reset();
+    params.process (c);
+    EXPECT_EQ (params.numEvents(), 0);
+
+    c.buttons[Parameters::ButtonA] = true;
+    params.process (c);
+    ASSERT_EQ (params.numEvents(), 1);
+    EXPECT_EQ (params.getEvent (0).type, Parameters::Event::ButtonDown);
+    EXPECT_EQ (params.getEvent (0).index, Parameters::ButtonA);
+    params.clearEvents();
+
+    // held: no new edge.
+    params.process (c);
+    EXPECT_EQ (params.numEvents(), 0);
+
+    c.buttons[Parameters::ButtonA] = false;
+    params.process (c);
+    ASSERT_EQ (params.numEvents(), 1);
+    EXPECT_EQ (params.getEvent (0).type, Parameters::Event::ButtonUp);
+    EXPECT_EQ (params.getEvent (0).index, Parameters::ButtonA);
+}
+
+TEST_F (ParametersTest, POVEvents) {
+    Parameters::Context c;
+    params.reset();
+
+    c.povs[0] = 90;
+    params.process (c);
+    ASSERT_EQ (params.numEvents(), 1);
+    EXPECT_EQ (params.getEvent (0).type, Parameters::Event::POV);
+    EXPECT_EQ (params.getEvent (0).value, 90.0);
+    params.clearEvents();
+
+    params.process (c);
+    EXPECT_EQ (params.numEvents(), 0);
+}
+
+TEST_F (ParametersTest, AxisThresholdEvents) {
+    Parameters::Context c;
+    params.reset();
+
+    // no threshold, no events.
+    c.axis[Parameters::TriggerLeft] = 0.9;
+    params.process (c);
+    EXPECT_EQ (params.numEvents(), 0);
+
+    params.setAxisThreshold (Parameters::TriggerLeft, 0.5);
+    c.axis[Parameters::TriggerLeft] = 0.2;
+    params.process (c);
+    EXPECT_EQ (params.numEvents(), 0);
+
+    c.axis[Parameters::TriggerLeft] = 0.6;
+    params.process (c);
+    ASSERT_EQ (params.numEvents(), 1);
+    EXPECT_EQ (params.getEvent (0).type, Parameters::Event::AxisAbove);
+    EXPECT_EQ (params.getEvent (0).index, Parameters::TriggerLeft);
+    params.clearEvents();
+
+    c.axis[Parameters::TriggerLeft] = 0.7;
+    params.process (c);
+    EXPECT_EQ (params.numEvents(), 0);
+
+    c.axis[Parameters::TriggerLeft] = 0.1;
+    params.process (c);
+    ASSERT_EQ (params.numEvents(), 1);
+    EXPECT_EQ (params.getEvent (0).type, Parameters::Event::AxisBelow);
+}
+
+TEST_F (ParametersTest, EventOverflowIsCounted) {
+    Parameters::Context c;
+    params.reset();
+
+    // every button toggles each tick, and nothing clears the queue.
+    const int ticks = 2 + Parameters::MaxEvents / Parameters::MaxButtons;
+    for (int t = 0; t < ticks; ++t) {
+        for (auto& b : c.buttons)
+            b = ! b;
+        params.process (c);
+    }
+
+    EXPECT_EQ (params.numEvents(), Parameters::MaxEvents);
+    EXPECT_EQ (params.droppedEvents(), ticks * Parameters::MaxButtons - Parameters::MaxEvents);
+}
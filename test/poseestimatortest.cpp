@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include "poseestimator.hpp"
+#include "syntheticvision.hpp"
+
+namespace {
+
+// Drive a straight line at 1 m/s with wheel odometry that reads 10% short,
+// optionally correcting it with synthetic measurements of the true pose.
+double finalError (bool useVision, int64_t* applied = nullptr, double* avgMicros = nullptr) {
+    frc::DifferentialDriveKinematics kinematics { 0.559_m };
+    PoseEstimator estimator { kinematics, frc::Rotation2d {}, 0_m, 0_m };
+
+    SyntheticVision::Settings settings;
+    settings.enabled = true;
+    SyntheticVision vision { settings };
+
+    const auto dt = 5_ms;
+    frc::Pose2d truth;
+    for (int i = 1; i <= 600; ++i) {
+        const auto now      = dt * i;
+        const auto distance = 1_mps * now;
+        truth               = frc::Pose2d { distance, 0_m, 0_rad };
+
+        if (useVision) {
+            if (auto m = vision.sample (truth, now))
+                EXPECT_TRUE (estimator.submit (*m));
+        }
+
+        estimator.update (now, frc::Rotation2d {}, distance * 0.9, distance * 0.9);
+    }
+
+    if (applied != nullptr)
+        *applied = estimator.applied();
+    if (avgMicros != nullptr)
+        *avgMicros = estimator.cost().averageMicros();
+    return estimator.pose().Translation().Distance (truth.Translation()).value();
+}
+
+} // namespace
+
+TEST (PoseEstimatorTest, VisionCorrectsDrift) {
+    int64_t applied  = 0;
+    double avgMicros = 0.0;
+    const double odometryOnly = finalError (false);
+    const double fused        = finalError (true, &applied, &avgMicros);
+
+    EXPECT_NEAR (odometryOnly, 0.3, 0.01);
+
+    // the drift between measurements, 1 cm, and their 5 cm noise weighed
+    // against the odometry leave a few centimeters.
+    EXPECT_LT (fused, 0.1);
+
+    // one every 100 ms after the first 50 ms of latency, none rejected.
+    EXPECT_GE (applied, 29);
+    EXPECT_LE (applied, 30);
+
+    // replaying the odometry history must stay cheap enough for the notifier.
+    EXPECT_GT (avgMicros, 0.0);
+    EXPECT_LT (avgMicros, 1000.0);
+}
+
+TEST (PoseEstimatorTest, RejectsStaleAndFuture) {
+    frc::DifferentialDriveKinematics kinematics { 0.559_m };
+    PoseEstimator::Settings settings;
+    settings.maxAge = 0.5_s;
+    PoseEstimator estimator { kinematics, frc::Rotation2d {}, 0_m, 0_m, frc::Pose2d {}, settings };
+
+    estimator.update (1_s, frc::Rotation2d {}, 0_m, 0_m);
+    estimator.submit ({ 0.2_s, frc::Pose2d { 1_m, 0_m, 0_rad } });
+    estimator.submit ({ 3_s, frc::Pose2d { 1_m, 0_m, 0_rad } });
+    estimator.update (2_s, frc::Rotation2d {}, 0_m, 0_m);
+
+    EXPECT_EQ (estimator.applied(), 0);
+    EXPECT_EQ (estimator.rejected(), 2);
+    EXPECT_NEAR (estimator.pose().X().value(), 0.0, 1e-9);
+}
+
+TEST (PoseEstimatorTest, QueueOverflowIsCounted) {
+    frc::DifferentialDriveKinematics kinematics { 0.559_m };
+    PoseEstimator estimator { kinematics, frc::Rotation2d {}, 0_m, 0_m };
+
+    const auto capacity = static_cast<int> (PoseEstimator::Queue::capacity());
+    for (int i = 0; i < capacity + 4; ++i)
+        estimator.submit ({ 0_s, frc::Pose2d {} });
+    EXPECT_GT (estimator.dropped(), 0);
+
+    estimator.reset (frc::Rotation2d {}, 0_m, 0_m, frc::Pose2d { 1_m, 1_m, 0_rad });
+    estimator.update (1_s, frc::Rotation2d {}, 0_m, 0_m);
+    EXPECT_EQ (estimator.applied() + estimator.rejected(), 0);
+}
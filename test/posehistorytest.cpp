@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include "posehistory.hpp"
+
+TEST (PoseHistoryTest, Empty) {
+    PoseHistory<4> history;
+    EXPECT_EQ (history.size(), 0u);
+    EXPECT_FALSE (history.latest().has_value());
+    EXPECT_FALSE (history.poseAt (1_s).has_value());
+}
+
+TEST (PoseHistoryTest, Interpolates) {
+    PoseHistory<8> history;
+    history.add (1_s, frc::Pose2d { 0_m, 0_m, 0_rad });
+    history.add (2_s, frc::Pose2d { 2_m, 0_m, 0_rad });
+
+    auto pose = history.poseAt (1.5_s);
+    ASSERT_TRUE (pose.has_value());
+    EXPECT_NEAR (pose->X().value(), 1.0, 1e-9);
+    EXPECT_NEAR (pose->Y().value(), 0.0, 1e-9);
+
+    // clamped outside the history.
+    EXPECT_NEAR (history.poseAt (0_s)->X().value(), 0.0, 1e-9);
+    EXPECT_NEAR (history.poseAt (5_s)->X().value(), 2.0, 1e-9);
+}
+
+TEST (PoseHistoryTest, DropsOldest) {
+    PoseHistory<4> history;
+    for (int i = 0; i < 6; ++i)
+        history.add (units::second_t (i), frc::Pose2d { units::meter_t (i), 0_m, 0_rad });
+
+    EXPECT_EQ (history.size(), 4u);
+    EXPECT_NEAR (history.latest()->pose.X().value(), 5.0, 1e-9);
+    EXPECT_NEAR (history.poseAt (0_s)->X().value(), 2.0, 1e-9);
+    EXPECT_NEAR (history.poseAt (3.25_s)->X().value(), 3.25, 1e-9);
+
+    // out of order samples are ignored.
+    history.add (1_s, frc::Pose2d {});
+    EXPECT_NEAR (history.latest()->pose.X().value(), 5.0, 1e-9);
+
+    history.clear();
+    EXPECT_EQ (history.size(), 0u);
+}
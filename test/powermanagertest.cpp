@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cmath>
+
+#include <frc/simulation/BatterySim.h>
+#include <gtest/gtest.h>
+
+#include "powermanager.hpp"
+
+namespace detail {
+
+using Currents = std::array<double, PowerManager::NumConsumers>;
+
+static constexpr int drivetrain = static_cast<int> (Consumer::Drivetrain);
+static constexpr int shooter    = static_cast<int> (Consumer::Shooter);
+static constexpr int lifter     = static_cast<int> (Consumer::Lifter);
+
+static PowerManager::Settings settings() {
+    PowerManager::Settings s;
+    s.minVoltage  = 8.0;
+    s.resistance  = 0.02;
+    s.minBudget   = 60.0;
+    s.maxBudget   = 400.0;
+    s.filterTime  = 0.1;
+    s.recoverRate = 1.0;
+    s.minScale    = 0.25;
+    s.shares      = { { { 1, 60.0 }, { 3, 20.0 }, { 2, 20.0 } } };
+    return s;
+}
+
+static double battery (const PowerManager::Settings& s, const Currents& amps) {
+    return frc::sim::BatterySim::Calculate (
+               12_V, units::ohm_t (s.resistance),
+               { units::ampere_t (amps[0]), units::ampere_t (amps[1]), units::ampere_t (amps[2]) })
+        .value();
+}
+
+/** What each subsystem would draw at full output, seconds into a match.
+    Auto, then teleop cycles of drive, intake, push and shoot, then an
+    endgame where everything runs at once while climbing.
+*/
+static Currents matchDemand (double t) {
+    Currents d { 0.0, 0.0, 0.0 };
+    if (t < 15.0) {
+        d[drivetrain] = t < 1.0 ? 200.0 : (t < 3.0 ? 80.0 : (t > 6.0 && t < 7.0 ? 200.0 : 40.0));
+        d[shooter]    = t < 0.5 ? 120.0 : (t < 2.0 ? 40.0 : (t > 4.0 && t < 6.0 ? 30.0 : 0.0));
+        return d;
+    }
+
+    if (t < 130.0) {
+        const double c = std::fmod (t - 15.0, 10.0);
+        if (c < 1.0)
+            d[drivetrain] = 220.0; // accelerating
+        else if (c < 3.0)
+            d[drivetrain] = 90.0;
+        else if (c < 5.0)
+            d[drivetrain] = 40.0, d[shooter] = 30.0; // intaking
+        else if (c < 7.0)
+            d[drivetrain] = 260.0; // pushing
+        else if (c < 7.5)
+            d[shooter] = 120.0; // spin-up
+        else if (c < 9.0)
+            d[shooter] = 40.0;
+        return d;
+    }
+
+    // endgame: pushing into position, a last shot and the climb overlap.
+    d[drivetrain] = t < 140.0 ? 240.0 : 60.0;
+    d[shooter]    = t > 135.0 && t < 138.0 ? 110.0 : 0.0;
+    d[lifter]     = t > 136.0 ? 90.0 : 0.0;
+    return d;
+}
+
+struct MatchResult {
+    double lowestVoltage { 1.0e9 };
+    Currents delivered {}, demanded {};
+    // average scales while the drivetrain and shooter both run.
+    Currents sharedScale {};
+    int sharedTicks { 0 };
+};
+
+/** Replay a match. Motor current follows what's asked of it with a lag,
+    the battery sags under the total and the manager sees the result.
+*/
+static MatchResult replay (bool managed) {
+    const auto s = settings();
+    PowerManager manager (s);
+    MatchResult result;
+
+    constexpr double dt = 0.02, lag = 0.04;
+    Currents drawn { 0.0, 0.0, 0.0 };
+    for (double t = 0.0; t < 150.0; t += dt) {
+        const auto demand = matchDemand (t);
+        if (demand[drivetrain] > 0.0 && demand[shooter] > 0.0) {
+            for (int i = 0; i < PowerManager::NumConsumers; ++i)
+                result.sharedScale[i] += manager.scale (static_cast<Consumer> (i));
+            ++result.sharedTicks;
+        }
+
+        for (int i = 0; i < PowerManager::NumConsumers; ++i) {
+            const double scale = managed ? manager.scale (static_cast<Consumer> (i)) : 1.0;
+            drawn[i] += (demand[i] * scale - drawn[i]) * (1.0 - std::exp (-dt / lag));
+            result.delivered[i] += drawn[i] * dt;
+            result.demanded[i] += demand[i] * dt;
+        }
+
+        const double volts   = battery (s, drawn);
+        result.lowestVoltage = std::min (result.lowestVoltage, volts);
+        manager.update (volts, -1.0, drawn, dt);
+    }
+
+    for (auto& scale : result.sharedScale)
+        scale /= std::max (1, result.sharedTicks);
+    return result;
+}
+
+} // namespace detail
+
+TEST (PowerManagerTest, AllocatesByPriority) {
+    auto s = detail::settings();
+    PowerManager manager (s);
+
+    // 8V at 200A: 12V open circuit, so 200A is the budget.
+    manager.update (8.0, -1.0, { 150.0, 50.0, 0.0 }, 0.02);
+    EXPECT_NEAR (manager.budget(), 200.0, 1.0e-6);
+    EXPECT_GE (manager.allocation (Consumer::Drivetrain), 150.0);
+    EXPECT_DOUBLE_EQ (manager.scale (Consumer::Drivetrain), 1.0);
+
+    // over budget: the shooter is last in line.
+    manager.update (7.2, -1.0, { 150.0, 80.0, 0.0 }, 0.02);
+    EXPECT_NEAR (manager.budget(), 190.0, 1.0e-6);
+    EXPECT_DOUBLE_EQ (manager.scale (Consumer::Drivetrain), 1.0);
+    EXPECT_LT (manager.scale (Consumer::Shooter), 1.0);
+    EXPECT_GE (manager.allocation (Consumer::Shooter), s.shares[detail::shooter].minCurrent);
+}
+
+TEST (PowerManagerTest, ScalesRecover) {
+    PowerManager manager (detail::settings());
+    manager.update (6.0, -1.0, { 250.0, 80.0, 50.0 }, 0.02);
+    const double cut = manager.scale (Consumer::Shooter);
+    ASSERT_LT (cut, 1.0);
+    EXPECT_GE (cut, manager.settings().minScale);
+
+    for (int i = 0; i < 100; ++i)
+        manager.update (11.5, -1.0, { 20.0, 5.0, 0.0 }, 0.02);
+    EXPECT_DOUBLE_EQ (manager.scale (Consumer::Shooter), 1.0);
+    EXPECT_DOUBLE_EQ (manager.scale (Consumer::Drivetrain), 1.0);
+}
+
+TEST (PowerManagerTest, Disabled) {
+    auto s    = detail::settings();
+    s.enabled = false;
+    PowerManager manager (s);
+    manager.update (5.0, -1.0, { 300.0, 100.0, 100.0 }, 0.02);
+    EXPECT_DOUBLE_EQ (manager.scale (Consumer::Shooter), 1.0);
+}
+
+// A whole match against a simulated battery. Unmanaged the bus browns out;
+// managed it stays up, and the drivetrain is cut less than the shooter
+// when they run together.
+TEST (PowerManagerTest, MatchReplay) {
+    const auto unmanaged = detail::replay (false);
+    const auto managed   = detail::replay (true);
+
+    auto fraction = [] (const detail::MatchResult& r, int i) {
+        return r.demanded[i] > 0.0 ? r.delivered[i] / r.demanded[i] : 1.0;
+    };
+
+    // unmanaged the endgame sags far below brownout.
+    EXPECT_LT (unmanaged.lowestVoltage, 5.0);
+    EXPECT_GT (managed.lowestVoltage, 6.8);
+
+    // most of the demand is still delivered, the drivetrain most of all.
+    EXPECT_GT (fraction (managed, detail::drivetrain), 0.8);
+    EXPECT_GT (fraction (managed, detail::shooter), 0.8);
+    EXPECT_GT (fraction (managed, detail::lifter), 0.7);
+
+    ASSERT_GT (managed.sharedTicks, 0);
+    EXPECT_GT (managed.sharedScale[detail::drivetrain], 0.95);
+    EXPECT_GT (managed.sharedScale[detail::drivetrain], managed.sharedScale[detail::shooter]);
+}
@@ -0,0 +1,81 @@
+#include <chrono>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "profiler.hpp"
+#include "sol/sol.hpp"
+
+TEST (ProfilerTest, FoldsStacks) {
+    lua::Profiler profiler ({});
+    profiler.record ("robot:drive;gamepad:axis", 3, 'I');
+    profiler.record ("robot:drive;gamepad:axis", 2, 'N');
+    profiler.record ("robot:drive", 1, 'G');
+    profiler.record ("", 1, 'C');
+
+    EXPECT_EQ (profiler.samples(), 7);
+    EXPECT_EQ (profiler.stacks(), 3);
+    EXPECT_EQ (profiler.dropped(), 0);
+    EXPECT_EQ (profiler.samplesIn ('I'), 3);
+    EXPECT_EQ (profiler.samplesIn ('N'), 2);
+    EXPECT_EQ (profiler.samplesIn ('G'), 1);
+
+    std::stringstream out;
+    profiler.write (out);
+    EXPECT_EQ (out.str(), "robot:drive;gamepad:axis 5\n"
+                          "[vm];[C] 1\n"
+                          "robot:drive;[GC] 1\n");
+}
+
+TEST (ProfilerTest, DropsWhenFull) {
+    lua::Profiler::Settings settings;
+    settings.slots = 16;
+    settings.arena = 64;
+    lua::Profiler profiler (settings);
+
+    // 8 bytes each, the arena holds 8 of them.
+    for (int i = 0; i < 20; ++i)
+        profiler.record ("frame:" + std::to_string (10 + i), 1, 'I');
+    EXPECT_EQ (profiler.stacks(), 8);
+    EXPECT_EQ (profiler.dropped(), 12);
+
+    // known stacks still count.
+    profiler.record ("frame:10", 1, 'I');
+    EXPECT_EQ (profiler.dropped(), 12);
+    EXPECT_EQ (profiler.samples(), 21);
+
+    profiler.clear();
+    EXPECT_EQ (profiler.samples(), 0);
+    EXPECT_EQ (profiler.stacks(), 0);
+}
+
+TEST (ProfilerTest, SamplesRunningLua) {
+    sol::state L;
+    L.open_libraries();
+    L.script (R"(
+        function inner (n)
+            local x = 0
+            for i = 1, n do x = x + math.sin (i) end
+            return x
+        end
+        function outer (seconds)
+            local stop = os.clock() + seconds
+            while os.clock() < stop do inner (1000) end
+        end
+    )");
+
+    lua::Profiler profiler ({});
+    ASSERT_TRUE (profiler.start (L.lua_state()));
+    lua::Profiler other ({});
+    EXPECT_FALSE (other.start (L.lua_state()));
+
+    sol::protected_function outer = L["outer"];
+    outer (0.2);
+    profiler.stop();
+    EXPECT_FALSE (profiler.running());
+
+    EXPECT_GT (profiler.samples(), 0);
+    std::stringstream out;
+    profiler.write (out);
+    EXPECT_NE (out.str().find ("outer"), std::string::npos);
+}
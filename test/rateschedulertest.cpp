@@ -0,0 +1,53 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "ratescheduler.hpp"
+#include "scripting.hpp"
+
+TEST (RateSchedulerTest, ReadsConfig) {
+    RateScheduler rates;
+    int calls = 0;
+    rates.add ("drivetrain", [&calls]() { ++calls; }, 20.0);
+    rates.add ("not_configured", []() {}, 42.0);
+
+    auto cfg = lua::config::get ("rates", "drivetrain").as<sol::table>();
+    EXPECT_EQ (rates.periodMs ("drivetrain"), cfg.get<double> ("period"));
+    EXPECT_EQ (rates.periodMs ("not_configured"), 42.0);
+    EXPECT_EQ (rates.periodMs ("missing"), 0.0);
+    EXPECT_EQ (rates.groups().size(), 2u);
+
+    rates.groups()[0]->task();
+    EXPECT_EQ (calls, 1);
+}
+
+TEST (RateSchedulerTest, OffsetsWithinPeriod) {
+    for (const auto* name : { "drivetrain", "mechanisms", "telemetry" }) {
+        RateScheduler rates;
+        rates.add (name, []() {}, 20.0);
+        const auto& group = *rates.groups().front();
+        EXPECT_GE (group.periodMs, 1.0);
+        EXPECT_GE (group.offsetMs, 0.0);
+        EXPECT_LE (group.offsetMs, group.periodMs);
+    }
+}
+
+TEST (RateSchedulerTest, RunUntilSteps) {
+    RateScheduler rates;
+    std::string order;
+    int fast = 0, slow = 0;
+    rates.add ("not_configured_fast", [&]() { ++fast; order += 'f'; }, 10.0);
+    rates.add ("not_configured_slow", [&]() { ++slow; order += 's'; }, 25.0);
+
+    rates.runUntil (30.0);
+    EXPECT_EQ (order, "fsffsf");
+
+    rates.runUntil (100.0);
+    EXPECT_EQ (fast, 11);
+    EXPECT_EQ (slow, 5);
+    EXPECT_EQ (rates.groups()[0]->stats.count(), 11);
+
+    rates.runUntil (100.0);
+    EXPECT_EQ (fast, 11);
+    EXPECT_EQ (slow, 5);
+}
@@ -0,0 +1,67 @@
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "realtime.hpp"
+#include "scripting.hpp"
+#include "snider/jittermonitor.hpp"
+
+namespace {
+bool appliedOrRefused (rt::Status status) {
+    return status == rt::Status::Applied
+           || status == rt::Status::Denied
+           || status == rt::Status::Unsupported;
+}
+} // namespace
+
+TEST (RealtimeTest, DegradesGracefully) {
+    EXPECT_TRUE (appliedOrRefused (rt::prefaultStack (64 * 1024)));
+    EXPECT_EQ (rt::pinCurrentThread (-1), rt::Status::Failed);
+    EXPECT_EQ (rt::pinCurrentThread (rt::numCpus()), rt::Status::Failed);
+
+    // never change the affinity or scheduling of the test thread itself.
+    rt::Status pin = rt::Status::Failed, fifo = rt::Status::Failed, nice = rt::Status::Failed;
+    std::thread helper ([&]() {
+        pin  = rt::pinCurrentThread (0);
+        fifo = rt::setFifoPriority (10);
+        nice = rt::lowerPriority (5);
+    });
+    helper.join();
+    EXPECT_TRUE (appliedOrRefused (pin));
+    EXPECT_TRUE (appliedOrRefused (fifo));
+    EXPECT_TRUE (appliedOrRefused (nice));
+}
+
+TEST (RealtimeTest, PrefaultLua) {
+    EXPECT_TRUE (lua::prefault (0));
+    EXPECT_TRUE (lua::prefault (1 << 20));
+}
+
+TEST (RealtimeTest, OptionsDefaultDisabled) {
+    const auto opts = rt::options();
+    EXPECT_FALSE (opts.enabled);
+    rt::setup (opts); // must be a no-op
+}
+
+TEST (RealtimeTest, JitterMonitor) {
+    using namespace std::chrono;
+    snider::JitterMonitor monitor (milliseconds (20));
+    auto now = snider::JitterMonitor::clock::time_point {} + seconds (1);
+
+    monitor.tick (now);
+    EXPECT_EQ (monitor.count(), 0);
+
+    // 99 perfect intervals and one 5 ms late.
+    for (int i = 0; i < 99; ++i)
+        monitor.tick (now += milliseconds (20));
+    monitor.tick (now += milliseconds (25));
+
+    EXPECT_EQ (monitor.count(), 100);
+    EXPECT_EQ (monitor.maxMicros(), 5000);
+    EXPECT_NEAR (monitor.meanMicros(), 50.0, 1e-9);
+    EXPECT_LE (monitor.percentileMicros (0.5), snider::JitterMonitor::BinMicros);
+    EXPECT_EQ (monitor.percentileMicros (1.0), 5000);
+
+    monitor.reset();
+    EXPECT_EQ (monitor.count(), 0);
+}
@@ -0,0 +1,127 @@
+#include <cmath>
+#include <numbers>
+
+#include <frc/system/plant/DCMotor.h>
+#include <frc/system/plant/LinearSystemId.h>
+#include <gtest/gtest.h>
+
+#include "simulateddrive.hpp"
+
+namespace detail {
+
+/** The plant the robot simulates. */
+static frc::sim::DifferentialDrivetrainSim plant() {
+    return frc::sim::DifferentialDrivetrainSim {
+        frc::LinearSystemId::IdentifyDrivetrainSystem (
+            1.98_V / 1_mps, 0.2_V / 1_mps_sq, 1.5_V / 1_mps, 0.3_V / 1_mps_sq),
+        0.559_m, frc::DCMotor::CIM (2), 8, 2_in
+    };
+}
+
+static SimulatedDrive::Settings settings() {
+    SimulatedDrive::Settings s;
+    s.step            = 0.001;
+    s.controllerDelay = 0.001;
+    s.reference       = true;
+    s.referenceStep   = 0.0001;
+    return s;
+}
+
+/** Weave for a few seconds with a 5ms control loop, voltages changing
+    every tick.
+*/
+static SimulatedDrive::Error weave (const SimulatedDrive::Settings& s) {
+    SimulatedDrive drive (plant(), s);
+    constexpr double period = 0.005;
+    for (int tick = 0; tick <= 800; ++tick) {
+        const double now  = tick * period;
+        const double turn = 4.0 * std::sin (2.0 * std::numbers::pi * now);
+        drive.command (now, 6.0 + turn, 6.0 - turn);
+        drive.advance (now);
+    }
+    return drive.error().value_or (SimulatedDrive::Error {});
+}
+
+} // namespace detail
+
+// Steps that line up with the control loop track the reference closely,
+// steps longer than it miss voltages and drift.
+TEST (SimulatedDriveTest, ReferenceError) {
+    auto s         = detail::settings();
+    const auto one = detail::weave (s);
+    s.step         = 0.02;
+    const auto big = detail::weave (s);
+
+    EXPECT_GT (one.samples, big.samples);
+    EXPECT_GT (big.samples, 0);
+    EXPECT_LE (one.rmsPosition, one.maxPosition);
+    EXPECT_LE (big.rmsPosition, big.maxPosition);
+
+    // under 0.1 mm in step, over 1 mm and ten times worse out of step.
+    EXPECT_LT (one.maxPosition, 1.0e-4);
+    EXPECT_GT (big.maxPosition, 1.0e-3);
+    EXPECT_GT (big.maxPosition, 10.0 * one.maxPosition);
+    EXPECT_GT (big.rmsPosition, 10.0 * one.rmsPosition);
+    EXPECT_LT (one.maxHeading, big.maxHeading);
+    EXPECT_LT (one.maxVelocity, big.maxVelocity);
+}
+
+TEST (SimulatedDriveTest, ControllerDelay) {
+    auto s            = detail::settings();
+    s.controllerDelay = 0.01;
+    SimulatedDrive drive (detail::plant(), s);
+    drive.advance (0.0);
+    drive.command (0.0, 6.0, 6.0);
+
+    drive.advance (0.009);
+    EXPECT_DOUBLE_EQ (drive.sensors().leftDistance, 0.0);
+    EXPECT_DOUBLE_EQ (drive.sensors().leftRate, 0.0);
+    drive.advance (0.03);
+    EXPECT_GT (drive.sensors().leftDistance, 0.0);
+}
+
+TEST (SimulatedDriveTest, SensorLatency) {
+    auto s             = detail::settings();
+    auto late          = s;
+    late.sensorLatency = 0.02;
+    SimulatedDrive now (detail::plant(), s), delayed (detail::plant(), late);
+
+    double earlier = 0.0;
+    for (int ms = 0; ms <= 500; ++ms) {
+        for (auto* drive : { &now, &delayed }) {
+            drive->command (ms * 0.001, 6.0, 4.0);
+            drive->advance (ms * 0.001);
+        }
+        if (ms == 480)
+            earlier = now.sensors().leftDistance;
+    }
+
+    ASSERT_GT (earlier, 0.0);
+    EXPECT_NEAR (delayed.sensors().leftDistance, earlier, 1.0e-9);
+    EXPECT_LT (delayed.sensors().leftDistance, now.sensors().leftDistance);
+}
+
+TEST (SimulatedDriveTest, RepeatableNoise) {
+    auto s          = detail::settings();
+    auto noisy      = s;
+    noisy.rateNoise = 0.05;
+    SimulatedDrive a (detail::plant(), noisy), b (detail::plant(), noisy), clean (detail::plant(), s);
+
+    double sum = 0.0, sumSquares = 0.0;
+    constexpr int count = 2000;
+    for (int ms = 0; ms < count; ++ms) {
+        for (auto* drive : { &a, &b, &clean }) {
+            drive->command (ms * 0.001, 3.0, 3.0);
+            drive->advance (ms * 0.001);
+        }
+        ASSERT_DOUBLE_EQ (a.sensors().leftRate, b.sensors().leftRate);
+        const double noise = a.sensors().leftRate - clean.sensors().leftRate;
+        sum += noise;
+        sumSquares += noise * noise;
+    }
+
+    const double mean = sum / count;
+    EXPECT_NEAR (mean, 0.0, 0.01);
+    EXPECT_NEAR (std::sqrt (sumSquares / count - mean * mean), 0.05, 0.01);
+    EXPECT_DOUBLE_EQ (a.sensors().leftDistance, clean.sensors().leftDistance);
+}
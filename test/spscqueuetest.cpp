@@ -0,0 +1,46 @@
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "snider/spscqueue.hpp"
+
+TEST (SpscQueueTest, FullAndEmpty) {
+    snider::SpscQueue<int, 4> queue;
+    int value = 0;
+
+    EXPECT_TRUE (queue.empty());
+    EXPECT_FALSE (queue.pop (value));
+
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE (queue.push (i));
+    EXPECT_FALSE (queue.push (4));
+    EXPECT_EQ (queue.size(), 4u);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE (queue.pop (value));
+        EXPECT_EQ (value, i);
+    }
+    EXPECT_TRUE (queue.empty());
+}
+
+TEST (SpscQueueTest, TwoThreadsKeepOrder) {
+    snider::SpscQueue<int, 64> queue;
+    constexpr int total = 100000;
+
+    std::thread producer ([&queue]() {
+        for (int i = 0; i < total;)
+            if (queue.push (i))
+                ++i;
+    });
+
+    int expected = 0, value = 0;
+    while (expected < total) {
+        if (queue.pop (value)) {
+            ASSERT_EQ (value, expected);
+            ++expected;
+        }
+    }
+
+    producer.join();
+    EXPECT_TRUE (queue.empty());
+}
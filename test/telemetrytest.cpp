@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+
+#include "telemetry.hpp"
+
+TEST (TelemetryTest, PublishesOnlyChanges) {
+    Telemetry telemetry;
+    EXPECT_EQ (telemetry.flush(), 0);
+
+    auto& frame = telemetry.write();
+    frame.poseX = 1.0;
+    telemetry.commit();
+    const int all = telemetry.flush();
+    EXPECT_GT (all, 10);
+
+    // nothing committed.
+    EXPECT_EQ (telemetry.flush(), 0);
+
+    // committed but unchanged. The writer gets an old buffer back, so fill
+    // every field like the robot does.
+    telemetry.write()       = TelemetryFrame {};
+    telemetry.write().poseX = 1.0;
+    telemetry.commit();
+    EXPECT_EQ (telemetry.flush(), 0);
+
+    telemetry.write()              = TelemetryFrame {};
+    telemetry.write().poseX        = 1.0;
+    telemetry.write().shooterState = 2;
+    telemetry.write().luaError     = true;
+    telemetry.commit();
+    EXPECT_EQ (telemetry.flush(), 2);
+}
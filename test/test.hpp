@@ -2,4 +2,24 @@
 
 #include <frc/TimedRobot.h>
 
+#include "telemetry.hpp"
+
 extern frc::TimedRobot* gTimedRobot;
+
+/** Run the robot's rate groups due by `nowMs`, counted from the first call,
+    and return the drive and shooter outputs they left. Defined in main.cpp.
+*/
+extern TelemetryFrame step_rate_groups (frc::TimedRobot* robot, double nowMs);
+
+class Lifter;
+class Shooter;
+
+/** Returns the robot's shooter with its flywheel physics running, stepped
+    by the robot's SimulationPeriodic(). Defined in main.cpp.
+*/
+extern Shooter& simulated_shooter (frc::TimedRobot* robot);
+
+/** Returns the robot's lifter with its arm physics running, stepped by the
+    robot's SimulationPeriodic(). Defined in main.cpp.
+*/
+extern Lifter& simulated_lifter (frc::TimedRobot* robot);
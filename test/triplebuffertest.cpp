@@ -0,0 +1,49 @@
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "snider/triplebuffer.hpp"
+
+TEST (TripleBufferTest, NewestWins) {
+    snider::TripleBuffer<int> buffer;
+    EXPECT_FALSE (buffer.update());
+
+    buffer.write() = 1;
+    buffer.publish();
+    buffer.write() = 2;
+    buffer.publish();
+
+    EXPECT_TRUE (buffer.update());
+    EXPECT_EQ (buffer.read(), 2);
+    EXPECT_FALSE (buffer.update());
+    EXPECT_EQ (buffer.read(), 2);
+}
+
+TEST (TripleBufferTest, TwoThreadsSeeWholeValues) {
+    struct Pair {
+        int64_t a { 0 }, b { 0 };
+    };
+    snider::TripleBuffer<Pair> buffer;
+    constexpr int64_t total = 200000;
+
+    std::thread writer ([&buffer]() {
+        for (int64_t i = 1; i <= total; ++i) {
+            auto& p = buffer.write();
+            p.a     = i;
+            p.b     = -i;
+            buffer.publish();
+        }
+    });
+
+    int64_t last = 0;
+    while (last < total) {
+        if (! buffer.update())
+            continue;
+        const auto& p = buffer.read();
+        ASSERT_EQ (p.a, -p.b);
+        ASSERT_GT (p.a, last);
+        last = p.a;
+    }
+
+    writer.join();
+}
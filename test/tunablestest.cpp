@@ -0,0 +1,82 @@
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "config.hpp"
+#include "tunables.hpp"
+
+TEST (TunablesTest, StartsFromConfig) {
+    Tunables tunables;
+    const auto values = tunables.snapshot();
+    EXPECT_DOUBLE_EQ (values[Tunable::DriveP], config::number ("drivetrain", "kp"));
+    EXPECT_DOUBLE_EQ (values[Tunable::RotationThrottle], config::number ("drivetrain", "rotation_throttle"));
+    EXPECT_DOUBLE_EQ (values[Tunable::ShootPower], config::number ("shooter", "shoot_power"));
+    EXPECT_EQ (Tunables::category (Tunable::DriveP), "drivetrain");
+    EXPECT_EQ (Tunables::symbol (Tunable::DriveP), "kp");
+}
+
+TEST (TunablesTest, ValidatesEdits) {
+    Tunables tunables;
+    auto reader        = tunables.reader();
+    const auto version = reader.read().version;
+
+    EXPECT_TRUE (tunables.set (Tunable::RotationThrottle, 0.25));
+    EXPECT_DOUBLE_EQ (reader.read()[Tunable::RotationThrottle], 0.25);
+    EXPECT_GT (reader.read().version, version);
+
+    // clamped to config.tunables range.
+    EXPECT_TRUE (tunables.set (Tunable::RotationThrottle, 5.0));
+    EXPECT_DOUBLE_EQ (reader.read()[Tunable::RotationThrottle], tunables.maximum (Tunable::RotationThrottle));
+
+    // rejected.
+    EXPECT_FALSE (tunables.set (Tunable::RotationThrottle, std::numeric_limits<double>::quiet_NaN()));
+    EXPECT_DOUBLE_EQ (reader.read()[Tunable::RotationThrottle], tunables.maximum (Tunable::RotationThrottle));
+}
+
+TEST (TunablesTest, ReaderSlots) {
+    Tunables tunables;
+    std::vector<Tunables::Reader> readers;
+    for (int i = 0; i < Tunables::MaxReaders; ++i)
+        readers.push_back (tunables.reader());
+    EXPECT_THROW (tunables.reader(), std::runtime_error);
+
+    readers.pop_back();
+    EXPECT_NO_THROW (tunables.reader());
+}
+
+TEST (TunablesTest, ConcurrentEdits) {
+    // a writer sets kp and ki to the same value every time. Readers must never
+    // see a block where they differ, or the version go backwards.
+    Tunables tunables;
+    std::atomic<bool> done { false };
+
+    std::thread writer ([&]() {
+        for (int i = 0; i < 20000; ++i) {
+            const double v = static_cast<double> (i % 10);
+            tunables.set (Tunable::DriveP, v);
+            tunables.set (Tunable::DriveI, v);
+        }
+        done = true;
+    });
+
+    auto reader       = tunables.reader();
+    uint64_t last     = 0;
+    int64_t reads     = 0;
+    int64_t mismatch  = 0;
+    while (! done.load()) {
+        const auto block = reader.read();
+        EXPECT_GE (block.version, last);
+        last = block.version;
+        // between the two set() calls they may differ by one step only.
+        const auto p = block[Tunable::DriveP], i = block[Tunable::DriveI];
+        if (p != i && std::fmod (i + 1.0, 10.0) != p)
+            ++mismatch;
+        ++reads;
+    }
+
+    writer.join();
+    EXPECT_EQ (mismatch, 0);
+    EXPECT_GT (reads, 0);
+}
@@ -0,0 +1,103 @@
+#include <filesystem>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "vision.hpp"
+
+namespace {
+
+// write a few images with an orange circle moving across them.
+std::filesystem::path makeRecording (int count, int width, int height) {
+    auto dir = std::filesystem::temp_directory_path() / "frc-vision-test";
+    std::filesystem::remove_all (dir);
+    std::filesystem::create_directories (dir);
+
+    for (int i = 0; i < count; ++i) {
+        cv::Mat image (height, width, CV_8UC3, cv::Scalar (40, 40, 40));
+        cv::circle (image, cv::Point (40 + i * 20, height / 2), 25, cv::Scalar (0, 128, 255), cv::FILLED);
+        cv::imwrite ((dir / ("frame" + std::to_string (100 + i) + ".png")).string(), image);
+    }
+    return dir;
+}
+
+vision::Pipeline::Stats runRecording (vision::DropPolicy policy, double fps, int sleepMicros) {
+    vision::Settings settings;
+    settings.width      = 320;
+    settings.height     = 240;
+    settings.poolSize   = 4;
+    settings.dropPolicy = policy;
+
+    const auto dir = makeRecording (10, settings.width, settings.height);
+    auto source    = std::make_unique<vision::FileFrameSource> (dir.string(), settings.width, settings.height, fps, false);
+    EXPECT_EQ (source->size(), 10u);
+
+    int targets = 0;
+    vision::Pipeline pipeline { settings };
+    pipeline.start (std::move (source), [sleepMicros] (vision::Frame& frame) {
+        vision::Pipeline::findTarget (frame);
+        std::this_thread::sleep_for (std::chrono::microseconds (sleepMicros)); },
+                    [&targets] (const vision::Frame& frame) { targets += frame.hasTarget ? 1 : 0; });
+
+    for (int i = 0; i < 2000 && ! pipeline.drained(); ++i)
+        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+    pipeline.stop();
+
+    // the circle is in every frame and nothing is dropped after processing.
+    const auto stats = pipeline.stats();
+    EXPECT_EQ (targets, stats.published);
+    EXPECT_EQ (stats.processed, stats.published);
+    EXPECT_GE (stats.latencyMax, stats.latencyAvg);
+    EXPECT_GE (stats.processMax, stats.processAvg);
+    std::filesystem::remove_all (dir);
+    return stats;
+}
+
+} // namespace
+
+TEST (VisionTest, FindTarget) {
+    vision::Frame frame;
+    frame.image = cv::Mat (240, 320, CV_8UC3, cv::Scalar (40, 40, 40));
+    cv::circle (frame.image, cv::Point (100, 120), 25, cv::Scalar (0, 128, 255), cv::FILLED);
+    vision::Pipeline::findTarget (frame);
+    ASSERT_TRUE (frame.hasTarget);
+    EXPECT_NEAR (frame.targetX, 100.0, 1.0);
+    EXPECT_NEAR (frame.targetY, 120.0, 1.0);
+
+    // a smaller note elsewhere doesn't pull the center off the larger one.
+    const double area = frame.targetArea;
+    cv::circle (frame.image, cv::Point (260, 60), 12, cv::Scalar (0, 128, 255), cv::FILLED);
+    vision::Pipeline::findTarget (frame);
+    ASSERT_TRUE (frame.hasTarget);
+    EXPECT_NEAR (frame.targetX, 100.0, 1.0);
+    EXPECT_NEAR (frame.targetY, 120.0, 1.0);
+    EXPECT_DOUBLE_EQ (frame.targetArea, area);
+}
+
+TEST (VisionTest, ProcessesEveryFrame) {
+    // a 100 fps source is well within budget so nothing should be lost.
+    const auto stats = runRecording (vision::DropPolicy::DropNewest, 100.0, 0);
+    EXPECT_EQ (stats.captured, 10);
+    EXPECT_EQ (stats.dropped, 0);
+    EXPECT_EQ (stats.starved, 0);
+    EXPECT_EQ (stats.published, 10);
+    EXPECT_GT (stats.fps, 0.0);
+    EXPECT_LT (stats.fps, 150.0); // paced by the source
+    EXPECT_GT (stats.latencyAvg, 0.0);
+}
+
+TEST (VisionTest, DropsUnderLoad) {
+    // processing much slower than an unpaced source must drop frames but
+    // never block capture or lose track of a buffer.
+    for (auto policy : { vision::DropPolicy::DropOldest, vision::DropPolicy::DropNewest }) {
+        const auto stats = runRecording (policy, 0.0, 20000);
+        EXPECT_EQ (stats.captured, 10);
+        EXPECT_GT (stats.dropped, 0);
+        EXPECT_GT (stats.published, 0);
+        EXPECT_EQ (stats.published + stats.dropped, stats.captured);
+        EXPECT_GE (stats.processAvg, 20000.0);
+        EXPECT_GE (stats.latencyAvg, stats.processAvg);
+    }
+}
@@ -0,0 +1,39 @@
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "scripting.hpp"
+#include "worker.hpp"
+
+TEST (WorkerTest, MessageLimits) {
+    lua::Message msg;
+    EXPECT_TRUE (msg.assign ("topic", "data"));
+    EXPECT_EQ (msg.size, 4);
+    EXPECT_FALSE (msg.assign (std::string (lua::Message::MaxTopic, 't'), ""));
+    EXPECT_FALSE (msg.assign ("topic", std::string (lua::Message::MaxData + 1, 'd')));
+}
+
+TEST (WorkerTest, PingPong) {
+    using namespace std::chrono;
+    lua::Worker worker;
+    ASSERT_TRUE (worker.start (lua::search_directory(), "background.lua", 5));
+    EXPECT_FALSE (worker.start (lua::search_directory(), "background.lua", 5));
+    EXPECT_TRUE (worker.post ("ping", "hello"));
+
+    lua::Message msg;
+    bool received    = false;
+    const auto until = steady_clock::now() + seconds (2);
+    while (! received && steady_clock::now() < until) {
+        received = worker.poll (msg);
+        if (! received)
+            std::this_thread::sleep_for (milliseconds (1));
+    }
+
+    EXPECT_TRUE (received);
+    EXPECT_EQ (std::string (msg.topic), "pong");
+    EXPECT_EQ (std::string (msg.data, msg.size), "hello");
+
+    worker.stop();
+    EXPECT_FALSE (worker.running());
+}
@@ -0,0 +1,53 @@
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "snider/workpool.hpp"
+
+TEST (WorkPoolTest, RunsEveryJobOnce) {
+    snider::WorkPool pool (4);
+    ASSERT_EQ (pool.size(), 4);
+
+    // the first quarter is far slower, the other workers have to steal it.
+    constexpr int count = 4000;
+    std::vector<std::atomic<int>> runs (count);
+    std::vector<int> workers (count, -1);
+    pool.run (count, [&] (int index, int worker) {
+        volatile double x = 0.0;
+        for (int i = index < count / 4 ? 20000 : 10; --i >= 0;)
+            x = x + 1.0;
+        runs[index].fetch_add (1);
+        workers[index] = worker;
+    });
+
+    for (int i = 0; i < count; ++i) {
+        ASSERT_EQ (runs[i].load(), 1) << "job " << i;
+        EXPECT_GE (workers[i], 0);
+        EXPECT_LT (workers[i], pool.size());
+    }
+}
+
+TEST (WorkPoolTest, RunsBatchesBackToBack) {
+    snider::WorkPool pool (3);
+    std::atomic<long> sum { 0 };
+    for (int batch = 1; batch <= 50; ++batch)
+        pool.run (batch, [&] (int index, int) { sum += index + 1; });
+
+    long expected = 0;
+    for (int batch = 1; batch <= 50; ++batch)
+        expected += batch * (batch + 1) / 2;
+    EXPECT_EQ (sum.load(), expected);
+}
+
+TEST (WorkPoolTest, SingleWorkerRunsInOrder) {
+    snider::WorkPool pool (1);
+    std::vector<int> order;
+    pool.run (100, [&] (int index, int worker) {
+        EXPECT_EQ (worker, 0);
+        order.push_back (index);
+    });
+    ASSERT_EQ (order.size(), 100u);
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ (order[i], i);
+}
@@ -0,0 +1,113 @@
+/** Monte Carlo evaluation of the autonomous trajectories in config.lua.
+
+    Every trajectory runs `config.evaluator.runs` episodes with perturbed
+    start poses, wheel slip and plant gains on all cores, then one is run
+    again on 1, 2, 4... workers to show how throughput scales. Run from the
+    project root so robot/config.lua is found, or pass --robot.
+
+    evaluator [--runs N] [--threads N] [--no-scaling] [--robot DIR] [name...]
+*/
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <frc/trajectory/Trajectory.h>
+
+#include "config.hpp"
+#include "evaluator.hpp"
+#include "scripting.hpp"
+#include "snider/workpool.hpp"
+
+static lua::Lifecycle engine;
+
+namespace detail {
+
+static void usage() {
+    std::clog << "usage: evaluator [--runs N] [--threads N] [--no-scaling] [--robot DIR] [name...]"
+              << std::endl;
+}
+
+static std::vector<int> scalingSteps (int most) {
+    std::vector<int> steps;
+    for (int n = 1; n < most; n *= 2)
+        steps.push_back (n);
+    steps.push_back (most);
+    return steps;
+}
+
+} // namespace detail
+
+int main (int argc, char** argv) {
+    int runs = 0, threads = 0;
+    bool scaling = true;
+    std::vector<std::string> names;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if ((arg == "--runs" || arg == "--threads" || arg == "--robot") && i + 1 < argc) {
+            const std::string value = argv[++i];
+            if (arg == "--runs")
+                runs = std::atoi (value.c_str());
+            else if (arg == "--threads")
+                threads = std::atoi (value.c_str());
+            else
+                lua::set_path (value);
+        } else if (arg == "--no-scaling") {
+            scaling = false;
+        } else if (arg == "--help" || arg.rfind ("--", 0) == 0) {
+            detail::usage();
+            return arg == "--help" ? 0 : 1;
+        } else {
+            names.push_back (arg);
+        }
+    }
+
+    if (! lua::bootstrap()) {
+        std::cerr << "[eval] config.lua could not be loaded" << std::endl;
+        return 1;
+    }
+
+    auto settings = Evaluator::Settings::fromConfig();
+    if (runs > 0)
+        settings.runs = runs;
+    const Evaluator evaluator (settings);
+
+    if (names.empty())
+        names = config::trajectory_names();
+
+    // trajectories are generated once and only read by the workers.
+    std::vector<std::pair<frc::Trajectory, bool>> trajectories;
+    for (const auto& name : names) {
+        try {
+            trajectories.emplace_back (config::trajectory (name), config::trajectory_reverse (name));
+        } catch (const std::exception& e) {
+            std::cerr << "[eval] " << name << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    snider::WorkPool pool (threads);
+    std::clog << "[eval] " << settings.runs << " runs per trajectory on "
+              << pool.size() << " workers" << std::endl;
+    for (std::size_t i = 0; i < names.size(); ++i)
+        Evaluator::report (std::clog, evaluator.evaluate (names[i], trajectories[i].first, trajectories[i].second, pool));
+
+    if (! scaling || names.empty())
+        return 0;
+
+    std::clog << "[eval] scaling (" << names.front() << "):";
+    double single = 0.0;
+    for (int workers : detail::scalingSteps (pool.size())) {
+        snider::WorkPool sized (workers);
+        const auto stats = evaluator.evaluate (names.front(), trajectories.front().first, trajectories.front().second, sized);
+        if (workers == 1)
+            single = stats.runsPerSecond;
+        std::clog << " " << workers << "=" << std::fixed << std::setprecision (0) << stats.runsPerSecond
+                  << "/s (x" << std::setprecision (2) << (single > 0.0 ? stats.runsPerSecond / single : 0.0) << ")";
+    }
+    std::clog << std::endl;
+    return 0;
+}
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+
+## Precompiles robot/*.lua and *.bot in to one bundle file the robot maps in to
+# memory at startup. see src/luabundle.hpp for the loader.
+#
+# usage: bundle-lua.py [--luajit PATH] [--target 32|64] --output FILE DIR
+#
+# Chunks are compiled with `luajit -b`. When the target's bytecode can't be
+# produced on this machine (e.g. a 64 bit GC64 LuaJIT without -W for the 32
+# bit roboRIO) the source is bundled instead, which still loads from memory.
+#
+# File layout, little endian:
+#   header  "SNLB" u32 version, u32 count, u32 reserved
+#   index   count x { u32 name offset, u32 name size, u32 data offset,
+#                     u32 data size, u32 flags, u32 reserved }, sorted by name
+#   names, then chunk data.
+
+import argparse
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+MAGIC = b'SNLB'
+VERSION = 2
+HEADER = struct.Struct('<4sIII')
+ENTRY = struct.Struct('<IIIIII')
+FLAG_BYTECODE = 1
+
+# written at runtime by characterize.bot, on the robot or in the simulator.
+# Never bundled, and the deploy clean step leaves the robot's copy alone.
+EXCLUDE = {'config_overlay.lua'}
+
+# Returns script paths relative to `root`, with forward slashes.
+def script_files(root):
+    out = []
+    for parent, _, files in os.walk(root):
+        for f in files:
+            if f in EXCLUDE:
+                continue
+            if f.endswith('.lua') or f.endswith('.bot'):
+                path = os.path.relpath(os.path.join(parent, f), root)
+                out.append(path.replace(os.sep, '/'))
+    return sorted(out)
+
+# Returns (bytecode, error) for a file, bytecode is None if luajit couldn't make it.
+def compile_chunk(luajit, path, target):
+    flags = []
+    if target == '32':
+        flags.append('-W')
+    elif target == '64':
+        flags.append('-X')
+
+    fd, out = tempfile.mkstemp(suffix='.raw')
+    os.close(fd)
+    try:
+        # -g keeps line numbers for error messages.
+        cmd = [luajit, '-b', '-g', '-t', 'raw'] + flags + [path, out]
+        try:
+            result = subprocess.run(cmd, capture_output=True, text=True)
+        except OSError as e:
+            return None, str(e)
+        if result.returncode != 0:
+            return None, result.stderr.strip()
+        with open(out, 'rb') as f:
+            return f.read(), ''
+    finally:
+        os.remove(out)
+
+def main():
+    parser = argparse.ArgumentParser(description='Bundle robot scripts.')
+    parser.add_argument('--luajit', default='', help='luajit used to compile, empty bundles source')
+    parser.add_argument('--target', default='', choices=['', '32', '64'], help='target bytecode width')
+    parser.add_argument('--output', required=True)
+    parser.add_argument('directory')
+    args = parser.parse_args()
+
+    chunks = []
+    warned = False
+    for name in script_files(args.directory):
+        path = os.path.join(args.directory, name)
+        with open(path, 'rb') as f:
+            source = f.read()
+        data, flags = source, 0
+        if args.luajit:
+            code, error = compile_chunk(args.luajit, path, args.target)
+            if code is not None:
+                data, flags = code, FLAG_BYTECODE
+            elif not warned:
+                print('bundle-lua: no bytecode, bundling source (%s)' % error, file=sys.stderr)
+                warned = True
+        chunks.append((name.encode('utf-8'), data, flags))
+
+    names = b''.join(c[0] for c in chunks)
+    offset = HEADER.size + ENTRY.size * len(chunks)
+    name_offset = offset
+    data_offset = offset + len(names)
+
+    index = b''
+    for name, data, flags in chunks:
+        index += ENTRY.pack(name_offset, len(name), data_offset, len(data), flags, 0)
+        name_offset += len(name)
+        data_offset += len(data)
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, 'wb') as f:
+        f.write(HEADER.pack(MAGIC, VERSION, len(chunks), 0))
+        f.write(index)
+        f.write(names)
+        for chunk in chunks:
+            f.write(chunk[1])
+
+    compiled = sum(1 for c in chunks if c[2] & FLAG_BYTECODE)
+    print('bundle-lua: %d chunks (%d bytecode) -> %s' % (len(chunks), compiled, args.output))
+
+if __name__ == '__main__':
+    main()